@@ -27,7 +27,10 @@ WAYLANDCLIENTSOURCES += \
             ../extensions/touch-extension.xml \
             ../extensions/qt-key-unstable-v1.xml \
             ../extensions/qt-windowmanager.xml \
+            ../extensions/qt-glyph-cache-unstable-v1.xml \
             ../3rdparty/protocol/text-input-unstable-v2.xml \
+            ../3rdparty/protocol/viewporter.xml \
+            ../3rdparty/protocol/presentation-time.xml \
 
 WAYLANDCLIENTSOURCES_SYSTEM += \
             ../3rdparty/protocol/wayland.xml \
@@ -45,16 +48,20 @@ SOURCES +=  qwaylandintegration.cpp \
             qwaylandsubsurface.cpp \
             qwaylandtouch.cpp \
             qwaylandqtkey.cpp \
+            qwaylandglyphcache.cpp \
+            qwaylandpresentationtime.cpp \
             ../shared/qwaylandmimehelper.cpp \
             ../shared/qwaylandxkb.cpp \
             ../shared/qwaylandinputmethodeventbuilder.cpp \
             qwaylandabstractdecoration.cpp \
+            qwaylanddecorationsubsurfaces.cpp \
             qwaylanddecorationfactory.cpp \
             qwaylanddecorationplugin.cpp \
             qwaylandwindowmanagerintegration.cpp \
             qwaylandinputcontext.cpp \
             qwaylandshm.cpp \
             qwaylandbuffer.cpp \
+            qwaylandstartupprofiler.cpp \
 
 HEADERS +=  qwaylandintegration_p.h \
             qwaylandnativeinterface_p.h \
@@ -70,18 +77,23 @@ HEADERS +=  qwaylandintegration_p.h \
             qwaylandsubsurface_p.h \
             qwaylandtouch_p.h \
             qwaylandqtkey_p.h \
+            qwaylandglyphcache_p.h \
+            qwaylandpresentationtime_p.h \
             qwaylandabstractdecoration_p.h \
+            qwaylanddecorationsubsurfaces_p.h \
             qwaylanddecorationfactory_p.h \
             qwaylanddecorationplugin_p.h \
             qwaylandwindowmanagerintegration_p.h \
             qwaylandinputcontext_p.h \
             qwaylandshm_p.h \
+            qwaylandstartupprofiler_p.h \
             qtwaylandclientglobal.h \
             qtwaylandclientglobal_p.h \
             ../shared/qwaylandinputmethodeventbuilder_p.h \
             ../shared/qwaylandmimehelper_p.h \
             ../shared/qwaylandxkb_p.h \
             ../shared/qwaylandsharedmemoryformathelper_p.h \
+            ../shared/qwaylandglyphcacheentry_p.h \
 
 qtConfig(clipboard) {
     HEADERS += qwaylandclipboard_p.h
@@ -93,6 +105,13 @@ include(shellintegration/shellintegration.pri)
 include(inputdeviceintegration/inputdeviceintegration.pri)
 include(global/global.pri)
 
+qtConfig(xkbcommon-evdev) {
+    HEADERS += \
+        qwaylandkeymapcache_p.h
+    SOURCES += \
+        qwaylandkeymapcache.cpp
+}
+
 qtConfig(cursor) {
     QMAKE_USE += wayland-cursor
 
@@ -107,12 +126,14 @@ qtConfig(wayland-datadevice) {
         qwaylanddatadevice_p.h \
         qwaylanddatadevicemanager_p.h \
         qwaylanddataoffer_p.h \
-        qwaylanddatasource_p.h
+        qwaylanddatasource_p.h \
+        ../shared/qwaylanddatawriter_p.h
     SOURCES += \
         qwaylanddatadevice.cpp \
         qwaylanddatadevicemanager.cpp \
         qwaylanddataoffer.cpp \
-        qwaylanddatasource.cpp
+        qwaylanddatasource.cpp \
+        ../shared/qwaylanddatawriter.cpp
 }
 
 qtConfig(draganddrop) {
@@ -51,6 +51,16 @@ QWaylandServerBuffer::~QWaylandServerBuffer()
 {
 }
 
+/*
+    Returns the contents of the buffer for raster rendering, or a null image if
+    the buffer can only be used as a texture. Integrations backed by memory the
+    client can map should return a view of it rather than a copy.
+*/
+QImage QWaylandServerBuffer::toImage()
+{
+    return QImage();
+}
+
 QWaylandServerBuffer::Format QWaylandServerBuffer::format() const
 {
     return m_format;
@@ -61,6 +71,18 @@ QSize QWaylandServerBuffer::size() const
     return m_size;
 }
 
+/*
+    Returns the areas the compositor has updated since the last call, so raster
+    users of toImage() know what to repaint. Textures returned by
+    toOpenGlTexture() are kept up to date by the integration itself.
+*/
+QRegion QWaylandServerBuffer::takeDamage()
+{
+    QRegion damage = m_damage;
+    m_damage = QRegion();
+    return damage;
+}
+
 void QWaylandServerBuffer::setUserData(void *userData)
 {
     m_user_data = userData;
@@ -52,6 +52,8 @@
 //
 
 #include <QtCore/QSize>
+#include <QtGui/QImage>
+#include <QtGui/QRegion>
 #include <QtGui/qopengl.h>
 
 #include <QtWaylandClient/private/qwayland-server-buffer-extension.h>
@@ -77,16 +79,20 @@ public:
     virtual ~QWaylandServerBuffer();
 
     virtual QOpenGLTexture *toOpenGlTexture() = 0;
+    virtual QImage toImage();
 
     Format format() const;
     QSize size() const;
 
+    QRegion takeDamage();
+
     void setUserData(void *userData);
     void *userData() const;
 
 protected:
     Format m_format;
     QSize m_size;
+    QRegion m_damage;
 
 private:
     void *m_user_data = nullptr;
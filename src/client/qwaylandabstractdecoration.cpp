@@ -47,6 +47,10 @@
 #include "qwaylandscreen_p.h"
 
 #include <QtGui/QImage>
+#include <QtGui/QPainter>
+#if QT_CONFIG(picture)
+#include <QtGui/QPicture>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -60,11 +64,17 @@ public:
     QWaylandAbstractDecorationPrivate();
     ~QWaylandAbstractDecorationPrivate() override;
 
+    void renderEdges();
+
     QWindow *m_window = nullptr;
     QWaylandWindow *m_wayland_window = nullptr;
 
+    // m_isDirty means the whole frame needs repainting, otherwise only m_dirtyRegion does
     bool m_isDirty = true;
+    QRegion m_dirtyRegion;
+    bool m_contentImageDirty = true;
     QImage m_decorationContentImage;
+    QImage m_edgeImages[4];
 
     Qt::MouseButtons m_mouseButtons = Qt::NoButton;
 };
@@ -78,6 +88,62 @@ QWaylandAbstractDecorationPrivate::~QWaylandAbstractDecorationPrivate()
 {
 }
 
+static const Qt::Edge decorationEdges[] = { Qt::TopEdge, Qt::LeftEdge, Qt::RightEdge, Qt::BottomEdge };
+
+static int edgeIndex(Qt::Edge edge)
+{
+    switch (edge) {
+    case Qt::TopEdge: return 0;
+    case Qt::LeftEdge: return 1;
+    case Qt::RightEdge: return 2;
+    case Qt::BottomEdge: return 3;
+    }
+    return 0;
+}
+
+// Repaints the dirty parts of the four margin tiles. Only the margins are ever
+// backed by memory, the area covered by the window contents is never allocated.
+void QWaylandAbstractDecorationPrivate::renderEdges()
+{
+    Q_Q(QWaylandAbstractDecoration);
+
+    const int scale = m_wayland_window->scale();
+    QRegion region = q->dirtyRegion();
+
+    for (Qt::Edge edge : decorationEdges) {
+        QImage &image = m_edgeImages[edgeIndex(edge)];
+        const QRect rect = q->edgeRect(edge);
+        if (image.size() != rect.size() * scale || image.devicePixelRatio() != scale) {
+            image = rect.isEmpty() ? QImage() : QImage(rect.size() * scale, QImage::Format_ARGB32_Premultiplied);
+            image.setDevicePixelRatio(scale);
+            region += rect;
+        }
+    }
+
+    m_isDirty = false;
+    m_dirtyRegion = QRegion();
+
+    if (region.isEmpty())
+        return;
+
+    for (Qt::Edge edge : decorationEdges) {
+        QImage &image = m_edgeImages[edgeIndex(edge)];
+        const QRect rect = q->edgeRect(edge);
+        const QRegion clip = region & rect;
+        if (image.isNull() || clip.isEmpty())
+            continue;
+
+        QPainter painter(&image);
+        painter.translate(-rect.topLeft());
+        painter.setClipRegion(clip);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRect &r : clip)
+            painter.fillRect(r, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        q->paintDecoration(&painter, clip);
+    }
+}
+
 QWaylandAbstractDecoration::QWaylandAbstractDecoration()
     : QObject(*new QWaylandAbstractDecorationPrivate)
 {
@@ -103,7 +169,7 @@ void QWaylandAbstractDecoration::setWaylandWindow(QWaylandWindow *window)
 const QImage &QWaylandAbstractDecoration::contentImage()
 {
     Q_D(QWaylandAbstractDecoration);
-    if (d->m_isDirty) {
+    if (d->m_contentImageDirty) {
         //Update the decoration backingstore
 
         const int scale = waylandWindow()->scale();
@@ -113,16 +179,78 @@ const QImage &QWaylandAbstractDecoration::contentImage()
         d->m_decorationContentImage.fill(Qt::transparent);
         this->paint(&d->m_decorationContentImage);
 
-        d->m_isDirty = false;
+        d->m_contentImageDirty = false;
     }
 
     return d->m_decorationContentImage;
 }
 
+// Returns the part of the frame covered by the given margin, in frame coordinates.
+// The top and bottom tiles span the full frame width, the side tiles sit between them.
+QRect QWaylandAbstractDecoration::edgeRect(Qt::Edge edge) const
+{
+    const QSize frameSize = window()->frameGeometry().size();
+    const QMargins m = margins();
+    const int sideHeight = qMax(0, frameSize.height() - m.top() - m.bottom());
+
+    switch (edge) {
+    case Qt::TopEdge:
+        return QRect(0, 0, frameSize.width(), m.top());
+    case Qt::LeftEdge:
+        return QRect(0, m.top(), m.left(), sideHeight);
+    case Qt::RightEdge:
+        return QRect(frameSize.width() - m.right(), m.top(), m.right(), sideHeight);
+    case Qt::BottomEdge:
+        return QRect(0, frameSize.height() - m.bottom(), frameSize.width(), m.bottom());
+    }
+    return QRect();
+}
+
+// Returns the decoration contents of the given margin, sized to edgeRect(edge)
+// at the window scale. Only the dirty parts of the tiles are repainted.
+const QImage &QWaylandAbstractDecoration::edgeImage(Qt::Edge edge)
+{
+    Q_D(QWaylandAbstractDecoration);
+    d->renderEdges();
+    return d->m_edgeImages[edgeIndex(edge)];
+}
+
+// Paints the parts of the decoration inside \a region, given in frame coordinates.
+// The painter is already clipped to the region. Decorations should reimplement this
+// to skip the elements they don't need to repaint; the default implementation replays
+// the whole of paint().
+void QWaylandAbstractDecoration::paintDecoration(QPainter *painter, const QRegion &region)
+{
+    Q_UNUSED(region);
+#if QT_CONFIG(picture)
+    QPicture picture;
+    paint(&picture);
+    painter->drawPicture(0, 0, picture);
+#else
+    const int scale = waylandWindow()->scale();
+    QImage image(window()->frameGeometry().size() * scale, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(scale);
+    image.fill(Qt::transparent);
+    paint(&image);
+    painter->drawImage(0, 0, image);
+#endif
+}
+
 void QWaylandAbstractDecoration::update()
 {
     Q_D(QWaylandAbstractDecoration);
     d->m_isDirty = true;
+    d->m_dirtyRegion = QRegion();
+    d->m_contentImageDirty = true;
+}
+
+// Marks only \a rect, in frame coordinates, as needing a repaint
+void QWaylandAbstractDecoration::update(const QRect &rect)
+{
+    Q_D(QWaylandAbstractDecoration);
+    if (!d->m_isDirty)
+        d->m_dirtyRegion += rect;
+    d->m_contentImageDirty = true;
 }
 
 void QWaylandAbstractDecoration::setMouseButtons(Qt::MouseButtons mb)
@@ -168,7 +296,20 @@ bool QWaylandAbstractDecoration::isLeftReleased(Qt::MouseButtons newMouseButtonS
 bool QWaylandAbstractDecoration::isDirty() const
 {
     Q_D(const QWaylandAbstractDecoration);
-    return d->m_isDirty;
+    return d->m_isDirty || !d->m_dirtyRegion.isEmpty();
+}
+
+QRegion QWaylandAbstractDecoration::dirtyRegion() const
+{
+    Q_D(const QWaylandAbstractDecoration);
+    if (!d->m_isDirty)
+        return d->m_dirtyRegion;
+
+    // Even a full repaint only touches the margins, never the area under the contents
+    QRegion region;
+    for (Qt::Edge edge : decorationEdges)
+        region += edgeRect(edge);
+    return region;
 }
 
 QWindow *QWaylandAbstractDecoration::window() const
@@ -59,6 +59,7 @@
 #include <QtGui/QColor>
 #include <QtGui/QStaticText>
 #include <QtGui/QImage>
+#include <QtGui/QRegion>
 #include <QtWaylandClient/qtwaylandclientglobal.h>
 
 #include <wayland-client.h>
@@ -91,17 +92,23 @@ public:
     QWaylandWindow *waylandWindow() const;
 
     void update();
+    void update(const QRect &rect);
     bool isDirty() const;
+    QRegion dirtyRegion() const;
 
     virtual QMargins margins() const = 0;
     QWindow *window() const;
     const QImage &contentImage();
 
+    QRect edgeRect(Qt::Edge edge) const;
+    const QImage &edgeImage(Qt::Edge edge);
+
     virtual bool handleMouse(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global,Qt::MouseButtons b,Qt::KeyboardModifiers mods) = 0;
     virtual bool handleTouch(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global, Qt::TouchPointState state, Qt::KeyboardModifiers mods) = 0;
 
 protected:
     virtual void paint(QPaintDevice *device) = 0;
+    virtual void paintDecoration(QPainter *painter, const QRegion &region);
 
     void setMouseButtons(Qt::MouseButtons mb);
 
@@ -44,15 +44,123 @@
 #include "qwaylandscreen_p.h"
 #include "qwaylandshmbackingstore_p.h"
 
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QtEndian>
 #include <QtGui/QImageReader>
 #include <QDebug>
 
 #include <wayland-cursor.h>
 
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC     0x0001U
+#  endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
 
+// Xcursor files, see Xcursor(3)
+static uint cursorBufferGeneration = 0;
+
+static const quint32 XcursorMagic = 0x72756358; // "Xcur"
+static const quint32 XcursorImageType = 0xfffd0002;
+static const quint32 XcursorImageHeaderSize = 36;
+static const quint32 XcursorImageMaxSize = 0x7fff;
+
+static QStringList cursorSearchPath()
+{
+    QByteArray path = qgetenv("XCURSOR_PATH");
+    if (path.isEmpty()) {
+        QByteArray dataHome = qgetenv("XDG_DATA_HOME");
+        if (dataHome.isEmpty())
+            dataHome = "~/.local/share";
+        path = dataHome + "/icons:~/.icons:/usr/share/icons:/usr/share/pixmaps:~/.cursors:/usr/share/cursors/xorg-x11:/usr/X11R6/lib/X11/icons";
+    }
+
+    const QString home = QDir::homePath();
+    QStringList dirs;
+    for (const QByteArray &entry : path.split(':')) {
+        if (entry.isEmpty())
+            continue;
+        QString dir = QFile::decodeName(entry);
+        if (dir.startsWith(QLatin1Char('~')))
+            dir.replace(0, 1, home);
+        dirs.append(dir);
+    }
+    return dirs;
+}
+
+// Resolves the theme and everything it inherits into the list of cursors
+// directories to search, once, instead of loading all of their cursors
+static void resolveTheme(const QString &themeName, const QStringList &searchPath, QStringList *visited, QStringList *cursorDirs)
+{
+    if (themeName.isEmpty() || visited->contains(themeName))
+        return;
+    visited->append(themeName);
+
+    QStringList inherits;
+    bool foundIndex = false;
+    for (const QString &dir : searchPath) {
+        const QString themeDir = dir + QLatin1Char('/') + themeName;
+        const QString cursors = themeDir + QLatin1String("/cursors");
+        if (QFileInfo(cursors).isDir())
+            cursorDirs->append(cursors);
+
+        // Like libXcursor, only the first index.theme counts
+        QFile index(themeDir + QLatin1String("/index.theme"));
+        if (foundIndex || !index.open(QIODevice::ReadOnly))
+            continue;
+        foundIndex = true;
+        while (!index.atEnd()) {
+            const QByteArray line = index.readLine().trimmed();
+            if (!line.startsWith("Inherits"))
+                continue;
+            const int equals = line.indexOf('=');
+            if (equals < 0)
+                continue;
+            const QString value = QString::fromUtf8(line.mid(equals + 1));
+            for (const QString &parent : value.split(QRegularExpression(QStringLiteral("[,;\\s]+")), QString::SkipEmptyParts))
+                inherits.append(parent);
+        }
+    }
+
+    for (const QString &parent : qAsConst(inherits))
+        resolveTheme(parent, searchPath, visited, cursorDirs);
+}
+
+static int createPoolFile(int size)
+{
+    int fd = -1;
+#ifdef SYS_memfd_create
+    fd = int(syscall(SYS_memfd_create, "wayland-cursor", MFD_CLOEXEC));
+#endif
+    if (fd < 0) {
+        QByteArray name = QFile::encodeName(QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)
+                                            + QLatin1String("/wayland-cursor-XXXXXX"));
+        fd = mkostemp(name.data(), O_CLOEXEC);
+        if (fd >= 0)
+            unlink(name.constData());
+    }
+    if (fd >= 0 && ftruncate(fd, size) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
 QWaylandCursorTheme *QWaylandCursorTheme::create(QWaylandShm *shm, int size)
 {
     static QString themeName = qEnvironmentVariable("XCURSOR_THEME", QStringLiteral("default"));
@@ -61,26 +169,202 @@ QWaylandCursorTheme *QWaylandCursorTheme::create(QWaylandShm *shm, int size)
 
 QWaylandCursorTheme *QWaylandCursorTheme::create(QWaylandShm *shm, int size, const QString &themeName)
 {
-    QByteArray nameBytes = themeName.toLocal8Bit();
-    struct ::wl_cursor_theme *theme = wl_cursor_theme_load(nameBytes.constData(), size, shm->object());
+    QStringList visited;
+    QStringList cursorDirs;
+    resolveTheme(themeName, cursorSearchPath(), &visited, &cursorDirs);
 
-    if (!theme) {
-        qCWarning(lcQpaWayland) << "Could not load cursor theme" << themeName << "size" << size;
-        return nullptr;
-    }
+    if (cursorDirs.isEmpty())
+        qCDebug(lcQpaWayland) << "Cursor theme" << themeName << "not found, using the built-in cursors";
 
-    return new QWaylandCursorTheme(theme);
+    return new QWaylandCursorTheme(shm, size, themeName, cursorDirs);
+}
+
+QWaylandCursorTheme::QWaylandCursorTheme(QWaylandShm *shm, int size, const QString &themeName, const QStringList &cursorDirs)
+    : m_shm(shm)
+    , m_size(size)
+    , m_themeName(themeName)
+    , m_cursorDirs(cursorDirs)
+{
 }
 
 QWaylandCursorTheme::~QWaylandCursorTheme()
 {
-    wl_cursor_theme_destroy(m_theme);
+    ++cursorBufferGeneration;
+    for (struct ::wl_buffer *buffer : qAsConst(m_buffers))
+        wl_buffer_destroy(buffer);
+    if (m_pool)
+        wl_shm_pool_destroy(m_pool);
+    if (m_poolData)
+        munmap(m_poolData, size_t(m_poolSize));
+    if (m_poolFd >= 0)
+        close(m_poolFd);
+    if (m_fallbackTheme)
+        wl_cursor_theme_destroy(m_fallbackTheme);
+}
+
+uchar *QWaylandCursorTheme::allocate(int bytes, int *offset)
+{
+    if (m_poolUsed + bytes > m_poolSize) {
+        // Room for a few more shapes of the same size, to avoid growing on every new shape
+        int newSize = qMax(m_poolSize * 2, m_poolUsed + bytes);
+        newSize = qMax(newSize, m_size * m_size * 4 * 4);
+
+        if (m_poolFd < 0) {
+            m_poolFd = createPoolFile(newSize);
+            if (m_poolFd < 0) {
+                qCWarning(lcQpaWayland) << "Could not create a shared memory pool for cursors";
+                return nullptr;
+            }
+        } else if (ftruncate(m_poolFd, newSize) < 0) {
+            qCWarning(lcQpaWayland) << "Could not grow the shared memory pool for cursors";
+            return nullptr;
+        }
+
+        uchar *data = static_cast<uchar *>(mmap(nullptr, size_t(newSize), PROT_READ | PROT_WRITE, MAP_SHARED, m_poolFd, 0));
+        if (data == MAP_FAILED) {
+            qCWarning(lcQpaWayland) << "Could not map the shared memory pool for cursors";
+            return nullptr;
+        }
+        if (m_poolData)
+            munmap(m_poolData, size_t(m_poolSize));
+        m_poolData = data;
+
+        if (m_pool)
+            wl_shm_pool_resize(m_pool, newSize);
+        else
+            m_pool = wl_shm_create_pool(m_shm->object(), m_poolFd, newSize);
+        m_poolSize = newSize;
+    }
+
+    *offset = m_poolUsed;
+    m_poolUsed += bytes;
+    return m_poolData + *offset;
+}
+
+static bool readCard32(QFile *file, quint32 *values, int count)
+{
+    const qint64 bytes = qint64(count) * 4;
+    if (file->read(reinterpret_cast<char *>(values), bytes) != bytes)
+        return false;
+    for (int i = 0; i < count; ++i)
+        values[i] = qFromLittleEndian(values[i]);
+    return true;
+}
+
+QWaylandCursorTheme::Image QWaylandCursorTheme::loadImage(QFile *file, quint32 nominalSize, quint32 position)
+{
+    quint32 chunk[9]; // header size, type, nominal size, version, width, height, hot spot x and y, delay
+    if (!file->seek(position) || !readCard32(file, chunk, 9)
+            || chunk[0] != XcursorImageHeaderSize || chunk[1] != XcursorImageType
+            || chunk[2] != nominalSize || !chunk[4] || !chunk[5]
+            || chunk[4] > XcursorImageMaxSize || chunk[5] > XcursorImageMaxSize
+            || chunk[6] > chunk[4] || chunk[7] > chunk[5]) {
+        qCWarning(lcQpaWayland) << "Invalid cursor file" << file->fileName();
+        return Image();
+    }
+
+    const int width = int(chunk[4]);
+    const int height = int(chunk[5]);
+    const int stride = width * 4;
+    int offset = 0;
+    uchar *pixels = allocate(stride * height, &offset);
+    if (!pixels)
+        return Image();
+
+    // Xcursor pixels are premultiplied ARGB in little endian, which is what WL_SHM_FORMAT_ARGB8888 is
+    if (file->read(reinterpret_cast<char *>(pixels), stride * height) != stride * height) {
+        qCWarning(lcQpaWayland) << "Truncated cursor file" << file->fileName();
+        m_poolUsed = offset;
+        return Image();
+    }
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    quint32 *argb = reinterpret_cast<quint32 *>(pixels);
+    for (int i = 0; i < width * height; ++i)
+        argb[i] = qFromLittleEndian(argb[i]);
+#endif
+
+    Image image;
+    image.buffer = wl_shm_pool_create_buffer(m_pool, offset, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    image.hotSpot = QPoint(int(chunk[6]), int(chunk[7]));
+    image.size = QSize(width, height);
+    image.delay = chunk[8];
+    m_buffers.append(image.buffer);
+    return image;
+}
+
+QVector<QWaylandCursorTheme::Image> QWaylandCursorTheme::loadCursor(const QByteArray &name)
+{
+    const QString fileName = QFile::decodeName(name);
+    QFile file;
+    for (const QString &dir : qAsConst(m_cursorDirs)) {
+        file.setFileName(dir + QLatin1Char('/') + fileName);
+        if (file.open(QIODevice::ReadOnly))
+            break;
+    }
+    if (!file.isOpen())
+        return QVector<Image>();
+
+    quint32 header[4]; // magic, header size, version, number of table of contents entries
+    if (!readCard32(&file, header, 4) || header[0] != XcursorMagic || header[3] > 0x10000 || !file.seek(header[1]))
+        return QVector<Image>();
+
+    // Only the frames of the nominal size closest to the one requested are used
+    quint32 bestSize = 0;
+    QVector<QPair<quint32, quint32>> images; // nominal size and position
+    for (quint32 i = 0; i < header[3]; ++i) {
+        quint32 entry[3]; // type, nominal size, position
+        if (!readCard32(&file, entry, 3))
+            return QVector<Image>();
+        if (entry[0] != XcursorImageType)
+            continue;
+        images.append(qMakePair(entry[1], entry[2]));
+        if (!bestSize || qAbs(int(entry[1]) - m_size) < qAbs(int(bestSize) - m_size))
+            bestSize = entry[1];
+    }
+
+    QVector<Image> frames;
+    for (const auto &image : qAsConst(images)) {
+        if (image.first != bestSize)
+            continue;
+        const Image frame = loadImage(&file, image.first, image.second);
+        if (!frame.buffer)
+            break;
+        frames.append(frame);
+    }
+    return frames;
 }
 
-wl_cursor *QWaylandCursorTheme::requestCursor(WaylandCursor shape)
+QVector<QWaylandCursorTheme::Image> QWaylandCursorTheme::loadFallbackCursor(const QByteArray &name)
 {
-    if (struct wl_cursor *cursor = m_cursors.value(shape, nullptr))
-        return cursor;
+    // libwayland-cursor has a few cursors built in, which it uses when the
+    // theme can't be found. This loads the whole theme, so it's a last resort.
+    if (!m_fallbackTheme) {
+        m_fallbackTheme = wl_cursor_theme_load(m_themeName.toLocal8Bit().constData(), m_size, m_shm->object());
+        if (!m_fallbackTheme) {
+            qCWarning(lcQpaWayland) << "Could not load cursor theme" << m_themeName << "size" << m_size;
+            return QVector<Image>();
+        }
+    }
+
+    QVector<Image> frames;
+    struct wl_cursor *cursor = wl_cursor_theme_get_cursor(m_fallbackTheme, name.constData());
+    for (uint i = 0; cursor && i < cursor->image_count; ++i) {
+        struct wl_cursor_image *cursorImage = cursor->images[i];
+        Image image;
+        image.buffer = wl_cursor_image_get_buffer(cursorImage);
+        image.hotSpot = QPoint(int(cursorImage->hotspot_x), int(cursorImage->hotspot_y));
+        image.size = QSize(int(cursorImage->width), int(cursorImage->height));
+        image.delay = cursorImage->delay;
+        frames.append(image);
+    }
+    return frames;
+}
+
+QVector<QWaylandCursorTheme::Image> QWaylandCursorTheme::requestCursor(WaylandCursor shape)
+{
+    const auto cached = m_cursors.constFind(shape);
+    if (cached != m_cursors.constEnd())
+        return *cached;
 
     static const QMultiMap<WaylandCursor, QByteArray>cursorNamesMap {
         {ArrowCursor, "left_ptr"},
@@ -202,9 +486,17 @@ wl_cursor *QWaylandCursorTheme::requestCursor(WaylandCursor shape)
 
     QList<QByteArray> cursorNames = cursorNamesMap.values(shape);
     for (auto &name : qAsConst(cursorNames)) {
-        if (wl_cursor *cursor = wl_cursor_theme_get_cursor(m_theme, name.constData())) {
-            m_cursors.insert(shape, cursor);
-            return cursor;
+        const QVector<Image> frames = loadCursor(name);
+        if (!frames.isEmpty()) {
+            m_cursors.insert(shape, frames);
+            return frames;
+        }
+    }
+    for (auto &name : qAsConst(cursorNames)) {
+        const QVector<Image> frames = loadFallbackCursor(name);
+        if (!frames.isEmpty()) {
+            m_cursors.insert(shape, frames);
+            return frames;
         }
     }
 
@@ -213,40 +505,41 @@ wl_cursor *QWaylandCursorTheme::requestCursor(WaylandCursor shape)
         return requestCursor(ArrowCursor);
 
     // Give up
-    return nullptr;
+    return QVector<Image>();
 }
 
-struct wl_cursor_image *QWaylandCursorTheme::cursorImage(Qt::CursorShape shape)
+QVector<QWaylandCursorTheme::Image> QWaylandCursorTheme::cursorFrames(Qt::CursorShape shape)
 {
-    struct wl_cursor *waylandCursor = nullptr;
+    QVector<Image> frames;
 
     if (shape < Qt::BitmapCursor) {
-        waylandCursor = requestCursor(WaylandCursor(shape));
+        frames = requestCursor(WaylandCursor(shape));
     } else if (shape == Qt::BitmapCursor) {
         qCWarning(lcQpaWayland) << "cannot create a wl_cursor_image for a CursorShape";
-        return nullptr;
+        return frames;
     } else {
         //TODO: Custom cursor logic (for resize arrows)
     }
 
-    if (!waylandCursor) {
+    if (frames.isEmpty())
         qCWarning(lcQpaWayland) << "Could not find cursor for shape" << shape;
-        return nullptr;
-    }
 
-    struct wl_cursor_image *image = waylandCursor->images[0];
-    struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
-    if (!buffer) {
-        qCWarning(lcQpaWayland) << "Could not find buffer for cursor";
-        return nullptr;
-    }
+    return frames;
+}
 
-    return image;
+QWaylandCursorTheme::Image QWaylandCursorTheme::cursorImage(Qt::CursorShape shape)
+{
+    return cursorFrames(shape).value(0);
 }
 
+// Applications with many custom cursors switch between them on every
+// mouse move, so the buffers are kept around within a budget
+static const int BitmapBufferCacheSize = 4 * 1024 * 1024;
+
 QWaylandCursor::QWaylandCursor(QWaylandScreen *screen)
     : mDisplay(screen->display())
     , mCursorTheme(mDisplay->loadCursorTheme(screen->devicePixelRatio()))
+    , mBitmapBuffers(BitmapBufferCacheSize)
 {
 }
 
@@ -255,17 +548,32 @@ QSharedPointer<QWaylandBuffer> QWaylandCursor::cursorBitmapImage(const QCursor *
     if (cursor->shape() != Qt::BitmapCursor)
         return QSharedPointer<QWaylandShmBuffer>();
 
-    const QImage &img = cursor->pixmap().toImage();
-    QSharedPointer<QWaylandShmBuffer> buffer(new QWaylandShmBuffer(mDisplay, img.size(), img.format()));
+    // Modifying a pixmap, or changing its device pixel ratio, gives it a new cache key
+    const QPixmap pixmap = cursor->pixmap();
+    if (QSharedPointer<QWaylandBuffer> *cached = mBitmapBuffers.object(pixmap.cacheKey()))
+        return *cached;
+
+    const QImage &img = pixmap.toImage();
+    QSharedPointer<QWaylandShmBuffer> buffer(new QWaylandShmBuffer(mDisplay, img.size(), img.format()),
+                                             [](QWaylandShmBuffer *buffer) {
+        ++cursorBufferGeneration;
+        delete buffer;
+    });
     memcpy(buffer->image()->bits(), img.bits(), img.sizeInBytes());
+    mBitmapBuffers.insert(pixmap.cacheKey(), new QSharedPointer<QWaylandBuffer>(buffer), int(img.sizeInBytes()));
     return buffer;
 }
 
-struct wl_cursor_image *QWaylandCursor::cursorImage(Qt::CursorShape shape)
+uint QWaylandCursor::bufferGeneration()
+{
+    return cursorBufferGeneration;
+}
+
+QVector<QWaylandCursorTheme::Image> QWaylandCursor::cursorFrames(Qt::CursorShape shape)
 {
     if (!mCursorTheme)
-        return nullptr;
-    return mCursorTheme->cursorImage(shape);
+        return QVector<QWaylandCursorTheme::Image>();
+    return mCursorTheme->cursorFrames(shape);
 }
 
 void QWaylandCursor::changeCursor(QCursor *cursor, QWindow *window)
@@ -273,7 +581,7 @@ void QWaylandCursor::changeCursor(QCursor *cursor, QWindow *window)
     const Qt::CursorShape newShape = cursor ? cursor->shape() : Qt::ArrowCursor;
 
     if (newShape == Qt::BlankCursor) {
-        mDisplay->setCursor(nullptr, nullptr, 1);
+        mDisplay->setCursor(nullptr, QPoint(), QSize(), 1);
         return;
     }
 
@@ -287,9 +595,9 @@ void QWaylandCursor::changeCursor(QCursor *cursor, QWindow *window)
         return;
     }
 
-    if (struct ::wl_cursor_image *image = mCursorTheme->cursorImage(newShape)) {
-        struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
-        mDisplay->setCursor(buffer, image, window->screen()->devicePixelRatio());
+    const QWaylandCursorTheme::Image image = mCursorTheme->cursorImage(newShape);
+    if (image.buffer) {
+        mDisplay->setCursor(image.buffer, image.hotSpot, image.size, window->screen()->devicePixelRatio());
         return;
     }
 
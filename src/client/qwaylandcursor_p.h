@@ -52,17 +52,23 @@
 //
 
 #include <qpa/qplatformcursor.h>
+#include <QtCore/QCache>
 #include <QtCore/QMap>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <QtWaylandClient/qtwaylandclientglobal.h>
 
 #if QT_CONFIG(cursor)
 
-struct wl_cursor;
-struct wl_cursor_image;
+struct wl_buffer;
 struct wl_cursor_theme;
+struct wl_shm_pool;
 
 QT_BEGIN_NAMESPACE
 
+class QFile;
+
 namespace QtWaylandClient {
 
 class QWaylandBuffer;
@@ -73,10 +79,18 @@ class QWaylandShm;
 class Q_WAYLAND_CLIENT_EXPORT QWaylandCursorTheme
 {
 public:
+    struct Image {
+        struct ::wl_buffer *buffer = nullptr;
+        QPoint hotSpot;
+        QSize size;
+        uint delay = 0; // milliseconds until the next frame of an animated cursor
+    };
+
     static QWaylandCursorTheme *create(QWaylandShm *shm, int size);
     static QWaylandCursorTheme *create(QWaylandShm *shm, int size, const QString &themeName);
     ~QWaylandCursorTheme();
-    struct wl_cursor_image *cursorImage(Qt::CursorShape shape);
+    Image cursorImage(Qt::CursorShape shape);
+    QVector<Image> cursorFrames(Qt::CursorShape shape);
 
 private:
     enum WaylandCursor {
@@ -113,10 +127,29 @@ private:
         ResizeSouthWestCursor
     };
 
-    explicit QWaylandCursorTheme(struct ::wl_cursor_theme *theme) : m_theme(theme) {}
-    struct ::wl_cursor *requestCursor(WaylandCursor shape);
-    struct ::wl_cursor_theme *m_theme = nullptr;
-    QMap<WaylandCursor, wl_cursor *> m_cursors;
+    QWaylandCursorTheme(QWaylandShm *shm, int size, const QString &themeName, const QStringList &cursorDirs);
+    QVector<Image> requestCursor(WaylandCursor shape);
+    QVector<Image> loadCursor(const QByteArray &name);
+    QVector<Image> loadFallbackCursor(const QByteArray &name);
+    Image loadImage(QFile *file, quint32 nominalSize, quint32 position);
+    uchar *allocate(int bytes, int *offset);
+
+    QWaylandShm *m_shm = nullptr;
+    int m_size = 0;
+    QString m_themeName;
+    QStringList m_cursorDirs; // the cursors directories of the theme and everything it inherits
+    QMap<WaylandCursor, QVector<Image>> m_cursors;
+    QVector<struct ::wl_buffer *> m_buffers;
+
+    // All shapes share one pool, which only grows when a new shape is loaded
+    struct ::wl_shm_pool *m_pool = nullptr;
+    int m_poolFd = -1;
+    uchar *m_poolData = nullptr;
+    int m_poolSize = 0;
+    int m_poolUsed = 0;
+
+    // Only loaded when the theme has none of the names for a shape
+    struct ::wl_cursor_theme *m_fallbackTheme = nullptr;
 };
 
 class Q_WAYLAND_CLIENT_EXPORT QWaylandCursor : public QPlatformCursor
@@ -130,11 +163,16 @@ public:
     void setPos(const QPoint &pos) override;
 
     QSharedPointer<QWaylandBuffer> cursorBitmapImage(const QCursor *cursor);
-    struct wl_cursor_image *cursorImage(Qt::CursorShape shape);
+    QVector<QWaylandCursorTheme::Image> cursorFrames(Qt::CursorShape shape);
+
+    // Changes whenever a cursor buffer is destroyed, so a wl_buffer remembered
+    // from before is not mistaken for a new one allocated at the same address
+    static uint bufferGeneration();
 
 private:
     QWaylandDisplay *mDisplay = nullptr;
-    QWaylandCursorTheme *mCursorTheme = nullptr;
+    QSharedPointer<QWaylandCursorTheme> mCursorTheme;
+    QCache<qint64, QSharedPointer<QWaylandBuffer>> mBitmapBuffers; // by QPixmap::cacheKey()
     QPoint mLastPos;
 };
 
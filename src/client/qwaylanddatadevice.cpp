@@ -264,8 +264,8 @@ QPoint QWaylandDataDevice::calculateDragPosition(int x, int y, QWindow *wnd) con
     if (wnd) {
         QWaylandWindow *wwnd = static_cast<QWaylandWindow*>(m_dragWindow->handle());
         if (wwnd && wwnd->decoration()) {
-            pnt -= QPoint(wwnd->decoration()->margins().left(),
-                          wwnd->decoration()->margins().top());
+            pnt -= QPoint(wwnd->surfaceMargins().left(),
+                          wwnd->surfaceMargins().top());
         }
     }
     return pnt;
@@ -43,6 +43,7 @@
 #include "qwaylanddatadevice_p.h"
 #include "qwaylanddataoffer_p.h"
 #include "qwaylanddisplay_p.h"
+#include "qwaylanddatawriter_p.h"
 
 #include <QtCore/QDebug>
 
@@ -53,6 +54,7 @@ namespace QtWaylandClient {
 QWaylandDataDeviceManager::QWaylandDataDeviceManager(QWaylandDisplay *display, uint32_t id)
     : wl_data_device_manager(display->wl_registry(), id, 1)
     , m_display(display)
+    , m_dataWriter(new QWaylandDataWriter)
 {
     // Create transfer devices for all input devices.
     // ### This only works if we get the global before all devices and is surely wrong when hotplugging.
@@ -77,6 +79,13 @@ QWaylandDisplay *QWaylandDataDeviceManager::display() const
     return m_display;
 }
 
+// Transfers outlive the data source, so that a paste in progress completes
+// even when the selection changes in the meantime.
+QWaylandDataWriter *QWaylandDataDeviceManager::dataWriter() const
+{
+    return m_dataWriter.data();
+}
+
 }
 
 QT_END_NAMESPACE
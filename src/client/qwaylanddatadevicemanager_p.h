@@ -54,10 +54,14 @@
 #include <QtWaylandClient/private/qtwaylandclientglobal_p.h>
 #include <QtWaylandClient/private/qwayland-wayland.h>
 
+#include <QtCore/QScopedPointer>
+
 QT_REQUIRE_CONFIG(wayland_datadevice);
 
 QT_BEGIN_NAMESPACE
 
+class QWaylandDataWriter;
+
 namespace QtWaylandClient {
 
 class QWaylandDisplay;
@@ -74,9 +78,11 @@ public:
     QWaylandDataDevice *getDataDevice(QWaylandInputDevice *inputDevice);
 
     QWaylandDisplay *display() const;
+    QWaylandDataWriter *dataWriter() const;
 
 private:
     QWaylandDisplay *m_display = nullptr;
+    QScopedPointer<QWaylandDataWriter> m_dataWriter;
 };
 
 }
@@ -46,6 +46,10 @@
 #include <qpa/qplatformclipboard.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QEventLoop>
+#include <QtCore/QPointer>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
 
 QT_BEGIN_NAMESPACE
 
@@ -56,6 +60,118 @@ static QString utf8Text()
     return QStringLiteral("text/plain;charset=utf-8");
 }
 
+static const int MinimumReadSize = 64 * 1024;
+
+// Drains whatever the writer has made available on the non-blocking \a fd.
+// The buffer grows geometrically so that large transfers are read with few,
+// large read() calls. Returns 0 at end of file, 1 if the writer is not done
+// yet and -1 on error or if the data exceeds \a maximumSize.
+static int readAvailable(int fd, QByteArray &data, qint64 maximumSize)
+{
+    forever {
+        const int size = data.size();
+        if (data.capacity() - size < MinimumReadSize) {
+            const qint64 wanted = qMax(2 * qint64(data.capacity()), qint64(size) + MinimumReadSize);
+            data.reserve(int(qMin(wanted, maximumSize + MinimumReadSize)));
+        }
+
+        const int chunk = data.capacity() - size;
+        data.resize(size + chunk);
+        const qint64 n = qt_safe_read(fd, data.data() + size, chunk);
+        data.resize(size + int(qMax<qint64>(n, 0)));
+
+        if (n == 0)
+            return 0;
+        if (n < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : -1;
+        if (data.size() > maximumSize) {
+            qWarning("QWaylandDataOffer: data exceeds the maximum size of %lld bytes", maximumSize);
+            return -1;
+        }
+    }
+}
+
+class QWaylandMimeDataReader : public QObject
+{
+public:
+    QWaylandMimeDataReader(int fd, const QString &mimeType, const QWaylandMimeData *mimeData)
+        : m_fd(fd)
+        , m_mimeType(mimeType)
+        , m_mimeData(mimeData)
+        , m_notifier(fd, QSocketNotifier::Read)
+    {
+        connect(&m_notifier, &QSocketNotifier::activated, this, [this]() {
+            const int result = readAvailable(m_fd, m_data, QWaylandMimeData::maximumSize());
+            if (result == 1)
+                m_idleTimer.start();
+            else
+                finish(result);
+        });
+
+        m_idleTimer.setSingleShot(true);
+        m_idleTimer.setInterval(QWaylandMimeData::readTimeout());
+        connect(&m_idleTimer, &QTimer::timeout, this, [this]() {
+            qWarning("QWaylandDataOffer: timeout reading from pipe");
+            finish(-1);
+        });
+        m_idleTimer.start();
+    }
+
+    ~QWaylandMimeDataReader() override
+    {
+        qt_safe_close(m_fd);
+
+        // The offer went away before the transfer completed, don't leave anyone waiting
+        for (const Callback &callback : qAsConst(m_callbacks)) {
+            if (!callback.guarded || callback.context)
+                callback.function(QByteArray());
+        }
+    }
+
+    void addCallback(QObject *context, const std::function<void(const QByteArray &)> &callback)
+    {
+        m_callbacks.append({ context, context != nullptr, callback });
+    }
+
+private:
+    struct Callback {
+        QPointer<QObject> context;
+        bool guarded;
+        std::function<void(const QByteArray &)> function;
+    };
+
+    void finish(int result)
+    {
+        m_notifier.setEnabled(false);
+        m_idleTimer.stop();
+
+        if (result != 0) {
+            qWarning("QWaylandDataOffer: error reading data for mimeType %s", qPrintable(m_mimeType));
+            m_data = QByteArray();
+        }
+
+        // The callbacks may destroy the offer, so detach from it first
+        m_mimeData->m_readers.remove(m_mimeType);
+        m_mimeData->m_data.insert(m_mimeType, m_data);
+        deleteLater();
+
+        QVector<Callback> callbacks;
+        callbacks.swap(m_callbacks);
+        for (const Callback &callback : callbacks) {
+            if (!callback.guarded || callback.context)
+                callback.function(m_data);
+        }
+    }
+
+    int m_fd;
+    QString m_mimeType;
+    const QWaylandMimeData *m_mimeData;
+    QSocketNotifier m_notifier;
+    QTimer m_idleTimer;
+    QByteArray m_data;
+    QVector<Callback> m_callbacks;
+};
+
 QWaylandDataOffer::QWaylandDataOffer(QWaylandDisplay *display, struct ::wl_data_offer *offer)
     : QtWayland::wl_data_offer(offer)
     , m_mimeData(new QWaylandMimeData(this, display))
@@ -94,6 +210,34 @@ QWaylandMimeData::QWaylandMimeData(QWaylandDataOffer *dataOffer, QWaylandDisplay
 
 QWaylandMimeData::~QWaylandMimeData()
 {
+    qDeleteAll(m_readers);
+}
+
+/*
+    Returns how long a transfer may stall before it is given up, in
+    milliseconds. The timeout restarts whenever data arrives, so large
+    transfers from a responsive source are not cut short.
+*/
+int QWaylandMimeData::readTimeout()
+{
+    static const int timeout = qEnvironmentVariableIsSet("QT_WAYLAND_DATA_OFFER_TIMEOUT")
+            ? qMax(1, qEnvironmentVariableIntValue("QT_WAYLAND_DATA_OFFER_TIMEOUT"))
+            : 1000;
+    return timeout;
+}
+
+/*
+    Returns the largest payload that is accepted from a data source, in bytes.
+*/
+qint64 QWaylandMimeData::maximumSize()
+{
+    static const qint64 size = [] {
+        const qint64 limit = 1024 * 1024 * 1024;
+        bool ok = false;
+        const qint64 value = qgetenv("QT_WAYLAND_DATA_OFFER_MAX_SIZE").toLongLong(&ok);
+        return ok && value > 0 ? qMin(value, limit) : limit / 2;
+    }();
+    return size;
 }
 
 void QWaylandMimeData::appendFormat(const QString &mimeType)
@@ -125,56 +269,81 @@ QVariant QWaylandMimeData::retrieveData_sys(const QString &mimeType, QVariant::T
     if (m_data.contains(mimeType))
         return m_data.value(mimeType);
 
-    QString mime = mimeType;
+    if (resolveFormat(mimeType).isEmpty())
+        return QVariant();
 
-    if (!m_types.contains(mimeType)) {
-        if (mimeType == QStringLiteral("text/plain") && m_types.contains(utf8Text()))
-            mime = utf8Text();
-        else
-            return QVariant();
-    }
+    // The source may well be a window of this application, so keep dispatching
+    // Wayland events and repainting while waiting for the data, only user input
+    // has to wait until the caller has got its answer.
+    QEventLoop loop;
+    QByteArray content;
+    bool done = false;
+    retrieveDataAsync(mimeType, &loop, [&](const QByteArray &data) {
+        content = data;
+        done = true;
+        loop.quit();
+    });
+    if (!done)
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
 
-    int pipefd[2];
-    if (::pipe2(pipefd, O_CLOEXEC|O_NONBLOCK) == -1) {
-        qWarning("QWaylandMimeData: pipe2() failed");
-        return QVariant();
+    return content;
+}
+
+/*
+    Fetches the data for \a mimeType without blocking and passes it to
+    \a callback once the source has written all of it. The callback is
+    invoked immediately if the data has been retrieved before, and is
+    dropped if \a context is destroyed before the transfer completes.
+    Concurrent requests for the same format share a single transfer.
+*/
+void QWaylandMimeData::retrieveDataAsync(const QString &mimeType, QObject *context,
+                                         const std::function<void(const QByteArray &)> &callback) const
+{
+    const auto cached = m_data.constFind(mimeType);
+    if (cached != m_data.constEnd()) {
+        callback(*cached);
+        return;
     }
 
-    m_dataOffer->receive(mime, pipefd[1]);
-    wl_display_flush(m_display->wl_display());
+    QWaylandMimeDataReader *reader = m_readers.value(mimeType);
+    if (!reader) {
+        const QString mime = resolveFormat(mimeType);
+        const int fd = mime.isEmpty() ? -1 : openReceivePipe(mime);
+        if (fd == -1) {
+            callback(QByteArray());
+            return;
+        }
+        reader = new QWaylandMimeDataReader(fd, mimeType, this);
+        m_readers.insert(mimeType, reader);
+    }
+    reader->addCallback(context, callback);
+}
 
-    close(pipefd[1]);
+QString QWaylandMimeData::resolveFormat(const QString &mimeType) const
+{
+    if (m_types.contains(mimeType))
+        return mimeType;
 
-    QByteArray content;
-    if (readData(pipefd[0], content) != 0) {
-        qWarning("QWaylandDataOffer: error reading data for mimeType %s", qPrintable(mimeType));
-        content = QByteArray();
-    }
+    if (mimeType == QStringLiteral("text/plain") && m_types.contains(utf8Text()))
+        return utf8Text();
 
-    close(pipefd[0]);
-    m_data.insert(mimeType, content);
-    return content;
+    return QString();
 }
 
-int QWaylandMimeData::readData(int fd, QByteArray &data) const
+// Asks the source to write \a mime into a new pipe and returns its read end
+int QWaylandMimeData::openReceivePipe(const QString &mime) const
 {
-    char buf[4096];
-    int retryCount = 0;
-    int n;
-    while (true) {
-        n = QT_READ(fd, buf, sizeof buf);
-        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK) && ++retryCount < 1000)
-            usleep(1000);
-        else
-            break;
-    }
-    if (retryCount >= 1000)
-        qWarning("QWaylandDataOffer: timeout reading from pipe");
-    if (n > 0) {
-        data.append(buf, n);
-        n = readData(fd, data);
+    int pipefd[2];
+    if (::pipe2(pipefd, O_CLOEXEC|O_NONBLOCK) == -1) {
+        qWarning("QWaylandMimeData: pipe2() failed");
+        return -1;
     }
-    return n;
+
+    m_dataOffer->receive(mime, pipefd[1]);
+    wl_display_flush(m_display->wl_display());
+
+    qt_safe_close(pipefd[1]);
+    return pipefd[0];
 }
 
 }
@@ -56,6 +56,8 @@
 #include <QtWaylandClient/private/qtwaylandclientglobal_p.h>
 #include <QtWaylandClient/private/qwayland-wayland.h>
 
+#include <functional>
+
 QT_REQUIRE_CONFIG(wayland_datadevice);
 
 QT_BEGIN_NAMESPACE
@@ -64,6 +66,7 @@ namespace QtWaylandClient {
 
 class QWaylandDisplay;
 class QWaylandMimeData;
+class QWaylandMimeDataReader;
 
 class Q_WAYLAND_CLIENT_EXPORT QWaylandDataOffer : public QtWayland::wl_data_offer
 {
@@ -83,25 +86,35 @@ private:
 };
 
 
-class QWaylandMimeData : public QInternalMimeData {
+class Q_WAYLAND_CLIENT_EXPORT QWaylandMimeData : public QInternalMimeData {
 public:
     explicit QWaylandMimeData(QWaylandDataOffer *dataOffer, QWaylandDisplay *display);
     ~QWaylandMimeData() override;
 
     void appendFormat(const QString &mimeType);
 
+    void retrieveDataAsync(const QString &mimeType, QObject *context,
+                           const std::function<void(const QByteArray &)> &callback) const;
+
+    static int readTimeout();
+    static qint64 maximumSize();
+
 protected:
     bool hasFormat_sys(const QString &mimeType) const override;
     QStringList formats_sys() const override;
     QVariant retrieveData_sys(const QString &mimeType, QVariant::Type type) const override;
 
 private:
-    int readData(int fd, QByteArray &data) const;
+    friend class QWaylandMimeDataReader;
+
+    QString resolveFormat(const QString &mimeType) const;
+    int openReceivePipe(const QString &mime) const;
 
     mutable QWaylandDataOffer *m_dataOffer = nullptr;
     QWaylandDisplay *m_display = nullptr;
     mutable QStringList m_types;
     mutable QHash<QString, QByteArray> m_data;
+    mutable QHash<QString, QWaylandMimeDataReader *> m_readers;
 };
 
 }
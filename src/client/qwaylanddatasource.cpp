@@ -42,27 +42,27 @@
 #include "qwaylanddatadevicemanager_p.h"
 #include "qwaylandinputdevice_p.h"
 #include "qwaylandmimehelper_p.h"
-
-#include <QtCore/QFile>
+#include "qwaylanddatawriter_p.h"
 
 #include <QtCore/QDebug>
 
-#include <unistd.h>
-#include <signal.h>
-
 QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
 
 QWaylandDataSource::QWaylandDataSource(QWaylandDataDeviceManager *dataDeviceManager, QMimeData *mimeData)
     : QtWayland::wl_data_source(dataDeviceManager->create_data_source())
+    , m_dataDeviceManager(dataDeviceManager)
     , m_mime_data(mimeData)
 {
     if (!mimeData)
         return;
-    Q_FOREACH (const QString &format, mimeData->formats()) {
+    const QStringList formats = mimeData->formats();
+    Q_FOREACH (const QString &format, formats) {
         offer(format);
     }
+    // Images take a while to encode, get a head start before they are requested
+    QWaylandMimeHelper::prepareByteArrays(mimeData, formats);
 }
 
 QWaylandDataSource::~QWaylandDataSource()
@@ -83,19 +83,7 @@ void QWaylandDataSource::data_source_cancelled()
 void QWaylandDataSource::data_source_send(const QString &mime_type, int32_t fd)
 {
     QByteArray content = QWaylandMimeHelper::getByteArray(m_mime_data, mime_type);
-    if (!content.isEmpty()) {
-        // Create a sigpipe handler that does nothing, or clients may be forced to terminate
-        // if the pipe is closed in the other end.
-        struct sigaction action, oldAction;
-        action.sa_handler = SIG_IGN;
-        sigemptyset (&action.sa_mask);
-        action.sa_flags = 0;
-
-        sigaction(SIGPIPE, &action, &oldAction);
-        write(fd, content.constData(), content.size());
-        sigaction(SIGPIPE, &oldAction, nullptr);
-    }
-    close(fd);
+    m_dataDeviceManager->dataWriter()->write(fd, content);
 }
 
 void QWaylandDataSource::data_source_target(const QString &mime_type)
@@ -87,6 +87,7 @@ protected:
 
 private:
     QWaylandDisplay *m_display = nullptr;
+    QWaylandDataDeviceManager *m_dataDeviceManager = nullptr;
     QMimeData *m_mime_data = nullptr;
 };
 
@@ -0,0 +1,209 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylanddecorationsubsurfaces_p.h"
+
+#include "qwaylandabstractdecoration_p.h"
+#include "qwaylanddisplay_p.h"
+#include "qwaylandshmbackingstore_p.h"
+#include "qwaylandwindow_p.h"
+
+#include <QtGui/QPainter>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+/*
+    Hosts the decoration of a window in four subsurfaces, one per margin, so that the
+    window's own surface only holds its contents. This lets EGL windows present their
+    surface directly instead of rendering into an intermediate FBO and blitting it
+    together with the decoration on every frame.
+
+    The subsurfaces are in synchronized mode, so decoration updates and position
+    changes are applied together with the next commit of the window's surface.
+*/
+
+QWaylandDecorationSubSurfaces *QWaylandDecorationSubSurfaces::create(QWaylandWindow *window)
+{
+    if (!window->display()->hasRegistryGlobal(QStringLiteral("wl_subcompositor")))
+        return nullptr;
+
+    QWaylandDecorationSubSurfaces *surfaces = new QWaylandDecorationSubSurfaces(window);
+    for (const Edge &edge : surfaces->m_edges) {
+        if (!edge.subsurface) {
+            delete surfaces;
+            return nullptr;
+        }
+    }
+    return surfaces;
+}
+
+QWaylandDecorationSubSurfaces::QWaylandDecorationSubSurfaces(QWaylandWindow *window)
+    : m_window(window)
+{
+    static const Qt::Edge edges[] = { Qt::TopEdge, Qt::LeftEdge, Qt::RightEdge, Qt::BottomEdge };
+
+    QWaylandDisplay *display = window->display();
+    for (int i = 0; i < 4; ++i) {
+        Edge &edge = m_edges[i];
+        edge.edge = edges[i];
+        // Input on the decoration goes to the window it decorates
+        edge.surface = display->createSurface(static_cast<QtWayland::wl_surface *>(window));
+        edge.subsurface = display->createSubSurface(edge.surface, window->object());
+        if (edge.subsurface)
+            wl_subsurface_place_below(edge.subsurface, window->object());
+    }
+}
+
+QWaylandDecorationSubSurfaces::~QWaylandDecorationSubSurfaces()
+{
+    for (Edge &edge : m_edges) {
+        if (edge.subsurface)
+            wl_subsurface_destroy(edge.subsurface);
+        if (edge.surface)
+            wl_surface_destroy(edge.surface);
+        qDeleteAll(edge.buffers);
+    }
+}
+
+bool QWaylandDecorationSubSurfaces::contains(::wl_surface *surface) const
+{
+    for (const Edge &edge : m_edges) {
+        if (edge.surface == surface)
+            return true;
+    }
+    return false;
+}
+
+::wl_surface *QWaylandDecorationSubSurfaces::surface(Qt::Edge edge) const
+{
+    for (const Edge &e : m_edges) {
+        if (e.edge == edge)
+            return e.surface;
+    }
+    return nullptr;
+}
+
+// Maps a position on the window's surface or on one of the decoration surfaces to
+// the frame coordinates the decoration and QWaylandWindow::handleMouse() expect.
+QPointF QWaylandDecorationSubSurfaces::mapToFrame(::wl_surface *surface, const QPointF &pos) const
+{
+    for (const Edge &edge : m_edges) {
+        if (edge.surface == surface)
+            return pos + edge.rect.topLeft();
+    }
+
+    const QMargins margins = m_window->frameMargins();
+    return pos + QPointF(margins.left(), margins.top());
+}
+
+void QWaylandDecorationSubSurfaces::update()
+{
+    QWaylandAbstractDecoration *decoration = m_window->decoration();
+    if (!decoration || !decoration->isDirty())
+        return;
+
+    const QMargins margins = decoration->margins();
+    const QRegion dirty = decoration->dirtyRegion();
+    const int scale = m_window->scale();
+
+    for (Edge &edge : m_edges) {
+        const QRect rect = decoration->edgeRect(edge.edge);
+        const QPoint position = rect.topLeft() - QPoint(margins.left(), margins.top());
+        if (position != edge.position) {
+            wl_subsurface_set_position(edge.subsurface, position.x(), position.y());
+            edge.position = position;
+        }
+
+        if (!dirty.intersects(rect) && rect.size() == edge.rect.size() && scale == edge.scale) {
+            edge.rect = rect;
+            continue;
+        }
+        edge.rect = rect;
+
+        const QImage &image = decoration->edgeImage(edge.edge);
+        if (image.isNull()) {
+            wl_surface_attach(edge.surface, nullptr, 0, 0);
+            wl_surface_commit(edge.surface);
+            continue;
+        }
+
+        QWaylandShmBuffer *buffer = bufferForEdge(edge, image.size());
+        QPainter painter(buffer->image());
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(QPoint(), image);
+        painter.end();
+
+        if (scale != edge.scale && m_window->display()->compositorVersion() >= 3)
+            wl_surface_set_buffer_scale(edge.surface, scale);
+        edge.scale = scale;
+
+        buffer->setBusy();
+        wl_surface_attach(edge.surface, buffer->buffer(), 0, 0);
+        wl_surface_damage(edge.surface, 0, 0, rect.width(), rect.height());
+        wl_surface_commit(edge.surface);
+    }
+}
+
+QWaylandShmBuffer *QWaylandDecorationSubSurfaces::bufferForEdge(Edge &edge, const QSize &size)
+{
+    for (auto it = edge.buffers.begin(); it != edge.buffers.end();) {
+        QWaylandShmBuffer *buffer = *it;
+        if (buffer->busy()) {
+            ++it;
+        } else if (buffer->size() == size) {
+            return buffer;
+        } else {
+            delete buffer;
+            it = edge.buffers.erase(it);
+        }
+    }
+
+    QWaylandShmBuffer *buffer = new QWaylandShmBuffer(m_window->display(), size,
+                                                      QImage::Format_ARGB32_Premultiplied,
+                                                      m_window->scale());
+    edge.buffers.append(buffer);
+    return buffer;
+}
+
+}
+
+QT_END_NAMESPACE
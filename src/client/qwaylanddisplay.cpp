@@ -64,8 +64,13 @@
 #include "qwaylandsubsurface_p.h"
 #include "qwaylandtouch_p.h"
 #include "qwaylandqtkey_p.h"
+#include "qwaylandglyphcache_p.h"
+#include "qwaylandpresentationtime_p.h"
+#include "qwaylandstartupprofiler_p.h"
+#include "qwaylandserverbufferintegration_p.h"
 
 #include <QtWaylandClient/private/qwayland-text-input-unstable-v2.h>
+#include <QtWaylandClient/private/qwayland-viewporter.h>
 
 #include <QtCore/QAbstractEventDispatcher>
 #include <QtGui/private/qguiapplication_p.h>
@@ -105,12 +110,17 @@ struct ::wl_region *QWaylandDisplay::createRegion(const QRegion &qregion)
 }
 
 ::wl_subsurface *QWaylandDisplay::createSubSurface(QWaylandWindow *window, QWaylandWindow *parent)
+{
+    return createSubSurface(window->object(), parent->object());
+}
+
+::wl_subsurface *QWaylandDisplay::createSubSurface(::wl_surface *surface, ::wl_surface *parent)
 {
     if (!mSubCompositor) {
         return nullptr;
     }
 
-    return mSubCompositor->get_subsurface(window->object(), parent->object());
+    return mSubCompositor->get_subsurface(surface, parent);
 }
 
 QWaylandClientBufferIntegration * QWaylandDisplay::clientBufferIntegration() const
@@ -126,6 +136,8 @@ QWaylandWindowManagerIntegration *QWaylandDisplay::windowManagerIntegration() co
 QWaylandDisplay::QWaylandDisplay(QWaylandIntegration *waylandIntegration)
     : mWaylandIntegration(waylandIntegration)
 {
+    QWaylandStartupProfiler::Scope profile(QWaylandStartupProfiler::DisplayPhase);
+
     qRegisterMetaType<uint32_t>("uint32_t");
 
     mDisplay = wl_display_connect(nullptr);
@@ -139,7 +151,15 @@ QWaylandDisplay::QWaylandDisplay(QWaylandIntegration *waylandIntegration)
 
     mWindowManagerIntegration.reset(new QWaylandWindowManagerIntegration(this));
 
+    // The first round trip collects the globals, which are all bound as they
+    // arrive. The second one receives their initial state, such as the output
+    // geometry and the hardware integration names, in a single batch.
+    forceRoundTrip();
     forceRoundTrip();
+
+    mScreensInitialized = true;
+    for (QWaylandScreen *screen : qAsConst(mScreens))
+        mWaylandIntegration->screenAdded(screen);
 }
 
 QWaylandDisplay::~QWaylandDisplay(void)
@@ -158,9 +178,7 @@ QWaylandDisplay::~QWaylandDisplay(void)
 #if QT_CONFIG(wayland_datadevice)
     delete mDndSelectionHandler.take();
 #endif
-#if QT_CONFIG(cursor)
-    qDeleteAll(mCursorThemesBySize);
-#endif
+    mGlyphCache.reset();
     if (mDisplay)
         wl_display_disconnect(mDisplay);
 }
@@ -242,11 +260,14 @@ void QWaylandDisplay::registry_global(uint32_t id, const QString &interface, uin
     if (interface == QStringLiteral("wl_output")) {
         QWaylandScreen *screen = new QWaylandScreen(this, version, id);
         mScreens.append(screen);
-        // We need to get the output events before creating surfaces
-        forceRoundTrip();
-        mWaylandIntegration->screenAdded(screen);
+        // Screens announced at startup are added by the constructor
+        if (mScreensInitialized) {
+            // We need to get the output events before creating surfaces
+            forceRoundTrip();
+            mWaylandIntegration->screenAdded(screen);
+        }
     } else if (interface == QStringLiteral("wl_compositor")) {
-        mCompositorVersion = qMin((int)version, 3);
+        mCompositorVersion = qMin((int)version, 4);
         mCompositor.init(registry, id, mCompositorVersion);
     } else if (interface == QStringLiteral("wl_shm")) {
         mShm.reset(new QWaylandShm(this, version, id));
@@ -261,6 +282,10 @@ void QWaylandDisplay::registry_global(uint32_t id, const QString &interface, uin
         mWindowExtension.reset(new QtWayland::qt_surface_extension(registry, id, 1));
     } else if (interface == QStringLiteral("wl_subcompositor")) {
         mSubCompositor.reset(new QtWayland::wl_subcompositor(registry, id, 1));
+    } else if (interface == QStringLiteral("wp_viewporter")) {
+        mViewporter.reset(new QtWayland::wp_viewporter(registry, id, 1));
+    } else if (interface == QStringLiteral("wp_presentation")) {
+        mPresentationTime.reset(new QWaylandPresentationTime(this, id));
     } else if (interface == QStringLiteral("qt_touch_extension")) {
         mTouchExtension.reset(new QWaylandTouchExtension(this, id));
     } else if (interface == QStringLiteral("zqt_key_v1")) {
@@ -272,9 +297,14 @@ void QWaylandDisplay::registry_global(uint32_t id, const QString &interface, uin
         }
     } else if (interface == QStringLiteral("qt_hardware_integration")) {
         mHardwareIntegration.reset(new QWaylandHardwareIntegration(registry, id));
-        // make a roundtrip here since we need to receive the events sent by
-        // qt_hardware_integration before creating windows
-        forceRoundTrip();
+        // we need to receive the events sent by qt_hardware_integration before
+        // creating windows, at startup the constructor's round trip does that
+        if (mScreensInitialized)
+            forceRoundTrip();
+    } else if (interface == QStringLiteral("zqt_glyph_cache_v1")) {
+        mGlyphCacheId = id;
+        if (mScreensInitialized)
+            initializeGlyphCache();
     }
 
     mGlobals.append(RegistryGlobal(id, interface, version, registry));
@@ -312,6 +342,31 @@ bool QWaylandDisplay::hasRegistryGlobal(const QString &interfaceName)
     return false;
 }
 
+/*
+    The glyph cache's atlases are server buffers, so the server buffer
+    integration has to be bound before it. At startup that is only possible
+    once the integration has its display, so it calls this after creating it;
+    a glyph cache announced later is bound as soon as it arrives.
+
+    Drawing from the atlases snaps glyphs to the pixel grid, so the cache is
+    only bound when QT_WAYLAND_USE_GLYPH_CACHE is set.
+*/
+void QWaylandDisplay::initializeGlyphCache()
+{
+    if (mGlyphCache || !mGlyphCacheId)
+        return;
+
+    if (!qEnvironmentVariableIntValue("QT_WAYLAND_USE_GLYPH_CACHE"))
+        return;
+
+    QWaylandServerBufferIntegration *serverBufferIntegration = mWaylandIntegration->serverBufferIntegration();
+    if (!serverBufferIntegration)
+        return;
+
+    // The atlases and fonts arrive asynchronously, until then glyphs are drawn locally
+    mGlyphCache.reset(new QWaylandGlyphCache(this, mGlyphCacheId, serverBufferIntegration));
+}
+
 void QWaylandDisplay::addRegistryListener(RegistryListener listener, void *data)
 {
     Listener l = { listener, data };
@@ -480,13 +535,13 @@ QWaylandInputDevice *QWaylandDisplay::defaultInputDevice() const
 
 #if QT_CONFIG(cursor)
 
-void QWaylandDisplay::setCursor(struct wl_buffer *buffer, struct wl_cursor_image *image, qreal dpr)
+void QWaylandDisplay::setCursor(struct wl_buffer *buffer, const QPoint &hotSpot, const QSize &size, qreal dpr)
 {
     /* Qt doesn't tell us which input device we should set the cursor
      * for, so set it for all devices. */
     for (int i = 0; i < mInputDevices.count(); i++) {
         QWaylandInputDevice *inputDevice = mInputDevices.at(i);
-        inputDevice->setCursor(buffer, image, dpr);
+        inputDevice->setCursor(buffer, hotSpot, size, dpr);
     }
 }
 
@@ -500,7 +555,7 @@ void QWaylandDisplay::setCursor(const QSharedPointer<QWaylandBuffer> &buffer, co
     }
 }
 
-QWaylandCursorTheme *QWaylandDisplay::loadCursorTheme(qreal devicePixelRatio)
+QSharedPointer<QWaylandCursorTheme> QWaylandDisplay::loadCursorTheme(qreal devicePixelRatio)
 {
     static int cursorSize = qEnvironmentVariableIntValue("XCURSOR_SIZE");
     if (cursorSize <= 0)
@@ -508,15 +563,18 @@ QWaylandCursorTheme *QWaylandDisplay::loadCursorTheme(qreal devicePixelRatio)
     if (compositorVersion() >= 3) // set_buffer_scale is not supported on earlier versions
         cursorSize *= devicePixelRatio;
 
-    if (auto *theme = mCursorThemesBySize.value(cursorSize, nullptr))
+    // Themes are only kept alive by the screens using them, so sizes for
+    // scale factors no screen has anymore are released
+    if (QSharedPointer<QWaylandCursorTheme> theme = mCursorThemesBySize.value(cursorSize).toStrongRef())
         return theme;
 
     if (auto *theme = QWaylandCursorTheme::create(shm(), cursorSize)) {
-        mCursorThemesBySize[cursorSize] = theme;
-        return theme;
+        QSharedPointer<QWaylandCursorTheme> sharedTheme(theme);
+        mCursorThemesBySize[cursorSize] = sharedTheme;
+        return sharedTheme;
     }
 
-    return nullptr;
+    return QSharedPointer<QWaylandCursorTheme>();
 }
 
 #endif // QT_CONFIG(cursor)
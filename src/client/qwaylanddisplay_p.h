@@ -65,8 +65,6 @@
 #include <QtWaylandClient/private/qtwaylandclientglobal_p.h>
 #include <QtWaylandClient/private/qwaylandshm_p.h>
 
-struct wl_cursor_image;
-
 QT_BEGIN_NAMESPACE
 
 class QAbstractEventDispatcher;
@@ -76,6 +74,7 @@ class QPlatformScreen;
 namespace QtWayland {
     class qt_surface_extension;
     class zwp_text_input_manager_v2;
+    class wp_viewporter;
 }
 
 namespace QtWaylandClient {
@@ -90,6 +89,8 @@ class QWaylandWindowManagerIntegration;
 class QWaylandDataDeviceManager;
 class QWaylandTouchExtension;
 class QWaylandQtKeyExtension;
+class QWaylandGlyphCache;
+class QWaylandPresentationTime;
 class QWaylandWindow;
 class QWaylandIntegration;
 class QWaylandHardwareIntegration;
@@ -117,14 +118,15 @@ public:
     QWaylandShellSurface *createShellSurface(QWaylandWindow *window);
     struct ::wl_region *createRegion(const QRegion &qregion);
     struct ::wl_subsurface *createSubSurface(QWaylandWindow *window, QWaylandWindow *parent);
+    struct ::wl_subsurface *createSubSurface(struct ::wl_surface *surface, struct ::wl_surface *parent);
 
     QWaylandClientBufferIntegration *clientBufferIntegration() const;
 
     QWaylandWindowManagerIntegration *windowManagerIntegration() const;
 #if QT_CONFIG(cursor)
-    void setCursor(struct wl_buffer *buffer, struct wl_cursor_image *image, qreal dpr);
+    void setCursor(struct wl_buffer *buffer, const QPoint &hotSpot, const QSize &size, qreal dpr);
     void setCursor(const QSharedPointer<QWaylandBuffer> &buffer, const QPoint &hotSpot, qreal dpr);
-    QWaylandCursorTheme *loadCursorTheme(qreal devicePixelRatio);
+    QSharedPointer<QWaylandCursorTheme> loadCursorTheme(qreal devicePixelRatio);
 #endif
     struct wl_display *wl_display() const { return mDisplay; }
     struct ::wl_registry *wl_registry() { return object(); }
@@ -142,7 +144,11 @@ public:
     QtWayland::qt_surface_extension *windowExtension() const { return mWindowExtension.data(); }
     QWaylandTouchExtension *touchExtension() const { return mTouchExtension.data(); }
     QtWayland::zwp_text_input_manager_v2 *textInputManager() const { return mTextInputManager.data(); }
+    QtWayland::wp_viewporter *viewporter() const { return mViewporter.data(); }
+    QWaylandPresentationTime *presentationTime() const { return mPresentationTime.data(); }
     QWaylandHardwareIntegration *hardwareIntegration() const { return mHardwareIntegration.data(); }
+    QWaylandGlyphCache *glyphCache() const { return mGlyphCache.data(); }
+    void initializeGlyphCache();
 
     struct RegistryGlobal {
         uint32_t id;
@@ -202,22 +208,27 @@ private:
     QList<Listener> mRegistryListeners;
     QWaylandIntegration *mWaylandIntegration = nullptr;
 #if QT_CONFIG(cursor)
-    QMap<int, QWaylandCursorTheme *> mCursorThemesBySize;
+    QMap<int, QWeakPointer<QWaylandCursorTheme>> mCursorThemesBySize;
 #endif
 #if QT_CONFIG(wayland_datadevice)
     QScopedPointer<QWaylandDataDeviceManager> mDndSelectionHandler;
 #endif
     QScopedPointer<QtWayland::qt_surface_extension> mWindowExtension;
     QScopedPointer<QtWayland::wl_subcompositor> mSubCompositor;
+    QScopedPointer<QtWayland::wp_viewporter> mViewporter;
+    QScopedPointer<QWaylandPresentationTime> mPresentationTime;
     QScopedPointer<QWaylandTouchExtension> mTouchExtension;
     QScopedPointer<QWaylandQtKeyExtension> mQtKeyExtension;
     QScopedPointer<QWaylandWindowManagerIntegration> mWindowManagerIntegration;
     QScopedPointer<QtWayland::zwp_text_input_manager_v2> mTextInputManager;
     QScopedPointer<QWaylandHardwareIntegration> mHardwareIntegration;
+    QScopedPointer<QWaylandGlyphCache> mGlyphCache;
+    uint32_t mGlyphCacheId = 0;
     QSocketNotifier *mReadNotifier = nullptr;
     int mFd;
     int mWritableNotificationFd;
     QList<RegistryGlobal> mGlobals;
+    bool mScreensInitialized = false;
     int mCompositorVersion;
     uint32_t mLastInputSerial = 0;
     QWaylandInputDevice *mLastInputDevice = nullptr;
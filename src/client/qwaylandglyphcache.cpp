@@ -0,0 +1,265 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandglyphcache_p.h"
+#include "qwaylanddisplay_p.h"
+#include "qwaylandserverbufferintegration_p.h"
+#include "qwaylandglyphcacheentry_p.h"
+
+#include <QtCore/private/qcore_unix_p.h>
+#include <QtGui/QGlyphRun>
+#include <QtGui/QPainter>
+#include <QtGui/QRawFont>
+
+#include <algorithm>
+
+#include <sys/mman.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+QWaylandGlyphCache::QWaylandGlyphCache(QWaylandDisplay *display, uint32_t id, QWaylandServerBufferIntegration *serverBufferIntegration)
+    : QtWayland::zqt_glyph_cache_v1(display->wl_registry(), id, 1)
+    , mServerBufferIntegration(serverBufferIntegration)
+{
+}
+
+QWaylandGlyphCache::~QWaylandGlyphCache()
+{
+    for (const Font &font : qAsConst(mFonts))
+        munmap(const_cast<QWaylandGlyphCacheEntry *>(font.entries), font.count * sizeof(QWaylandGlyphCacheEntry));
+    destroy();
+}
+
+/*
+    Returns the cached font matching font, or null. Glyph indexes are only
+    valid for one font file, so the font only matches if it was loaded from
+    the same file as the one the compositor rendered, at the same pixel size.
+*/
+const QWaylandGlyphCache::Font *QWaylandGlyphCache::findFont(const QRawFont &font) const
+{
+    const wl_fixed_t pixelSize = wl_fixed_from_double(font.pixelSize());
+    QByteArray id;
+    for (const Font &cached : mFonts) {
+        if (cached.pixelSize != pixelSize)
+            continue;
+        // Hashing the font tables isn't free, so it's only done when needed
+        if (id.isNull()) {
+            id = qWaylandGlyphCacheFontId(font);
+            if (id.isEmpty())
+                return nullptr;
+        }
+        if (cached.id == id)
+            return &cached;
+    }
+    return nullptr;
+}
+
+/*
+    Looks up glyphIndex of font, as returned by findFont(), in the atlases
+    shared by the compositor.
+*/
+bool QWaylandGlyphCache::lookup(const Font *font, quint32 glyphIndex, Glyph *glyph) const
+{
+    const QWaylandGlyphCacheEntry *end = font->entries + font->count;
+    const QWaylandGlyphCacheEntry *entry = std::lower_bound(font->entries, end, glyphIndex,
+                                                            [](const QWaylandGlyphCacheEntry &e, quint32 index) {
+        return e.glyphIndex < index;
+    });
+    if (entry == end || entry->glyphIndex != glyphIndex)
+        return false;
+
+    QWaylandServerBuffer *atlas = mAtlases.value(entry->atlas);
+    if (!atlas)
+        return false;
+
+    glyph->atlas = atlas;
+    glyph->rect = QRect(entry->x, entry->y, entry->width, entry->height);
+    glyph->offset = QPoint(entry->left, entry->top);
+    return true;
+}
+
+bool QWaylandGlyphCache::lookup(const QRawFont &font, quint32 glyphIndex, Glyph *glyph) const
+{
+    const Font *cached = findFont(font);
+    return cached && lookup(cached, glyphIndex, glyph);
+}
+
+/*
+    Returns the alpha map of glyphIndex, and its position relative to the glyph
+    origin in offset, with y pointing up. Glyphs that are not cached are
+    rendered locally, the same way the compositor renders its atlases.
+*/
+QImage QWaylandGlyphCache::glyphImage(const QRawFont &font, quint32 glyphIndex, QPoint *offset) const
+{
+    Glyph glyph;
+    if (lookup(font, glyphIndex, &glyph)) {
+        const QImage atlas = glyph.atlas->toImage();
+        if (!atlas.isNull()) {
+            if (offset)
+                *offset = glyph.offset;
+            return atlas.copy(glyph.rect);
+        }
+    }
+
+    const QRect rect = font.boundingRect(glyphIndex).toAlignedRect();
+    if (offset)
+        *offset = QPoint(rect.left(), -rect.top());
+
+    QImage image(rect.size(), QImage::Format_Alpha8);
+    if (image.isNull())
+        return image;
+    image.fill(Qt::transparent);
+
+    QGlyphRun run;
+    run.setRawFont(font);
+    run.setGlyphIndexes(QVector<quint32>() << glyphIndex);
+    run.setPositions(QVector<QPointF>() << QPointF(-rect.left(), -rect.top()));
+
+    QPainter painter(&image);
+    painter.setPen(Qt::black);
+    painter.drawGlyphRun(QPointF(), run);
+    return image;
+}
+
+/*
+    Draws glyphRun at position like QPainter::drawGlyphRun(), but takes the
+    glyphs from the atlases shared by the compositor instead of rasterizing
+    them. Only runs drawn untransformed with a solid pen can use the cache;
+    other runs, and the glyphs that aren't cached, are drawn by the painter.
+    Cached glyphs are snapped to the pixel grid, which is why the display only
+    binds the cache when QT_WAYLAND_USE_GLYPH_CACHE is set.
+*/
+void QWaylandGlyphCache::drawGlyphRun(QPainter *painter, const QPointF &position, const QGlyphRun &glyphRun) const
+{
+    const Font *font = nullptr;
+    if (painter->deviceTransform().type() <= QTransform::TxTranslate
+            && painter->pen().brush().style() == Qt::SolidPattern
+            && !(glyphRun.flags() & (QGlyphRun::Overline | QGlyphRun::Underline | QGlyphRun::StrikeOut))) {
+        font = findFont(glyphRun.rawFont());
+    }
+    if (!font) {
+        painter->drawGlyphRun(position, glyphRun);
+        return;
+    }
+
+    struct CachedGlyph {
+        QImage atlas;
+        QRect rect;
+        QPoint topLeft;
+    };
+
+    const QVector<quint32> glyphIndexes = glyphRun.glyphIndexes();
+    const QVector<QPointF> positions = glyphRun.positions();
+    QHash<QWaylandServerBuffer *, QImage> atlases;
+    QVector<CachedGlyph> cached;
+    QVector<quint32> missedIndexes;
+    QVector<QPointF> missedPositions;
+    QRect bounds;
+    for (int i = 0; i < glyphIndexes.size(); ++i) {
+        Glyph glyph;
+        QImage atlas;
+        if (lookup(font, glyphIndexes.at(i), &glyph)) {
+            auto it = atlases.find(glyph.atlas);
+            if (it == atlases.end())
+                it = atlases.insert(glyph.atlas, glyph.atlas->toImage());
+            atlas = *it;
+        }
+        if (atlas.isNull()) {
+            missedIndexes.append(glyphIndexes.at(i));
+            missedPositions.append(positions.at(i));
+            continue;
+        }
+        if (glyph.rect.isEmpty())
+            continue;
+
+        // The atlases hold unpositioned glyphs, so the origin is snapped to the pixel grid
+        const QPointF origin = position + positions.at(i);
+        const QPoint topLeft(qRound(origin.x()) + glyph.offset.x(), qRound(origin.y()) - glyph.offset.y());
+        cached.append({ atlas, glyph.rect, topLeft });
+        bounds |= QRect(topLeft, glyph.rect.size());
+    }
+
+    if (!bounds.isEmpty()) {
+        // Stamp the alpha maps, then color them with the pen in one go
+        QImage image(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        QPainter imagePainter(&image);
+        for (const CachedGlyph &glyph : qAsConst(cached))
+            imagePainter.drawImage(glyph.topLeft - bounds.topLeft(), glyph.atlas, glyph.rect);
+        imagePainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+        imagePainter.fillRect(image.rect(), painter->pen().brush());
+        imagePainter.end();
+        painter->drawImage(bounds.topLeft(), image);
+    }
+
+    if (!missedIndexes.isEmpty()) {
+        QGlyphRun missed = glyphRun;
+        missed.setGlyphIndexes(missedIndexes);
+        missed.setPositions(missedPositions);
+        painter->drawGlyphRun(position, missed);
+    }
+}
+
+void QWaylandGlyphCache::zqt_glyph_cache_v1_atlas(uint32_t id, struct ::qt_server_buffer *buffer)
+{
+    mAtlases.insert(id, mServerBufferIntegration->serverBuffer(buffer));
+}
+
+void QWaylandGlyphCache::zqt_glyph_cache_v1_font(const QString &family, const QString &style_name, wl_array *font_id, wl_fixed_t pixel_size, int32_t glyphs, uint32_t glyph_count)
+{
+    const size_t size = size_t(glyph_count) * sizeof(QWaylandGlyphCacheEntry);
+    void *data = size ? mmap(nullptr, size, PROT_READ, MAP_SHARED, glyphs, 0) : MAP_FAILED;
+    qt_safe_close(glyphs);
+    if (data == MAP_FAILED) {
+        if (size)
+            qErrnoWarning("QWaylandGlyphCache: Failed to map the glyph table");
+        return;
+    }
+
+    const QByteArray id(static_cast<const char *>(font_id->data), int(font_id->size));
+    const Font font = { family, style_name, id, pixel_size, static_cast<const QWaylandGlyphCacheEntry *>(data), glyph_count };
+    mFonts.append(font);
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWAYLANDGLYPHCACHE_P_H
+#define QWAYLANDGLYPHCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QPoint>
+#include <QtCore/QRect>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+#include <QtWaylandClient/qtwaylandclientglobal.h>
+#include <QtWaylandClient/private/qwayland-qt-glyph-cache-unstable-v1.h>
+
+QT_BEGIN_NAMESPACE
+
+class QGlyphRun;
+class QPainter;
+class QRawFont;
+struct QWaylandGlyphCacheEntry;
+
+namespace QtWaylandClient {
+
+class QWaylandDisplay;
+class QWaylandServerBuffer;
+class QWaylandServerBufferIntegration;
+
+class Q_WAYLAND_CLIENT_EXPORT QWaylandGlyphCache : public QtWayland::zqt_glyph_cache_v1
+{
+public:
+    struct Glyph {
+        QWaylandServerBuffer *atlas = nullptr;
+        QRect rect;
+        QPoint offset;
+    };
+
+    struct Font {
+        QString family;
+        QString styleName;
+        QByteArray id;
+        wl_fixed_t pixelSize;
+        const QWaylandGlyphCacheEntry *entries;
+        uint count;
+    };
+
+    QWaylandGlyphCache(QWaylandDisplay *display, uint32_t id, QWaylandServerBufferIntegration *serverBufferIntegration);
+    ~QWaylandGlyphCache() override;
+
+    const Font *findFont(const QRawFont &font) const;
+    bool lookup(const Font *font, quint32 glyphIndex, Glyph *glyph) const;
+    bool lookup(const QRawFont &font, quint32 glyphIndex, Glyph *glyph) const;
+    QImage glyphImage(const QRawFont &font, quint32 glyphIndex, QPoint *offset = nullptr) const;
+
+    void drawGlyphRun(QPainter *painter, const QPointF &position, const QGlyphRun &glyphRun) const;
+
+protected:
+    void zqt_glyph_cache_v1_atlas(uint32_t id, struct ::qt_server_buffer *buffer) override;
+    void zqt_glyph_cache_v1_font(const QString &family, const QString &style_name, wl_array *font_id, wl_fixed_t pixel_size, int32_t glyphs, uint32_t glyph_count) override;
+
+private:
+    QWaylandServerBufferIntegration *mServerBufferIntegration = nullptr;
+    QHash<uint, QWaylandServerBuffer *> mAtlases;
+    QVector<Font> mFonts;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDGLYPHCACHE_P_H
@@ -66,12 +66,28 @@ const Qt::InputMethodQueries supportedQueries = Qt::ImEnabled |
                                                 Qt::ImHints |
                                                 Qt::ImCursorRectangle |
                                                 Qt::ImPreferredLanguage;
+
+// Maximum number of UTF-16 code units of surrounding text sent to the compositor.
+// Even at three UTF-8 bytes each, this keeps set_surrounding_text below the size
+// limit of a Wayland message.
+int surroundingTextWindow()
+{
+    static int window = qEnvironmentVariableIsSet("QT_WAYLAND_SURROUNDING_TEXT_WINDOW")
+            ? qBound(16, qEnvironmentVariableIntValue("QT_WAYLAND_SURROUNDING_TEXT_WINDOW"), 1000)
+            : 512;
+    return window;
+}
 }
 
 QWaylandTextInput::QWaylandTextInput(QWaylandDisplay *display, struct ::zwp_text_input_v2 *text_input)
     : QtWayland::zwp_text_input_v2(text_input)
     , m_display(display)
 {
+    m_updateStateTimer.setSingleShot(true);
+    m_updateStateTimer.setInterval(0);
+    QObject::connect(&m_updateStateTimer, &QTimer::timeout, [this]() {
+        updateState(m_pendingQueries, update_state_change);
+    });
 }
 
 QWaylandTextInput::~QWaylandTextInput()
@@ -112,8 +128,21 @@ void QWaylandTextInput::resetCallback(void *data, wl_callback *, uint32_t)
     }
 }
 
+void QWaylandTextInput::scheduleUpdateState(Qt::InputMethodQueries queries)
+{
+    // A single key press typically results in several QInputMethod::update() calls
+    m_pendingQueries |= queries;
+    if (!m_updateStateTimer.isActive())
+        m_updateStateTimer.start();
+}
+
 void QWaylandTextInput::updateState(Qt::InputMethodQueries queries, uint32_t flags)
 {
+    // Any state scheduled for later goes out with this request
+    queries |= m_pendingQueries;
+    m_pendingQueries = Qt::InputMethodQueries();
+    m_updateStateTimer.stop();
+
     if (!QGuiApplication::focusObject())
         return;
 
@@ -138,17 +167,22 @@ void QWaylandTextInput::updateState(Qt::InputMethodQueries queries, uint32_t fla
         int cursor = event.value(Qt::ImCursorPosition).toInt();
         int anchor = event.value(Qt::ImAnchorPosition).toInt();
 
-        // Make sure text is not too big
-        if (text.toUtf8().size() > 2048) {
-            int c = qAbs(cursor - anchor) <= 512 ? qMin(cursor, anchor) + qAbs(cursor - anchor) / 2: cursor;
-
-            const int offset = c - qBound(0, c, 512 - qMin(text.size() - c, 256));
-            text = text.mid(offset + c - 256, 512);
-            cursor -= offset;
-            anchor -= offset;
+        // Only send a window of the text around the cursor, centered on the selection if it fits
+        const int window = surroundingTextWindow();
+        if (text.size() > window) {
+            const int c = qAbs(cursor - anchor) <= window ? qMin(cursor, anchor) + qAbs(cursor - anchor) / 2 : cursor;
+            const int offset = qBound(0, c - window / 2, text.size() - window);
+            text = text.mid(offset, window);
+            cursor = qBound(0, cursor - offset, window);
+            anchor = qBound(0, anchor - offset, window);
         }
 
-        set_surrounding_text(text, QWaylandInputMethodEventBuilder::indexToWayland(text, cursor), QWaylandInputMethodEventBuilder::indexToWayland(text, anchor));
+        if (flags != update_state_change || cursor != m_surroundingCursor || anchor != m_surroundingAnchor || text != m_surroundingText) {
+            set_surrounding_text(text, QWaylandInputMethodEventBuilder::indexToWayland(text, cursor), QWaylandInputMethodEventBuilder::indexToWayland(text, anchor));
+            m_surroundingText = text;
+            m_surroundingCursor = cursor;
+            m_surroundingAnchor = anchor;
+        }
     }
 
     if (queries & Qt::ImHints) {
@@ -287,6 +321,10 @@ void QWaylandTextInput::zwp_text_input_v2_preedit_cursor(int32_t index)
 
 void QWaylandTextInput::zwp_text_input_v2_commit_string(const QString &text)
 {
+    // The compositor has applied the commit to its copy of the surrounding text,
+    // make sure the next update corrects it whatever the client made of it
+    m_surroundingCursor = -1;
+
     if (m_resetCallback) {
         qCDebug(qLcQpaInputMethods()) << "discard commit_string: reset not confirmed";
         m_builder.reset();
@@ -437,7 +475,7 @@ void QWaylandInputContext::update(Qt::InputMethodQueries queries)
         }
     }
 
-    textInput()->updateState(queries, QtWayland::zwp_text_input_v2::update_state_change);
+    textInput()->scheduleUpdateState(queries);
 }
 
 void QWaylandInputContext::invokeAction(QInputMethod::Action action, int cursorPostion)
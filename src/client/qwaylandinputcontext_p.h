@@ -57,6 +57,7 @@
 #include <QLoggingCategory>
 #include <QPointer>
 #include <QRectF>
+#include <QTimer>
 #include <QVector>
 
 #include <QtWaylandClient/private/qwayland-text-input-unstable-v2.h>
@@ -79,6 +80,7 @@ public:
     void reset();
     void commit();
     void updateState(Qt::InputMethodQueries queries, uint32_t flags);
+    void scheduleUpdateState(Qt::InputMethodQueries queries);
 
     void setCursorInsidePreedit(int cursor);
 
@@ -122,6 +124,15 @@ private:
     QLocale m_locale;
     Qt::LayoutDirection m_inputDirection = Qt::LayoutDirectionAuto;
 
+    // update_state_change requests are coalesced until the event loop is idle
+    QTimer m_updateStateTimer;
+    Qt::InputMethodQueries m_pendingQueries;
+
+    // What was last sent with set_surrounding_text, to avoid resending it
+    QString m_surroundingText;
+    int m_surroundingCursor = -1;
+    int m_surroundingAnchor = -1;
+
     struct ::wl_callback *m_resetCallback = nullptr;
     static const wl_callback_listener callbackListener;
     static void resetCallback(void *data, struct wl_callback *wl_callback, uint32_t time);
@@ -71,6 +71,7 @@
 #include <QtGui/QGuiApplication>
 
 #if QT_CONFIG(xkbcommon_evdev)
+#include "qwaylandkeymapcache_p.h"
 #include <xkbcommon/xkbcommon-compose.h>
 #endif
 
@@ -92,15 +93,15 @@ bool QWaylandInputDevice::Keyboard::createDefaultKeyMap()
     }
 
     xkb_rule_names names;
-    names.rules = strdup("evdev");
-    names.model = strdup("pc105");
-    names.layout = strdup("us");
-    names.variant = strdup("");
-    names.options = strdup("");
+    names.rules = "evdev";
+    names.model = "pc105";
+    names.layout = "us";
+    names.variant = "";
+    names.options = "";
 
-    mXkbContext = xkb_context_new(xkb_context_flags(0));
+    mXkbContext = QWaylandKeymapCache::context();
     if (mXkbContext) {
-        mXkbMap = xkb_map_new_from_names(mXkbContext, &names, xkb_map_compile_flags(0));
+        mXkbMap = QWaylandKeymapCache::keymapFromNames(names);
         if (mXkbMap) {
             mXkbState = xkb_state_new(mXkbMap);
         }
@@ -122,6 +123,9 @@ void QWaylandInputDevice::Keyboard::releaseKeyMap()
         xkb_map_unref(mXkbMap);
     if (mXkbContext)
         xkb_context_unref(mXkbContext);
+    mXkbState = nullptr;
+    mXkbMap = nullptr;
+    mXkbContext = nullptr;
 }
 
 void QWaylandInputDevice::Keyboard::createComposeState()
@@ -137,7 +141,8 @@ void QWaylandInputDevice::Keyboard::createComposeState()
             locale = "C";
     }
 
-    mXkbComposeTable = xkb_compose_table_new_from_locale(mXkbContext, locale, XKB_COMPOSE_COMPILE_NO_FLAGS);
+    // The table only depends on the locale, so keymap changes reuse it
+    mXkbComposeTable = QWaylandKeymapCache::composeTable(QByteArray(locale));
     if (mXkbComposeTable)
         mXkbComposeState = xkb_compose_state_new(mXkbComposeTable, XKB_COMPOSE_STATE_NO_FLAGS);
 }
@@ -214,10 +219,18 @@ QWaylandInputDevice::QWaylandInputDevice(QWaylandDisplay *display, int version,
     if (mQDisplay->textInputManager()) {
         mTextInput = new QWaylandTextInput(mQDisplay, mQDisplay->textInputManager()->get_text_input(wl_seat()));
     }
+
+#if QT_CONFIG(cursor)
+    mCursorFrameTimer.setSingleShot(true);
+    connect(&mCursorFrameTimer, &QTimer::timeout, this, &QWaylandInputDevice::nextCursorFrame);
+#endif
 }
 
 QWaylandInputDevice::~QWaylandInputDevice()
 {
+#if QT_CONFIG(cursor)
+    stopCursorAnimation();
+#endif
     delete mPointer;
     delete mKeyboard;
     delete mTouch;
@@ -240,6 +253,9 @@ void QWaylandInputDevice::seat_capabilities(uint32_t caps)
         mPointer->init(get_pointer());
         pointerSurface = mQDisplay->createSurface(this);
     } else if (!(caps & WL_SEAT_CAPABILITY_POINTER) && mPointer) {
+#if QT_CONFIG(cursor)
+        stopCursorAnimation();
+#endif
         delete mPointer;
         mPointer = nullptr;
     }
@@ -365,13 +381,17 @@ uint32_t QWaylandInputDevice::cursorSerial() const
 
 void QWaylandInputDevice::setCursor(Qt::CursorShape newShape, QWaylandScreen *screen)
 {
-    struct wl_cursor_image *image = screen->waylandCursor()->cursorImage(newShape);
-    if (!image) {
+    const QVector<QWaylandCursorTheme::Image> frames = screen->waylandCursor()->cursorFrames(newShape);
+    if (frames.isEmpty()) {
         return;
     }
 
-    struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
-    setCursor(buffer, image, screen->devicePixelRatio());
+    const QWaylandCursorTheme::Image &image = frames.first();
+    setCursor(image.buffer, image.hotSpot, image.size, screen->devicePixelRatio());
+
+    // Setting an animated cursor again doesn't restart its animation
+    if (frames.size() > 1 && mCursorFrames.isEmpty() && mPointer && mPointer->mCursorBuffer == image.buffer)
+        startCursorAnimation(frames, screen->devicePixelRatio());
 }
 
 void QWaylandInputDevice::setCursor(const QCursor &cursor, QWaylandScreen *screen)
@@ -387,43 +407,108 @@ void QWaylandInputDevice::setCursor(const QCursor &cursor, QWaylandScreen *scree
     setCursor(cursor.shape(), screen);
 }
 
-void QWaylandInputDevice::setCursor(struct wl_buffer *buffer, struct wl_cursor_image *image, int bufferScale)
-{
-    setCursor(buffer,
-              image ? QPoint(image->hotspot_x, image->hotspot_y) : QPoint(),
-              image ? QSize(image->width, image->height) : QSize(), bufferScale);
-}
-
 void QWaylandInputDevice::setCursor(struct wl_buffer *buffer, const QPoint &hotSpot, const QSize &size, int bufferScale)
 {
     if (mCaps & WL_SEAT_CAPABILITY_POINTER) {
         bool force = mPointer->mEnterSerial > mPointer->mCursorSerial;
+        const uint generation = QWaylandCursor::bufferGeneration();
 
-        if (!force && mPointer->mCursorBuffer == buffer)
+        if (!force && mPointer->mCursorBuffer == buffer && mPointer->mCursorBufferGeneration == generation
+                && mPointer->mCursorHotSpot == hotSpot && mPointer->mCursorBufferScale == bufferScale)
             return;
 
+        // The cursor surface keeps its content, e.g. when entering another surface
+        const bool attached = mPointer->mAttachedCursorBuffer == buffer
+                && mPointer->mAttachedCursorBufferGeneration == generation
+                && mPointer->mCursorBufferScale == bufferScale;
+
+        stopCursorAnimation();
         mPixmapCursor.clear();
         mPointer->mCursorSerial = mPointer->mEnterSerial;
 
         mPointer->mCursorBuffer = buffer;
+        mPointer->mCursorBufferGeneration = generation;
+        mPointer->mCursorHotSpot = hotSpot;
+        mPointer->mCursorBufferScale = bufferScale;
 
         /* Hide cursor */
         if (!buffer)
         {
             mPointer->set_cursor(mPointer->mEnterSerial, nullptr, 0, 0);
+            // The attached buffer may be destroyed while the cursor is hidden
+            mPointer->mAttachedCursorBuffer = nullptr;
             return;
         }
 
         mPointer->set_cursor(mPointer->mEnterSerial, pointerSurface,
                              hotSpot.x(), hotSpot.y());
-        wl_surface_attach(pointerSurface, buffer, 0, 0);
-        if (mQDisplay->compositorVersion() >= 3)
-            wl_surface_set_buffer_scale(pointerSurface, bufferScale);
-        wl_surface_damage(pointerSurface, 0, 0, size.width(), size.height());
-        wl_surface_commit(pointerSurface);
+        if (!attached)
+            attachCursor(buffer, size, bufferScale);
     }
 }
 
+void QWaylandInputDevice::attachCursor(struct wl_buffer *buffer, const QSize &size, int bufferScale)
+{
+    wl_surface_attach(pointerSurface, buffer, 0, 0);
+    if (mQDisplay->compositorVersion() >= 3)
+        wl_surface_set_buffer_scale(pointerSurface, bufferScale);
+    wl_surface_damage(pointerSurface, 0, 0, size.width(), size.height());
+    wl_surface_commit(pointerSurface);
+    mPointer->mAttachedCursorBuffer = buffer;
+    mPointer->mAttachedCursorBufferGeneration = QWaylandCursor::bufferGeneration();
+}
+
+const struct wl_callback_listener QWaylandInputDevice::cursorFrameListener = {
+    QWaylandInputDevice::cursorFrameCallback
+};
+
+void QWaylandInputDevice::startCursorAnimation(const QVector<QWaylandCursorTheme::Image> &frames, int bufferScale)
+{
+    mCursorFrames = frames;
+    mCursorFrame = 0;
+    mCursorFrameScale = bufferScale;
+    mCursorFrameTimer.start(int(frames.first().delay));
+}
+
+void QWaylandInputDevice::stopCursorAnimation()
+{
+    mCursorFrames.clear();
+    mCursorFrameTimer.stop();
+    if (mCursorFrameCallback) {
+        wl_callback_destroy(mCursorFrameCallback);
+        mCursorFrameCallback = nullptr;
+    }
+}
+
+void QWaylandInputDevice::nextCursorFrame()
+{
+    if (mCursorFrames.isEmpty() || !mPointer)
+        return;
+
+    const QPoint previousHotSpot = mCursorFrames.at(mCursorFrame).hotSpot;
+    mCursorFrame = (mCursorFrame + 1) % mCursorFrames.size();
+    const QWaylandCursorTheme::Image &frame = mCursorFrames.at(mCursorFrame);
+
+    if (frame.hotSpot != previousHotSpot)
+        mPointer->set_cursor(mPointer->mEnterSerial, pointerSurface, frame.hotSpot.x(), frame.hotSpot.y());
+
+    // The next frame is only scheduled once this one has been shown, so
+    // cursors that are not visible stop animating
+    mCursorFrameCallback = wl_surface_frame(pointerSurface);
+    wl_callback_add_listener(mCursorFrameCallback, &cursorFrameListener, this);
+    attachCursor(frame.buffer, frame.size, mCursorFrameScale);
+}
+
+void QWaylandInputDevice::cursorFrameCallback(void *data, struct wl_callback *callback, uint32_t time)
+{
+    Q_UNUSED(time);
+    QWaylandInputDevice *self = static_cast<QWaylandInputDevice *>(data);
+    wl_callback_destroy(callback);
+    self->mCursorFrameCallback = nullptr;
+    if (!self->mCursorFrames.isEmpty())
+        self->mCursorFrameTimer.start(int(self->mCursorFrames.at(self->mCursorFrame).delay));
+}
+
 void QWaylandInputDevice::setCursor(const QSharedPointer<QWaylandBuffer> &buffer, const QPoint &hotSpot, int bufferScale)
 {
     setCursor(buffer->buffer(), hotSpot, buffer->size(), bufferScale);
@@ -451,7 +536,8 @@ void QWaylandInputDevice::Pointer::pointer_enter(uint32_t serial, struct wl_surf
 #endif
 
     mFocus = window;
-    mSurfacePos = QPointF(wl_fixed_to_double(sx), wl_fixed_to_double(sy));
+    mFocusSurface = surface;
+    mSurfacePos = window->mapFromWlSurface(surface, QPointF(wl_fixed_to_double(sx), wl_fixed_to_double(sy)));
     mGlobalPos = window->window()->mapToGlobal(mSurfacePos.toPoint());
 
     mParent->mSerial = serial;
@@ -476,6 +562,7 @@ void QWaylandInputDevice::Pointer::pointer_leave(uint32_t time, struct wl_surfac
         window->handleMouseLeave(mParent);
     }
     mFocus = nullptr;
+    mFocusSurface = nullptr;
     mButtons = Qt::NoButton;
 
     mParent->mTime = time;
@@ -500,7 +587,7 @@ void QWaylandInputDevice::Pointer::pointer_motion(uint32_t time, wl_fixed_t surf
         return;
     }
 
-    QPointF pos(wl_fixed_to_double(surface_x), wl_fixed_to_double(surface_y));
+    QPointF pos = window->mapFromWlSurface(mFocusSurface, QPointF(wl_fixed_to_double(surface_x), wl_fixed_to_double(surface_y)));
     QPointF delta = pos - pos.toPoint();
     QPointF global = window->window()->mapToGlobal(pos.toPoint());
     global += delta;
@@ -636,11 +723,16 @@ void QWaylandInputDevice::Keyboard::keyboard_keymap(uint32_t format, int32_t fd,
     releaseComposeState();
     releaseKeyMap();
 
-    mXkbContext = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-    mXkbMap = xkb_map_new_from_string(mXkbContext, map_str, XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    mXkbContext = QWaylandKeymapCache::context();
+    mXkbMap = QWaylandKeymapCache::keymapFromString(map_str, size);
     munmap(map_str, size);
     close(fd);
 
+    if (!mXkbMap) {
+        qWarning() << "Failed to compile the keymap sent by the compositor";
+        return;
+    }
+
     mXkbState = xkb_state_new(mXkbMap);
     createComposeState();
 
@@ -838,6 +930,7 @@ void QWaylandInputDevice::Touch::touch_down(uint32_t serial,
     mParent->mTime = time;
     mParent->mSerial = serial;
     mFocus = QWaylandWindow::fromWlSurface(surface);
+    mFocusSurface = surface;
     mParent->mQDisplay->setLastInputDevice(mParent, serial, mFocus);
     mParent->handleTouchPoint(id, wl_fixed_to_double(x), wl_fixed_to_double(y), Qt::TouchPointPressed);
 }
@@ -902,9 +995,13 @@ void QWaylandInputDevice::handleTouchPoint(int id, double x, double y, Qt::Touch
         if (!win || !win->window())
             return;
 
+        QPointF pos(x, y);
+        if (win == mTouch->mFocus)
+            pos = win->mapFromWlSurface(mTouch->mFocusSurface, pos);
+
         tp.area = QRectF(0, 0, 8, 8);
         QMargins margins = win->frameMargins();
-        tp.area.moveCenter(win->window()->mapToGlobal(QPoint(x - margins.left(), y - margins.top())));
+        tp.area.moveCenter(win->window()->mapToGlobal(QPoint(pos.x() - margins.left(), pos.y() - margins.top())));
     }
 
     tp.state = state;
@@ -64,6 +64,9 @@
 #include <wayland-client.h>
 
 #include <QtWaylandClient/private/qwayland-wayland.h>
+#if QT_CONFIG(cursor)
+#include <QtWaylandClient/private/qwaylandcursor_p.h>
+#endif
 
 #if QT_CONFIG(xkbcommon_evdev)
 #include <xkbcommon/xkbcommon.h>
@@ -73,10 +76,6 @@
 #include <QtCore/QDebug>
 #include <QPointer>
 
-#if QT_CONFIG(cursor)
-struct wl_cursor_image;
-#endif
-
 #if QT_CONFIG(xkbcommon_evdev)
 struct xkb_compose_state;
 struct xkb_compose_table;
@@ -110,7 +109,6 @@ public:
 
 #if QT_CONFIG(cursor)
     void setCursor(const QCursor &cursor, QWaylandScreen *screen);
-    void setCursor(struct wl_buffer *buffer, struct ::wl_cursor_image *image, int bufferScale);
     void setCursor(struct wl_buffer *buffer, const QPoint &hotSpot, const QSize &size, int bufferScale);
     void setCursor(const QSharedPointer<QWaylandBuffer> &buffer, const QPoint &hotSpot, int bufferScale);
 #endif
@@ -141,7 +139,15 @@ public:
     virtual Touch *createTouch(QWaylandInputDevice *device);
 
 private:
+#if QT_CONFIG(cursor)
     void setCursor(Qt::CursorShape cursor, QWaylandScreen *screen);
+    void attachCursor(struct wl_buffer *buffer, const QSize &size, int bufferScale);
+    void startCursorAnimation(const QVector<QWaylandCursorTheme::Image> &frames, int bufferScale);
+    void stopCursorAnimation();
+    void nextCursorFrame();
+    static void cursorFrameCallback(void *data, struct wl_callback *callback, uint32_t time);
+    static const struct wl_callback_listener cursorFrameListener;
+#endif
 
     QWaylandDisplay *mQDisplay = nullptr;
     struct wl_display *mDisplay = nullptr;
@@ -170,6 +176,13 @@ private:
     QTouchDevice *mTouchDevice = nullptr;
 
     QSharedPointer<QWaylandBuffer> mPixmapCursor;
+#if QT_CONFIG(cursor)
+    QVector<QWaylandCursorTheme::Image> mCursorFrames;
+    int mCursorFrame = 0;
+    int mCursorFrameScale = 1;
+    struct wl_callback *mCursorFrameCallback = nullptr;
+    QTimer mCursorFrameTimer;
+#endif
 
     friend class QWaylandTouchExtension;
     friend class QWaylandQtKeyExtension;
@@ -264,6 +277,7 @@ public:
 
     QWaylandInputDevice *mParent = nullptr;
     QPointer<QWaylandWindow> mFocus;
+    ::wl_surface *mFocusSurface = nullptr;
     uint32_t mEnterSerial = 0;
 #if QT_CONFIG(cursor)
     uint32_t mCursorSerial = 0;
@@ -273,6 +287,11 @@ public:
     Qt::MouseButtons mButtons = Qt::NoButton;
 #if QT_CONFIG(cursor)
     wl_buffer *mCursorBuffer = nullptr;
+    uint mCursorBufferGeneration = 0;
+    QPoint mCursorHotSpot;
+    int mCursorBufferScale = 1;
+    wl_buffer *mAttachedCursorBuffer = nullptr;
+    uint mAttachedCursorBufferGeneration = 0;
     Qt::CursorShape mCursorShape = Qt::BitmapCursor;
 #endif
 };
@@ -304,6 +323,7 @@ public:
 
     QWaylandInputDevice *mParent = nullptr;
     QPointer<QWaylandWindow> mFocus;
+    ::wl_surface *mFocusSurface = nullptr;
     QList<QWindowSystemInterface::TouchPoint> mTouchPoints;
     QList<QWindowSystemInterface::TouchPoint> mPrevTouchPoints;
 };
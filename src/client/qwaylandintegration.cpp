@@ -51,6 +51,7 @@
 #include "qwaylanddnd_p.h"
 #include "qwaylandwindowmanagerintegration_p.h"
 #include "qwaylandscreen_p.h"
+#include "qwaylandstartupprofiler_p.h"
 
 #include <QtFontDatabaseSupport/private/qgenericunixfontdatabase_p.h>
 #include <QtEventDispatcherSupport/private/qgenericunixeventdispatcher_p.h>
@@ -124,12 +125,15 @@ QWaylandIntegration::QWaylandIntegration()
     , mAccessibility(new QPlatformAccessibility())
 #endif
 {
+    QWaylandStartupProfiler::Scope profile(QWaylandStartupProfiler::IntegrationPhase);
+
     initializeInputDeviceIntegration();
     mDisplay.reset(new QWaylandDisplay(this));
     if (!mDisplay->isInitialized()) {
         mFailed = true;
         return;
     }
+    mDisplay->initializeGlyphCache();
 #if QT_CONFIG(clipboard)
     mClipboard.reset(new QWaylandClipboard(mDisplay.data()));
 #endif
@@ -316,6 +320,7 @@ QWaylandShellIntegration *QWaylandIntegration::shellIntegration() const
 
 void QWaylandIntegration::initializeClientBufferIntegration()
 {
+    QWaylandStartupProfiler::Scope profile(QWaylandStartupProfiler::ClientBufferIntegrationPhase);
     mClientBufferIntegrationInitialized = true;
 
     QString targetKey;
@@ -347,6 +352,7 @@ void QWaylandIntegration::initializeClientBufferIntegration()
 
 void QWaylandIntegration::initializeServerBufferIntegration()
 {
+    QWaylandStartupProfiler::Scope profile(QWaylandStartupProfiler::ServerBufferIntegrationPhase);
     mServerBufferIntegrationInitialized = true;
 
     QString targetKey;
@@ -377,6 +383,7 @@ void QWaylandIntegration::initializeServerBufferIntegration()
 
 void QWaylandIntegration::initializeShellIntegration()
 {
+    QWaylandStartupProfiler::Scope profile(QWaylandStartupProfiler::ShellIntegrationPhase);
     mShellIntegrationInitialized = true;
 
     QByteArray integrationName = qgetenv("QT_WAYLAND_SHELL_INTEGRATION");
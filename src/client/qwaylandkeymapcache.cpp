@@ -0,0 +1,229 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandkeymapcache_p.h"
+#include "qwaylanddisplay_p.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
+#include <string.h>
+
+#include <xkbcommon/xkbcommon.h>
+#include <xkbcommon/xkbcommon-compose.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+/*
+    Compositors send the same serialized keymap to every client, and
+    usually to every wl_keyboard of a client. Compiling it is by far the
+    most expensive part of handling wl_keyboard.keymap, so compiled keymaps
+    are cached by their content and shared by all keyboards of the
+    process. Compiled keymaps are immutable, which makes sharing them safe.
+
+    Like the keyboards using it, the cache is only used from the GUI thread.
+    Set QT_WAYLAND_DISABLE_KEYMAP_CACHE to compile every keymap anew.
+*/
+
+static const int MaximumCachedKeymaps = 8;
+
+namespace {
+
+struct KeymapCacheData
+{
+    ~KeymapCacheData()
+    {
+        clear();
+        if (context)
+            xkb_context_unref(context);
+    }
+
+    void clear()
+    {
+        for (xkb_keymap *keymap : qAsConst(keymaps))
+            xkb_keymap_unref(keymap);
+        keymaps.clear();
+        usageOrder.clear();
+        if (composeTable)
+            xkb_compose_table_unref(composeTable);
+        composeTable = nullptr;
+        composeLocale.clear();
+        compiledKeymaps = 0;
+    }
+
+    xkb_keymap *find(const QByteArray &key)
+    {
+        xkb_keymap *keymap = keymaps.value(key);
+        if (keymap) {
+            usageOrder.removeOne(key);
+            usageOrder.append(key);
+        }
+        return keymap;
+    }
+
+    void insert(const QByteArray &key, xkb_keymap *keymap)
+    {
+        if (usageOrder.size() >= MaximumCachedKeymaps)
+            xkb_keymap_unref(keymaps.take(usageOrder.takeFirst()));
+        keymaps.insert(key, xkb_keymap_ref(keymap));
+        usageOrder.append(key);
+    }
+
+    xkb_context *context = nullptr;
+    QHash<QByteArray, xkb_keymap *> keymaps;
+    QList<QByteArray> usageOrder; // least recently used first
+    QByteArray composeLocale;
+    xkb_compose_table *composeTable = nullptr;
+    int compiledKeymaps = 0; // since the last clear()
+};
+
+}
+
+Q_GLOBAL_STATIC(KeymapCacheData, cacheData)
+
+bool QWaylandKeymapCache::isEnabled()
+{
+    static const bool enabled = qEnvironmentVariableIsEmpty("QT_WAYLAND_DISABLE_KEYMAP_CACHE");
+    return enabled;
+}
+
+xkb_context *QWaylandKeymapCache::context()
+{
+    KeymapCacheData *data = cacheData();
+    if (!data->context)
+        data->context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+    return data->context ? xkb_context_ref(data->context) : nullptr;
+}
+
+xkb_keymap *QWaylandKeymapCache::keymapFromString(const char *keymap, size_t size)
+{
+    // The size sent by compositors usually includes the terminating null
+    const QByteArray text(keymap, int(strnlen(keymap, size)));
+
+    if (isEnabled()) {
+        if (xkb_keymap *cached = cacheData()->find(text))
+            return xkb_keymap_ref(cached);
+    }
+
+    xkb_context *ctx = context();
+    if (!ctx)
+        return nullptr;
+
+    QElapsedTimer timer;
+    timer.start();
+    xkb_keymap *compiled = xkb_keymap_new_from_string(ctx, text.constData(), XKB_KEYMAP_FORMAT_TEXT_V1,
+                                                      XKB_KEYMAP_COMPILE_NO_FLAGS);
+    xkb_context_unref(ctx);
+    ++cacheData()->compiledKeymaps;
+    qCDebug(lcQpaWayland) << "Compiled" << text.size() << "byte keymap in" << timer.nsecsElapsed() / 1000 << "us";
+
+    if (compiled && isEnabled())
+        cacheData()->insert(text, compiled);
+    return compiled;
+}
+
+xkb_keymap *QWaylandKeymapCache::keymapFromNames(const xkb_rule_names &names)
+{
+    // Null is not a valid part of any of the names, so it can separate them
+    QByteArray key("names");
+    for (const char *name : {names.rules, names.model, names.layout, names.variant, names.options})
+        key += '\0' + QByteArray(name);
+
+    if (isEnabled()) {
+        if (xkb_keymap *cached = cacheData()->find(key))
+            return xkb_keymap_ref(cached);
+    }
+
+    xkb_context *ctx = context();
+    if (!ctx)
+        return nullptr;
+
+    xkb_keymap *compiled = xkb_keymap_new_from_names(ctx, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    xkb_context_unref(ctx);
+    ++cacheData()->compiledKeymaps;
+
+    if (compiled && isEnabled())
+        cacheData()->insert(key, compiled);
+    return compiled;
+}
+
+xkb_compose_table *QWaylandKeymapCache::composeTable(const QByteArray &locale)
+{
+    KeymapCacheData *data = cacheData();
+    if (isEnabled() && data->composeTable && data->composeLocale == locale)
+        return xkb_compose_table_ref(data->composeTable);
+
+    xkb_context *ctx = context();
+    if (!ctx)
+        return nullptr;
+
+    xkb_compose_table *table = xkb_compose_table_new_from_locale(ctx, locale.constData(), XKB_COMPOSE_COMPILE_NO_FLAGS);
+    xkb_context_unref(ctx);
+
+    if (table && isEnabled()) {
+        if (data->composeTable)
+            xkb_compose_table_unref(data->composeTable);
+        data->composeTable = xkb_compose_table_ref(table);
+        data->composeLocale = locale;
+    }
+    return table;
+}
+
+int QWaylandKeymapCache::cachedKeymapCount()
+{
+    return cacheData()->keymaps.size();
+}
+
+int QWaylandKeymapCache::compiledKeymapCount()
+{
+    return cacheData()->compiledKeymaps;
+}
+
+void QWaylandKeymapCache::clear()
+{
+    cacheData()->clear();
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwaylandpresentationtime_p.h"
+#include "qwaylanddisplay_p.h"
+#include "qwaylandwindow_p.h"
+
+#include <time.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+QWaylandPresentationTime::QWaylandPresentationTime(QWaylandDisplay *display, uint32_t id)
+    : QtWayland::wp_presentation(display->wl_registry(), id, 1)
+    , mClockId(CLOCK_MONOTONIC)
+{
+}
+
+QWaylandPresentationTime::~QWaylandPresentationTime()
+{
+    destroy();
+}
+
+void QWaylandPresentationTime::wp_presentation_clock_id(uint32_t clk_id)
+{
+    mClockId = clk_id;
+}
+
+QWaylandPresentationFeedback::QWaylandPresentationFeedback(QWaylandWindow *window, struct ::wp_presentation_feedback *feedback)
+    : QtWayland::wp_presentation_feedback(feedback)
+    , mWindow(window)
+{
+}
+
+QWaylandPresentationFeedback::~QWaylandPresentationFeedback()
+{
+    wp_presentation_feedback_destroy(object());
+}
+
+// The window owns the feedback, and deletes it when it's told about the result
+void QWaylandPresentationFeedback::wp_presentation_feedback_presented(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags)
+{
+    const qint64 seconds = qint64((quint64(tv_sec_hi) << 32) | tv_sec_lo);
+    const quint64 sequence = (quint64(seq_hi) << 32) | seq_lo;
+    mWindow->handlePresented(this, seconds * 1000000000 + tv_nsec, refresh, sequence, flags);
+}
+
+void QWaylandPresentationFeedback::wp_presentation_feedback_discarded()
+{
+    mWindow->handleDiscarded(this);
+}
+
+}
+
+QT_END_NAMESPACE
@@ -75,7 +75,8 @@ Q_LOGGING_CATEGORY(logCategory, "qt.qpa.wayland.backingstore")
 QWaylandShmBuffer::QWaylandShmBuffer(QWaylandDisplay *display,
                      const QSize &size, QImage::Format format, int scale)
 {
-    int stride = size.width() * 4;
+    // QImage requires 32-bit aligned scanlines, which also satisfies wl_shm
+    int stride = ((size.width() * QImage::toPixelFormat(format).bitsPerPixel() + 31) / 32) * 4;
     int alloc = stride * size.height();
     int fd = -1;
 
@@ -221,14 +222,15 @@ void QWaylandShmBackingStore::flush(QWindow *window, const QRegion &region, cons
     Q_UNUSED(window);
     Q_UNUSED(offset);
 
+    QRegion decorationDamage;
     if (windowDecoration() && windowDecoration()->isDirty())
-        updateDecorations();
+        decorationDamage = updateDecorations();
 
     mFrontBuffer = mBackBuffer;
 
     QMargins margins = windowDecorationMargins();
 
-    waylandWindow()->commit(mFrontBuffer, region.translated(margins.left(), margins.top()));
+    waylandWindow()->commit(mFrontBuffer, region.translated(margins.left(), margins.top()) + decorationDamage);
 }
 
 void QWaylandShmBackingStore::resize(const QSize &size, const QRegion &)
@@ -236,11 +238,11 @@ void QWaylandShmBackingStore::resize(const QSize &size, const QRegion &)
     mRequestedSize = size;
 }
 
-QWaylandShmBuffer *QWaylandShmBackingStore::getBuffer(const QSize &size)
+QWaylandShmBuffer *QWaylandShmBackingStore::getBuffer(const QSize &size, QImage::Format format)
 {
     foreach (QWaylandShmBuffer *b, mBuffers) {
         if (!b->busy()) {
-            if (b->size() == size) {
+            if (b->size() == size && b->image()->format() == format) {
                 return b;
             } else {
                 mBuffers.removeOne(b);
@@ -253,7 +255,6 @@ QWaylandShmBuffer *QWaylandShmBackingStore::getBuffer(const QSize &size)
 
     static const int MAX_BUFFERS = 5;
     if (mBuffers.count() < MAX_BUFFERS) {
-        QImage::Format format = QPlatformScreen::platformScreenForWindow(window())->format();
         QWaylandShmBuffer *b = new QWaylandShmBuffer(mDisplay, size, format, waylandWindow()->scale());
         mBuffers.prepend(b);
         return b;
@@ -261,11 +262,40 @@ QWaylandShmBuffer *QWaylandShmBackingStore::getBuffer(const QSize &size)
     return nullptr;
 }
 
+QImage::Format QWaylandShmBackingStore::bufferFormat() const
+{
+    // The depth follows the window's requested surface format. The decoration
+    // has rounded corners, so only undecorated windows without alpha are opaque.
+    const QSurfaceFormat surfaceFormat = window()->requestedFormat();
+    const bool opaque = !surfaceFormat.hasAlpha() && !windowDecoration();
+    const int red = surfaceFormat.redBufferSize();
+    const int green = surfaceFormat.greenBufferSize();
+    const int blue = surfaceFormat.blueBufferSize();
+
+    QImage::Format format;
+    if (red == 5 && green == 6 && blue == 5 && opaque)
+        format = QImage::Format_RGB16;
+    else if (red == 10 && green == 10 && blue == 10)
+        format = opaque ? QImage::Format_RGB30 : QImage::Format_A2RGB30_Premultiplied;
+    else if (opaque)
+        format = QImage::Format_RGB32;
+    else
+        format = QPlatformScreen::platformScreenForWindow(window())->format();
+
+    if (!mDisplay->shm()->formatSupported(format)) {
+        // XRGB8888 and ARGB8888 are supported by every compositor
+        qCDebug(logCategory, "QWaylandShmBackingStore: compositor does not support image format %d, falling back", format);
+        format = opaque ? QImage::Format_RGB32 : QImage::Format_ARGB32_Premultiplied;
+    }
+    return format;
+}
+
 void QWaylandShmBackingStore::resize(const QSize &size)
 {
     QMargins margins = windowDecorationMargins();
     int scale = waylandWindow()->scale();
     QSize sizeWithMargins = (size + QSize(margins.left()+margins.right(),margins.top()+margins.bottom())) * scale;
+    QImage::Format format = bufferFormat();
 
     // We look for a free buffer to draw into. If the buffer is not the last buffer we used,
     // that is mBackBuffer, and the size is the same we memcpy the old content into the new
@@ -275,18 +305,23 @@ void QWaylandShmBackingStore::resize(const QSize &size)
     // You can exercise the different codepaths with weston, switching between the gl and the
     // pixman renderer. With the gl renderer release events are sent early so we can effectively
     // run single buffered, while with the pixman renderer we have to use two.
-    QWaylandShmBuffer *buffer = getBuffer(sizeWithMargins);
+    QWaylandShmBuffer *buffer = getBuffer(sizeWithMargins, format);
     while (!buffer) {
         qCDebug(logCategory, "QWaylandShmBackingStore: stalling waiting for a buffer to be released from the compositor...");
 
         mDisplay->blockingReadEvents();
-        buffer = getBuffer(sizeWithMargins);
+        buffer = getBuffer(sizeWithMargins, format);
     }
 
     qsizetype oldSize = mBackBuffer ? mBackBuffer->image()->sizeInBytes() : 0;
-    // mBackBuffer may have been deleted here but if so it means its size was different so we wouldn't copy it anyway
-    if (mBackBuffer != buffer && oldSize == buffer->image()->sizeInBytes()) {
+    // The decoration only needs repainting when the buffer no longer holds what was drawn
+    // into the previous one, that is when its size, scale or format changed
+    bool contentsKept = mBackBuffer == buffer;
+    // mBackBuffer may have been deleted here but if so it means its size or format was different so we wouldn't copy it anyway
+    if (mBackBuffer != buffer && oldSize == buffer->image()->sizeInBytes()
+            && mBackBuffer->image()->format() == format) {
         memcpy(buffer->image()->bits(), mBackBuffer->image()->constBits(), buffer->image()->sizeInBytes());
+        contentsKept = true;
     }
     mBackBuffer = buffer;
     // ensure the new buffer is at the beginning of the list so next time getBuffer() will pick
@@ -296,7 +331,7 @@ void QWaylandShmBackingStore::resize(const QSize &size)
         mBuffers.prepend(buffer);
     }
 
-    if (windowDecoration() && window()->isVisible())
+    if (windowDecoration() && window()->isVisible() && !contentsKept)
         windowDecoration()->update();
 }
 
@@ -310,42 +345,32 @@ QImage *QWaylandShmBackingStore::contentSurface() const
     return windowDecoration() ? mBackBuffer->imageInsideMargins(windowDecorationMargins()) : mBackBuffer->image();
 }
 
-void QWaylandShmBackingStore::updateDecorations()
+QRegion QWaylandShmBackingStore::updateDecorations()
 {
+    // Only the margin tiles that changed are copied into the buffer, the decoration
+    // never needs an image the size of the whole window.
+    const QRegion dirty = windowDecoration()->dirtyRegion();
+
     QPainter decorationPainter(entireSurface());
     decorationPainter.setCompositionMode(QPainter::CompositionMode_Source);
-    QImage sourceImage = windowDecoration()->contentImage();
-
-    qreal dp = sourceImage.devicePixelRatio();
-    int dpWidth = int(sourceImage.width() / dp);
-    int dpHeight = int(sourceImage.height() / dp);
-    QMatrix sourceMatrix;
-    sourceMatrix.scale(dp, dp);
-    QRect target; // needs to be in device independent pixels
-
-    //Top
-    target.setX(0);
-    target.setY(0);
-    target.setWidth(dpWidth);
-    target.setHeight(windowDecorationMargins().top());
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-
-    //Left
-    target.setWidth(windowDecorationMargins().left());
-    target.setHeight(dpHeight);
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-
-    //Right
-    target.setX(dpWidth - windowDecorationMargins().right());
-    target.setWidth(windowDecorationMargins().right());
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-
-    //Bottom
-    target.setX(0);
-    target.setY(dpHeight - windowDecorationMargins().bottom());
-    target.setWidth(dpWidth);
-    target.setHeight(windowDecorationMargins().bottom());
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
+
+    for (Qt::Edge edge : { Qt::TopEdge, Qt::LeftEdge, Qt::RightEdge, Qt::BottomEdge }) {
+        const QRect target = windowDecoration()->edgeRect(edge);
+        const QRegion edgeDirty = dirty & target;
+        if (edgeDirty.isEmpty())
+            continue;
+
+        const QImage &sourceImage = windowDecoration()->edgeImage(edge);
+        if (sourceImage.isNull())
+            continue;
+
+        decorationPainter.save();
+        decorationPainter.setClipRegion(edgeDirty);
+        decorationPainter.drawImage(target.topLeft(), sourceImage);
+        decorationPainter.restore();
+    }
+
+    return dirty;
 }
 
 QWaylandAbstractDecoration *QWaylandShmBackingStore::windowDecoration() const
@@ -112,8 +112,9 @@ public:
 #endif
 
 private:
-    void updateDecorations();
-    QWaylandShmBuffer *getBuffer(const QSize &size);
+    QRegion updateDecorations();
+    QImage::Format bufferFormat() const;
+    QWaylandShmBuffer *getBuffer(const QSize &size, QImage::Format format);
 
     QWaylandDisplay *mDisplay = nullptr;
     QLinkedList<QWaylandShmBuffer *> mBuffers;
@@ -0,0 +1,174 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandstartupprofiler_p.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QMutex>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+Q_LOGGING_CATEGORY(lcQpaWaylandStartup, "qt.qpa.wayland.startup")
+
+/*
+    QWaylandStartupProfiler records when the first occurrence of each startup
+    phase began and how long it took, relative to the creation of the platform
+    integration. When the first buffer is committed, the phases are reported
+    to qt.qpa.wayland.startup, once as readable lines and once as a single
+    line of JSON meant for tracking startup time across releases.
+
+    Nothing is recorded unless debug output is enabled for the category, e.g.
+    with QT_LOGGING_RULES="qt.qpa.wayland.startup.debug=true".
+*/
+
+static const char *const phaseNames[QWaylandStartupProfiler::PhaseCount] = {
+    "integration",
+    "display",
+    "shellIntegration",
+    "clientBufferIntegration",
+    "serverBufferIntegration",
+    "initWindow",
+    "firstCommit"
+};
+
+namespace {
+
+struct StartupPhases
+{
+    StartupPhases()
+    {
+        timer.start();
+        for (int i = 0; i < QWaylandStartupProfiler::PhaseCount; ++i)
+            start[i] = finish[i] = -1;
+    }
+
+    QMutex mutex;
+    QElapsedTimer timer;
+    qint64 start[QWaylandStartupProfiler::PhaseCount];
+    qint64 finish[QWaylandStartupProfiler::PhaseCount];
+    bool reported = false;
+};
+
+}
+
+Q_GLOBAL_STATIC(StartupPhases, startupPhases)
+
+static double toMsecs(qint64 nsecs)
+{
+    return double(nsecs) / 1000000.0;
+}
+
+void QWaylandStartupProfiler::begin(Phase phase)
+{
+    if (!lcQpaWaylandStartup().isDebugEnabled())
+        return;
+
+    StartupPhases *phases = startupPhases();
+    QMutexLocker locker(&phases->mutex);
+    if (phases->start[phase] < 0)
+        phases->start[phase] = phases->timer.nsecsElapsed();
+}
+
+void QWaylandStartupProfiler::end(Phase phase)
+{
+    if (!lcQpaWaylandStartup().isDebugEnabled())
+        return;
+
+    StartupPhases *phases = startupPhases();
+    {
+        QMutexLocker locker(&phases->mutex);
+        if (phases->start[phase] < 0 || phases->finish[phase] >= 0)
+            return;
+        phases->finish[phase] = phases->timer.nsecsElapsed();
+        if (phase != FirstCommitPhase || phases->reported)
+            return;
+        phases->reported = true;
+    }
+
+    qCDebug(lcQpaWaylandStartup) << "Startup phases, in ms since the platform integration was created:";
+    const QJsonObject startupReport = report();
+    const QJsonArray reportedPhases = startupReport.value(QLatin1String("phases")).toArray();
+    for (const QJsonValue &value : reportedPhases) {
+        const QJsonObject entry = value.toObject();
+        qCDebug(lcQpaWaylandStartup, "  %-24s at %9.3f took %9.3f",
+                qPrintable(entry.value(QLatin1String("name")).toString()),
+                entry.value(QLatin1String("start")).toDouble(),
+                entry.value(QLatin1String("duration")).toDouble());
+    }
+    qCDebug(lcQpaWaylandStartup, "%s", QJsonDocument(startupReport).toJson(QJsonDocument::Compact).constData());
+}
+
+// Records a phase without duration, such as the first commit
+void QWaylandStartupProfiler::mark(Phase phase)
+{
+    begin(phase);
+    end(phase);
+}
+
+QJsonObject QWaylandStartupProfiler::report()
+{
+    StartupPhases *phases = startupPhases();
+    QMutexLocker locker(&phases->mutex);
+
+    QJsonArray entries;
+    for (int i = 0; i < PhaseCount; ++i) {
+        if (phases->start[i] < 0 || phases->finish[i] < 0)
+            continue;
+        QJsonObject entry;
+        entry.insert(QLatin1String("name"), QLatin1String(phaseNames[i]));
+        entry.insert(QLatin1String("start"), toMsecs(phases->start[i]));
+        entry.insert(QLatin1String("duration"), toMsecs(phases->finish[i] - phases->start[i]));
+        entries.append(entry);
+    }
+
+    QJsonObject result;
+    result.insert(QLatin1String("phases"), entries);
+    if (phases->finish[FirstCommitPhase] >= 0)
+        result.insert(QLatin1String("timeToFirstCommit"), toMsecs(phases->finish[FirstCommitPhase]));
+    return result;
+}
+
+}
+
+QT_END_NAMESPACE
@@ -45,11 +45,14 @@
 #include "qwaylandscreen_p.h"
 #include "qwaylandshellsurface_p.h"
 #include "qwaylandsubsurface_p.h"
+#include "qwaylanddecorationsubsurfaces_p.h"
 #include "qwaylandabstractdecoration_p.h"
 #include "qwaylandwindowmanagerintegration_p.h"
 #include "qwaylandnativeinterface_p.h"
 #include "qwaylanddecorationfactory_p.h"
 #include "qwaylandshmbackingstore_p.h"
+#include "qwaylandstartupprofiler_p.h"
+#include "qwaylandpresentationtime_p.h"
 
 #if QT_CONFIG(wayland_datadevice)
 #include "qwaylanddatadevice_p.h"
@@ -65,10 +68,14 @@
 #include <qpa/qwindowsysteminterface.h>
 #include <QtGui/private/qwindow_p.h>
 
+#include <QtWaylandClient/private/qwayland-viewporter.h>
+
 #include <QtCore/QDebug>
 
 #include <wayland-client-core.h>
 
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
@@ -121,6 +128,8 @@ void QWaylandWindow::initWindow()
     if (window()->type() == Qt::Desktop)
         return;
 
+    QWaylandStartupProfiler::Scope profile(QWaylandStartupProfiler::InitWindowPhase);
+
     if (!isInitialized()) {
         initializeWlSurface();
         QPlatformSurfaceEvent e(QPlatformSurfaceEvent::SurfaceCreated);
@@ -189,6 +198,7 @@ void QWaylandWindow::initWindow()
     // to inform the compositor that high-resolution buffers will be provided.
     if (mDisplay->compositorVersion() >= 3)
         set_buffer_scale(scale());
+    updateViewport();
 
     if (QScreen *s = window()->screen())
         setOrientationMask(s->orientationUpdateMask());
@@ -238,6 +248,16 @@ void QWaylandWindow::reset(bool sendDestroyEvent)
     mShellSurface = nullptr;
     delete mSubSurfaceWindow;
     mSubSurfaceWindow = nullptr;
+    delete mDecorationSubSurfaces;
+    mDecorationSubSurfaces = nullptr;
+    mDecorationSubSurfacesFailed = false;
+    if (mViewport) {
+        mViewport->destroy();
+        mViewport.reset();
+    }
+    // Feedback for a destroyed surface is of no use, and nothing else would free it
+    qDeleteAll(mPresentationFeedbacks);
+    mPresentationFeedbacks.clear();
     if (isInitialized())
         destroy();
 
@@ -254,6 +274,15 @@ QWaylandWindow *QWaylandWindow::fromWlSurface(::wl_surface *surface)
     return static_cast<QWaylandWindow *>(static_cast<QtWayland::wl_surface *>(wl_surface_get_user_data(surface)));
 }
 
+// Maps a position on one of the window's surfaces to frame coordinates, i.e. to
+// what the position would be if the decoration was drawn in the window's own surface
+QPointF QWaylandWindow::mapFromWlSurface(::wl_surface *surface, const QPointF &pos) const
+{
+    if (mDecorationSubSurfaces)
+        return mDecorationSubSurfaces->mapToFrame(surface, pos);
+    return pos;
+}
+
 WId QWaylandWindow::winId() const
 {
     return mWindowId;
@@ -304,7 +333,7 @@ void QWaylandWindow::setGeometry_helper(const QRect &rect)
                 qBound(window()->minimumHeight(), rect.height(), window()->maximumHeight())));
 
     if (mSubSurfaceWindow) {
-        QMargins m = QPlatformWindow::parent()->frameMargins();
+        QMargins m = static_cast<const QWaylandWindow *>(QPlatformWindow::parent())->surfaceMargins();
         mSubSurfaceWindow->set_position(rect.x() + m.left(), rect.y() + m.top());
         mSubSurfaceWindow->parent()->window()->requestUpdate();
     }
@@ -312,10 +341,12 @@ void QWaylandWindow::setGeometry_helper(const QRect &rect)
 
 void QWaylandWindow::setGeometry(const QRect &rect)
 {
+    const QSize oldSize = geometry().size();
     setGeometry_helper(rect);
+    updateViewport();
 
     if (window()->isVisible() && rect.isValid()) {
-        if (mWindowDecoration)
+        if (mWindowDecoration && geometry().size() != oldSize)
             mWindowDecoration->update();
 
         if (mResizeAfterSwap && windowType() == Egl && mSentInitialResize)
@@ -553,15 +584,74 @@ void QWaylandWindow::damage(const QRect &rect)
     damage(rect.x(), rect.y(), rect.width(), rect.height());
 }
 
+// Damage coming from the backing store is often split into many small rects,
+// each of which becomes a separate request the compositor has to process.
+// Merge neighbouring rects when their bounding box adds at most a quarter of
+// undamaged area, then keep merging the cheapest pairs until at most
+// MaxDamageRects remain.
+static const int MaxDamageRects = 16;
+
+static QVector<QRect> mergedDamageRects(const QRegion &region)
+{
+    QVector<QRect> rects;
+    QVector<qint64> areas; // damaged area covered by each merged rect
+    rects.reserve(region.rectCount());
+    areas.reserve(region.rectCount());
+
+    auto area = [](const QRect &rect) { return qint64(rect.width()) * rect.height(); };
+
+    for (const QRect &rect : region) {
+        if (!rects.isEmpty()) {
+            const QRect united = rects.last().united(rect);
+            const qint64 damaged = areas.last() + area(rect);
+            if ((area(united) - damaged) * 4 <= damaged) {
+                rects.last() = united;
+                areas.last() = damaged;
+                continue;
+            }
+        }
+        rects.append(rect);
+        areas.append(area(rect));
+    }
+
+    while (rects.size() > MaxDamageRects) {
+        int best = 0;
+        qint64 bestOverhead = std::numeric_limits<qint64>::max();
+        for (int i = 0; i < rects.size() - 1; ++i) {
+            const qint64 overhead = area(rects.at(i).united(rects.at(i + 1))) - areas.at(i) - areas.at(i + 1);
+            if (overhead < bestOverhead) {
+                best = i;
+                bestOverhead = overhead;
+            }
+        }
+        rects[best] = rects.at(best).united(rects.at(best + 1));
+        areas[best] += areas.at(best + 1);
+        rects.remove(best + 1);
+        areas.remove(best + 1);
+    }
+
+    return rects;
+}
+
 void QWaylandWindow::commit(QWaylandBuffer *buffer, const QRegion &damage)
 {
     if (!isInitialized())
         return;
 
     attachOffset(buffer);
-    for (const QRect &rect: damage)
-        wl_surface::damage(rect.x(), rect.y(), rect.width(), rect.height());
+    const QVector<QRect> rects = mergedDamageRects(damage);
+    if (mDisplay->compositorVersion() >= 4) {
+        // Send damage in buffer coordinates so the compositor doesn't have
+        // to transform it using the buffer scale.
+        for (const QRect &rect : rects)
+            damage_buffer(rect.x() * mScale, rect.y() * mScale, rect.width() * mScale, rect.height() * mScale);
+    } else {
+        for (const QRect &rect : rects)
+            wl_surface::damage(rect.x(), rect.y(), rect.width(), rect.height());
+    }
+    requestPresentationFeedback();
     wl_surface::commit();
+    QWaylandStartupProfiler::mark(QWaylandStartupProfiler::FirstCommitPhase);
 }
 
 const wl_callback_listener QWaylandWindow::callbackListener = {
@@ -601,6 +691,15 @@ QMargins QWaylandWindow::frameMargins() const
     return QPlatformWindow::frameMargins();
 }
 
+// The part of frameMargins() that is drawn in the window's own surface, which is
+// none of it when the decoration lives in subsurfaces
+QMargins QWaylandWindow::surfaceMargins() const
+{
+    if (mDecorationSubSurfaces)
+        return QMargins();
+    return frameMargins();
+}
+
 QWaylandShellSurface *QWaylandWindow::shellSurface() const
 {
     return mShellSurface;
@@ -694,6 +793,10 @@ bool QWaylandWindow::createDecoration()
         decoration = false;
     if (mShellSurface && !mShellSurface->wantsDecorations())
         decoration = false;
+    // Windows that can't draw the decoration themselves are only decorated in subsurfaces,
+    // which can't be created before the window's surface is
+    if (needsDecorationSubSurfaces() && (!isInitialized() || mDecorationSubSurfacesFailed))
+        decoration = false;
 
     bool hadDecoration = mWindowDecoration;
     if (decoration && !decorationPluginFailed) {
@@ -732,10 +835,24 @@ bool QWaylandWindow::createDecoration()
         mWindowDecoration = nullptr;
     }
 
+    if (mWindowDecoration && !mDecorationSubSurfaces && wantsDecorationSubSurfaces() && isInitialized()) {
+        mDecorationSubSurfaces = QWaylandDecorationSubSurfaces::create(this);
+        mDecorationSubSurfacesFailed = !mDecorationSubSurfaces;
+        mWindowDecoration->update();
+    }
+    if (mWindowDecoration && !mDecorationSubSurfaces && needsDecorationSubSurfaces()) {
+        qCDebug(lcQpaWayland) << "Could not create decoration subsurfaces, running" << window() << "with no decorations";
+        delete mWindowDecoration;
+        mWindowDecoration = nullptr;
+    } else if (!mWindowDecoration) {
+        delete mDecorationSubSurfaces;
+        mDecorationSubSurfaces = nullptr;
+    }
+
     if (hadDecoration != (bool)mWindowDecoration) {
         foreach (QWaylandSubSurface *subsurf, mChildren) {
             QPoint pos = subsurf->window()->geometry().topLeft();
-            QMargins m = frameMargins();
+            QMargins m = surfaceMargins();
             subsurf->set_position(pos.x() + m.left(), pos.y() + m.top());
         }
         sendExposeEvent(QRect(QPoint(), geometry().size()));
@@ -804,6 +921,7 @@ void QWaylandWindow::handleMouseLeave(QWaylandInputDevice *inputDevice)
     if (mWindowDecoration) {
         if (mMouseEventsInContentArea) {
             QWindowSystemInterface::handleLeaveEvent(window());
+            mMouseEventsInContentArea = false;
         }
     } else {
         QWindowSystemInterface::handleLeaveEvent(window());
@@ -880,6 +998,7 @@ void QWaylandWindow::handleScreenChanged()
         mScale = scale;
         if (isInitialized() && mDisplay->compositorVersion() >= 3)
             set_buffer_scale(mScale);
+        updateViewport();
         ensureSize();
     }
 }
@@ -926,7 +1045,107 @@ int QWaylandWindow::scale() const
 
 qreal QWaylandWindow::devicePixelRatio() const
 {
-    return mScale;
+    return mScale * mRenderScale;
+}
+
+// Renders the window at a fraction of its size and lets the compositor scale
+// it up using wp_viewporter, to save fill rate. Set through the "renderScale"
+// window property, and only supported for OpenGL windows.
+void QWaylandWindow::setRenderScale(qreal renderScale)
+{
+    if (renderScale <= 0 || renderScale > 1) {
+        qWarning() << "Ignoring invalid render scale" << renderScale;
+        return;
+    }
+    if (!qFuzzyCompare(renderScale, 1) && windowType() != Egl) {
+        qWarning("Rendering at a reduced resolution is only supported for OpenGL windows");
+        return;
+    }
+    if (!qFuzzyCompare(renderScale, 1) && !mDisplay->viewporter()) {
+        qCWarning(lcQpaWayland) << "Can't render at a reduced resolution, the compositor does not support wp_viewporter";
+        return;
+    }
+    if (qFuzzyCompare(renderScale, mRenderScale))
+        return;
+
+    mRenderScale = renderScale;
+    if (isInitialized()) {
+        updateViewport();
+        ensureSize();
+        sendExposeEvent(QRect(QPoint(), geometry().size()));
+    }
+}
+
+void QWaylandWindow::updateViewport()
+{
+    if (!isInitialized())
+        return;
+
+    if (qFuzzyCompare(mRenderScale, 1)) {
+        if (mViewport) {
+            // Destroying the viewport removes the scaling on the next commit
+            mViewport->destroy();
+            mViewport.reset();
+            if (mDisplay->compositorVersion() >= 3)
+                set_buffer_scale(mScale);
+        }
+        return;
+    }
+
+    if (!mViewport) {
+        mViewport.reset(new QtWayland::wp_viewport(mDisplay->viewporter()->get_viewport(object())));
+        // The buffer size is no longer a multiple of the scale, the viewport
+        // destination size defines the surface size instead
+        if (mDisplay->compositorVersion() >= 3)
+            set_buffer_scale(1);
+    }
+
+    const QMargins margins = surfaceMargins();
+    const QSize size = geometry().size() + QSize(margins.left() + margins.right(), margins.top() + margins.bottom());
+    if (!size.isEmpty())
+        mViewport->set_destination(size.width(), size.height());
+}
+
+// Requests feedback on when the next commit is presented. Enabled through the
+// "presentationFeedback" window property, the results are published in the
+// "presentation" window property. The window owns the feedback objects until
+// the compositor answers them, or until its surface is destroyed.
+void QWaylandWindow::requestPresentationFeedback()
+{
+    if (!mPresentationFeedback || !isInitialized() || !mDisplay->presentationTime())
+        return;
+
+    mPresentationFeedbacks.append(new QWaylandPresentationFeedback(this, mDisplay->presentationTime()->feedback(object())));
+}
+
+void QWaylandWindow::handlePresented(QWaylandPresentationFeedback *feedback, qint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags)
+{
+    mPresentationFeedbacks.removeOne(feedback);
+    delete feedback;
+    ++mPresentedFrames;
+
+    QVariantMap presentation;
+    // Timestamps are in the clock domain given by clockId, see clock_gettime()
+    if (mDisplay->presentationTime())
+        presentation.insert(QStringLiteral("clockId"), mDisplay->presentationTime()->clockId());
+    presentation.insert(QStringLiteral("timestamp"), timestampNsecs);
+    presentation.insert(QStringLiteral("refresh"), refreshNsecs);
+    presentation.insert(QStringLiteral("sequence"), sequence);
+    presentation.insert(QStringLiteral("flags"), flags);
+    presentation.insert(QStringLiteral("presentedFrames"), mPresentedFrames);
+    presentation.insert(QStringLiteral("discardedFrames"), mDiscardedFrames);
+    setProperty(QStringLiteral("presentation"), presentation);
+}
+
+void QWaylandWindow::handleDiscarded(QWaylandPresentationFeedback *feedback)
+{
+    mPresentationFeedbacks.removeOne(feedback);
+    delete feedback;
+    ++mDiscardedFrames;
+
+    QVariantMap presentation = property(QStringLiteral("presentation")).toMap();
+    presentation.insert(QStringLiteral("discardedFrames"), mDiscardedFrames);
+    setProperty(QStringLiteral("presentation"), presentation);
 }
 
 bool QWaylandWindow::setMouseGrabEnabled(bool grab)
@@ -943,6 +1162,8 @@ bool QWaylandWindow::setMouseGrabEnabled(bool grab)
 void QWaylandWindow::handleWindowStatesChanged(Qt::WindowStates states)
 {
     createDecoration();
+    if (mWindowDecoration && states != mLastReportedWindowStates)
+        mWindowDecoration->update();
     QWindowSystemInterface::handleWindowStateChanged(window(), states, mLastReportedWindowStates);
     mLastReportedWindowStates = states;
 }
@@ -953,6 +1174,14 @@ void QWaylandWindow::sendProperty(const QString &name, const QVariant &value)
     QWaylandNativeInterface *nativeInterface = static_cast<QWaylandNativeInterface *>(
                 QGuiApplication::platformNativeInterface());
     nativeInterface->emitWindowPropertyChanged(this, name);
+    if (name == QLatin1String("renderScale")) {
+        setRenderScale(value.toReal());
+        return;
+    }
+    if (name == QLatin1String("presentationFeedback")) {
+        mPresentationFeedback = value.toBool();
+        return;
+    }
     if (mShellSurface)
         mShellSurface->sendProperty(name, value);
 }
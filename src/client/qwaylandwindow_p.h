@@ -55,6 +55,7 @@
 #include <QtCore/QMutex>
 #include <QtGui/QIcon>
 #include <QtCore/QVariant>
+#include <QtCore/QScopedPointer>
 
 #include <qpa/qplatformwindow.h>
 
@@ -65,6 +66,10 @@ struct wl_egl_window;
 
 QT_BEGIN_NAMESPACE
 
+namespace QtWayland {
+class wp_viewport;
+}
+
 namespace QtWaylandClient {
 
 class QWaylandDisplay;
@@ -72,10 +77,12 @@ class QWaylandBuffer;
 class QWaylandShellSurface;
 class QWaylandSubSurface;
 class QWaylandAbstractDecoration;
+class QWaylandDecorationSubSurfaces;
 class QWaylandInputDevice;
 class QWaylandScreen;
 class QWaylandShmBackingStore;
 class QWaylandPointerEvent;
+class QWaylandPresentationFeedback;
 
 class Q_WAYLAND_CLIENT_EXPORT QWaylandWindow : public QObject, public QPlatformWindow, public QtWayland::wl_surface
 {
@@ -118,8 +125,10 @@ public:
     void waitForFrameSync();
 
     QMargins frameMargins() const override;
+    QMargins surfaceMargins() const;
 
     static QWaylandWindow *fromWlSurface(::wl_surface *surface);
+    QPointF mapFromWlSurface(::wl_surface *surface, const QPointF &pos) const;
 
     QWaylandDisplay *display() const { return mDisplay; }
     QWaylandShellSurface *shellSurface() const;
@@ -141,11 +150,19 @@ public:
     int scale() const;
     qreal devicePixelRatio() const override;
 
+    qreal renderScale() const { return mRenderScale; }
+    void setRenderScale(qreal renderScale);
+
+    void requestPresentationFeedback();
+    void handlePresented(QWaylandPresentationFeedback *feedback, qint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags);
+    void handleDiscarded(QWaylandPresentationFeedback *feedback);
+
     void requestActivateWindow() override;
     bool isExposed() const override;
     void unfocus();
 
     QWaylandAbstractDecoration *decoration() const;
+    QWaylandDecorationSubSurfaces *decorationSubSurfaces() const { return mDecorationSubSurfaces; }
 
     void handleMouse(QWaylandInputDevice *inputDevice, const QWaylandPointerEvent &e);
     void handleMouseLeave(QWaylandInputDevice *inputDevice);
@@ -193,6 +210,8 @@ public slots:
 protected:
     void surface_enter(struct ::wl_output *output) override;
     void surface_leave(struct ::wl_output *output) override;
+    virtual bool wantsDecorationSubSurfaces() const { return false; }
+    virtual bool needsDecorationSubSurfaces() const { return false; }
 
     QVector<QWaylandScreen *> mScreens; //As seen by wl_surface.enter/leave events. Chronological order.
     QWaylandDisplay *mDisplay = nullptr;
@@ -201,6 +220,8 @@ protected:
     QVector<QWaylandSubSurface *> mChildren;
 
     QWaylandAbstractDecoration *mWindowDecoration = nullptr;
+    QWaylandDecorationSubSurfaces *mDecorationSubSurfaces = nullptr;
+    bool mDecorationSubSurfacesFailed = false;
     bool mMouseEventsInContentArea = false;
     Qt::MouseButtons mMousePressedInContentArea = Qt::NoButton;
 
@@ -219,6 +240,12 @@ protected:
     bool mSentInitialResize = false;
     QPoint mOffset;
     int mScale = 1;
+    qreal mRenderScale = 1;
+    QScopedPointer<QtWayland::wp_viewport> mViewport;
+    bool mPresentationFeedback = false;
+    QVector<QWaylandPresentationFeedback *> mPresentationFeedbacks;
+    quint64 mPresentedFrames = 0;
+    quint64 mDiscardedFrames = 0;
 
     QIcon mWindowIcon;
 
@@ -239,6 +266,7 @@ private:
     bool shouldCreateSubSurface() const;
     void reset(bool sendDestroyEvent = true);
     void sendExposeEvent(const QRect &rect);
+    void updateViewport();
     static void closePopups(QWaylandWindow *parent);
     QWaylandScreen *calculateScreenFromSurfaceEvents() const;
 
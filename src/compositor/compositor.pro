@@ -16,10 +16,13 @@ INCLUDEPATH += ../shared
 
 HEADERS += ../shared/qwaylandmimehelper_p.h \
            ../shared/qwaylandinputmethodeventbuilder_p.h \
-           ../shared/qwaylandsharedmemoryformathelper_p.h
+           ../shared/qwaylandsharedmemoryformathelper_p.h \
+           ../shared/qwaylanddatawriter_p.h \
+           ../shared/qwaylandglyphcacheentry_p.h
 
 SOURCES += ../shared/qwaylandmimehelper.cpp \
-           ../shared/qwaylandinputmethodeventbuilder.cpp
+           ../shared/qwaylandinputmethodeventbuilder.cpp \
+           ../shared/qwaylanddatawriter.cpp
 
 RESOURCES += compositor.qrc
 
@@ -4,6 +4,7 @@ HEADERS += \
     compositor_api/qwaylandcompositor.h \
     compositor_api/qwaylandcompositor_p.h \
     compositor_api/qwaylandclient.h \
+    compositor_api/qwaylandclient_p.h \
     compositor_api/qwaylandsurface.h \
     compositor_api/qwaylandsurface_p.h \
     compositor_api/qwaylandseat.h \
@@ -26,6 +27,9 @@ HEADERS += \
     compositor_api/qwaylandview_p.h \
     compositor_api/qwaylandresource.h \
     compositor_api/qwaylandsurfacegrabber.h \
+    compositor_api/qwaylandsurfacecapture.h \
+    compositor_api/qwaylandoutputrecorder.h \
+    compositor_api/qwaylandoutputrecorderlayout.h \
     compositor_api/qwaylandoutputmode_p.h
 
 SOURCES += \
@@ -43,7 +47,16 @@ SOURCES += \
     compositor_api/qwaylanddestroylistener.cpp \
     compositor_api/qwaylandview.cpp \
     compositor_api/qwaylandresource.cpp \
-    compositor_api/qwaylandsurfacegrabber.cpp
+    compositor_api/qwaylandsurfacegrabber.cpp \
+    compositor_api/qwaylandsurfacecapture.cpp \
+    compositor_api/qwaylandoutputrecorder.cpp
+
+qtConfig(xkbcommon-evdev) {
+    HEADERS += \
+        compositor_api/qwaylandkeymapcache_p.h
+    SOURCES += \
+        compositor_api/qwaylandkeymapcache.cpp
+}
 
 qtConfig(im) {
     HEADERS += \
@@ -38,54 +38,56 @@
 ****************************************************************************/
 
 #include "qwaylandclient.h"
-#include <QtCore/private/qobject_p.h>
+#include "qwaylandclient_p.h"
 
 #include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandSurface>
 #include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
 
 
 #include <wayland-server.h>
 #include <wayland-util.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
-class QWaylandClientPrivate : public QObjectPrivate
+const QVector<int> &QWaylandClientPrivate::pingLatencyBounds()
 {
-public:
-    QWaylandClientPrivate(QWaylandCompositor *compositor, wl_client *_client)
-        : compositor(compositor)
-        , client(_client)
-    {
-        // Save client credentials
-        wl_client_get_credentials(client, &pid, &uid, &gid);
-    }
+    static const QVector<int> bounds = { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    return bounds;
+}
 
-    ~QWaylandClientPrivate() override
-    {
+void QWaylandClientPrivate::setResponsive(bool isResponsive)
+{
+    Q_Q(QWaylandClient);
+    if (responsive == isResponsive)
+        return;
+
+    responsive = isResponsive;
+    emit q->responsiveChanged();
+
+    // The client may be waiting for a held back frame callback before it commits
+    // again, so don't wait for a repaint that might never come
+    if (responsive && compositor) {
+        const QList<QWaylandSurface *> surfaces = compositor->surfacesForClient(q);
+        for (QWaylandSurface *surface : surfaces)
+            surface->sendFrameCallbacks();
     }
+}
 
-    static void client_destroy_callback(wl_listener *listener, void *data)
-    {
-        Q_UNUSED(data);
-
-        QWaylandClient *client = reinterpret_cast<Listener *>(listener)->parent;
-        Q_ASSERT(client != nullptr);
-        delete client;
+void QWaylandClientPrivate::recordPingLatency(int msecs)
+{
+    Q_Q(QWaylandClient);
+    const QVector<int> &bounds = pingLatencyBounds();
+    int bucket = std::lower_bound(bounds.cbegin(), bounds.cend(), msecs) - bounds.cbegin();
+    ++pingLatencyHistogram[bucket];
+
+    if (pingLatency != msecs) {
+        pingLatency = msecs;
+        emit q->pingLatencyChanged();
     }
-
-    QWaylandCompositor *compositor = nullptr;
-    wl_client *client = nullptr;
-
-    uid_t uid;
-    gid_t gid;
-    pid_t pid;
-
-    struct Listener {
-        wl_listener listener;
-        QWaylandClient *parent = nullptr;
-    };
-    Listener listener;
-};
+}
 
 /*!
  * \qmltype WaylandClient
@@ -251,6 +253,84 @@ qint64 QWaylandClient::processId() const
     return d->pid;
 }
 
+/*!
+ * \qmlproperty bool QtWaylandCompositor::WaylandClient::responsive
+ * \readonly
+ * \since 5.12
+ *
+ * This property holds whether the client answers ping events in time.
+ *
+ * Responsiveness is only monitored if a shell extension, such as XdgShellV6, has a
+ * non-zero \c pingInterval. Frame callbacks are not sent to unresponsive clients; the
+ * ones that were due are sent when the client becomes responsive again.
+ */
+
+/*!
+ * \property QWaylandClient::responsive
+ * \since 5.12
+ *
+ * This property holds whether the client answers ping events in time.
+ *
+ * Responsiveness is only monitored if a shell extension, such as QWaylandXdgShellV6, has
+ * a non-zero \l {QWaylandXdgShellV6::pingInterval}{pingInterval}. Frame callbacks are
+ * not sent to unresponsive clients, so they don't pile up in the connection. The ones
+ * that were due are sent when the client becomes responsive again, without waiting for
+ * the next frame.
+ */
+bool QWaylandClient::isResponsive() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->responsive;
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::WaylandClient::pingLatency
+ * \readonly
+ * \since 5.12
+ *
+ * This property holds the round trip time in milliseconds of the last answered ping
+ * event, or -1 if the client hasn't answered any.
+ */
+
+/*!
+ * \property QWaylandClient::pingLatency
+ * \since 5.12
+ *
+ * This property holds the round trip time in milliseconds of the last answered ping
+ * event, or -1 if the client hasn't answered any.
+ */
+int QWaylandClient::pingLatency() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->pingLatency;
+}
+
+/*!
+ * \since 5.12
+ *
+ * Returns the number of answered ping events per latency bucket. Entry \c i counts round
+ * trips up to pingLatencyHistogramBounds()[i] milliseconds, the last entry counts the
+ * ones that took longer than the largest bound.
+ */
+QVector<int> QWaylandClient::pingLatencyHistogram() const
+{
+    Q_D(const QWaylandClient);
+
+    return d->pingLatencyHistogram;
+}
+
+/*!
+ * \since 5.12
+ *
+ * Returns the upper bounds in milliseconds of the buckets in pingLatencyHistogram().
+ */
+QVector<int> QWaylandClient::pingLatencyHistogramBounds()
+{
+    return QWaylandClientPrivate::pingLatencyBounds();
+}
+
 /*!
  * \qmlmethod void QtWaylandCompositor::WaylandClient::kill(signal)
  *
@@ -43,6 +43,7 @@
 #include <QtWaylandCompositor/qtwaylandcompositorglobal.h>
 
 #include <QObject>
+#include <QVector>
 
 #include <signal.h>
 
@@ -62,6 +63,8 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandClient : public QObject
     Q_PROPERTY(qint64 userId READ userId CONSTANT)
     Q_PROPERTY(qint64 groupId READ groupId CONSTANT)
     Q_PROPERTY(qint64 processId READ processId CONSTANT)
+    Q_PROPERTY(bool responsive READ isResponsive NOTIFY responsiveChanged)
+    Q_PROPERTY(int pingLatency READ pingLatency NOTIFY pingLatencyChanged)
 public:
     ~QWaylandClient() override;
 
@@ -76,11 +79,20 @@ public:
 
     qint64 processId() const;
 
+    bool isResponsive() const;
+    int pingLatency() const;
+    QVector<int> pingLatencyHistogram() const;
+    static QVector<int> pingLatencyHistogramBounds();
+
     Q_INVOKABLE void kill(int signal = SIGTERM);
 
 public Q_SLOTS:
     void close();
 
+Q_SIGNALS:
+    void responsiveChanged();
+    void pingLatencyChanged();
+
 private:
     explicit QWaylandClient(QWaylandCompositor *compositor, wl_client *client);
 };
@@ -179,6 +179,10 @@ void QWaylandCompositorPrivate::init()
 
     wl_display_init_shm(display);
     QVector<wl_shm_format> formats = QWaylandSharedMemoryFormatHelper::supportedWaylandFormats();
+    // Planar YUV buffers can make the compositor read past the end of the pool,
+    // so they are only accepted when all clients are trusted
+    if (qEnvironmentVariableIntValue("QT_WAYLAND_SHM_PLANAR_YUV"))
+        formats += QWaylandSharedMemoryFormatHelper::planarYuvWaylandFormats();
     foreach (wl_shm_format format, formats)
         wl_display_add_shm_format(display, format);
 
@@ -893,7 +897,8 @@ void QWaylandCompositor::setUseHardwareIntegrationExtension(bool use)
 void QWaylandCompositor::grabSurface(QWaylandSurfaceGrabber *grabber, const QWaylandBufferRef &buffer)
 {
     if (buffer.isSharedMemory()) {
-        emit grabber->success(buffer.image());
+        // Don't hand out an image aliasing memory the client may write to after release
+        emit grabber->success(buffer.image().copy());
     } else {
 #if QT_CONFIG(opengl)
         if (QOpenGLContext::currentContext()) {
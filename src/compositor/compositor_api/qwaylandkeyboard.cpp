@@ -46,14 +46,9 @@
 #include <QtWaylandCompositor/QWaylandSeat>
 #include <QtWaylandCompositor/QWaylandClient>
 
-#include <QtCore/QFile>
-#include <QtCore/QStandardPaths>
-
 #include <fcntl.h>
 #include <unistd.h>
 #if QT_CONFIG(xkbcommon_evdev)
-#include <sys/mman.h>
-#include <sys/types.h>
 #include <qwaylandxkb_p.h>
 #endif
 
@@ -68,11 +63,9 @@ QWaylandKeyboardPrivate::~QWaylandKeyboardPrivate()
 {
 #if QT_CONFIG(xkbcommon_evdev)
     if (xkb_context) {
-        if (keymap_area)
-            munmap(keymap_area, keymap_size);
-        close(keymap_fd);
-        xkb_context_unref(xkb_context);
         xkb_state_unref(xkb_state);
+        compiledKeymap.reset();
+        xkb_context_unref(xkb_context);
     }
 #endif
 }
@@ -137,9 +130,11 @@ void QWaylandKeyboardPrivate::keyboard_bind_resource(wl_keyboard::Resource *reso
         send_repeat_info(resource->handle, repeatRate, repeatDelay);
 
 #if QT_CONFIG(xkbcommon_evdev)
-    if (xkb_context) {
+    const int keymap_fd = compiledKeymap ? compiledKeymap->createClientFile() : -1;
+    if (keymap_fd >= 0) {
         send_keymap(resource->handle, WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1,
-                    keymap_fd, keymap_size);
+                    keymap_fd, compiledKeymap->size);
+        close(keymap_fd);
     } else
 #endif
     {
@@ -270,8 +265,14 @@ void QWaylandKeyboardPrivate::maybeUpdateKeymap()
         return;
 
     createXKBKeymap();
+    if (!compiledKeymap)
+        return;
     foreach (Resource *res, resourceMap()) {
-        send_keymap(res->handle, WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1, keymap_fd, keymap_size);
+        const int keymap_fd = compiledKeymap->createClientFile();
+        if (keymap_fd < 0)
+            continue;
+        send_keymap(res->handle, WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1, keymap_fd, compiledKeymap->size);
+        close(keymap_fd);
     }
 
     xkb_state_update_mask(xkb_state, 0, modsLatched, modsLocked, 0, 0, 0);
@@ -286,34 +287,15 @@ void QWaylandKeyboardPrivate::maybeUpdateKeymap()
 }
 
 #if QT_CONFIG(xkbcommon_evdev)
-static int createAnonymousFile(size_t size)
+static QWaylandKeymapNames keymapNames(const QWaylandKeymap *keymap)
 {
-    QString path = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
-    if (path.isEmpty())
-        return -1;
-
-    QByteArray name = QFile::encodeName(path + QStringLiteral("/qtwayland-XXXXXX"));
-
-    int fd = mkstemp(name.data());
-    if (fd < 0)
-        return -1;
-
-    long flags = fcntl(fd, F_GETFD);
-    if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
-        close(fd);
-        fd = -1;
-    }
-    unlink(name.constData());
-
-    if (fd < 0)
-        return -1;
-
-    if (ftruncate(fd, size) < 0) {
-        close(fd);
-        return -1;
-    }
-
-    return fd;
+    QWaylandKeymapNames names;
+    names.rules = keymap->rules().toLocal8Bit();
+    names.model = keymap->model().toLocal8Bit();
+    names.layout = keymap->layout().toLocal8Bit();
+    names.variant = keymap->variant().toLocal8Bit();
+    names.options = keymap->options().toLocal8Bit();
+    return names;
 }
 
 void QWaylandKeyboardPrivate::initXKB()
@@ -325,37 +307,28 @@ void QWaylandKeyboardPrivate::initXKB()
     }
 
     createXKBKeymap();
-}
 
+    // Compile the layouts the user is likely to switch to in the background,
+    // e.g. QT_WAYLAND_KEYMAP_PREWARM="de;fr:azerty"
+    const QByteArray prewarm = qgetenv("QT_WAYLAND_KEYMAP_PREWARM");
+    if (!prewarm.isEmpty()) {
+        const QWaylandKeymapNames current = keymapNames(seat->keymap());
+        QList<QWaylandKeymapNames> layouts;
+        for (const QByteArray &entry : prewarm.split(';')) {
+            const QList<QByteArray> layoutAndVariant = entry.trimmed().split(':');
+            if (layoutAndVariant.first().isEmpty())
+                continue;
+            QWaylandKeymapNames names = current;
+            names.layout = layoutAndVariant.first();
+            names.variant = layoutAndVariant.value(1);
+            layouts.append(names);
+        }
+        QWaylandKeymapCache::prewarm(layouts);
+    }
+}
 
 void QWaylandKeyboardPrivate::createXKBState(xkb_keymap *keymap)
 {
-    char *keymap_str = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
-    if (!keymap_str) {
-        qWarning("Failed to compile global XKB keymap");
-        return;
-    }
-
-    keymap_size = strlen(keymap_str) + 1;
-    if (keymap_fd >= 0)
-        close(keymap_fd);
-    keymap_fd = createAnonymousFile(keymap_size);
-    if (keymap_fd < 0) {
-        qWarning("Failed to create anonymous file of size %lu", static_cast<unsigned long>(keymap_size));
-        return;
-    }
-
-    keymap_area = static_cast<char *>(mmap(nullptr, keymap_size, PROT_READ | PROT_WRITE, MAP_SHARED, keymap_fd, 0));
-    if (keymap_area == MAP_FAILED) {
-        close(keymap_fd);
-        keymap_fd = -1;
-        qWarning("Failed to map shared memory segment");
-        return;
-    }
-
-    strcpy(keymap_area, keymap_str);
-    free(keymap_str);
-
     if (xkb_state)
         xkb_state_unref(xkb_state);
     xkb_state = xkb_state_new(keymap);
@@ -374,26 +347,17 @@ void QWaylandKeyboardPrivate::createXKBKeymap()
         return;
 
     auto keymap = seat->keymap();
-    struct xkb_rule_names rule_names = { strdup(qPrintable(keymap->rules())),
-                                         strdup(qPrintable(keymap->model())),
-                                         strdup(qPrintable(keymap->layout())),
-                                         strdup(qPrintable(keymap->variant())),
-                                         strdup(qPrintable(keymap->options())) };
-    struct xkb_keymap *xkbKeymap = xkb_keymap_new_from_names(xkb_context, &rule_names, static_cast<xkb_keymap_compile_flags>(0));
-
-    if (xkbKeymap) {
-        scanCodesByQtKey.clear();
-        createXKBState(xkbKeymap);
-        xkb_keymap_unref(xkbKeymap);
+    QSharedPointer<QWaylandCompiledKeymap> compiled = QWaylandKeymapCache::keymap(xkb_context, keymapNames(keymap));
+
+    if (compiled) {
+        if (compiled != compiledKeymap) {
+            scanCodesByQtKey.clear();
+            compiledKeymap = compiled;
+            createXKBState(compiledKeymap->keymap);
+        }
     } else {
         qWarning("Failed to load the '%s' XKB keymap.", qPrintable(keymap->layout()));
     }
-
-    free((char *)rule_names.rules);
-    free((char *)rule_names.model);
-    free((char *)rule_names.layout);
-    free((char *)rule_names.variant);
-    free((char *)rule_names.options);
 }
 #endif
 
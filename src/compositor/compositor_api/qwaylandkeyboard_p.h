@@ -64,6 +64,7 @@
 
 #if QT_CONFIG(xkbcommon_evdev)
 #include <xkbcommon/xkbcommon.h>
+#include <QtWaylandCompositor/private/qwaylandkeymapcache_p.h>
 #endif
 
 
@@ -129,9 +130,7 @@ private:
 
     bool pendingKeymap = false;
 #if QT_CONFIG(xkbcommon_evdev)
-    size_t keymap_size;
-    int keymap_fd = -1;
-    char *keymap_area = nullptr;
+    QSharedPointer<QWaylandCompiledKeymap> compiledKeymap;
     using ScanCodeKey = std::pair<uint,int>; // group/layout and QtKey
     QMap<ScanCodeKey, uint> scanCodesByQtKey;
     struct xkb_context *xkb_context = nullptr;
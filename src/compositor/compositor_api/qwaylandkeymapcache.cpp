@@ -0,0 +1,320 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandkeymapcache_p.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThreadPool>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h and linux/fcntl.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC         0x0001U
+#  endif
+#  ifndef MFD_ALLOW_SEALING
+#    define MFD_ALLOW_SEALING   0x0002U
+#  endif
+#  ifndef F_ADD_SEALS
+#    define F_ADD_SEALS         (1024 + 9)
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL         0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK       0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW         0x0004
+#  endif
+#  ifndef F_SEAL_WRITE
+#    define F_SEAL_WRITE        0x0008
+#  endif
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*
+    QWaylandKeymapCache compiles each RMLVO combination once per process.
+
+    The serialized keymap is written to a sealed, read-only memfd that is
+    sent as is to every wl_keyboard resource of every seat, so switching
+    back to a layout that was used before neither recompiles it nor
+    creates a new file. Where memfds can't be sealed, every client gets a
+    private copy instead, so none of them can change the keymap of another.
+*/
+
+static const int MaximumCachedKeymaps = 32;
+
+namespace {
+
+struct KeymapCache
+{
+    QMutex mutex;
+    QHash<QByteArray, QSharedPointer<QWaylandCompiledKeymap>> keymaps;
+    QList<QByteArray> insertionOrder;
+
+    QSharedPointer<QWaylandCompiledKeymap> find(const QByteArray &key)
+    {
+        QMutexLocker locker(&mutex);
+        return keymaps.value(key);
+    }
+
+    // Returns the keymap that ended up in the cache, which is the existing
+    // one if another thread compiled the same names first
+    QSharedPointer<QWaylandCompiledKeymap> insert(const QByteArray &key, const QSharedPointer<QWaylandCompiledKeymap> &keymap)
+    {
+        QMutexLocker locker(&mutex);
+        const auto existing = keymaps.constFind(key);
+        if (existing != keymaps.constEnd())
+            return *existing;
+
+        // Keymaps still in use stay alive through their users
+        if (insertionOrder.size() >= MaximumCachedKeymaps)
+            keymaps.remove(insertionOrder.takeFirst());
+        keymaps.insert(key, keymap);
+        insertionOrder.append(key);
+        return keymap;
+    }
+};
+
+}
+
+Q_GLOBAL_STATIC(KeymapCache, keymapCache)
+
+static int createAnonymousFile(size_t size)
+{
+    QString path = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (path.isEmpty())
+        return -1;
+
+    QByteArray name = QFile::encodeName(path + QStringLiteral("/qtwayland-XXXXXX"));
+
+    int fd = mkstemp(name.data());
+    if (fd < 0)
+        return -1;
+
+    long flags = fcntl(fd, F_GETFD);
+    if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+        close(fd);
+        fd = -1;
+    }
+    unlink(name.constData());
+
+    if (fd < 0)
+        return -1;
+
+    if (ftruncate(fd, size) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool writeKeymap(int fd, const char *keymap, size_t size)
+{
+    size_t written = 0;
+    while (written < size) {
+        const qint64 n = qt_safe_write(fd, keymap + written, qint64(size - written));
+        if (n <= 0)
+            return false;
+        written += size_t(n);
+    }
+    return true;
+}
+
+// Returns a read-only memfd holding \a keymap, or -1 if sealing is not supported
+static int createSealedKeymapFile(const char *keymap, size_t size)
+{
+#ifdef SYS_memfd_create
+    const int fd = int(syscall(SYS_memfd_create, "qt-wayland-keymap", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (fd < 0)
+        return -1;
+
+    // All clients share this file, none of them may change it
+    if (!writeKeymap(fd, keymap, size)
+            || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    Q_UNUSED(keymap);
+    Q_UNUSED(size);
+    return -1;
+#endif
+}
+
+static QSharedPointer<QWaylandCompiledKeymap> compileKeymap(xkb_context *context, const QWaylandKeymapNames &names)
+{
+    const struct xkb_rule_names rule_names = { names.rules.constData(),
+                                               names.model.constData(),
+                                               names.layout.constData(),
+                                               names.variant.constData(),
+                                               names.options.constData() };
+    xkb_keymap *keymap = xkb_keymap_new_from_names(context, &rule_names, static_cast<xkb_keymap_compile_flags>(0));
+    if (!keymap)
+        return QSharedPointer<QWaylandCompiledKeymap>();
+
+    QSharedPointer<QWaylandCompiledKeymap> compiled(new QWaylandCompiledKeymap);
+    compiled->keymap = keymap;
+
+    char *keymap_str = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    if (!keymap_str) {
+        qWarning("Failed to compile global XKB keymap");
+        return QSharedPointer<QWaylandCompiledKeymap>();
+    }
+
+    const size_t size = strlen(keymap_str) + 1;
+    compiled->fd = createSealedKeymapFile(keymap_str, size);
+    if (compiled->fd < 0)
+        compiled->text = QByteArray(keymap_str, int(size));
+    compiled->size = uint32_t(size);
+    free(keymap_str);
+
+    return compiled;
+}
+
+class KeymapPrewarmTask : public QRunnable
+{
+public:
+    explicit KeymapPrewarmTask(const QWaylandKeymapNames &names)
+        : m_names(names)
+    {
+    }
+
+    void run() override
+    {
+        const QByteArray key = m_names.key();
+        if (keymapCache()->find(key))
+            return;
+
+        // xkb contexts are not thread safe, so every task compiles with its own
+        xkb_context *context = xkb_context_new(static_cast<xkb_context_flags>(0));
+        if (!context)
+            return;
+        const QSharedPointer<QWaylandCompiledKeymap> compiled = compileKeymap(context, m_names);
+        xkb_context_unref(context);
+
+        if (compiled)
+            keymapCache()->insert(key, compiled);
+    }
+
+private:
+    QWaylandKeymapNames m_names;
+};
+
+QByteArray QWaylandKeymapNames::key() const
+{
+    return rules + '\n' + model + '\n' + layout + '\n' + variant + '\n' + options;
+}
+
+QWaylandCompiledKeymap::~QWaylandCompiledKeymap()
+{
+    if (fd >= 0)
+        close(fd);
+    xkb_keymap_unref(keymap);
+}
+
+/*
+    Returns a file holding the keymap to send to one client, which the caller
+    has to close. Returns -1 if no file can be created.
+*/
+int QWaylandCompiledKeymap::createClientFile() const
+{
+    if (fd >= 0)
+        return qt_safe_dup(fd);
+
+    const int clientFd = createAnonymousFile(0);
+    if (clientFd < 0 || !writeKeymap(clientFd, text.constData(), size_t(size))) {
+        qWarning("Failed to create anonymous file of size %lu", static_cast<unsigned long>(size));
+        if (clientFd >= 0)
+            close(clientFd);
+        return -1;
+    }
+    return clientFd;
+}
+
+/*
+    Returns the compiled keymap for \a names, compiling it with \a context
+    unless it is cached. Returns a null pointer if it fails to compile.
+*/
+QSharedPointer<QWaylandCompiledKeymap> QWaylandKeymapCache::keymap(xkb_context *context, const QWaylandKeymapNames &names)
+{
+    const QByteArray key = names.key();
+    if (QSharedPointer<QWaylandCompiledKeymap> cached = keymapCache()->find(key))
+        return cached;
+
+    const QSharedPointer<QWaylandCompiledKeymap> compiled = compileKeymap(context, names);
+    if (!compiled)
+        return compiled;
+    return keymapCache()->insert(key, compiled);
+}
+
+/*
+    Returns the compiled keymap for \a names if it is cached, a null pointer otherwise.
+*/
+QSharedPointer<QWaylandCompiledKeymap> QWaylandKeymapCache::cachedKeymap(const QWaylandKeymapNames &names)
+{
+    return keymapCache()->find(names.key());
+}
+
+/*
+    Compiles the keymaps for \a names on worker threads, so that switching to
+    them later is instantaneous.
+*/
+void QWaylandKeymapCache::prewarm(const QList<QWaylandKeymapNames> &names)
+{
+    for (const QWaylandKeymapNames &keymapNames : names)
+        QThreadPool::globalInstance()->start(new KeymapPrewarmTask(keymapNames));
+}
+
+QT_END_NAMESPACE
@@ -108,6 +108,10 @@ QWaylandOutputPrivate::QWaylandOutputPrivate()
 
 QWaylandOutputPrivate::~QWaylandOutputPrivate()
 {
+    const auto feedbacks = presentationFeedbacks;
+    presentationFeedbacks.clear();
+    for (auto *feedback : feedbacks)
+        feedback->sendDiscarded();
 }
 
 void QWaylandOutputPrivate::output_bind_resource(Resource *resource)
@@ -164,6 +168,38 @@ void QWaylandOutputPrivate::sendModesInfo()
     }
 }
 
+void QWaylandOutputPrivate::latchPresentationFeedbacks(QWaylandSurface *surface)
+{
+    Q_Q(QWaylandOutput);
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(surface);
+    for (auto *feedback : qAsConst(surfacePrivate->presentationFeedbacks)) {
+        feedback->latch(q, latchedFrame);
+        presentationFeedbacks.append(feedback);
+    }
+    surfacePrivate->presentationFeedbacks.clear();
+}
+
+// Sends presentation feedback for the content updates shown in all frames up
+// to and including the given frame, which was presented at timestampNsecs.
+void QWaylandOutputPrivate::sendPresentationFeedbacks(quint64 frame, qint64 timestampNsecs, uint flags)
+{
+    Q_Q(QWaylandOutput);
+    ++presentationSequence;
+
+    // The refresh rate of the mode is in mHz
+    const int refreshRate = q->currentMode().refreshRate();
+    const uint refreshNsecs = refreshRate > 0 ? uint(Q_INT64_C(1000000000000) / refreshRate) : 0;
+
+    const auto feedbacks = presentationFeedbacks;
+    for (auto *feedback : feedbacks) {
+        if (feedback->frame() > frame)
+            continue;
+        presentationFeedbacks.removeOne(feedback);
+        feedback->sendPresented(timestampNsecs, refreshNsecs, presentationSequence, flags);
+    }
+    wl_display_flush_clients(compositor->display());
+}
+
 void QWaylandOutputPrivate::addView(QWaylandView *view, QWaylandSurface *surface)
 {
     for (int i = 0; i < surfaceViews.size(); i++) {
@@ -865,10 +901,15 @@ void QWaylandOutput::setWindow(QWindow *window)
 void QWaylandOutput::frameStarted()
 {
     Q_D(QWaylandOutput);
+    if (d->reportsPresentation)
+        ++d->latchedFrame;
     for (int i = 0; i < d->surfaceViews.size(); i++) {
         QWaylandSurfaceViewMapper &surfacemapper = d->surfaceViews[i];
-        if (surfacemapper.maybePrimaryView())
+        if (surfacemapper.maybePrimaryView()) {
             surfacemapper.surface->frameStarted();
+            if (d->reportsPresentation)
+                d->latchPresentationFeedbacks(surfacemapper.surface);
+        }
     }
 }
 
@@ -59,6 +59,7 @@
 #include <QtWaylandCompositor/QWaylandSurface>
 
 #include <QtWaylandCompositor/private/qwayland-server-wayland.h>
+#include <QtWaylandCompositor/private/qwaylandpresentationtime_p.h>
 
 #include <QtCore/QRect>
 #include <QtCore/QVector>
@@ -108,6 +109,16 @@ public:
     void sendMode(const Resource *resource, const QWaylandOutputMode &mode);
     void sendModesInfo();
 
+    void latchPresentationFeedbacks(QWaylandSurface *surface);
+    void sendPresentationFeedbacks(quint64 frame, qint64 timestampNsecs, uint flags);
+
+    // Presentation feedback is only collected for outputs that report when
+    // their frames are presented, see QWaylandQuickOutput.
+    bool reportsPresentation = false;
+    quint64 latchedFrame = 0;
+    quint64 presentationSequence = 0;
+    QVector<QWaylandPresentationTimePrivate::Feedback *> presentationFeedbacks;
+
 protected:
     void output_bind_resource(Resource *resource) override;
 
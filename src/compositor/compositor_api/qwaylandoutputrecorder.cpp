@@ -0,0 +1,879 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandoutputrecorder.h"
+#include "qwaylandoutputrecorderlayout.h"
+
+#include <QtCore/private/qobject_p.h>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QRunnable>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+#if QT_CONFIG(opengl)
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QOpenGLFramebufferObject>
+#endif
+#include <QtGui/QWindow>
+#include <QtWaylandCompositor/qwaylandcompositor.h>
+#include <QtWaylandCompositor/qwaylandoutput.h>
+#include <QtWaylandCompositor/qwaylandsurface.h>
+#include <QtWaylandCompositor/qwaylandview.h>
+
+#ifdef QT_WAYLAND_COMPOSITOR_QUICK
+#include <QtQuick/QQuickWindow>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h and linux/fcntl.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC         0x0001U
+#  endif
+#  ifndef MFD_ALLOW_SEALING
+#    define MFD_ALLOW_SEALING   0x0002U
+#  endif
+#  ifndef F_ADD_SEALS
+#    define F_ADD_SEALS         (1024 + 9)
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL         0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK       0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW         0x0004
+#  endif
+#  ifndef F_SEAL_FUTURE_WRITE
+#    define F_SEAL_FUTURE_WRITE 0x0010
+#  endif
+#endif
+
+#if QT_CONFIG(opengl)
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandOutputRecorder
+    \inmodule QtWaylandCompositor
+    \since 5.12
+    \brief The QWaylandOutputRecorder class records the composed content of a QWaylandOutput into shared memory
+
+    QWaylandOutputRecorder reads back every frame rendered for an output into a ring of
+    \l frameCount frames in a sealed memfd. The compositor hands fileDescriptor() to a
+    consumer process, for instance over a Unix socket, which maps it read-only and reads
+    frames straight out of the ring without any further copy. The descriptor is read-only,
+    and the memory is sealed against writes on kernels that support it, so consumers can
+    not modify the frames other consumers see.
+
+    The memory starts with a ring header, followed by the frame slots. Each slot starts
+    with a frame header holding the frame sequence number and a CLOCK_MONOTONIC timestamp,
+    followed by the pixel data in top-down row order. A slot is guarded by a sequence lock,
+    so consumers can detect frames that were overwritten while they were being read. The
+    layout, and how to read it, is described in
+    \c{<QtWaylandCompositor/qwaylandoutputrecorderlayout.h>}. When the output size changes,
+    a new memfd is created and bufferChanged() is emitted.
+
+    Frames are only recorded when something on the output changed: a surface shown on the
+    output was damaged, or markDirty() was called, for instance because compositor-side
+    decorations were animated. This can be turned off with \l skipUnchangedFrames.
+    \l maxFrameRate limits how often frames are recorded.
+
+    On a QWaylandQuickOutput frames are recorded automatically after the scene graph has
+    rendered, and the readback goes through a pixel buffer object that is collected during
+    the next frame, so the render thread does not wait for the GPU. For other outputs,
+    call recordFrame() after rendering, while the OpenGL context is still current, or
+    recordImage() for outputs that are not rendered with OpenGL.
+*/
+
+namespace {
+
+Q_STATIC_ASSERT(sizeof(QAtomicInteger<quint64>) == sizeof(uint64_t));
+
+// The layout header only uses plain integers, so it can be shared with consumers
+inline QAtomicInteger<quint64> *atomic(uint64_t *value)
+{
+    return reinterpret_cast<QAtomicInteger<quint64> *>(value);
+}
+
+quint64 monotonicTimestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return quint64(ts.tv_sec) * 1000000000 + quint64(ts.tv_nsec);
+}
+
+class OutputRecorderRenderer
+{
+public:
+    ~OutputRecorderRenderer();
+
+    void synchronize();
+#if QT_CONFIG(opengl)
+    void render(const QSize &size, GLuint framebuffer, bool deferred);
+#endif
+    void record(const QImage &image);
+    void releaseResources();
+
+    // Shared with the GUI thread
+    QMutex mutex;
+    QWaylandOutputRecorder *recorder = nullptr;
+    int fd = -1;
+    QSize frameSize;
+
+    QAtomicInt dirty{1};
+    QAtomicInt frameCount{3};
+    QAtomicInt skipUnchangedFrames{1};
+    QAtomicInteger<qint64> minimumInterval{0};
+
+private:
+    bool shouldRecord(quint64 timestamp);
+    bool ensureRing(const QSize &size, int frames);
+    void destroyRing();
+    void writeFrame(const uchar *pixels, int bytesPerLine, bool bottomUp, quint64 timestamp);
+#if QT_CONFIG(opengl)
+    void flushPending();
+#endif
+    void notifyFrame(quint64 sequence, quint64 timestamp);
+    void notifyBufferChanged();
+    void requestUpdate(qint64 delay);
+
+    // Only touched from the thread rendering the output
+    bool frameDirty = false;
+    int memfd = -1;
+    uchar *ring = nullptr;
+    size_t ringSize = 0;
+    QSize ringFrameSize;
+    int ringFrames = 0;
+    quint64 sequence = 0;
+    quint64 lastRecorded = 0;
+    bool pending = false;
+
+#if QT_CONFIG(opengl)
+    bool initialized = false;
+    bool usePixelBufferObject = false;
+    GLuint pbo = 0;
+    int pboCapacity = 0;
+    quint64 pendingTimestamp = 0;
+    QByteArray scratch;
+#endif
+};
+
+OutputRecorderRenderer::~OutputRecorderRenderer()
+{
+    destroyRing();
+}
+
+void OutputRecorderRenderer::synchronize()
+{
+    // The GUI thread is blocked while we synchronize, so damage that arrives after
+    // this point is rendered, and therefore recorded, in the next frame
+    frameDirty = dirty.fetchAndStoreOrdered(0);
+}
+
+#if QT_CONFIG(opengl)
+void OutputRecorderRenderer::render(const QSize &size, GLuint framebuffer, bool deferred)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context || size.isEmpty())
+        return;
+
+    QOpenGLExtraFunctions *f = context->extraFunctions();
+    if (!initialized) {
+        usePixelBufferObject = context->format().majorVersion() >= 3;
+        initialized = true;
+    }
+
+    flushPending();
+
+    const quint64 timestamp = monotonicTimestamp();
+    if (!shouldRecord(timestamp) || !ensureRing(size, frameCount.loadAcquire()))
+        return;
+
+    lastRecorded = timestamp;
+    const int bytes = size.width() * size.height() * 4;
+
+    f->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    if (deferred && usePixelBufferObject) {
+        if (!pbo)
+            f->glGenBuffers(1, &pbo);
+        f->glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        if (pboCapacity < bytes) {
+            f->glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            pboCapacity = bytes;
+        }
+        f->glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        f->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending = true;
+        pendingTimestamp = timestamp;
+        // Make sure there is a next frame to collect the readback in
+        requestUpdate(0);
+        return;
+    }
+
+    if (scratch.size() < bytes)
+        scratch.resize(bytes);
+    f->glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, scratch.data());
+    writeFrame(reinterpret_cast<const uchar *>(scratch.constData()), size.width() * 4, true, timestamp);
+}
+#endif
+
+void OutputRecorderRenderer::record(const QImage &image)
+{
+    const quint64 timestamp = monotonicTimestamp();
+    if (image.isNull() || !shouldRecord(timestamp) || !ensureRing(image.size(), frameCount.loadAcquire()))
+        return;
+
+    lastRecorded = timestamp;
+    const QImage pixels = image.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    writeFrame(pixels.constBits(), pixels.bytesPerLine(), false, timestamp);
+}
+
+bool OutputRecorderRenderer::shouldRecord(quint64 timestamp)
+{
+    if (skipUnchangedFrames.loadAcquire() && !frameDirty)
+        return false;
+    frameDirty = false;
+
+    const qint64 interval = minimumInterval.loadAcquire();
+    if (interval > 0 && lastRecorded && timestamp - lastRecorded < quint64(interval)) {
+        // Too early, try again once the interval has passed
+        dirty.storeRelease(1);
+        requestUpdate((interval - qint64(timestamp - lastRecorded)) / 1000000);
+        return false;
+    }
+    return true;
+}
+
+#if QT_CONFIG(opengl)
+void OutputRecorderRenderer::flushPending()
+{
+    if (!pending)
+        return;
+    pending = false;
+
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    const int bytes = ringFrameSize.width() * ringFrameSize.height() * 4;
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    if (void *data = f->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT)) {
+        writeFrame(static_cast<const uchar *>(data), ringFrameSize.width() * 4, true, pendingTimestamp);
+        f->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+#endif
+
+bool OutputRecorderRenderer::ensureRing(const QSize &size, int frames)
+{
+    if (ring && ringFrameSize == size && ringFrames == frames)
+        return true;
+
+    // A pending readback has the old size, it cannot go into the new ring
+    pending = false;
+    destroyRing();
+
+    const quint32 stride = quint32(size.width()) * 4;
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t frameOffset = pageSize;
+    const size_t slotSize = (QWaylandOutputRecorderDataOffset + size_t(stride) * size_t(size.height()) + pageSize - 1)
+                            & ~(pageSize - 1);
+    const size_t total = frameOffset + slotSize * size_t(frames);
+
+#ifdef SYS_memfd_create
+    memfd = int(syscall(SYS_memfd_create, "qt-wayland-output-recorder", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+#endif
+    if (memfd < 0) {
+        qWarning("QWaylandOutputRecorder: memfd_create failed: %s", strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(memfd, off_t(total)) < 0) {
+        qWarning("QWaylandOutputRecorder: ftruncate failed: %s", strerror(errno));
+        close(memfd);
+        memfd = -1;
+        return false;
+    }
+
+    void *data = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (data == MAP_FAILED) {
+        qWarning("QWaylandOutputRecorder: mmap failed: %s", strerror(errno));
+        close(memfd);
+        memfd = -1;
+        return false;
+    }
+
+    // Consumers must be able to rely on the size not changing under them, and must not be
+    // able to write into the ring. F_SEAL_WRITE would also revoke our own mapping, so seal
+    // future writes where the kernel supports it (Linux 5.1), and only ever hand out a
+    // read-only descriptor.
+    if (fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) < 0)
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+    const QByteArray path = "/proc/self/fd/" + QByteArray::number(memfd);
+    const int readOnlyFd = open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (readOnlyFd < 0) {
+        qWarning("QWaylandOutputRecorder: could not open a read-only descriptor: %s", strerror(errno));
+        munmap(data, total);
+        close(memfd);
+        memfd = -1;
+        return false;
+    }
+
+    ring = static_cast<uchar *>(data);
+    ringSize = total;
+    ringFrameSize = size;
+    ringFrames = frames;
+
+    auto *header = reinterpret_cast<QWaylandOutputRecorderRingHeader *>(ring);
+    header->magic = QT_WAYLAND_OUTPUT_RECORDER_MAGIC;
+    header->version = QT_WAYLAND_OUTPUT_RECORDER_VERSION;
+    header->frameCount = quint32(frames);
+    header->width = quint32(size.width());
+    header->height = quint32(size.height());
+    header->stride = stride;
+    header->format = QImage::Format_RGBA8888_Premultiplied;
+    header->frameOffset = quint32(frameOffset);
+    header->slotSize = quint32(slotSize);
+    atomic(&header->latestSequence)->storeRelease(0);
+
+    {
+        QMutexLocker locker(&mutex);
+        fd = readOnlyFd;
+        frameSize = size;
+    }
+    notifyBufferChanged();
+    return true;
+}
+
+void OutputRecorderRenderer::destroyRing()
+{
+    if (ring)
+        munmap(ring, ringSize);
+    ring = nullptr;
+    ringSize = 0;
+    ringFrameSize = QSize();
+    ringFrames = 0;
+    if (memfd >= 0)
+        close(memfd);
+    memfd = -1;
+
+    QMutexLocker locker(&mutex);
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    frameSize = QSize();
+}
+
+void OutputRecorderRenderer::writeFrame(const uchar *pixels, int bytesPerLine, bool bottomUp, quint64 timestamp)
+{
+    auto *header = reinterpret_cast<QWaylandOutputRecorderRingHeader *>(ring);
+    const quint64 frame = ++sequence;
+    uchar *slot = ring + header->frameOffset + size_t((frame - 1) % header->frameCount) * header->slotSize;
+    auto *frameHeader = reinterpret_cast<QWaylandOutputRecorderFrameHeader *>(slot);
+
+    atomic(&frameHeader->lock)->storeRelease(2 * frame - 1);
+    frameHeader->sequence = frame;
+    frameHeader->timestamp = timestamp;
+
+    // glReadPixels returns the rows bottom-up
+    const int stride = int(header->stride);
+    const int height = int(header->height);
+    uchar *data = slot + QWaylandOutputRecorderDataOffset;
+    for (int y = 0; y < height; ++y)
+        memcpy(data + y * stride, pixels + (bottomUp ? height - 1 - y : y) * bytesPerLine, size_t(stride));
+
+    atomic(&frameHeader->lock)->storeRelease(2 * frame);
+    atomic(&header->latestSequence)->storeRelease(frame);
+
+    notifyFrame(frame, timestamp);
+}
+
+void OutputRecorderRenderer::releaseResources()
+{
+#if QT_CONFIG(opengl)
+    if (QOpenGLContext *context = QOpenGLContext::currentContext()) {
+        if (pbo)
+            context->functions()->glDeleteBuffers(1, &pbo);
+    }
+    pbo = 0;
+    pboCapacity = 0;
+    initialized = false;
+#endif
+    pending = false;
+    destroyRing();
+}
+
+void OutputRecorderRenderer::notifyFrame(quint64 frame, quint64 timestamp)
+{
+    QMutexLocker locker(&mutex);
+    if (QWaylandOutputRecorder *r = recorder) {
+        QMetaObject::invokeMethod(r, [r, frame, timestamp]() {
+            emit r->frameRecorded(frame, timestamp);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void OutputRecorderRenderer::notifyBufferChanged()
+{
+    QMutexLocker locker(&mutex);
+    if (QWaylandOutputRecorder *r = recorder)
+        QMetaObject::invokeMethod(r, &QWaylandOutputRecorder::bufferChanged, Qt::QueuedConnection);
+}
+
+void OutputRecorderRenderer::requestUpdate(qint64 delay)
+{
+    QMutexLocker locker(&mutex);
+    if (QWaylandOutputRecorder *r = recorder) {
+        QMetaObject::invokeMethod(r, [r, delay]() {
+            QWaylandOutput *output = r->output();
+            if (!output)
+                return;
+            if (delay > 0)
+                QTimer::singleShot(int(delay), output, &QWaylandOutput::update);
+            else
+                output->update();
+        }, Qt::QueuedConnection);
+    }
+}
+
+class OutputRecorderReleaseJob : public QRunnable
+{
+public:
+    void run() override { renderer->releaseResources(); }
+    QSharedPointer<OutputRecorderRenderer> renderer;
+};
+
+}
+
+class QWaylandOutputRecorderPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QWaylandOutputRecorder)
+public:
+    void start();
+    void stop();
+    void watchSurface(QWaylandSurface *surface);
+    void surfaceDamaged(QWaylandSurface *surface, const QRegion &damage);
+    void updateSettings();
+
+    QPointer<QWaylandOutput> output;
+    bool active = false;
+    int frameCount = 3;
+    qreal maxFrameRate = 0;
+    bool skipUnchangedFrames = true;
+
+    QSharedPointer<OutputRecorderRenderer> renderer;
+    QVector<QMetaObject::Connection> connections;
+    QHash<QWaylandSurface *, QVector<QMetaObject::Connection>> surfaceConnections;
+};
+
+void QWaylandOutputRecorderPrivate::start()
+{
+    Q_Q(QWaylandOutputRecorder);
+    if (!active || !output || renderer)
+        return;
+
+    renderer.reset(new OutputRecorderRenderer);
+    renderer->recorder = q;
+    updateSettings();
+
+    if (QWaylandCompositor *compositor = output->compositor()) {
+        const auto surfaces = compositor->surfaces();
+        for (QWaylandSurface *surface : surfaces)
+            watchSurface(surface);
+        connections << QObject::connect(compositor, &QWaylandCompositor::surfaceCreated, q, [this](QWaylandSurface *surface) {
+            watchSurface(surface);
+        });
+    }
+    connections << QObject::connect(output.data(), &QWaylandOutput::geometryChanged, q, &QWaylandOutputRecorder::markDirty);
+
+#ifdef QT_WAYLAND_COMPOSITOR_QUICK
+    if (QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(output->window())) {
+        QSharedPointer<OutputRecorderRenderer> r = renderer;
+        connections << QObject::connect(quickWindow, &QQuickWindow::afterSynchronizing, q, [r]() {
+            r->synchronize();
+        }, Qt::DirectConnection);
+        connections << QObject::connect(quickWindow, &QQuickWindow::afterRendering, q, [r, quickWindow]() {
+            GLuint framebuffer = quickWindow->renderTarget() ? quickWindow->renderTarget()->handle()
+                                                             : QOpenGLContext::currentContext()->defaultFramebufferObject();
+            r->render(quickWindow->size() * quickWindow->effectiveDevicePixelRatio(), framebuffer, true);
+        }, Qt::DirectConnection);
+    }
+#endif
+
+    q->markDirty();
+}
+
+void QWaylandOutputRecorderPrivate::stop()
+{
+    for (const QMetaObject::Connection &connection : qAsConst(connections))
+        QObject::disconnect(connection);
+    connections.clear();
+    for (const auto &surfaceConnection : qAsConst(surfaceConnections)) {
+        for (const QMetaObject::Connection &connection : surfaceConnection)
+            QObject::disconnect(connection);
+    }
+    surfaceConnections.clear();
+
+    if (!renderer)
+        return;
+
+    {
+        QMutexLocker locker(&renderer->mutex);
+        renderer->recorder = nullptr;
+    }
+
+#ifdef QT_WAYLAND_COMPOSITOR_QUICK
+    QQuickWindow *quickWindow = output ? qobject_cast<QQuickWindow *>(output->window()) : nullptr;
+    if (quickWindow) {
+        // The pixel buffer object belongs to the render thread
+        auto *job = new OutputRecorderReleaseJob;
+        job->renderer = renderer;
+        quickWindow->scheduleRenderJob(job, QQuickWindow::NoStage);
+    } else
+#endif
+    {
+        renderer->releaseResources();
+    }
+
+    renderer.reset();
+}
+
+void QWaylandOutputRecorderPrivate::watchSurface(QWaylandSurface *surface)
+{
+    Q_Q(QWaylandOutputRecorder);
+    if (surfaceConnections.contains(surface))
+        return;
+
+    auto &surfaceConnection = surfaceConnections[surface];
+    surfaceConnection << QObject::connect(surface, &QWaylandSurface::damaged, q, [this, surface](const QRegion &damage) {
+        surfaceDamaged(surface, damage);
+    });
+    // Qt drops the connections when the surface goes away, only the bookkeeping is left
+    surfaceConnection << QObject::connect(surface, &QObject::destroyed, q, [this, surface]() {
+        surfaceConnections.remove(surface);
+    });
+}
+
+void QWaylandOutputRecorderPrivate::surfaceDamaged(QWaylandSurface *surface, const QRegion &damage)
+{
+    if (damage.isEmpty() || !renderer)
+        return;
+
+    const auto views = surface->views();
+    for (QWaylandView *view : views) {
+        if (view->output() == output) {
+            renderer->dirty.storeRelease(1);
+            return;
+        }
+    }
+}
+
+void QWaylandOutputRecorderPrivate::updateSettings()
+{
+    if (!renderer)
+        return;
+
+    renderer->frameCount.storeRelease(frameCount);
+    renderer->skipUnchangedFrames.storeRelease(skipUnchangedFrames ? 1 : 0);
+    renderer->minimumInterval.storeRelease(maxFrameRate > 0 ? qint64(1000000000 / maxFrameRate) : 0);
+}
+
+/*!
+ * Create a QWaylandOutputRecorder object recording \a output, with the given \a parent.
+ */
+QWaylandOutputRecorder::QWaylandOutputRecorder(QWaylandOutput *output, QObject *parent)
+    : QObject(*(new QWaylandOutputRecorderPrivate), parent)
+{
+    Q_D(QWaylandOutputRecorder);
+    d->output = output;
+}
+
+QWaylandOutputRecorder::~QWaylandOutputRecorder()
+{
+    Q_D(QWaylandOutputRecorder);
+    d->stop();
+}
+
+/*!
+ * \property QWaylandOutputRecorder::output
+ *
+ * This property holds the output being recorded.
+ */
+QWaylandOutput *QWaylandOutputRecorder::output() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    return d->output;
+}
+
+void QWaylandOutputRecorder::setOutput(QWaylandOutput *output)
+{
+    Q_D(QWaylandOutputRecorder);
+    if (d->output == output)
+        return;
+
+    d->stop();
+    d->output = output;
+    d->start();
+    emit outputChanged();
+}
+
+/*!
+ * \property QWaylandOutputRecorder::active
+ *
+ * This property holds whether frames are being recorded. The shared memory is
+ * allocated when the first frame is recorded, and released when recording stops.
+ *
+ * The default is false.
+ */
+bool QWaylandOutputRecorder::isActive() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    return d->active;
+}
+
+void QWaylandOutputRecorder::setActive(bool active)
+{
+    Q_D(QWaylandOutputRecorder);
+    if (d->active == active)
+        return;
+
+    d->active = active;
+    if (active)
+        d->start();
+    else
+        d->stop();
+    emit activeChanged();
+}
+
+/*!
+ * \property QWaylandOutputRecorder::frameCount
+ *
+ * This property holds the number of frames kept in the ring. Changing it
+ * reallocates the shared memory.
+ *
+ * The default is 3.
+ */
+int QWaylandOutputRecorder::frameCount() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    return d->frameCount;
+}
+
+void QWaylandOutputRecorder::setFrameCount(int count)
+{
+    Q_D(QWaylandOutputRecorder);
+    count = qMax(1, count);
+    if (d->frameCount == count)
+        return;
+
+    d->frameCount = count;
+    d->updateSettings();
+    emit frameCountChanged();
+}
+
+/*!
+ * \property QWaylandOutputRecorder::maxFrameRate
+ *
+ * This property holds the maximum number of frames recorded per second. Frames
+ * rendered in between are not recorded; the latest content is recorded once
+ * enough time has passed.
+ *
+ * The default is 0, which means every changed frame is recorded.
+ */
+qreal QWaylandOutputRecorder::maxFrameRate() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    return d->maxFrameRate;
+}
+
+void QWaylandOutputRecorder::setMaxFrameRate(qreal rate)
+{
+    Q_D(QWaylandOutputRecorder);
+    rate = qMax(qreal(0), rate);
+    if (qFuzzyCompare(d->maxFrameRate, rate))
+        return;
+
+    d->maxFrameRate = rate;
+    d->updateSettings();
+    emit maxFrameRateChanged();
+}
+
+/*!
+ * \property QWaylandOutputRecorder::skipUnchangedFrames
+ *
+ * This property holds whether frames are only recorded when a surface shown on
+ * the output has been damaged, or markDirty() has been called, since the
+ * previous frame was recorded.
+ *
+ * The default is true.
+ */
+bool QWaylandOutputRecorder::skipUnchangedFrames() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    return d->skipUnchangedFrames;
+}
+
+void QWaylandOutputRecorder::setSkipUnchangedFrames(bool skip)
+{
+    Q_D(QWaylandOutputRecorder);
+    if (d->skipUnchangedFrames == skip)
+        return;
+
+    d->skipUnchangedFrames = skip;
+    d->updateSettings();
+    emit skipUnchangedFramesChanged();
+}
+
+/*!
+ * \property QWaylandOutputRecorder::fileDescriptor
+ *
+ * This property holds the file descriptor of the memfd holding the ring, or -1
+ * if nothing has been recorded yet. The descriptor remains owned by the recorder;
+ * it is replaced, and bufferChanged() emitted, when the output size changes.
+ */
+int QWaylandOutputRecorder::fileDescriptor() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    if (!d->renderer)
+        return -1;
+    QMutexLocker locker(&d->renderer->mutex);
+    return d->renderer->fd;
+}
+
+/*!
+ * Returns the size in pixels of the frames in the ring.
+ */
+QSize QWaylandOutputRecorder::frameSize() const
+{
+    Q_D(const QWaylandOutputRecorder);
+    if (!d->renderer)
+        return QSize();
+    QMutexLocker locker(&d->renderer->mutex);
+    return d->renderer->frameSize;
+}
+
+/*!
+ * Marks the output content as changed, so that the next frame is recorded even
+ * though no client surface on it was damaged. Call this when the compositor
+ * itself changes what is shown on the output.
+ */
+void QWaylandOutputRecorder::markDirty()
+{
+    Q_D(QWaylandOutputRecorder);
+    if (!d->renderer)
+        return;
+
+    d->renderer->dirty.storeRelease(1);
+    if (d->output)
+        d->output->update();
+}
+
+/*!
+ * Records the frame that was just rendered for an output that is not a
+ * QWaylandQuickOutput. The OpenGL context used to render the output must be
+ * current, and the frame must not have been swapped yet.
+ */
+void QWaylandOutputRecorder::recordFrame()
+{
+    Q_D(QWaylandOutputRecorder);
+    if (!d->renderer || !d->output || !d->output->window())
+        return;
+
+#if QT_CONFIG(opengl)
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        qWarning("QWaylandOutputRecorder::recordFrame() called without a current OpenGL context");
+        return;
+    }
+
+    QWindow *window = d->output->window();
+    d->renderer->synchronize();
+    d->renderer->render(window->size() * window->devicePixelRatio(), context->defaultFramebufferObject(), false);
+#else
+    qWarning("QWaylandOutputRecorder::recordFrame() needs OpenGL, use recordImage() instead");
+#endif
+}
+
+/*!
+ * Records \a image as the frame that was just rendered. Use this instead of recordFrame()
+ * for outputs that are not rendered with OpenGL, for instance with QPainter. The image
+ * should have the size of the output in pixels.
+ */
+void QWaylandOutputRecorder::recordImage(const QImage &image)
+{
+    Q_D(QWaylandOutputRecorder);
+    if (!d->renderer)
+        return;
+
+    d->renderer->synchronize();
+    d->renderer->record(image);
+}
+
+/*!
+ * \fn void QWaylandOutputRecorder::frameRecorded(quint64 sequence, quint64 timestamp)
+ *
+ * This signal is emitted when frame number \a sequence has been written to the ring.
+ * The \a timestamp is the CLOCK_MONOTONIC time in nanoseconds at which the frame was
+ * rendered, the same value as stored in the frame header.
+ */
+
+QT_END_NAMESPACE
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWAYLANDOUTPUTRECORDER_H
+#define QWAYLANDOUTPUTRECORDER_H
+
+#include <QtWaylandCompositor/qtwaylandcompositorglobal.h>
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtGui/QImage>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandOutput;
+class QWaylandOutputRecorderPrivate;
+
+class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandOutputRecorder : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QWaylandOutputRecorder)
+    Q_PROPERTY(QWaylandOutput *output READ output WRITE setOutput NOTIFY outputChanged)
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(int frameCount READ frameCount WRITE setFrameCount NOTIFY frameCountChanged)
+    Q_PROPERTY(qreal maxFrameRate READ maxFrameRate WRITE setMaxFrameRate NOTIFY maxFrameRateChanged)
+    Q_PROPERTY(bool skipUnchangedFrames READ skipUnchangedFrames WRITE setSkipUnchangedFrames NOTIFY skipUnchangedFramesChanged)
+    Q_PROPERTY(int fileDescriptor READ fileDescriptor NOTIFY bufferChanged)
+public:
+    explicit QWaylandOutputRecorder(QWaylandOutput *output = nullptr, QObject *parent = nullptr);
+    ~QWaylandOutputRecorder() override;
+
+    QWaylandOutput *output() const;
+    void setOutput(QWaylandOutput *output);
+
+    bool isActive() const;
+    void setActive(bool active);
+
+    int frameCount() const;
+    void setFrameCount(int count);
+
+    qreal maxFrameRate() const;
+    void setMaxFrameRate(qreal rate);
+
+    bool skipUnchangedFrames() const;
+    void setSkipUnchangedFrames(bool skip);
+
+    int fileDescriptor() const;
+    QSize frameSize() const;
+
+public Q_SLOTS:
+    void markDirty();
+    void recordFrame();
+    void recordImage(const QImage &image);
+
+Q_SIGNALS:
+    void outputChanged();
+    void activeChanged();
+    void frameCountChanged();
+    void maxFrameRateChanged();
+    void skipUnchangedFramesChanged();
+    void bufferChanged();
+    void frameRecorded(quint64 sequence, quint64 timestamp);
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDOUTPUTRECORDER_H
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+****************************************************************************/
+
+#ifndef QWAYLANDOUTPUTRECORDERLAYOUT_H
+#define QWAYLANDOUTPUTRECORDERLAYOUT_H
+
+#include <stdint.h>
+
+#if 0
+#pragma qt_no_master_include
+#pragma qt_sync_skip_header_check
+#endif
+
+// Layout of the shared memory written by QWaylandOutputRecorder.
+//
+// Consumers in other processes receive QWaylandOutputRecorder::fileDescriptor(),
+// map it read-only and may copy these definitions; they only depend on the
+// fixed-size integer types of <stdint.h>, not on Qt. All integers are in host byte
+// order, and the version is bumped on any incompatible change.
+//
+// The memory starts with a QWaylandOutputRecorderRingHeader. Frame slots start at
+// frameOffset and are slotSize bytes apart. Each slot starts with a
+// QWaylandOutputRecorderFrameHeader, followed by height rows of stride bytes of
+// pixel data at QWaylandOutputRecorderDataOffset, top row first.
+//
+// Frame n (counting from 1) lives in slot (n - 1) % frameCount. Fields marked as
+// atomic are written with release semantics and must be read with acquire
+// semantics. To read a frame:
+//
+//   1. read latestSequence; 0 means no frame has been recorded yet
+//   2. read the lock of the frame's slot; it must be 2 * n
+//   3. copy the frame header and pixels
+//   4. read the lock again; if it changed, the slot was overwritten while
+//      copying and the copy must be discarded
+//
+// The lock is odd while a slot is written.
+
+#define QT_WAYLAND_OUTPUT_RECORDER_MAGIC 0x51575242 // "QWRB"
+#define QT_WAYLAND_OUTPUT_RECORDER_VERSION 1
+
+struct QWaylandOutputRecorderRingHeader
+{
+    uint32_t magic;          // QT_WAYLAND_OUTPUT_RECORDER_MAGIC
+    uint32_t version;        // QT_WAYLAND_OUTPUT_RECORDER_VERSION
+    uint32_t frameCount;     // number of frame slots in the ring
+    uint32_t width;          // in pixels
+    uint32_t height;
+    uint32_t stride;         // bytes per line
+    uint32_t format;         // QImage::Format of the pixel data
+    uint32_t frameOffset;    // offset of the first slot from the start of the memory
+    uint32_t slotSize;       // distance between two slots
+    uint32_t reserved;
+    uint64_t latestSequence; // atomic: sequence of the latest complete frame, 0 if none
+};
+
+struct QWaylandOutputRecorderFrameHeader
+{
+    uint64_t lock;           // atomic: odd while written, 2 * sequence once complete
+    uint64_t sequence;
+    uint64_t timestamp;      // CLOCK_MONOTONIC, in nanoseconds
+    uint64_t reserved;
+};
+
+enum : uint32_t {
+    QWaylandOutputRecorderDataOffset = 64
+};
+
+#endif // QWAYLANDOUTPUTRECORDERLAYOUT_H
@@ -50,6 +50,7 @@
 #include <QtWaylandCompositor/QWaylandDrag>
 #endif
 #include <QtWaylandCompositor/private/qwlclientbufferintegration_p.h>
+#include <QtWaylandCompositor/private/qwlclientbuffer_p.h>
 
 #include <QtGui/QKeyEvent>
 #include <QtGui/QGuiApplication>
@@ -1189,6 +1190,19 @@ void QWaylandQuickItem::updateInputMethod(Qt::InputMethodQueries queries)
  * \sa QWaylandQuickkItem::bufferLocked
  */
 
+// Returns the part of the buffer cropped by the surface's viewport, in texture
+// pixel coordinates.
+static QRectF textureSourceRect(const QWaylandSurface *surface, const QWaylandBufferRef &ref, bool invertY)
+{
+    const QRectF bufferRect(QPointF(), QSizeF(ref.size()));
+    QRectF source = surface ? surface->sourceGeometry().intersected(bufferRect) : QRectF();
+    if (source.isEmpty())
+        return bufferRect;
+    if (invertY)
+        source.moveTop(bufferRect.height() - source.bottom());
+    return source;
+}
+
 QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
     Q_D(QWaylandQuickItem);
@@ -1206,8 +1220,14 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
     const bool invertY = ref.origin() == QWaylandSurface::OriginBottomLeft;
     const QRectF rect = invertY ? QRectF(0, height(), width(), -height())
                                 : QRectF(0, 0, width(), height());
+    const QRectF source = textureSourceRect(surface(), ref, invertY);
+
+    // Shared memory YUV buffers are uploaded plane by plane and converted by
+    // the YUV buffer materials, instead of being converted on the CPU.
+    const QWaylandBufferRef::BufferFormatEgl format = ref.bufferFormatEgl();
+    const bool samplesShmPlanes = ref.isSharedMemory() && QtWayland::SharedMemoryBuffer::canSamplePlanes(format);
 
-    if (ref.isSharedMemory() || bufferTypes[ref.bufferFormatEgl()].canProvideTexture) {
+    if ((ref.isSharedMemory() && !samplesShmPlanes) || bufferTypes[format].canProvideTexture) {
         // This case could covered by the more general path below, but this is more efficient (especially when using ShaderEffect items).
         QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode *>(oldNode);
 
@@ -1227,6 +1247,7 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
 
         d->provider->setSmooth(smooth());
         node->setRect(rect);
+        node->setSourceRect(source);
 
         return node;
     } else {
@@ -1246,17 +1267,20 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
             geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4);
 
         if (!material)
-            material = new QWaylandBufferMaterial(ref.bufferFormatEgl());
+            material = new QWaylandBufferMaterial(format);
 
         if (d->newTexture) {
             d->newTexture = false;
-            for (int plane = 0; plane < bufferTypes[ref.bufferFormatEgl()].planeCount; plane++)
+            for (int plane = 0; plane < bufferTypes[format].planeCount; plane++)
                 if (auto texture = ref.toOpenGLTexture(plane))
                     material->setTextureForPlane(plane, texture);
             material->bind();
         }
 
-        QSGGeometry::updateTexturedRectGeometry(geometry, rect, QRectF(0, 0, 1, 1));
+        const QSizeF bufferSize(ref.size());
+        const QRectF textureRect(source.x() / bufferSize.width(), source.y() / bufferSize.height(),
+                                 source.width() / bufferSize.width(), source.height() / bufferSize.height());
+        QSGGeometry::updateTexturedRectGeometry(geometry, rect, textureRect);
 
         node->setGeometry(geometry);
         node->setFlag(QSGNode::OwnsGeometry, true);
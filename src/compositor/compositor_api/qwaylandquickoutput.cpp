@@ -41,6 +41,9 @@
 #include "qwaylandquickoutput.h"
 #include "qwaylandquickcompositor.h"
 #include "qwaylandquickitem_p.h"
+#include "qwaylandoutput_p.h"
+
+#include <time.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -68,6 +71,11 @@ void QWaylandQuickOutput::initialize()
 
     connect(quickWindow, &QQuickWindow::beforeRendering,
             this, &QWaylandQuickOutput::doFrameCallbacks);
+
+    QWaylandOutputPrivate::get(this)->reportsPresentation = true;
+    connect(quickWindow, &QQuickWindow::frameSwapped,
+            this, &QWaylandQuickOutput::framePresented,
+            Qt::DirectConnection);
 }
 
 void QWaylandQuickOutput::classBegin()
@@ -173,4 +181,21 @@ void QWaylandQuickOutput::doFrameCallbacks()
     if (m_automaticFrameCallback)
         sendFrameCallbacks();
 }
+
+// Called on the render thread right after the frame started in updateStarted()
+// has been swapped. The timestamp is taken here, while the feedback is sent
+// from the compositor's thread.
+void QWaylandQuickOutput::framePresented()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const qint64 timestamp = qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+    const quint64 frame = QWaylandOutputPrivate::get(this)->latchedFrame;
+
+    QMetaObject::invokeMethod(this, [this, frame, timestamp]() {
+        const uint flags = window()->format().swapInterval() > 0
+                ? QtWaylandServer::wp_presentation_feedback::kind_vsync : 0;
+        QWaylandOutputPrivate::get(this)->sendPresentationFeedbacks(frame, timestamp, flags);
+    });
+}
 QT_END_NAMESPACE
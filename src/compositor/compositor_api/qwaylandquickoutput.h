@@ -78,6 +78,7 @@ protected:
 
 private:
     void doFrameCallbacks();
+    void framePresented();
 
     bool m_updateScheduled = false;
     bool m_automaticFrameCallback = true;
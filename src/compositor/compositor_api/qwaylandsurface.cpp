@@ -169,12 +169,38 @@ void QWaylandSurfacePrivate::setBufferScale(int scale)
     emit q->bufferScaleChanged();
 }
 
+void QWaylandSurfacePrivate::setSourceGeometry(const QRectF &geometry)
+{
+    Q_Q(QWaylandSurface);
+    if (geometry == sourceGeometry)
+        return;
+    sourceGeometry = geometry;
+    emit q->sourceGeometryChanged();
+}
+
+void QWaylandSurfacePrivate::setDestinationSize(const QSize &size)
+{
+    Q_Q(QWaylandSurface);
+    if (size == destinationSize)
+        return;
+    destinationSize = size;
+    emit q->destinationSizeChanged();
+}
+
 void QWaylandSurfacePrivate::removeFrameCallback(QtWayland::FrameCallback *callback)
 {
     pendingFrameCallbacks.removeOne(callback);
     frameCallbacks.removeOne(callback);
 }
 
+void QWaylandSurfacePrivate::discardPresentationFeedbacks(QList<QWaylandPresentationTimePrivate::Feedback *> *feedbacks)
+{
+    const auto discarded = *feedbacks;
+    feedbacks->clear();
+    for (auto *feedback : discarded)
+        feedback->sendDiscarded();
+}
+
 void QWaylandSurfacePrivate::notifyViewsAboutDestruction()
 {
     Q_Q(QWaylandSurface);
@@ -213,6 +239,9 @@ void QWaylandSurfacePrivate::surface_destroy_resource(Resource *)
     Q_Q(QWaylandSurface);
     notifyViewsAboutDestruction();
 
+    discardPresentationFeedbacks(&pendingPresentationFeedbacks);
+    discardPresentationFeedbacks(&presentationFeedbacks);
+
     destroyed = true;
     emit q->surfaceDestroyed();
     q->destroy();
@@ -267,7 +296,26 @@ void QWaylandSurfacePrivate::surface_commit(Resource *)
     if (buffer)
         buffer->setCommitted(pending.damage);
 
-    setSize(bufferRef.size());
+    const int scale = pending.bufferScale;
+    const QSize bufferSize = bufferRef.size();
+    QSize surfaceSize = bufferSize;
+    QRectF source;
+    QSize destination;
+    if (bufferRef.hasBuffer()) {
+        // The viewport source rectangle is given in surface coordinates before
+        // cropping and scaling, i.e. with the buffer scale already applied.
+        const QSizeF contentSize = QSizeF(bufferSize) / scale;
+        if (viewport)
+            viewport->checkCommittedState(contentSize);
+        source = pending.sourceGeometry.isValid() ? pending.sourceGeometry : QRectF(QPointF(), contentSize);
+        destination = pending.destinationSize.isValid() ? pending.destinationSize : source.size().toSize();
+        if (pending.sourceGeometry.isValid() || pending.destinationSize.isValid())
+            surfaceSize = destination * scale;
+    }
+
+    setSourceGeometry(QRectF(source.topLeft() * scale, source.size() * scale));
+    setDestinationSize(destination);
+    setSize(surfaceSize);
     damage = pending.damage.intersected(QRect(QPoint(), size));
 
     for (int i = 0; i < views.size(); i++) {
@@ -295,6 +343,11 @@ void QWaylandSurfacePrivate::surface_commit(Resource *)
     frameCallbacks << pendingFrameCallbacks;
     pendingFrameCallbacks.clear();
 
+    // Content updates that no output has started showing yet are superseded
+    discardPresentationFeedbacks(&presentationFeedbacks);
+    presentationFeedbacks = pendingPresentationFeedbacks;
+    pendingPresentationFeedbacks.clear();
+
     inputRegion = pending.inputRegion.intersected(QRect(QPoint(), size));
 
     emit q->redraw();
@@ -467,13 +520,15 @@ bool QWaylandSurface::hasContent() const
 /*!
  * \qmlproperty size QtWaylandCompositor::WaylandSurface::size
  *
- * This property holds the WaylandSurface's size in pixels.
+ * This property holds the WaylandSurface's size in pixels. This is the
+ * destinationSize multiplied by the buffer scale.
  */
 
 /*!
  * \property QWaylandSurface::size
  *
- * This property holds the QWaylandSurface's size in pixels.
+ * This property holds the QWaylandSurface's size in pixels. This is the
+ * destinationSize multiplied by the buffer scale.
  */
 QSize QWaylandSurface::size() const
 {
@@ -502,6 +557,54 @@ int QWaylandSurface::bufferScale() const
     return d->bufferScale;
 }
 
+/*!
+ * \qmlproperty rect QtWaylandCompositor::WaylandSurface::sourceGeometry
+ *
+ * This property holds the part of the attached buffer that is displayed, in
+ * buffer pixel coordinates. Unless the client has cropped the surface with
+ * a viewport, this is the whole buffer.
+ *
+ * \sa destinationSize
+ */
+
+/*!
+ * \property QWaylandSurface::sourceGeometry
+ *
+ * This property holds the part of the attached buffer that is displayed, in
+ * buffer pixel coordinates. Unless the client has cropped the surface with
+ * a viewport, this is the whole buffer.
+ *
+ * \sa destinationSize, QWaylandViewporter
+ */
+QRectF QWaylandSurface::sourceGeometry() const
+{
+    Q_D(const QWaylandSurface);
+    return d->sourceGeometry;
+}
+
+/*!
+ * \qmlproperty size QtWaylandCompositor::WaylandSurface::destinationSize
+ *
+ * This property holds the size of the WaylandSurface in surface coordinates.
+ * The source geometry is scaled to this size. Unless the client has set a
+ * viewport, this is the buffer size divided by the buffer scale.
+ */
+
+/*!
+ * \property QWaylandSurface::destinationSize
+ *
+ * This property holds the size of the QWaylandSurface in surface coordinates.
+ * The source geometry is scaled to this size. Unless the client has set a
+ * viewport, this is the buffer size divided by the buffer scale.
+ *
+ * \sa sourceGeometry, QWaylandViewporter
+ */
+QSize QWaylandSurface::destinationSize() const
+{
+    Q_D(const QWaylandSurface);
+    return d->destinationSize;
+}
+
 /*!
  * \qmlproperty enum QtWaylandCompositor::WaylandSurface::contentOrientation
  *
@@ -578,10 +681,17 @@ void QWaylandSurface::frameStarted()
 
 /*!
  * Sends pending frame callbacks.
+ *
+ * Frame callbacks are held back while the client is not \l {QWaylandClient::responsive}
+ * {responsive}. The ones that were due are sent as soon as it answers ping events again.
  */
 void QWaylandSurface::sendFrameCallbacks()
 {
     Q_D(QWaylandSurface);
+    QWaylandClient *surfaceClient = client();
+    if (surfaceClient && !surfaceClient->isResponsive())
+        return;
+
     uint time = d->compositor->currentTimeMsecs();
     int i = 0;
     while (i < d->frameCallbacks.size()) {
@@ -46,6 +46,7 @@
 #include <QtWaylandCompositor/qwaylandclient.h>
 
 #include <QtCore/QScopedPointer>
+#include <QtCore/QRectF>
 #include <QtGui/QImage>
 #include <QtGui/QWindow>
 #include <QtCore/QVariantMap>
@@ -83,6 +84,8 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandSurface : public QWaylandObject
     Q_PROPERTY(QWaylandClient *client READ client CONSTANT)
     Q_PROPERTY(QSize size READ size NOTIFY sizeChanged)
     Q_PROPERTY(int bufferScale READ bufferScale NOTIFY bufferScaleChanged)
+    Q_PROPERTY(QRectF sourceGeometry READ sourceGeometry NOTIFY sourceGeometryChanged)
+    Q_PROPERTY(QSize destinationSize READ destinationSize NOTIFY destinationSizeChanged)
     Q_PROPERTY(Qt::ScreenOrientation contentOrientation READ contentOrientation NOTIFY contentOrientationChanged)
     Q_PROPERTY(QWaylandSurface::Origin origin READ origin NOTIFY originChanged)
     Q_PROPERTY(bool hasContent READ hasContent NOTIFY hasContentChanged)
@@ -112,6 +115,8 @@ public:
 
     QSize size() const;
     int bufferScale() const;
+    QRectF sourceGeometry() const;
+    QSize destinationSize() const;
 
     Qt::ScreenOrientation contentOrientation() const;
 
@@ -157,6 +162,8 @@ Q_SIGNALS:
     void childAdded(QWaylandSurface *child);
     void sizeChanged();
     void bufferScaleChanged();
+    void sourceGeometryChanged();
+    void destinationSizeChanged();
     void offsetForNextFrame(const QPoint &offset);
     void contentOrientationChanged();
     void surfaceDestroyed();
@@ -60,6 +60,8 @@
 #include <QtWaylandCompositor/qwaylandbufferref.h>
 
 #include <QtWaylandCompositor/private/qwlregion_p.h>
+#include <QtWaylandCompositor/private/qwaylandviewporter_p.h>
+#include <QtWaylandCompositor/private/qwaylandpresentationtime_p.h>
 
 #include <QtCore/QVector>
 #include <QtCore/QRect>
@@ -104,8 +106,11 @@ public:
 
     void setSize(const QSize &size);
     void setBufferScale(int bufferScale);
+    void setSourceGeometry(const QRectF &sourceGeometry);
+    void setDestinationSize(const QSize &destinationSize);
 
     void removeFrameCallback(QtWayland::FrameCallback *callback);
+    void discardPresentationFeedbacks(QList<QWaylandPresentationTimePrivate::Feedback *> *feedbacks);
 
     void notifyViewsAboutDestruction();
 
@@ -155,6 +160,8 @@ public: //member variables
         bool newlyAttached;
         QRegion inputRegion;
         int bufferScale;
+        QRectF sourceGeometry;
+        QSize destinationSize;
     } pending;
 
     QPoint lastLocalMousePos;
@@ -163,11 +170,17 @@ public: //member variables
     QList<QtWayland::FrameCallback *> pendingFrameCallbacks;
     QList<QtWayland::FrameCallback *> frameCallbacks;
 
+    QList<QWaylandPresentationTimePrivate::Feedback *> pendingPresentationFeedbacks;
+    QList<QWaylandPresentationTimePrivate::Feedback *> presentationFeedbacks;
+
     QRegion inputRegion;
     QRegion opaqueRegion;
 
     QSize size;
     int bufferScale = 1;
+    QRectF sourceGeometry;
+    QSize destinationSize;
+    QWaylandViewporterPrivate::Viewport *viewport = nullptr;
     bool isCursorSurface = false;
     bool destroyed = false;
     bool hasContent = false;
@@ -0,0 +1,758 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandsurfacecapture.h"
+
+#include <QtCore/private/qobject_p.h>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QRunnable>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtGui/QPainter>
+#include <QtGui/QWindow>
+#include <QtWaylandCompositor/qwaylandsurface.h>
+#include <QtWaylandCompositor/qwaylandcompositor.h>
+#include <QtWaylandCompositor/qwaylandoutput.h>
+#include <QtWaylandCompositor/qwaylandview.h>
+#include <QtWaylandCompositor/private/qwaylandsurface_p.h>
+
+#if QT_CONFIG(opengl)
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QOpenGLTexture>
+#include <QtGui/QOpenGLTextureBlitter>
+#include <QtGui/QMatrix4x4>
+#endif
+
+#ifdef QT_WAYLAND_COMPOSITOR_QUICK
+#include <QtQuick/QQuickWindow>
+#endif
+
+#include <string.h>
+
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandSurfaceCapture
+    \inmodule QtWaylandCompositor
+    \since 5.12
+    \brief The QWaylandSurfaceCapture class continuously reads back the content of a QWaylandSurface
+
+    QWaylandSurfaceGrabber is meant for taking a single screenshot. QWaylandSurfaceCapture is
+    meant for thumbnails, screencasts and other consumers that need the content of a surface
+    every time it changes.
+
+    While \l active is true, every commit that damages the surface results in a
+    frameCaptured() signal carrying the complete, up to date frame and the region that changed
+    since the previous delivery. Only the damaged part of the surface is read back.
+
+    Shared memory buffers are copied out of client memory before the buffer can be released,
+    so the delivered images never alias memory the client may write to.
+
+    OpenGL buffers are rendered into a framebuffer object that is kept around between captures,
+    and read back into a ring of \l bufferCount pixel buffer objects when the context supports
+    them (OpenGL ES 3 or OpenGL 3). The readback is collected after the next frame has been
+    swapped, so the render thread does not stall waiting for the GPU. Pixel format conversion
+    happens on a worker thread. Asynchronous readback requires the surface to be shown on a
+    QWaylandQuickOutput; otherwise an OpenGL context must be current when the surface is
+    committed, and the readback is synchronous.
+*/
+
+namespace {
+
+struct CaptureSink
+{
+    QMutex mutex;
+    QWaylandSurfaceCapture *capture = nullptr;
+};
+
+struct CapturedPatch
+{
+    quint64 sequence = 0;
+    QSize frameSize;
+    QRect rect;
+    QRegion damage;
+    QImage image;
+};
+
+}
+
+class CaptureRenderState;
+
+class QWaylandSurfaceCapturePrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QWaylandSurfaceCapture)
+public:
+    static QWaylandSurfaceCapturePrivate *get(QWaylandSurfaceCapture *capture) { return capture->d_func(); }
+
+    void connectSurface();
+    void disconnectSurface();
+    void requestCapture(const QRegion &damage);
+    void captureSharedMemory(const QWaylandBufferRef &buffer, const QRegion &damage);
+#if QT_CONFIG(opengl)
+    void captureTexture(const QWaylandBufferRef &buffer, const QRegion &damage);
+    void releaseRenderState();
+#endif
+    void applyPatch(const CapturedPatch &patch);
+
+    QPointer<QWaylandSurface> surface;
+    QMetaObject::Connection damagedConnection;
+    QMetaObject::Connection destroyedConnection;
+    bool active = false;
+    int bufferCount = 2;
+    QImage frame;
+
+    QSharedPointer<CaptureSink> sink;
+    quint64 nextSequence = 0;
+    quint64 nextSequenceToApply = 0;
+    QMap<quint64, CapturedPatch> completedPatches;
+
+#if QT_CONFIG(opengl)
+    QSharedPointer<CaptureRenderState> renderState;
+    QPointer<QWindow> renderWindow;
+#endif
+};
+
+static void deliverPatch(const QSharedPointer<CaptureSink> &sink, const CapturedPatch &patch)
+{
+    QMutexLocker locker(&sink->mutex);
+    QWaylandSurfaceCapture *capture = sink->capture;
+    if (!capture)
+        return;
+
+    QMetaObject::invokeMethod(capture, [capture, patch]() {
+        QWaylandSurfaceCapturePrivate::get(capture)->applyPatch(patch);
+    }, Qt::QueuedConnection);
+}
+
+#if QT_CONFIG(opengl)
+namespace {
+
+class CaptureConversionJob : public QRunnable
+{
+public:
+    void run() override
+    {
+        // glReadPixels returns the rows bottom-up and in RGBA byte order
+        if (!patch.image.isNull())
+            patch.image = patch.image.mirrored().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        deliverPatch(sink, patch);
+    }
+
+    QSharedPointer<CaptureSink> sink;
+    CapturedPatch patch;
+};
+
+}
+
+class CaptureRenderState
+{
+public:
+    explicit CaptureRenderState(const QSharedPointer<CaptureSink> &sink) : m_sink(sink) {}
+    ~CaptureRenderState();
+
+    void capture(const QWaylandBufferRef &buffer, CapturedPatch patch, int bufferCount);
+    void drain();
+    void releaseResources();
+
+private:
+    struct Readback
+    {
+        GLuint pbo = 0;
+        int capacity = 0;
+        bool pending = false;
+        CapturedPatch patch;
+    };
+
+    void collect(Readback &readback);
+    void convert(const CapturedPatch &patch);
+
+    QSharedPointer<CaptureSink> m_sink;
+    QOpenGLFramebufferObject *m_fbo = nullptr;
+    QOpenGLTextureBlitter m_blitter;
+    QVector<Readback> m_readbacks;
+    int m_next = 0;
+    bool m_initialized = false;
+    bool m_usePixelBufferObjects = false;
+};
+
+CaptureRenderState::~CaptureRenderState()
+{
+    // Readbacks that can no longer be collected are delivered empty, so that the
+    // patches following them are not held back forever
+    for (const Readback &readback : qAsConst(m_readbacks)) {
+        if (readback.pending)
+            deliverPatch(m_sink, readback.patch);
+    }
+}
+
+void CaptureRenderState::convert(const CapturedPatch &patch)
+{
+    auto *job = new CaptureConversionJob;
+    job->sink = m_sink;
+    job->patch = patch;
+    QThreadPool::globalInstance()->start(job);
+}
+
+void CaptureRenderState::capture(const QWaylandBufferRef &buffer, CapturedPatch patch, int bufferCount)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        convert(patch);
+        return;
+    }
+
+    QOpenGLExtraFunctions *f = context->extraFunctions();
+
+    if (!m_initialized) {
+        m_usePixelBufferObjects = context->format().majorVersion() >= 3;
+        m_blitter.create();
+        m_initialized = true;
+    }
+
+    const QSize size = buffer.size();
+    if (!m_fbo || m_fbo->size() != size) {
+        delete m_fbo;
+        m_fbo = new QOpenGLFramebufferObject(size);
+    }
+
+    m_fbo->bind();
+    f->glViewport(0, 0, size.width(), size.height());
+
+    QOpenGLTextureBlitter::Origin surfaceOrigin =
+        buffer.origin() == QWaylandSurface::OriginTopLeft
+        ? QOpenGLTextureBlitter::OriginTopLeft
+        : QOpenGLTextureBlitter::OriginBottomLeft;
+
+    auto texture = buffer.toOpenGLTexture();
+    m_blitter.bind(texture->target());
+    m_blitter.blit(texture->textureId(), QMatrix4x4(), surfaceOrigin);
+    m_blitter.release();
+
+    const QRect &rect = patch.rect;
+    const int glY = size.height() - rect.y() - rect.height();
+
+    if (!m_usePixelBufferObjects) {
+        patch.image = QImage(rect.size(), QImage::Format_RGBA8888_Premultiplied);
+        f->glReadPixels(rect.x(), glY, rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, patch.image.bits());
+        m_fbo->release();
+        convert(patch);
+        return;
+    }
+
+    if (m_readbacks.size() != bufferCount) {
+        drain();
+        for (const Readback &readback : qAsConst(m_readbacks)) {
+            if (readback.pbo)
+                f->glDeleteBuffers(1, &readback.pbo);
+        }
+        m_readbacks = QVector<Readback>(bufferCount);
+        m_next = 0;
+    }
+
+    // The slot we are about to reuse holds the oldest readback in flight, so it has had
+    // the most time to complete
+    Readback &readback = m_readbacks[m_next];
+    if (readback.pending)
+        collect(readback);
+
+    const int bytes = rect.width() * rect.height() * 4;
+    if (!readback.pbo)
+        f->glGenBuffers(1, &readback.pbo);
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    if (readback.capacity < bytes) {
+        f->glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        readback.capacity = bytes;
+    }
+    f->glReadPixels(rect.x(), glY, rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_fbo->release();
+
+    readback.pending = true;
+    readback.patch = patch;
+    m_next = (m_next + 1) % m_readbacks.size();
+}
+
+void CaptureRenderState::collect(Readback &readback)
+{
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    CapturedPatch patch = readback.patch;
+    readback.pending = false;
+    readback.patch = CapturedPatch();
+
+    const int bytes = patch.rect.width() * patch.rect.height() * 4;
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    if (void *data = f->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT)) {
+        patch.image = QImage(patch.rect.size(), QImage::Format_RGBA8888_Premultiplied);
+        memcpy(patch.image.bits(), data, bytes);
+        f->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Deliver even if mapping failed, so that the following patches are not held back
+    convert(patch);
+}
+
+void CaptureRenderState::drain()
+{
+    if (!QOpenGLContext::currentContext())
+        return;
+
+    for (int i = 0; i < m_readbacks.size(); ++i) {
+        Readback &readback = m_readbacks[(m_next + i) % m_readbacks.size()];
+        if (readback.pending)
+            collect(readback);
+    }
+}
+
+void CaptureRenderState::releaseResources()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context) {
+        for (const Readback &readback : qAsConst(m_readbacks)) {
+            if (readback.pbo)
+                context->functions()->glDeleteBuffers(1, &readback.pbo);
+        }
+        delete m_fbo;
+        if (m_blitter.isCreated())
+            m_blitter.destroy();
+    }
+    for (const Readback &readback : qAsConst(m_readbacks)) {
+        if (readback.pending)
+            deliverPatch(m_sink, readback.patch);
+    }
+    m_readbacks.clear();
+    m_fbo = nullptr;
+    m_initialized = false;
+}
+
+namespace {
+
+class CaptureRenderJob : public QRunnable
+{
+public:
+    enum Type {
+        Capture,
+        Drain,
+        Release
+    };
+
+    ~CaptureRenderJob() override
+    {
+        // The window may delete jobs without running them, e.g. when it is destroyed
+        if (type == Capture && !ran)
+            deliverPatch(sink, patch);
+    }
+
+    void run() override
+    {
+        ran = true;
+        switch (type) {
+        case Capture:
+            state->capture(buffer, patch, bufferCount);
+            break;
+        case Drain:
+            state->drain();
+            break;
+        case Release:
+            state->releaseResources();
+            break;
+        }
+    }
+
+    Type type = Capture;
+    QSharedPointer<CaptureRenderState> state;
+    QSharedPointer<CaptureSink> sink;
+    QWaylandBufferRef buffer;
+    CapturedPatch patch;
+    int bufferCount = 2;
+    bool ran = false;
+};
+
+}
+#endif // QT_CONFIG(opengl)
+
+void QWaylandSurfaceCapturePrivate::connectSurface()
+{
+    Q_Q(QWaylandSurfaceCapture);
+    if (!surface || !active)
+        return;
+
+    damagedConnection = QObject::connect(surface.data(), &QWaylandSurface::damaged, q, [this](const QRegion &damage) {
+        requestCapture(damage);
+    });
+    destroyedConnection = QObject::connect(surface.data(), &QWaylandSurface::surfaceDestroyed, q, [this, q]() {
+        q->setSurface(nullptr);
+    });
+}
+
+void QWaylandSurfaceCapturePrivate::disconnectSurface()
+{
+    QObject::disconnect(damagedConnection);
+    QObject::disconnect(destroyedConnection);
+}
+
+void QWaylandSurfaceCapturePrivate::requestCapture(const QRegion &damage)
+{
+    Q_Q(QWaylandSurfaceCapture);
+    if (!surface) {
+        emit q->failed(QWaylandSurfaceGrabber::InvalidSurface);
+        return;
+    }
+
+    QWaylandBufferRef buffer = QWaylandSurfacePrivate::get(surface)->bufferRef;
+    if (!buffer.hasBuffer()) {
+        emit q->failed(QWaylandSurfaceGrabber::NoBufferAttached);
+        return;
+    }
+
+    // Damage is in surface coordinates, while we copy buffer pixels. The damaged signal is
+    // emitted before the committed buffer scale is applied, so take it from the pending state.
+    const int scale = QWaylandSurfacePrivate::get(surface)->pending.bufferScale;
+    QRegion bufferDamage;
+    for (const QRect &rect : damage)
+        bufferDamage += QRect(rect.topLeft() * scale, rect.size() * scale);
+
+    const QRect bufferRect(QPoint(0, 0), buffer.size());
+    // A new buffer size invalidates everything we have captured so far
+    const QRegion effectiveDamage = frame.size() == buffer.size() ? bufferDamage & bufferRect : QRegion(bufferRect);
+    if (effectiveDamage.isEmpty())
+        return;
+
+    if (buffer.isSharedMemory()) {
+        captureSharedMemory(buffer, effectiveDamage);
+        return;
+    }
+
+#if QT_CONFIG(opengl)
+    captureTexture(buffer, effectiveDamage);
+#else
+    emit q->failed(QWaylandSurfaceGrabber::UnknownBufferType);
+#endif
+}
+
+void QWaylandSurfaceCapturePrivate::captureSharedMemory(const QWaylandBufferRef &buffer, const QRegion &damage)
+{
+    // Copy while we still hold the buffer: once it is released the client may reuse it
+    CapturedPatch patch;
+    patch.sequence = nextSequence++;
+    patch.frameSize = buffer.size();
+    patch.rect = damage.boundingRect();
+    patch.damage = damage;
+    patch.image = buffer.image().copy(patch.rect).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    applyPatch(patch);
+}
+
+#if QT_CONFIG(opengl)
+void QWaylandSurfaceCapturePrivate::captureTexture(const QWaylandBufferRef &buffer, const QRegion &damage)
+{
+    Q_Q(QWaylandSurfaceCapture);
+
+    QWaylandOutput *output = nullptr;
+    if (QWaylandView *view = surface->primaryView())
+        output = view->output();
+    if (!output)
+        output = surface->compositor()->defaultOutput();
+    QWindow *window = output ? output->window() : nullptr;
+
+    if (renderWindow != window)
+        releaseRenderState();
+    if (!renderState) {
+        renderState.reset(new CaptureRenderState(sink));
+        renderWindow = window;
+    }
+
+    CapturedPatch patch;
+    patch.sequence = nextSequence++;
+    patch.frameSize = buffer.size();
+    patch.rect = damage.boundingRect();
+    patch.damage = damage;
+
+    auto *job = new CaptureRenderJob;
+    job->type = CaptureRenderJob::Capture;
+    job->state = renderState;
+    job->sink = sink;
+    job->buffer = buffer;
+    job->patch = patch;
+    job->bufferCount = bufferCount;
+
+#ifdef QT_WAYLAND_COMPOSITOR_QUICK
+    if (QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(window)) {
+        // We need a current OpenGL context, so the readback has to be issued from the
+        // render thread. The results are collected once the next frame has been swapped.
+        quickWindow->scheduleRenderJob(job, QQuickWindow::NoStage);
+
+        auto *drainJob = new CaptureRenderJob;
+        drainJob->type = CaptureRenderJob::Drain;
+        drainJob->state = renderState;
+        quickWindow->scheduleRenderJob(drainJob, QQuickWindow::AfterSwapStage);
+        quickWindow->update();
+        return;
+    }
+#endif
+
+    if (!QOpenGLContext::currentContext()) {
+        // The job delivers an empty patch, so later patches are not held back
+        delete job;
+        emit q->failed(QWaylandSurfaceGrabber::RendererNotReady);
+        return;
+    }
+
+    // Without a render thread there is no later point at which the context is known
+    // to be current, so collect the readback right away
+    job->run();
+    delete job;
+    renderState->drain();
+}
+
+void QWaylandSurfaceCapturePrivate::releaseRenderState()
+{
+    if (!renderState)
+        return;
+
+#ifdef QT_WAYLAND_COMPOSITOR_QUICK
+    if (QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(renderWindow.data())) {
+        auto *job = new CaptureRenderJob;
+        job->type = CaptureRenderJob::Release;
+        job->state = renderState;
+        quickWindow->scheduleRenderJob(job, QQuickWindow::NoStage);
+    } else
+#endif
+    {
+        renderState->releaseResources();
+    }
+
+    renderState.reset();
+    renderWindow.clear();
+}
+#endif // QT_CONFIG(opengl)
+
+void QWaylandSurfaceCapturePrivate::applyPatch(const CapturedPatch &patch)
+{
+    Q_Q(QWaylandSurfaceCapture);
+
+    // Readbacks may complete out of order on the worker threads, but every patch
+    // builds on the previous ones
+    completedPatches.insert(patch.sequence, patch);
+    while (!completedPatches.isEmpty() && completedPatches.firstKey() == nextSequenceToApply) {
+        const CapturedPatch next = completedPatches.take(nextSequenceToApply++);
+        if (next.image.isNull())
+            continue;
+
+        if (frame.size() != next.frameSize) {
+            frame = QImage(next.frameSize, QImage::Format_ARGB32_Premultiplied);
+            frame.fill(Qt::transparent);
+        }
+
+        QPainter painter(&frame);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(next.rect.topLeft(), next.image);
+        painter.end();
+
+        emit q->frameCaptured(frame, next.damage);
+    }
+}
+
+/*!
+ * Create a QWaylandSurfaceCapture object with the given \a surface and \a parent
+ */
+QWaylandSurfaceCapture::QWaylandSurfaceCapture(QWaylandSurface *surface, QObject *parent)
+    : QObject(*(new QWaylandSurfaceCapturePrivate), parent)
+{
+    Q_D(QWaylandSurfaceCapture);
+    d->surface = surface;
+    d->sink.reset(new CaptureSink);
+    d->sink->capture = this;
+}
+
+QWaylandSurfaceCapture::~QWaylandSurfaceCapture()
+{
+    Q_D(QWaylandSurfaceCapture);
+    {
+        QMutexLocker locker(&d->sink->mutex);
+        d->sink->capture = nullptr;
+    }
+    d->disconnectSurface();
+#if QT_CONFIG(opengl)
+    d->releaseRenderState();
+#endif
+}
+
+/*!
+ * \property QWaylandSurfaceCapture::surface
+ *
+ * This property holds the surface whose content is captured.
+ */
+QWaylandSurface *QWaylandSurfaceCapture::surface() const
+{
+    Q_D(const QWaylandSurfaceCapture);
+    return d->surface;
+}
+
+void QWaylandSurfaceCapture::setSurface(QWaylandSurface *surface)
+{
+    Q_D(QWaylandSurfaceCapture);
+    if (d->surface == surface)
+        return;
+
+    d->disconnectSurface();
+    d->surface = surface;
+    d->frame = QImage();
+    d->connectSurface();
+    emit surfaceChanged();
+
+    if (d->active && surface)
+        capture();
+}
+
+/*!
+ * \property QWaylandSurfaceCapture::active
+ *
+ * This property holds whether the surface is captured every time it is damaged.
+ *
+ * When the capture becomes active, a complete frame is captured right away.
+ *
+ * The default is false.
+ */
+bool QWaylandSurfaceCapture::isActive() const
+{
+    Q_D(const QWaylandSurfaceCapture);
+    return d->active;
+}
+
+void QWaylandSurfaceCapture::setActive(bool active)
+{
+    Q_D(QWaylandSurfaceCapture);
+    if (d->active == active)
+        return;
+
+    d->active = active;
+    if (active) {
+        d->connectSurface();
+        capture();
+    } else {
+        d->disconnectSurface();
+    }
+    emit activeChanged();
+}
+
+/*!
+ * \property QWaylandSurfaceCapture::bufferCount
+ *
+ * This property holds the number of pixel buffer objects used for asynchronous readback
+ * of OpenGL buffers. It can be 2 or 3; a higher count tolerates more captures per frame
+ * before the render thread has to wait for a readback to complete.
+ *
+ * The default is 2.
+ */
+int QWaylandSurfaceCapture::bufferCount() const
+{
+    Q_D(const QWaylandSurfaceCapture);
+    return d->bufferCount;
+}
+
+void QWaylandSurfaceCapture::setBufferCount(int count)
+{
+    Q_D(QWaylandSurfaceCapture);
+    count = qBound(2, count, 3);
+    if (d->bufferCount == count)
+        return;
+
+    d->bufferCount = count;
+    emit bufferCountChanged();
+}
+
+/*!
+ * Returns the most recently captured frame.
+ */
+QImage QWaylandSurfaceCapture::frame() const
+{
+    Q_D(const QWaylandSurfaceCapture);
+    return d->frame;
+}
+
+/*!
+ * Capture the complete content of the surface, regardless of damage.
+ *
+ * The result is delivered through the frameCaptured() signal, or the failed()
+ * signal if the surface cannot be captured.
+ */
+void QWaylandSurfaceCapture::capture()
+{
+    Q_D(QWaylandSurfaceCapture);
+    if (!d->surface) {
+        emit failed(QWaylandSurfaceGrabber::InvalidSurface);
+        return;
+    }
+
+    d->frame = QImage();
+    d->requestCapture(QRect(QPoint(0, 0), QWaylandSurfacePrivate::get(d->surface)->bufferRef.size()));
+}
+
+/*!
+ * \fn void QWaylandSurfaceCapture::frameCaptured(const QImage &image, const QRegion &damage)
+ *
+ * This signal is emitted when a new frame has been captured. The \a image always holds the
+ * complete content of the surface, while \a damage is the part that changed since the
+ * previous frame, in buffer pixels.
+ */
+
+/*!
+ * \fn void QWaylandSurfaceCapture::failed(QWaylandSurfaceGrabber::Error error)
+ *
+ * This signal is emitted when the surface could not be captured, with \a error
+ * giving the reason.
+ */
+
+QT_END_NAMESPACE
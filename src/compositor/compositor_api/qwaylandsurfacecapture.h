@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWAYLANDSURFACECAPTURE_H
+#define QWAYLANDSURFACECAPTURE_H
+
+#include <QtWaylandCompositor/qtwaylandcompositorglobal.h>
+#include <QtWaylandCompositor/qwaylandsurfacegrabber.h>
+#include <QtCore/QObject>
+#include <QtGui/QImage>
+#include <QtGui/QRegion>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandSurface;
+class QWaylandSurfaceCapturePrivate;
+
+class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandSurfaceCapture : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QWaylandSurfaceCapture)
+    Q_PROPERTY(QWaylandSurface *surface READ surface WRITE setSurface NOTIFY surfaceChanged)
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(int bufferCount READ bufferCount WRITE setBufferCount NOTIFY bufferCountChanged)
+public:
+    explicit QWaylandSurfaceCapture(QWaylandSurface *surface = nullptr, QObject *parent = nullptr);
+    ~QWaylandSurfaceCapture() override;
+
+    QWaylandSurface *surface() const;
+    void setSurface(QWaylandSurface *surface);
+
+    bool isActive() const;
+    void setActive(bool active);
+
+    int bufferCount() const;
+    void setBufferCount(int count);
+
+    QImage frame() const;
+
+public Q_SLOTS:
+    void capture();
+
+Q_SIGNALS:
+    void surfaceChanged();
+    void activeChanged();
+    void bufferCountChanged();
+    void frameCaptured(const QImage &image, const QRegion &damage);
+    void failed(QWaylandSurfaceGrabber::Error error);
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDSURFACECAPTURE_H
@@ -56,6 +56,8 @@ QT_BEGIN_NAMESPACE
     to the user. The QWaylandSurfaceGrabber class provides a simple method to do so, without
     having to care what type of buffer backs the surface, be it shared memory, OpenGL or something
     else.
+
+    To follow the content of a surface as it changes, use QWaylandSurfaceCapture instead.
 */
 
 /*!
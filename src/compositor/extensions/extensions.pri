@@ -5,16 +5,20 @@ WAYLANDSERVERSOURCES += \
     ../extensions/touch-extension.xml \
     ../extensions/qt-key-unstable-v1.xml \
     ../extensions/qt-windowmanager.xml \
+    ../extensions/qt-glyph-cache-unstable-v1.xml \
     ../3rdparty/protocol/text-input-unstable-v2.xml \
     ../3rdparty/protocol/xdg-shell-unstable-v5.xml \
     ../3rdparty/protocol/xdg-shell-unstable-v6.xml \
     ../3rdparty/protocol/ivi-application.xml \
+    ../3rdparty/protocol/viewporter.xml \
+    ../3rdparty/protocol/presentation-time.xml \
 
 HEADERS += \
     extensions/qwlqttouch_p.h \
     extensions/qwlqtkey_p.h \
     extensions/qwaylandshell.h \
     extensions/qwaylandshell_p.h \
+    extensions/qwaylandpingmonitor_p.h \
     extensions/qwaylandwlshell.h \
     extensions/qwaylandwlshell_p.h \
     extensions/qwaylandtextinput.h \
@@ -23,6 +27,12 @@ HEADERS += \
     extensions/qwaylandtextinputmanager_p.h \
     extensions/qwaylandqtwindowmanager.h \
     extensions/qwaylandqtwindowmanager_p.h \
+    extensions/qwaylandglyphcache.h \
+    extensions/qwaylandglyphcache_p.h \
+    extensions/qwaylandviewporter.h \
+    extensions/qwaylandviewporter_p.h \
+    extensions/qwaylandpresentationtime.h \
+    extensions/qwaylandpresentationtime_p.h \
     extensions/qwaylandxdgshellv5.h \
     extensions/qwaylandxdgshellv5_p.h \
     extensions/qwaylandxdgshellv6.h \
@@ -37,10 +47,14 @@ SOURCES += \
     extensions/qwlqttouch.cpp \
     extensions/qwlqtkey.cpp \
     extensions/qwaylandshell.cpp \
+    extensions/qwaylandpingmonitor.cpp \
     extensions/qwaylandwlshell.cpp \
     extensions/qwaylandtextinput.cpp \
     extensions/qwaylandtextinputmanager.cpp \
     extensions/qwaylandqtwindowmanager.cpp \
+    extensions/qwaylandglyphcache.cpp \
+    extensions/qwaylandviewporter.cpp \
+    extensions/qwaylandpresentationtime.cpp \
     extensions/qwaylandxdgshellv5.cpp \
     extensions/qwaylandxdgshellv6.cpp \
     extensions/qwaylandshellsurface.cpp \
@@ -0,0 +1,481 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandglyphcache.h"
+#include "qwaylandglyphcache_p.h"
+
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
+#include <QtWaylandCompositor/private/qwlserverbufferintegration_p.h>
+
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/private/qcore_unix_p.h>
+#include <QtGui/QGlyphRun>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtGui/QRawFont>
+
+#include "qwaylandglyphcacheentry_p.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h and linux/fcntl.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC         0x0001U
+#  endif
+#  ifndef MFD_ALLOW_SEALING
+#    define MFD_ALLOW_SEALING   0x0002U
+#  endif
+#  ifndef F_ADD_SEALS
+#    define F_ADD_SEALS         (1024 + 9)
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL         0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK       0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW         0x0004
+#  endif
+#  ifndef F_SEAL_WRITE
+#    define F_SEAL_WRITE        0x0008
+#  endif
+#endif
+
+QT_BEGIN_NAMESPACE
+
+static const int AtlasSize = 1024;
+static const int GlyphPadding = 1;
+
+static int createAnonymousFile()
+{
+    QString path = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (path.isEmpty())
+        return -1;
+
+    QByteArray name = QFile::encodeName(path + QStringLiteral("/qtwayland-XXXXXX"));
+
+    int fd = mkstemp(name.data());
+    if (fd < 0)
+        return -1;
+
+    long flags = fcntl(fd, F_GETFD);
+    if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+        close(fd);
+        fd = -1;
+    }
+    unlink(name.constData());
+
+    return fd;
+}
+
+static int createGlyphFile(const QVector<QWaylandGlyphCacheEntry> &entries)
+{
+    int fd = -1;
+    bool sealable = false;
+#ifdef SYS_memfd_create
+    fd = int(syscall(SYS_memfd_create, "qt-wayland-glyph-cache", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    sealable = fd >= 0;
+#endif
+    if (fd < 0)
+        fd = createAnonymousFile();
+    if (fd < 0)
+        return -1;
+
+    const char *data = reinterpret_cast<const char *>(entries.constData());
+    const size_t size = size_t(entries.size()) * sizeof(QWaylandGlyphCacheEntry);
+    size_t written = 0;
+    while (written < size) {
+        const qint64 n = qt_safe_write(fd, data + written, qint64(size - written));
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        written += size_t(n);
+    }
+
+    // All clients share this file, none of them may change it
+    if (sealable)
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+
+    return fd;
+}
+
+// Printable ASCII and Latin-1, which covers the user interface of most
+// applications well enough to make the first frame cheap
+static QString defaultCharacters()
+{
+    QString characters;
+    for (ushort c = 0x20; c < 0x7f; ++c)
+        characters.append(QChar(c));
+    for (ushort c = 0xa0; c <= 0xff; ++c)
+        characters.append(QChar(c));
+    return characters;
+}
+
+QWaylandGlyphCachePrivate::QWaylandGlyphCachePrivate()
+{
+}
+
+QWaylandGlyphCachePrivate::~QWaylandGlyphCachePrivate()
+{
+    for (const Font &font : qAsConst(fonts))
+        qt_safe_close(font.fd);
+    for (const Atlas &atlas : qAsConst(atlases))
+        delete atlas.buffer;
+}
+
+QtWayland::ServerBufferIntegration *QWaylandGlyphCachePrivate::serverBufferIntegration()
+{
+    Q_Q(QWaylandGlyphCache);
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(q->extensionContainer());
+    if (!compositor) {
+        qWarning() << "Failed to find QWaylandCompositor for QWaylandGlyphCache";
+        return nullptr;
+    }
+
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(compositor)->serverBufferIntegration();
+    if (!integration || !integration->supportsFormat(QtWayland::ServerBuffer::A8)) {
+        qWarning("QWaylandGlyphCache: No server buffer integration supporting A8 buffers");
+        return nullptr;
+    }
+    return integration;
+}
+
+void QWaylandGlyphCachePrivate::sendAtlas(Resource *resource, const Atlas &atlas)
+{
+    // Clients that didn't bind the server buffer integration get no atlases,
+    // every lookup in them then misses and they render locally
+    struct ::wl_resource *buffer = atlas.buffer->resourceForClient(resource->client());
+    if (buffer)
+        send_atlas(resource->handle, atlas.id, buffer);
+}
+
+void QWaylandGlyphCachePrivate::sendFont(Resource *resource, const Font &font)
+{
+    send_font(resource->handle, font.family, font.styleName, font.id, font.pixelSize, font.fd, font.glyphCount);
+}
+
+void QWaylandGlyphCachePrivate::zqt_glyph_cache_v1_bind_resource(Resource *resource)
+{
+    for (const Atlas &atlas : qAsConst(atlases))
+        sendAtlas(resource, atlas);
+    for (const Font &font : qAsConst(fonts))
+        sendFont(resource, font);
+    send_done(resource->handle);
+}
+
+void QWaylandGlyphCachePrivate::zqt_glyph_cache_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+/*!
+ * \qmltype GlyphCache
+ * \inqmlmodule QtWayland.Compositor
+ * \since 5.12
+ * \brief Shares glyphs rendered by the compositor with Qt clients.
+ *
+ * The GlyphCache extension renders the glyphs of the fonts added to it once,
+ * into alpha-only atlases that are shared with clients through the server
+ * buffer integration. Clients look up glyphs of matching fonts in the atlases
+ * instead of rasterizing them again, and render the glyphs that are not in the
+ * cache themselves.
+ *
+ * GlyphCache corresponds to the Wayland \c zqt_glyph_cache_v1 interface.
+ * It requires a server buffer integration supporting A8 buffers, see
+ * \c QT_WAYLAND_SERVER_BUFFER_INTEGRATION.
+ */
+
+/*!
+ * \class QWaylandGlyphCache
+ * \inmodule QtWaylandCompositor
+ * \since 5.12
+ * \brief The QWaylandGlyphCache class shares glyphs rendered by the compositor with Qt clients.
+ *
+ * The QWaylandGlyphCache extension renders the glyphs of the fonts added to it
+ * once, into alpha-only atlases that are shared with clients through the
+ * server buffer integration. Clients look up glyphs of matching fonts in the
+ * atlases instead of rasterizing them again, and render the glyphs that are
+ * not in the cache themselves.
+ *
+ * QWaylandGlyphCache corresponds to the Wayland \c zqt_glyph_cache_v1 interface.
+ */
+
+/*!
+ * Constructs a QWaylandGlyphCache object.
+ */
+QWaylandGlyphCache::QWaylandGlyphCache()
+    : QWaylandCompositorExtensionTemplate<QWaylandGlyphCache>(*new QWaylandGlyphCachePrivate())
+{
+}
+
+/*!
+ * Constructs a QWaylandGlyphCache object for the provided \a compositor.
+ */
+QWaylandGlyphCache::QWaylandGlyphCache(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<QWaylandGlyphCache>(compositor, *new QWaylandGlyphCachePrivate())
+{
+}
+
+/*!
+ * \qmlmethod bool QtWaylandCompositor::GlyphCache::addFont(font font, string characters)
+ *
+ * Renders the glyphs needed for \a characters in \a font and shares them with
+ * clients. If \a characters is empty, printable ASCII and Latin-1 characters
+ * are used. Returns true if the font was added.
+ */
+
+/*!
+ * Renders the glyphs needed for \a characters in \a font and shares them with
+ * clients. If \a characters is empty, printable ASCII and Latin-1 characters
+ * are used. Returns true if the font was added.
+ *
+ * Clients only use the glyphs if they resolve to the same font file and pixel
+ * size, so \a font should match what the clients use, for instance the
+ * platform theme's default fonts.
+ */
+bool QWaylandGlyphCache::addFont(const QFont &font, const QString &characters)
+{
+    const QRawFont rawFont = QRawFont::fromFont(font);
+    if (!rawFont.isValid()) {
+        qWarning() << "QWaylandGlyphCache: Could not resolve" << font;
+        return false;
+    }
+    return addRawFont(rawFont, rawFont.glyphIndexesForString(characters.isEmpty() ? defaultCharacters() : characters));
+}
+
+/*!
+ * Renders \a glyphIndexes of \a font and shares them with clients. Returns
+ * true if the font was added.
+ *
+ * Each font and pixel size can only be added once. Clients only use the glyphs
+ * if their font was loaded from the same version of the same font file, with
+ * the same weight, style and hinting preference.
+ */
+bool QWaylandGlyphCache::addRawFont(const QRawFont &font, const QVector<quint32> &glyphIndexes)
+{
+    Q_D(QWaylandGlyphCache);
+
+    if (!font.isValid())
+        return false;
+
+    const QByteArray id = qWaylandGlyphCacheFontId(font);
+    if (id.isEmpty()) {
+        qWarning() << "QWaylandGlyphCache: Can't identify the font file of" << font.familyName() << font.styleName();
+        return false;
+    }
+
+    const wl_fixed_t pixelSize = wl_fixed_from_double(font.pixelSize());
+    for (const QWaylandGlyphCachePrivate::Font &cached : qAsConst(d->fonts)) {
+        if (cached.pixelSize == pixelSize && cached.id == id) {
+            qWarning() << "QWaylandGlyphCache: Font already added:" << font.familyName() << font.styleName() << font.pixelSize();
+            return false;
+        }
+    }
+
+    QtWayland::ServerBufferIntegration *integration = d->serverBufferIntegration();
+    if (!integration)
+        return false;
+
+    // Clients binary search the table, so it is sorted and without duplicates
+    QVector<quint32> glyphs = glyphIndexes;
+    std::sort(glyphs.begin(), glyphs.end());
+    glyphs.erase(std::unique(glyphs.begin(), glyphs.end()), glyphs.end());
+
+    // Pack the glyphs into rows, starting a new atlas when one is full. The
+    // atlas field holds the index into pages until the atlases exist.
+    QVector<QWaylandGlyphCacheEntry> entries;
+    entries.reserve(glyphs.size());
+    QVector<int> pageHeights;
+    QVector<QRect> rects;
+    rects.reserve(glyphs.size());
+    int x = 0;
+    int y = 0;
+    int rowHeight = 0;
+    for (quint32 glyph : qAsConst(glyphs)) {
+        const QRect rect = font.boundingRect(glyph).toAlignedRect();
+        if (rect.width() > AtlasSize - GlyphPadding || rect.height() > AtlasSize - GlyphPadding)
+            continue;
+
+        if (x + rect.width() + GlyphPadding > AtlasSize) {
+            x = 0;
+            y += rowHeight;
+            rowHeight = 0;
+        }
+        if (pageHeights.isEmpty() || y + rect.height() + GlyphPadding > AtlasSize) {
+            if (!pageHeights.isEmpty())
+                pageHeights.last() = y + rowHeight;
+            pageHeights.append(0);
+            x = 0;
+            y = 0;
+            rowHeight = 0;
+        }
+
+        QWaylandGlyphCacheEntry entry;
+        entry.glyphIndex = glyph;
+        entry.atlas = quint32(pageHeights.size() - 1);
+        entry.x = qint16(x);
+        entry.y = qint16(y);
+        entry.width = quint16(rect.width());
+        entry.height = quint16(rect.height());
+        entry.left = qint16(rect.left());
+        entry.top = qint16(-rect.top());
+        entries.append(entry);
+        rects.append(rect);
+
+        x += rect.width() + GlyphPadding;
+        rowHeight = qMax(rowHeight, rect.height() + GlyphPadding);
+    }
+    if (entries.isEmpty())
+        return false;
+    pageHeights.last() = y + rowHeight;
+
+    QVector<QImage> pages;
+    for (int height : qAsConst(pageHeights)) {
+        QImage page(AtlasSize, qMax(height, 1), QImage::Format_Alpha8);
+        page.fill(Qt::transparent);
+        pages.append(page);
+    }
+
+    // One glyph run per atlas, each glyph placed so its image lands at its slot
+    for (int i = 0; i < pages.size(); ++i) {
+        QVector<quint32> runGlyphs;
+        QVector<QPointF> positions;
+        for (int j = 0; j < entries.size(); ++j) {
+            const QWaylandGlyphCacheEntry &entry = entries.at(j);
+            if (entry.atlas != quint32(i) || entry.width == 0 || entry.height == 0)
+                continue;
+            runGlyphs.append(entry.glyphIndex);
+            positions.append(QPointF(entry.x - rects.at(j).left(), entry.y - rects.at(j).top()));
+        }
+        if (runGlyphs.isEmpty())
+            continue;
+
+        QGlyphRun run;
+        run.setRawFont(font);
+        run.setGlyphIndexes(runGlyphs);
+        run.setPositions(positions);
+
+        QPainter painter(&pages[i]);
+        painter.setPen(Qt::black);
+        painter.drawGlyphRun(QPointF(), run);
+    }
+
+    QVector<QWaylandGlyphCachePrivate::Atlas> newAtlases;
+    for (const QImage &page : qAsConst(pages)) {
+        QtWayland::ServerBuffer *buffer = integration->createServerBufferFromImage(page, QtWayland::ServerBuffer::A8);
+        if (!buffer) {
+            qWarning("QWaylandGlyphCache: Failed to create server buffer for glyph atlas");
+            for (const QWaylandGlyphCachePrivate::Atlas &atlas : qAsConst(newAtlases))
+                delete atlas.buffer;
+            return false;
+        }
+        newAtlases.append({ d->nextAtlasId + uint(newAtlases.size()), buffer });
+    }
+    for (QWaylandGlyphCacheEntry &entry : entries)
+        entry.atlas += d->nextAtlasId;
+
+    const int fd = createGlyphFile(entries);
+    if (fd < 0) {
+        qWarning("QWaylandGlyphCache: Failed to create glyph table");
+        for (const QWaylandGlyphCachePrivate::Atlas &atlas : qAsConst(newAtlases))
+            delete atlas.buffer;
+        return false;
+    }
+
+    d->nextAtlasId += uint(newAtlases.size());
+    d->atlases += newAtlases;
+
+    const QWaylandGlyphCachePrivate::Font cached = { font.familyName(), font.styleName(), id, pixelSize, fd, uint(entries.size()) };
+    d->fonts.append(cached);
+
+    for (QWaylandGlyphCachePrivate::Resource *resource : d->resourceMap()) {
+        for (const QWaylandGlyphCachePrivate::Atlas &atlas : qAsConst(newAtlases))
+            d->sendAtlas(resource, atlas);
+        d->sendFont(resource, cached);
+        d->send_done(resource->handle);
+    }
+
+    return true;
+}
+
+/*!
+ * Initializes the extension.
+ */
+void QWaylandGlyphCache::initialize()
+{
+    Q_D(QWaylandGlyphCache);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qWarning() << "Failed to find QWaylandCompositor when initializing QWaylandGlyphCache";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+/*!
+ * Returns the Wayland interface for the QWaylandGlyphCache.
+ */
+const struct wl_interface *QWaylandGlyphCache::interface()
+{
+    return QWaylandGlyphCachePrivate::interface();
+}
+
+/*!
+ * \internal
+ */
+QByteArray QWaylandGlyphCache::interfaceName()
+{
+    return QWaylandGlyphCachePrivate::interfaceName();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwaylandpingmonitor_p.h"
+
+#include <QtWaylandCompositor/QWaylandClient>
+#include <QtWaylandCompositor/private/qwaylandclient_p.h>
+
+QT_BEGIN_NAMESPACE
+
+QWaylandPingMonitor::QWaylandPingMonitor(QObject *parent)
+    : QObject(parent)
+{
+    connect(&m_timer, &QTimer::timeout, this, &QWaylandPingMonitor::pingClients);
+}
+
+bool QWaylandPingMonitor::setPingInterval(int msecs)
+{
+    msecs = qMax(0, msecs);
+    if (m_pingInterval == msecs)
+        return false;
+
+    m_pingInterval = msecs;
+    if (m_pingInterval > 0) {
+        m_timer.start(m_pingInterval);
+    } else {
+        m_timer.stop();
+        // Nobody is watching anymore, so nobody should be held back either
+        for (auto it = m_pendingPings.cbegin(); it != m_pendingPings.cend(); ++it)
+            QWaylandClientPrivate::get(it.key())->setResponsive(true);
+        m_pendingPings.clear();
+    }
+    return true;
+}
+
+bool QWaylandPingMonitor::setUnresponsiveTimeout(int msecs)
+{
+    msecs = qMax(1, msecs);
+    if (m_unresponsiveTimeout == msecs)
+        return false;
+
+    m_unresponsiveTimeout = msecs;
+    return true;
+}
+
+void QWaylandPingMonitor::handlePong(QWaylandClient *client, uint serial)
+{
+    auto it = m_pendingPings.find(client);
+    if (it == m_pendingPings.end() || it->serial != serial)
+        return;
+
+    QWaylandClientPrivate *clientPrivate = QWaylandClientPrivate::get(client);
+    clientPrivate->recordPingLatency(int(it->elapsed.elapsed()));
+    m_pendingPings.erase(it);
+
+    if (!client->isResponsive()) {
+        clientPrivate->setResponsive(true);
+        emit responsive(client);
+    }
+}
+
+void QWaylandPingMonitor::handlePong(wl_client *client, uint serial)
+{
+    if (m_compositor)
+        handlePong(QWaylandClient::fromWlClient(m_compositor, client), serial);
+}
+
+void QWaylandPingMonitor::pingClients()
+{
+    if (!mappedClients || !sendPing)
+        return;
+
+    const QList<QWaylandClient *> clients = mappedClients();
+    for (QWaylandClient *client : clients) {
+        auto it = m_pendingPings.find(client);
+        if (it == m_pendingPings.end()) {
+            connect(client, &QObject::destroyed, this, &QWaylandPingMonitor::forgetClient, Qt::UniqueConnection);
+            PendingPing ping;
+            ping.serial = sendPing(client);
+            ping.elapsed.start();
+            m_pendingPings.insert(client, ping);
+        } else if (client->isResponsive() && it->elapsed.hasExpired(m_unresponsiveTimeout)) {
+            // Keep waiting for the same ping, its latency is what we want to record
+            QWaylandClientPrivate::get(client)->setResponsive(false);
+            emit unresponsive(client);
+        }
+    }
+}
+
+void QWaylandPingMonitor::forgetClient(QObject *client)
+{
+    m_pendingPings.remove(static_cast<QWaylandClient *>(client));
+}
+
+QT_END_NAMESPACE
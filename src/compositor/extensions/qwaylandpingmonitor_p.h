@@ -0,0 +1,138 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QWAYLANDPINGMONITOR_P_H
+#define QWAYLANDPINGMONITOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtWaylandCompositor/qtwaylandcompositorglobal.h>
+#include <QtWaylandCompositor/QWaylandClient>
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandSurface>
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+// Periodically pings the clients a shell reports as having mapped surfaces, and
+// tracks their round trip latency and responsiveness in QWaylandClient.
+class QWaylandPingMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QWaylandPingMonitor(QObject *parent = nullptr);
+
+    int pingInterval() const { return m_pingInterval; }
+    bool setPingInterval(int msecs);
+
+    int unresponsiveTimeout() const { return m_unresponsiveTimeout; }
+    bool setUnresponsiveTimeout(int msecs);
+
+    // Hooks the monitor up to an xdg shell: clients that have a mapped xdg surface
+    // and the shell bound are pinged with shell->ping(), and the shell's
+    // unresponsive() and responsive() signals are emitted
+    template <typename Shell, typename ShellPrivate>
+    void attach(Shell *shell, const ShellPrivate *d);
+
+    // Called when a ping serial is answered, whether the monitor sent it or not
+    void handlePong(QWaylandClient *client, uint serial);
+    void handlePong(wl_client *client, uint serial);
+
+    std::function<QList<QWaylandClient *>()> mappedClients;
+    std::function<uint(QWaylandClient *)> sendPing;
+
+Q_SIGNALS:
+    void unresponsive(QWaylandClient *client);
+    void responsive(QWaylandClient *client);
+
+private:
+    void pingClients();
+    void forgetClient(QObject *client);
+
+    struct PendingPing {
+        uint serial;
+        QElapsedTimer elapsed;
+    };
+
+    QWaylandCompositor *m_compositor = nullptr;
+    QTimer m_timer;
+    QHash<QWaylandClient *, PendingPing> m_pendingPings;
+    int m_pingInterval = 0;
+    int m_unresponsiveTimeout = 5000;
+};
+
+template <typename Shell, typename ShellPrivate>
+void QWaylandPingMonitor::attach(Shell *shell, const ShellPrivate *d)
+{
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(shell->extensionContainer());
+    m_compositor = compositor;
+    mappedClients = [compositor, d]() {
+        QList<QWaylandClient *> clients;
+        for (auto it = d->m_xdgSurfaces.cbegin(); it != d->m_xdgSurfaces.cend(); ++it) {
+            if (!it.value()->surface()->hasContent() || !d->resourceMap().contains(it.key()))
+                continue;
+            QWaylandClient *client = QWaylandClient::fromWlClient(compositor, it.key());
+            if (!clients.contains(client))
+                clients.append(client);
+        }
+        return clients;
+    };
+    sendPing = [shell](QWaylandClient *client) { return shell->ping(client); };
+    connect(this, &QWaylandPingMonitor::unresponsive, shell, &Shell::unresponsive);
+    connect(this, &QWaylandPingMonitor::responsive, shell, &Shell::responsive);
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDPINGMONITOR_P_H
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwaylandpresentationtime.h"
+#include "qwaylandpresentationtime_p.h"
+
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandSurface>
+#include <QtWaylandCompositor/QWaylandOutput>
+#include <QtWaylandCompositor/private/qwaylandsurface_p.h>
+#include <QtWaylandCompositor/private/qwaylandoutput_p.h>
+
+#include <QtCore/QDebug>
+
+#include <time.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * \qmltype PresentationTime
+ * \inqmlmodule QtWayland.Compositor
+ * \since 5.12
+ * \brief Reports to clients when their content was presented.
+ *
+ * The PresentationTime extension lets clients request feedback on when a
+ * surface content update was shown on an output. The feedback contains the
+ * presentation timestamp, the refresh period of the output and its frame
+ * counter, which clients can use for audio/video synchronization and for
+ * detecting dropped frames. Content updates that are superseded before being
+ * shown, or whose surface is destroyed, are reported as discarded.
+ *
+ * Presentation is reported by WaylandOutput when its window is swapped, with
+ * timestamps taken from the monotonic clock.
+ *
+ * PresentationTime corresponds to the Wayland \c wp_presentation interface.
+ */
+
+/*!
+ * \class QWaylandPresentationTime
+ * \inmodule QtWaylandCompositor
+ * \since 5.12
+ * \brief The QWaylandPresentationTime class reports to clients when their content was presented.
+ *
+ * The QWaylandPresentationTime extension lets clients request feedback on when
+ * a surface content update was shown on an output. The feedback contains the
+ * presentation timestamp, the refresh period of the output and its frame
+ * counter, which clients can use for audio/video synchronization and for
+ * detecting dropped frames. Content updates that are superseded before being
+ * shown, or whose surface is destroyed, are reported as discarded.
+ *
+ * Presentation is reported by QWaylandQuickOutput when its window is swapped,
+ * with timestamps taken from the monotonic clock.
+ *
+ * QWaylandPresentationTime corresponds to the Wayland \c wp_presentation interface.
+ */
+
+/*!
+ * Constructs a QWaylandPresentationTime object.
+ */
+QWaylandPresentationTime::QWaylandPresentationTime()
+    : QWaylandCompositorExtensionTemplate<QWaylandPresentationTime>(*new QWaylandPresentationTimePrivate())
+{
+}
+
+/*!
+ * Constructs a QWaylandPresentationTime object for the provided \a compositor.
+ */
+QWaylandPresentationTime::QWaylandPresentationTime(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<QWaylandPresentationTime>(compositor, *new QWaylandPresentationTimePrivate())
+{
+}
+
+/*!
+ * Initializes the extension.
+ */
+void QWaylandPresentationTime::initialize()
+{
+    Q_D(QWaylandPresentationTime);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qWarning() << "Failed to find QWaylandCompositor when initializing QWaylandPresentationTime";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+/*!
+ * Returns the Wayland interface for the QWaylandPresentationTime.
+ */
+const struct wl_interface *QWaylandPresentationTime::interface()
+{
+    return QWaylandPresentationTimePrivate::interface();
+}
+
+/*!
+ * \internal
+ */
+QByteArray QWaylandPresentationTime::interfaceName()
+{
+    return QWaylandPresentationTimePrivate::interfaceName();
+}
+
+void QWaylandPresentationTimePrivate::wp_presentation_bind_resource(Resource *resource)
+{
+    send_clock_id(resource->handle, CLOCK_MONOTONIC);
+}
+
+void QWaylandPresentationTimePrivate::wp_presentation_destroy(Resource *resource)
+{
+    // Feedback objects are allowed to outlive the presentation object
+    wl_resource_destroy(resource->handle);
+}
+
+void QWaylandPresentationTimePrivate::wp_presentation_feedback(Resource *resource, wl_resource *surfaceResource, uint32_t callback)
+{
+    QWaylandSurface *surface = QWaylandSurface::fromResource(surfaceResource);
+    if (!surface) {
+        qWarning() << "Couldn't find surface for presentation feedback";
+        return;
+    }
+
+    auto *feedback = new Feedback(surface, resource->client(), callback, resource->version());
+    QWaylandSurfacePrivate::get(surface)->pendingPresentationFeedbacks.append(feedback);
+}
+
+QWaylandPresentationTimePrivate::Feedback::Feedback(QWaylandSurface *surface, wl_client *client, int id, int version)
+    : QtWaylandServer::wp_presentation_feedback(client, id, version)
+    , m_surface(surface)
+{
+}
+
+QWaylandPresentationTimePrivate::Feedback::~Feedback()
+{
+    if (m_surface) {
+        QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+        surfacePrivate->pendingPresentationFeedbacks.removeOne(this);
+        surfacePrivate->presentationFeedbacks.removeOne(this);
+    }
+    if (m_output)
+        QWaylandOutputPrivate::get(m_output)->presentationFeedbacks.removeOne(this);
+}
+
+// Called when an output starts a frame showing the content update, the
+// feedback is sent once the frame with the given number has been presented.
+void QWaylandPresentationTimePrivate::Feedback::latch(QWaylandOutput *output, quint64 frame)
+{
+    m_output = output;
+    m_frame = frame;
+}
+
+void QWaylandPresentationTimePrivate::Feedback::sendPresented(qint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags)
+{
+    if (m_output) {
+        QWaylandOutputPrivate *outputPrivate = QWaylandOutputPrivate::get(m_output);
+        const auto outputResources = outputPrivate->resourceMap().values(resource()->client());
+        for (auto *outputResource : outputResources)
+            send_sync_output(outputResource->handle);
+    }
+
+    const quint64 seconds = quint64(timestampNsecs / 1000000000);
+    const uint nanoseconds = uint(timestampNsecs % 1000000000);
+    send_presented(uint(seconds >> 32), uint(seconds & 0xffffffff), nanoseconds, refreshNsecs,
+                   uint(sequence >> 32), uint(sequence & 0xffffffff), flags);
+    wl_resource_destroy(resource()->handle);
+}
+
+void QWaylandPresentationTimePrivate::Feedback::sendDiscarded()
+{
+    send_discarded();
+    wl_resource_destroy(resource()->handle);
+}
+
+void QWaylandPresentationTimePrivate::Feedback::wp_presentation_feedback_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    delete this;
+}
+
+QT_END_NAMESPACE
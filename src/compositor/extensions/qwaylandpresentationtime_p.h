@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QWAYLANDPRESENTATIONTIME_P_H
+#define QWAYLANDPRESENTATIONTIME_P_H
+
+#include <QtCore/QPointer>
+
+#include <QtWaylandCompositor/QWaylandPresentationTime>
+#include <QtWaylandCompositor/private/qwaylandcompositorextension_p.h>
+#include <QtWaylandCompositor/private/qwayland-server-presentation-time.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandSurface;
+class QWaylandOutput;
+
+class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandPresentationTimePrivate
+        : public QWaylandCompositorExtensionPrivate
+        , public QtWaylandServer::wp_presentation
+{
+    Q_DECLARE_PUBLIC(QWaylandPresentationTime)
+public:
+    class Q_WAYLAND_COMPOSITOR_EXPORT Feedback : public QtWaylandServer::wp_presentation_feedback
+    {
+    public:
+        explicit Feedback(QWaylandSurface *surface, wl_client *client, int id, int version);
+        ~Feedback() override;
+
+        void latch(QWaylandOutput *output, quint64 frame);
+        QWaylandOutput *output() const { return m_output; }
+        quint64 frame() const { return m_frame; }
+
+        void sendPresented(qint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags);
+        void sendDiscarded();
+
+    protected:
+        void wp_presentation_feedback_destroy_resource(Resource *resource) override;
+
+    private:
+        QPointer<QWaylandSurface> m_surface;
+        QPointer<QWaylandOutput> m_output;
+        quint64 m_frame = 0;
+    };
+
+    QWaylandPresentationTimePrivate() = default;
+
+protected:
+    void wp_presentation_bind_resource(Resource *resource) override;
+    void wp_presentation_destroy(Resource *resource) override;
+    void wp_presentation_feedback(Resource *resource, wl_resource *surface, uint32_t callback) override;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDPRESENTATIONTIME_P_H
@@ -127,26 +127,16 @@ void QWaylandTextInputPrivate::sendInputMethodEvent(QInputMethodEvent *event)
     if (!focusResource || !focusResource->handle)
         return;
 
-    QWaylandTextInputClientState afterCommit;
-
-    afterCommit.surroundingText = currentState->surroundingText;
-    afterCommit.cursorPosition = qMin(currentState->cursorPosition, currentState->anchorPosition);
-
-    // Remove selection
-    afterCommit.surroundingText.remove(afterCommit.cursorPosition, qAbs(currentState->cursorPosition - currentState->anchorPosition));
+    // The surrounding text is edited in place and the changed queries are derived from
+    // the edit itself, so a keystroke costs the same no matter how long the text is.
+    QString &text = currentState->surroundingText;
+    const int selectionStart = qMin(currentState->cursorPosition, currentState->anchorPosition);
+    const int selectionEnd = qMax(currentState->cursorPosition, currentState->anchorPosition);
 
     if (event->replacementLength() > 0 || event->replacementStart() != 0) {
-        // Remove replacement
-        afterCommit.cursorPosition = qBound(0, afterCommit.cursorPosition + event->replacementStart(), afterCommit.surroundingText.length());
-        afterCommit.surroundingText.remove(afterCommit.cursorPosition,
-                                           qMin(event->replacementLength(),
-                                                afterCommit.surroundingText.length() - afterCommit.cursorPosition));
-
         if (event->replacementStart() <= 0 && (event->replacementLength() >= -event->replacementStart())) {
-            const int selectionStart = qMin(currentState->cursorPosition, currentState->anchorPosition);
-            const int selectionEnd = qMax(currentState->cursorPosition, currentState->anchorPosition);
-            const int before = QWaylandInputMethodEventBuilder::indexToWayland(currentState->surroundingText, -event->replacementStart(), selectionStart + event->replacementStart());
-            const int after = QWaylandInputMethodEventBuilder::indexToWayland(currentState->surroundingText, event->replacementLength() + event->replacementStart(), selectionEnd);
+            const int before = QWaylandInputMethodEventBuilder::indexToWayland(text, -event->replacementStart(), selectionStart + event->replacementStart());
+            const int after = QWaylandInputMethodEventBuilder::indexToWayland(text, event->replacementLength() + event->replacementStart(), selectionEnd);
             send_delete_surrounding_text(focusResource->handle, before, after);
         } else {
             // TODO: Implement this case
@@ -154,20 +144,34 @@ void QWaylandTextInputPrivate::sendInputMethodEvent(QInputMethodEvent *event)
         }
     }
 
+    // Remove selection
+    text.remove(selectionStart, selectionEnd - selectionStart);
+    bool textChanged = selectionEnd > selectionStart;
+    int cursorPosition = selectionStart;
+
+    if (event->replacementLength() > 0 || event->replacementStart() != 0) {
+        // Remove replacement
+        cursorPosition = qBound(0, cursorPosition + event->replacementStart(), text.length());
+        const int removed = qMin(event->replacementLength(), text.length() - cursorPosition);
+        text.remove(cursorPosition, removed);
+        textChanged |= removed > 0;
+    }
+
     // Insert commit string
-    afterCommit.surroundingText.insert(afterCommit.cursorPosition, event->commitString());
-    afterCommit.cursorPosition += event->commitString().length();
-    afterCommit.anchorPosition = afterCommit.cursorPosition;
+    text.insert(cursorPosition, event->commitString());
+    textChanged |= !event->commitString().isEmpty();
+    cursorPosition += event->commitString().length();
+    int anchorPosition = cursorPosition;
 
     foreach (const QInputMethodEvent::Attribute &attribute, event->attributes()) {
         if (attribute.type == QInputMethodEvent::Selection) {
-            afterCommit.cursorPosition = attribute.start;
-            afterCommit.anchorPosition = attribute.length;
-            int cursor = QWaylandInputMethodEventBuilder::indexToWayland(afterCommit.surroundingText, qAbs(attribute.start - afterCommit.cursorPosition), qMin(attribute.start, afterCommit.cursorPosition));
-            int anchor = QWaylandInputMethodEventBuilder::indexToWayland(afterCommit.surroundingText, qAbs(attribute.length - afterCommit.cursorPosition), qMin(attribute.length, afterCommit.cursorPosition));
+            int cursor = QWaylandInputMethodEventBuilder::indexToWayland(text, qAbs(attribute.start - cursorPosition), qMin(attribute.start, cursorPosition));
+            int anchor = QWaylandInputMethodEventBuilder::indexToWayland(text, qAbs(attribute.length - cursorPosition), qMin(attribute.length, cursorPosition));
             send_cursor_position(focusResource->handle,
-                                 attribute.start < afterCommit.cursorPosition ? -cursor : cursor,
-                                 attribute.length < afterCommit.cursorPosition ? -anchor : anchor);
+                                 attribute.start < cursorPosition ? -cursor : cursor,
+                                 attribute.length < cursorPosition ? -anchor : anchor);
+            cursorPosition = attribute.start;
+            anchorPosition = attribute.length;
         }
     }
     send_commit_string(focusResource->handle, event->commitString());
@@ -184,10 +188,15 @@ void QWaylandTextInputPrivate::sendInputMethodEvent(QInputMethodEvent *event)
     }
     send_preedit_string(focusResource->handle, event->preeditString(), event->preeditString());
 
-    Qt::InputMethodQueries queries = currentState->updatedQueries(afterCommit);
-    currentState->surroundingText = afterCommit.surroundingText;
-    currentState->cursorPosition = afterCommit.cursorPosition;
-    currentState->anchorPosition = afterCommit.anchorPosition;
+    Qt::InputMethodQueries queries;
+    if (textChanged)
+        queries |= Qt::ImSurroundingText | Qt::ImCurrentSelection;
+    if (cursorPosition != currentState->cursorPosition)
+        queries |= Qt::ImCursorPosition | Qt::ImCurrentSelection;
+    if (anchorPosition != currentState->anchorPosition)
+        queries |= Qt::ImAnchorPosition | Qt::ImCurrentSelection;
+    currentState->cursorPosition = cursorPosition;
+    currentState->anchorPosition = anchorPosition;
 
     if (queries) {
         qCDebug(qLcCompositorInputMethods) << "QInputMethod::update() after QInputMethodEvent" << queries;
@@ -0,0 +1,266 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandviewporter.h"
+#include "qwaylandviewporter_p.h"
+
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandSurface>
+#include <QtWaylandCompositor/private/qwaylandsurface_p.h>
+
+#include <QtCore/QDebug>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+ * \qmltype Viewporter
+ * \inqmlmodule QtWayland.Compositor
+ * \since 5.12
+ * \brief Lets clients crop and scale their surfaces.
+ *
+ * The Viewporter extension lets clients specify which part of a buffer is
+ * displayed, and at which size, independently of the buffer size. Clients
+ * can use it to render at a reduced resolution and let the compositor scale
+ * the content up, or to crop content without copying it.
+ *
+ * The resulting crop and scale state is available in the
+ * \l {WaylandSurface::sourceGeometry}{sourceGeometry} and
+ * \l {WaylandSurface::destinationSize}{destinationSize} properties of the
+ * surface, and is applied by WaylandQuickItem.
+ *
+ * Viewporter corresponds to the Wayland \c wp_viewporter interface.
+ */
+
+/*!
+ * \class QWaylandViewporter
+ * \inmodule QtWaylandCompositor
+ * \since 5.12
+ * \brief The QWaylandViewporter class lets clients crop and scale their surfaces.
+ *
+ * The QWaylandViewporter extension lets clients specify which part of a buffer
+ * is displayed, and at which size, independently of the buffer size. Clients
+ * can use it to render at a reduced resolution and let the compositor scale
+ * the content up, or to crop content without copying it.
+ *
+ * The resulting crop and scale state is available from
+ * QWaylandSurface::sourceGeometry() and QWaylandSurface::destinationSize(),
+ * and is applied by QWaylandQuickItem.
+ *
+ * QWaylandViewporter corresponds to the Wayland \c wp_viewporter interface.
+ */
+
+/*!
+ * Constructs a QWaylandViewporter object.
+ */
+QWaylandViewporter::QWaylandViewporter()
+    : QWaylandCompositorExtensionTemplate<QWaylandViewporter>(*new QWaylandViewporterPrivate())
+{
+}
+
+/*!
+ * Constructs a QWaylandViewporter object for the provided \a compositor.
+ */
+QWaylandViewporter::QWaylandViewporter(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<QWaylandViewporter>(compositor, *new QWaylandViewporterPrivate())
+{
+}
+
+/*!
+ * Initializes the extension.
+ */
+void QWaylandViewporter::initialize()
+{
+    Q_D(QWaylandViewporter);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qWarning() << "Failed to find QWaylandCompositor when initializing QWaylandViewporter";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+/*!
+ * Returns the Wayland interface for the QWaylandViewporter.
+ */
+const struct wl_interface *QWaylandViewporter::interface()
+{
+    return QWaylandViewporterPrivate::interface();
+}
+
+/*!
+ * \internal
+ */
+QByteArray QWaylandViewporter::interfaceName()
+{
+    return QWaylandViewporterPrivate::interfaceName();
+}
+
+void QWaylandViewporterPrivate::wp_viewporter_destroy(Resource *resource)
+{
+    // Viewport objects are allowed to outlive the viewporter
+    wl_resource_destroy(resource->handle);
+}
+
+void QWaylandViewporterPrivate::wp_viewporter_get_viewport(Resource *resource, uint32_t id, wl_resource *surfaceResource)
+{
+    QWaylandSurface *surface = QWaylandSurface::fromResource(surfaceResource);
+    if (!surface) {
+        qWarning() << "Couldn't find surface for viewporter";
+        return;
+    }
+
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(surface);
+    if (surfacePrivate->viewport) {
+        wl_resource_post_error(resource->handle, WP_VIEWPORTER_ERROR_VIEWPORT_EXISTS,
+                               "viewport already exists for surface");
+        return;
+    }
+
+    surfacePrivate->viewport = new Viewport(surface, resource->client(), id, resource->version());
+}
+
+QWaylandViewporterPrivate::Viewport::Viewport(QWaylandSurface *surface, wl_client *client, int id, int version)
+    : QtWaylandServer::wp_viewport(client, id, version)
+    , m_surface(surface)
+{
+}
+
+QWaylandViewporterPrivate::Viewport::~Viewport()
+{
+    if (m_surface) {
+        QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+        Q_ASSERT(surfacePrivate->viewport == this);
+        surfacePrivate->viewport = nullptr;
+        // The crop and scale state is removed on the next commit
+        surfacePrivate->pending.sourceGeometry = QRectF();
+        surfacePrivate->pending.destinationSize = QSize();
+    }
+}
+
+// Called when the surface state is applied, with the size of the buffer in
+// surface coordinates.
+void QWaylandViewporterPrivate::Viewport::checkCommittedState(const QSizeF &contentSize)
+{
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+    const QRectF source = surfacePrivate->pending.sourceGeometry;
+    const QSize destination = surfacePrivate->pending.destinationSize;
+
+    if (!source.isValid())
+        return;
+
+    if (!destination.isValid() && source.size() != QSizeF(source.size().toSize())) {
+        wl_resource_post_error(resource()->handle, error_bad_size,
+                               "non-integer source size (%f, %f) without a destination size",
+                               source.width(), source.height());
+        return;
+    }
+
+    if (!QRectF(QPointF(), contentSize).contains(source)) {
+        wl_resource_post_error(resource()->handle, error_out_of_buffer,
+                               "source rectangle (%f, %f, %f, %f) extends outside of the buffer (%f, %f)",
+                               source.x(), source.y(), source.width(), source.height(),
+                               contentSize.width(), contentSize.height());
+    }
+}
+
+void QWaylandViewporterPrivate::Viewport::wp_viewport_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    delete this;
+}
+
+void QWaylandViewporterPrivate::Viewport::wp_viewport_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void QWaylandViewporterPrivate::Viewport::wp_viewport_set_source(Resource *resource, wl_fixed_t x, wl_fixed_t y, wl_fixed_t width, wl_fixed_t height)
+{
+    if (!m_surface) {
+        wl_resource_post_error(resource->handle, error_no_surface,
+                               "set_source requested for destroyed surface");
+        return;
+    }
+
+    const QRectF source(wl_fixed_to_double(x), wl_fixed_to_double(y),
+                        wl_fixed_to_double(width), wl_fixed_to_double(height));
+
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+    if (source == QRectF(-1, -1, -1, -1)) {
+        surfacePrivate->pending.sourceGeometry = QRectF();
+        return;
+    }
+
+    if (source.x() < 0 || source.y() < 0 || source.width() <= 0 || source.height() <= 0) {
+        wl_resource_post_error(resource->handle, error_bad_value,
+                               "invalid source rectangle (%f, %f, %f, %f)",
+                               source.x(), source.y(), source.width(), source.height());
+        return;
+    }
+
+    surfacePrivate->pending.sourceGeometry = source;
+}
+
+void QWaylandViewporterPrivate::Viewport::wp_viewport_set_destination(Resource *resource, int32_t width, int32_t height)
+{
+    if (!m_surface) {
+        wl_resource_post_error(resource->handle, error_no_surface,
+                               "set_destination requested for destroyed surface");
+        return;
+    }
+
+    QWaylandSurfacePrivate *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+    if (width == -1 && height == -1) {
+        surfacePrivate->pending.destinationSize = QSize();
+        return;
+    }
+
+    if (width <= 0 || height <= 0) {
+        wl_resource_post_error(resource->handle, error_bad_value,
+                               "invalid destination size (%d, %d)", width, height);
+        return;
+    }
+
+    surfacePrivate->pending.destinationSize = QSize(width, height);
+}
+
+QT_END_NAMESPACE
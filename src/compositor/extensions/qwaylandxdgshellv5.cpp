@@ -48,6 +48,7 @@
 #include <QtWaylandCompositor/QWaylandSurface>
 #include <QtWaylandCompositor/QWaylandSurfaceRole>
 #include <QtWaylandCompositor/QWaylandResource>
+#include <QtWaylandCompositor/QWaylandClient>
 #include <QtWaylandCompositor/QWaylandSeat>
 
 #include <QtCore/QObject>
@@ -212,12 +213,13 @@ void QWaylandXdgShellV5Private::xdg_shell_get_xdg_popup(Resource *resource, uint
 
 void QWaylandXdgShellV5Private::xdg_shell_pong(Resource *resource, uint32_t serial)
 {
-    Q_UNUSED(resource);
     Q_Q(QWaylandXdgShellV5);
-    if (m_pings.remove(serial))
+    if (m_pings.remove(serial)) {
+        m_pingMonitor.handlePong(resource->client(), serial);
         emit q->pong(serial);
-    else
+    } else {
         qWarning("Received an unexpected pong!");
+    }
 }
 
 QWaylandXdgSurfaceV5Private::QWaylandXdgSurfaceV5Private()
@@ -409,6 +411,10 @@ void QWaylandXdgSurfaceV5Private::xdg_surface_ack_configure(Resource *resource,
 
         config = m_pendingConfigures.takeFirst();
 
+        // Acking a later configure implicitly acks the resize in flight as well
+        if (config.serial == m_resizeSerialInFlight)
+            m_resizeAcked = true;
+
         if (config.serial == serial)
             break;
     }
@@ -568,6 +574,64 @@ void QWaylandXdgShellV5::initialize()
 
     connect(compositor, &QWaylandCompositor::defaultSeatChanged,
             this, &QWaylandXdgShellV5::handleSeatChanged);
+
+    d->m_pingMonitor.attach(this, d);
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::XdgShellV5::pingInterval
+ * \since 5.12
+ *
+ * This property holds the interval in milliseconds at which clients are pinged.
+ * See XdgShellV6::pingInterval.
+ */
+
+/*!
+ * \property QWaylandXdgShellV5::pingInterval
+ * \since 5.12
+ *
+ * This property holds the interval in milliseconds at which clients are pinged.
+ * See QWaylandXdgShellV6::pingInterval.
+ */
+int QWaylandXdgShellV5::pingInterval() const
+{
+    Q_D(const QWaylandXdgShellV5);
+    return d->m_pingMonitor.pingInterval();
+}
+
+void QWaylandXdgShellV5::setPingInterval(int msecs)
+{
+    Q_D(QWaylandXdgShellV5);
+    if (d->m_pingMonitor.setPingInterval(msecs))
+        emit pingIntervalChanged();
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::XdgShellV5::unresponsiveTimeout
+ * \since 5.12
+ *
+ * This property holds how long a client may take to answer a ping.
+ * See XdgShellV6::unresponsiveTimeout.
+ */
+
+/*!
+ * \property QWaylandXdgShellV5::unresponsiveTimeout
+ * \since 5.12
+ *
+ * This property holds how long a client may take to answer a ping.
+ * See QWaylandXdgShellV6::unresponsiveTimeout.
+ */
+int QWaylandXdgShellV5::unresponsiveTimeout() const
+{
+    Q_D(const QWaylandXdgShellV5);
+    return d->m_pingMonitor.unresponsiveTimeout();
+}
+
+void QWaylandXdgShellV5::setUnresponsiveTimeout(int msecs)
+{
+    Q_D(QWaylandXdgShellV5);
+    if (d->m_pingMonitor.setUnresponsiveTimeout(msecs))
+        emit unresponsiveTimeoutChanged();
 }
 
 QWaylandClient *QWaylandXdgShellV5::popupClient() const
@@ -724,6 +788,34 @@ void QWaylandXdgShellV5::closeAllPopups()
  * \sa QWaylandXdgShellV5::ping()
  */
 
+/*!
+ * \qmlsignal void QtWaylandCompositor::XdgShellV5::unresponsive(WaylandClient client)
+ * \since 5.12
+ *
+ * See XdgShellV6::unresponsive().
+ */
+
+/*!
+ * \fn void QWaylandXdgShellV5::unresponsive(QWaylandClient *client)
+ * \since 5.12
+ *
+ * See QWaylandXdgShellV6::unresponsive().
+ */
+
+/*!
+ * \qmlsignal void QtWaylandCompositor::XdgShellV5::responsive(WaylandClient client)
+ * \since 5.12
+ *
+ * See XdgShellV6::responsive().
+ */
+
+/*!
+ * \fn void QWaylandXdgShellV5::responsive(QWaylandClient *client)
+ * \since 5.12
+ *
+ * See QWaylandXdgShellV6::responsive().
+ */
+
 void QWaylandXdgShellV5::handleSeatChanged(QWaylandSeat *newSeat, QWaylandSeat *oldSeat)
 {
     if (oldSeat != nullptr) {
@@ -831,6 +923,7 @@ void QWaylandXdgSurfaceV5::initialize(QWaylandXdgShellV5 *xdgShell, QWaylandSurf
     d->m_windowGeometry = d->calculateFallbackWindowGeometry();
     connect(surface, &QWaylandSurface::sizeChanged, this, &QWaylandXdgSurfaceV5::handleSurfaceSizeChanged);
     connect(surface, &QWaylandSurface::bufferScaleChanged, this, &QWaylandXdgSurfaceV5::handleBufferScaleChanged);
+    connect(surface, &QWaylandSurface::redraw, this, &QWaylandXdgSurfaceV5::handleSurfaceCommitted);
     emit shellChanged();
     emit surfaceChanged();
     emit windowGeometryChanged();
@@ -994,6 +1087,19 @@ void QWaylandXdgSurfaceV5::handleBufferScaleChanged()
     d->updateFallbackWindowGeometry();
 }
 
+void QWaylandXdgSurfaceV5::handleSurfaceCommitted()
+{
+    Q_D(QWaylandXdgSurfaceV5);
+    if (!d->m_resizeSerialInFlight || !d->m_resizeAcked)
+        return;
+
+    // The client has caught up with the resize in flight, send it the latest size
+    d->m_resizeSerialInFlight = 0;
+    d->m_resizeAcked = false;
+    if (d->m_hasDeferredResize)
+        sendResizing(d->m_deferredResizeSize);
+}
+
 /*!
  * \qmlproperty XdgShellV5 QtWaylandCompositor::XdgSurfaceV5::shell
  *
@@ -1158,6 +1264,54 @@ QByteArray QWaylandXdgSurfaceV5::interfaceName()
     return QWaylandXdgSurfaceV5Private::interfaceName();
 }
 
+/*!
+ * \enum QWaylandXdgSurfaceV5::ResizePacing
+ *
+ * This enum type is used to specify how configure events sent with sendResizing() are paced.
+ * It works like QWaylandXdgToplevelV6::ResizePacing.
+ *
+ * \value SendImmediately Every call to sendResizing() sends a configure event right away.
+ * \value WaitForCommit Sizes are coalesced while a resizing configure event is in flight.
+ */
+
+/*!
+ * \qmlproperty enumeration QtWaylandCompositor::XdgSurfaceV5::resizePacing
+ *
+ * This property holds how configure events sent during an interactive resize are paced,
+ * see XdgToplevelV6::resizePacing. The default is XdgSurfaceV5.SendImmediately.
+ * ShellSurfaceItem uses XdgSurfaceV5.WaitForCommit while it resizes the surface interactively.
+ */
+
+/*!
+ * \property QWaylandXdgSurfaceV5::resizePacing
+ *
+ * This property holds how configure events sent with sendResizing() are paced, see
+ * QWaylandXdgToplevelV6::resizePacing. The default is QWaylandXdgSurfaceV5::SendImmediately.
+ * QWaylandQuickShellSurfaceItem uses QWaylandXdgSurfaceV5::WaitForCommit while it resizes
+ * the surface interactively.
+ */
+QWaylandXdgSurfaceV5::ResizePacing QWaylandXdgSurfaceV5::resizePacing() const
+{
+    Q_D(const QWaylandXdgSurfaceV5);
+    return d->m_resizePacing;
+}
+
+void QWaylandXdgSurfaceV5::setResizePacing(QWaylandXdgSurfaceV5::ResizePacing pacing)
+{
+    Q_D(QWaylandXdgSurfaceV5);
+    if (d->m_resizePacing == pacing)
+        return;
+
+    d->m_resizePacing = pacing;
+    emit resizePacingChanged();
+
+    if (pacing == SendImmediately) {
+        d->m_resizeSerialInFlight = 0;
+        if (d->m_hasDeferredResize)
+            sendResizing(d->m_deferredResizeSize);
+    }
+}
+
 /*!
  * Returns the surface role for the QWaylandXdgSurfaceV5.
  */
@@ -1220,6 +1374,9 @@ uint QWaylandXdgSurfaceV5::sendConfigure(const QSize &size, const QVector<uint>
     QWaylandCompositor *compositor = surface->compositor();
     Q_ASSERT(compositor);
     uint32_t serial = compositor->nextSerial();
+    // Leaving the resizing state supersedes a resize we are still holding back
+    if (!states.contains(QWaylandXdgSurfaceV5::State::ResizingState))
+        d->m_hasDeferredResize = false;
     d->m_pendingConfigures.append(QWaylandXdgSurfaceV5Private::ConfigureEvent{states, size, serial});
     d->send_configure(size.width(), size.height(), statesBytes, serial);
     return serial;
@@ -1290,6 +1447,12 @@ uint QWaylandXdgSurfaceV5::sendFullscreen(const QSize &size)
 uint QWaylandXdgSurfaceV5::sendResizing(const QSize &maxSize)
 {
     Q_D(QWaylandXdgSurfaceV5);
+    if (d->m_resizePacing == WaitForCommit && d->m_resizeSerialInFlight) {
+        d->m_deferredResizeSize = maxSize;
+        d->m_hasDeferredResize = true;
+        return 0;
+    }
+
     QWaylandXdgSurfaceV5Private::ConfigureEvent conf = d->lastSentConfigure();
 
     if (!conf.states.contains(QWaylandXdgSurfaceV5::State::ResizingState))
@@ -1297,7 +1460,13 @@ uint QWaylandXdgSurfaceV5::sendResizing(const QSize &maxSize)
     conf.states.removeOne(QWaylandXdgSurfaceV5::State::MaximizedState);
     conf.states.removeOne(QWaylandXdgSurfaceV5::State::FullscreenState);
 
-    return sendConfigure(maxSize, conf.states);
+    uint serial = sendConfigure(maxSize, conf.states);
+    d->m_hasDeferredResize = false;
+    if (d->m_resizePacing == WaitForCommit && serial) {
+        d->m_resizeSerialInFlight = serial;
+        d->m_resizeAcked = false;
+    }
+    return serial;
 }
 
 #ifdef QT_WAYLAND_COMPOSITOR_QUICK
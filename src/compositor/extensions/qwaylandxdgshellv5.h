@@ -67,6 +67,8 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandXdgShellV5 : public QWaylandShellTempl
 {
     Q_OBJECT
     Q_DECLARE_PRIVATE(QWaylandXdgShellV5)
+    Q_PROPERTY(int pingInterval READ pingInterval WRITE setPingInterval NOTIFY pingIntervalChanged)
+    Q_PROPERTY(int unresponsiveTimeout READ unresponsiveTimeout WRITE setUnresponsiveTimeout NOTIFY unresponsiveTimeoutChanged)
 public:
     QWaylandXdgShellV5();
     QWaylandXdgShellV5(QWaylandCompositor *compositor);
@@ -77,6 +79,11 @@ public:
     static const struct wl_interface *interface();
     static QByteArray interfaceName();
 
+    int pingInterval() const;
+    void setPingInterval(int msecs);
+    int unresponsiveTimeout() const;
+    void setUnresponsiveTimeout(int msecs);
+
 public Q_SLOTS:
     uint ping(QWaylandClient *client);
     void closeAllPopups();
@@ -87,6 +94,10 @@ Q_SIGNALS:
     void xdgPopupCreated(QWaylandXdgPopupV5 *xdgPopup);
     void xdgPopupRequested(QWaylandSurface *surface, QWaylandSurface *parent, QWaylandSeat *seat, const QPoint &position, const QWaylandResource &resource);
     void pong(uint serial);
+    void pingIntervalChanged();
+    void unresponsiveTimeoutChanged();
+    void unresponsive(QWaylandClient *client);
+    void responsive(QWaylandClient *client);
 
 private Q_SLOTS:
     void handleSeatChanged(QWaylandSeat *newSeat, QWaylandSeat *oldSeat);
@@ -110,6 +121,7 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandXdgSurfaceV5 : public QWaylandShellSur
     Q_PROPERTY(bool fullscreen READ fullscreen NOTIFY fullscreenChanged)
     Q_PROPERTY(bool resizing READ resizing NOTIFY resizingChanged)
     Q_PROPERTY(bool activated READ activated NOTIFY activatedChanged)
+    Q_PROPERTY(ResizePacing resizePacing READ resizePacing WRITE setResizePacing NOTIFY resizePacingChanged)
 
 public:
     enum State : uint {
@@ -133,6 +145,12 @@ public:
     };
     Q_ENUM(ResizeEdge)
 
+    enum ResizePacing {
+        SendImmediately,
+        WaitForCommit
+    };
+    Q_ENUM(ResizePacing)
+
     QWaylandXdgSurfaceV5();
     QWaylandXdgSurfaceV5(QWaylandXdgShellV5* xdgShell, QWaylandSurface *surface, const QWaylandResource &resource);
 
@@ -149,6 +167,9 @@ public:
     bool resizing() const;
     bool activated() const;
 
+    ResizePacing resizePacing() const;
+    void setResizePacing(ResizePacing pacing);
+
     QWaylandXdgShellV5 *shell() const;
 
     QWaylandSurface *surface() const;
@@ -186,6 +207,7 @@ Q_SIGNALS:
     void fullscreenChanged();
     void resizingChanged();
     void activatedChanged();
+    void resizePacingChanged();
 
     void showWindowMenu(QWaylandSeat *seat, const QPoint &localSurfacePosition);
     void startMove(QWaylandSeat *seat);
@@ -206,6 +228,7 @@ private:
 private Q_SLOTS:
     void handleSurfaceSizeChanged();
     void handleBufferScaleChanged();
+    void handleSurfaceCommitted();
 };
 
 class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandXdgPopupV5 : public QWaylandShellSurfaceTemplate<QWaylandXdgPopupV5>
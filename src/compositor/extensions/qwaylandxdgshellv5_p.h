@@ -44,6 +44,7 @@
 #include <QtWaylandCompositor/private/qwayland-server-xdg-shell-unstable-v5.h>
 
 #include <QtWaylandCompositor/QWaylandXdgShellV5>
+#include <QtWaylandCompositor/private/qwaylandpingmonitor_p.h>
 
 #include <QtCore/QSet>
 
@@ -77,6 +78,7 @@ public:
     QWaylandXdgPopupV5 *topmostPopupForClient(struct wl_client* client) const;
 
     QSet<uint32_t> m_pings;
+    QWaylandPingMonitor m_pingMonitor;
     QMultiMap<struct wl_client *, QWaylandXdgSurfaceV5 *> m_xdgSurfaces;
     QMultiMap<struct wl_client *, QWaylandXdgPopupV5 *> m_xdgPopups;
 
@@ -131,6 +133,14 @@ private:
     ConfigureEvent m_lastAckedConfigure;
     ConfigureEvent lastSentConfigure() const { return m_pendingConfigures.empty() ? m_lastAckedConfigure : m_pendingConfigures.first(); }
 
+    // Interactive resizes keep at most one resizing configure in flight, until
+    // the client has acked and committed it. Newer sizes replace the deferred one.
+    QWaylandXdgSurfaceV5::ResizePacing m_resizePacing = QWaylandXdgSurfaceV5::SendImmediately;
+    uint m_resizeSerialInFlight = 0;
+    bool m_resizeAcked = false;
+    bool m_hasDeferredResize = false;
+    QSize m_deferredResizeSize;
+
     void xdg_surface_destroy_resource(Resource *resource) override;
 
     void xdg_surface_destroy(Resource *resource) override;
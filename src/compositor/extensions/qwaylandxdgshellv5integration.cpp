@@ -115,6 +115,8 @@ bool XdgShellV5Integration::mouseReleaseEvent(QMouseEvent *event)
     Q_UNUSED(event);
 
     if (grabberState == GrabberState::Resize) {
+        // Sends the latest size if it was held back
+        m_xdgSurface->setResizePacing(resizeState.resizePacing);
         m_xdgSurface->sendUnmaximized();
         grabberState = GrabberState::Default;
         return true;
@@ -134,6 +136,8 @@ void XdgShellV5Integration::handleStartMove(QWaylandSeat *seat)
 
 void XdgShellV5Integration::handleStartResize(QWaylandSeat *seat, QWaylandXdgSurfaceV5::ResizeEdge edges)
 {
+    if (grabberState != GrabberState::Resize)
+        resizeState.resizePacing = m_xdgSurface->resizePacing();
     grabberState = GrabberState::Resize;
     resizeState.seat = seat;
     resizeState.resizeEdges = edges;
@@ -141,6 +145,9 @@ void XdgShellV5Integration::handleStartResize(QWaylandSeat *seat, QWaylandXdgSur
     resizeState.initialPosition = m_item->moveItem()->position();
     resizeState.initialSurfaceSize = m_item->surface()->size();
     resizeState.initialized = false;
+
+    // Follow the pointer no faster than the client can keep up with
+    m_xdgSurface->setResizePacing(QWaylandXdgSurfaceV5::WaitForCommit);
 }
 
 void XdgShellV5Integration::handleSetTopLevel()
@@ -101,6 +101,7 @@ private:
         QPointF initialMousePos;
         QPointF initialPosition;
         QSize initialSurfaceSize;
+        QWaylandXdgSurfaceV5::ResizePacing resizePacing;
         bool initialized;
     } resizeState;
 
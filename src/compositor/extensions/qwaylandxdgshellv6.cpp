@@ -42,6 +42,7 @@
 #endif
 
 #include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandClient>
 #include <QtWaylandCompositor/QWaylandSeat>
 #include <QtWaylandCompositor/QWaylandSurface>
 #include <QtWaylandCompositor/QWaylandSurfaceRole>
@@ -135,12 +136,13 @@ void QWaylandXdgShellV6Private::zxdg_shell_v6_get_xdg_surface(Resource *resource
 
 void QWaylandXdgShellV6Private::zxdg_shell_v6_pong(Resource *resource, uint32_t serial)
 {
-    Q_UNUSED(resource);
     Q_Q(QWaylandXdgShellV6);
-    if (m_pings.remove(serial))
+    if (m_pings.remove(serial)) {
+        m_pingMonitor.handlePong(resource->client(), serial);
         emit q->pong(serial);
-    else
+    } else {
         qWarning("Received an unexpected pong!");
+    }
 }
 
 /*!
@@ -216,6 +218,80 @@ void QWaylandXdgShellV6::initialize()
 
     connect(compositor, &QWaylandCompositor::defaultSeatChanged,
             this, &QWaylandXdgShellV6::handleSeatChanged);
+
+    d->m_pingMonitor.attach(this, d);
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::XdgShellV6::pingInterval
+ * \since 5.12
+ *
+ * This property holds the interval in milliseconds at which clients with mapped
+ * surfaces are sent ping events to monitor their responsiveness. The round trip
+ * times are collected in WaylandClient::pingLatency.
+ *
+ * The default is 0, which disables responsiveness monitoring.
+ *
+ * \sa unresponsiveTimeout, unresponsive()
+ */
+
+/*!
+ * \property QWaylandXdgShellV6::pingInterval
+ * \since 5.12
+ *
+ * This property holds the interval in milliseconds at which clients with mapped
+ * surfaces are sent ping events to monitor their responsiveness. The round trip
+ * times are collected in QWaylandClient::pingLatencyHistogram().
+ *
+ * The default is 0, which disables responsiveness monitoring.
+ *
+ * \sa unresponsiveTimeout, unresponsive()
+ */
+int QWaylandXdgShellV6::pingInterval() const
+{
+    Q_D(const QWaylandXdgShellV6);
+    return d->m_pingMonitor.pingInterval();
+}
+
+void QWaylandXdgShellV6::setPingInterval(int msecs)
+{
+    Q_D(QWaylandXdgShellV6);
+    if (d->m_pingMonitor.setPingInterval(msecs))
+        emit pingIntervalChanged();
+}
+
+/*!
+ * \qmlproperty int QtWaylandCompositor::XdgShellV6::unresponsiveTimeout
+ * \since 5.12
+ *
+ * This property holds how long in milliseconds a client may take to answer a ping
+ * event before it is considered unresponsive. The timeout is checked whenever the
+ * next ping would be due.
+ *
+ * The default is 5000.
+ */
+
+/*!
+ * \property QWaylandXdgShellV6::unresponsiveTimeout
+ * \since 5.12
+ *
+ * This property holds how long in milliseconds a client may take to answer a ping
+ * event before it is considered unresponsive. The timeout is checked whenever the
+ * next ping would be due, see \l pingInterval.
+ *
+ * The default is 5000.
+ */
+int QWaylandXdgShellV6::unresponsiveTimeout() const
+{
+    Q_D(const QWaylandXdgShellV6);
+    return d->m_pingMonitor.unresponsiveTimeout();
+}
+
+void QWaylandXdgShellV6::setUnresponsiveTimeout(int msecs)
+{
+    Q_D(QWaylandXdgShellV6);
+    if (d->m_pingMonitor.setUnresponsiveTimeout(msecs))
+        emit unresponsiveTimeoutChanged();
 }
 
 /*!
@@ -734,6 +810,10 @@ QWaylandXdgToplevelV6::QWaylandXdgToplevelV6(QWaylandXdgSurfaceV6 *xdgSurface, Q
 {
     QVector<QWaylandXdgToplevelV6::State> states;
     sendConfigure({0, 0}, states);
+    connect(xdgSurface->surface(), &QWaylandSurface::redraw, this, [this]() {
+        Q_D(QWaylandXdgToplevelV6);
+        d->handleCommit();
+    });
 }
 
 /*!
@@ -954,6 +1034,9 @@ uint QWaylandXdgToplevelV6::sendConfigure(const QSize &size, const QVector<QWayl
     auto statesBytes = QByteArray::fromRawData(reinterpret_cast<const char *>(states.data()),
                                                states.size() * static_cast<int>(sizeof(State)));
     uint32_t serial = d->m_xdgSurface->surface()->compositor()->nextSerial();
+    // Leaving the resizing state supersedes a resize we are still holding back
+    if (!states.contains(QWaylandXdgToplevelV6::State::ResizingState))
+        d->m_hasDeferredResize = false;
     d->m_pendingConfigures.append(QWaylandXdgToplevelV6Private::ConfigureEvent{states, size, serial});
     d->send_configure(size.width(), size.height(), statesBytes);
     QWaylandXdgSurfaceV6Private::get(d->m_xdgSurface)->send_configure(serial);
@@ -1082,7 +1165,8 @@ uint QWaylandXdgToplevelV6::sendFullscreen(const QSize &size)
  * Convenience for sending a configure event with the resizing state set, and
  * maximized and fullscreen removed. The activated state is left in its current state.
  *
- * \a maxSize is the new size of the window.
+ * \a maxSize is the new size of the window. Depending on \l resizePacing, the
+ * configure event may be held back until the client has caught up with the previous one.
  */
 
 /*!
@@ -1090,10 +1174,20 @@ uint QWaylandXdgToplevelV6::sendFullscreen(const QSize &size)
  * maximized and fullscreen removed. The activated state is left in its current state.
  *
  * \a maxSize is the new size of the window.
+ *
+ * If \l resizePacing is QWaylandXdgToplevelV6::WaitForCommit and the client has not yet
+ * acked and committed the previous resizing configure event, the size is remembered and
+ * sent later, and 0 is returned instead of a serial.
  */
 uint QWaylandXdgToplevelV6::sendResizing(const QSize &maxSize)
 {
     Q_D(QWaylandXdgToplevelV6);
+    if (d->m_resizePacing == WaitForCommit && d->m_resizeSerialInFlight) {
+        d->m_deferredResizeSize = maxSize;
+        d->m_hasDeferredResize = true;
+        return 0;
+    }
+
     QWaylandXdgToplevelV6Private::ConfigureEvent conf = d->lastSentConfigure();
 
     if (!conf.states.contains(QWaylandXdgToplevelV6::State::ResizingState))
@@ -1101,7 +1195,74 @@ uint QWaylandXdgToplevelV6::sendResizing(const QSize &maxSize)
     conf.states.removeOne(QWaylandXdgToplevelV6::State::MaximizedState);
     conf.states.removeOne(QWaylandXdgToplevelV6::State::FullscreenState);
 
-    return sendConfigure(maxSize, conf.states);
+    uint serial = sendConfigure(maxSize, conf.states);
+    d->m_hasDeferredResize = false;
+    if (d->m_resizePacing == WaitForCommit && serial) {
+        d->m_resizeSerialInFlight = serial;
+        d->m_resizeAcked = false;
+    }
+    return serial;
+}
+
+/*!
+ * \enum QWaylandXdgToplevelV6::ResizePacing
+ *
+ * This enum type is used to specify how configure events sent with sendResizing() are paced.
+ *
+ * \value SendImmediately Every call to sendResizing() sends a configure event right away.
+ * \value WaitForCommit At most one resizing configure event is in flight. Sizes requested
+ * before the client has acked and committed it are coalesced, and only the latest one is
+ * sent once the client is done.
+ */
+
+/*!
+ * \qmlproperty enumeration QtWaylandCompositor::XdgToplevelV6::resizePacing
+ *
+ * This property holds how configure events sent during an interactive resize are paced.
+ *
+ * \list
+ * \li XdgToplevelV6.SendImmediately Every resize sends a configure event right away.
+ * \li XdgToplevelV6.WaitForCommit At most one resizing configure event is in flight,
+ * until the client has acked it and committed a new buffer. Later sizes are coalesced.
+ * \endlist
+ *
+ * The default is XdgToplevelV6.SendImmediately. ShellSurfaceItem uses
+ * XdgToplevelV6.WaitForCommit while it resizes the surface interactively.
+ */
+
+/*!
+ * \property QWaylandXdgToplevelV6::resizePacing
+ *
+ * This property holds how configure events sent with sendResizing() are paced.
+ *
+ * With QWaylandXdgToplevelV6::WaitForCommit, a client that is slower than the pointer
+ * never falls behind by more than one configure event: sizes requested while a resizing
+ * configure is in flight replace each other, and only the latest one is sent after the
+ * client has acked and committed the previous one.
+ *
+ * The default is QWaylandXdgToplevelV6::SendImmediately. QWaylandQuickShellSurfaceItem
+ * uses QWaylandXdgToplevelV6::WaitForCommit while it resizes the surface interactively.
+ */
+QWaylandXdgToplevelV6::ResizePacing QWaylandXdgToplevelV6::resizePacing() const
+{
+    Q_D(const QWaylandXdgToplevelV6);
+    return d->m_resizePacing;
+}
+
+void QWaylandXdgToplevelV6::setResizePacing(QWaylandXdgToplevelV6::ResizePacing pacing)
+{
+    Q_D(QWaylandXdgToplevelV6);
+    if (d->m_resizePacing == pacing)
+        return;
+
+    d->m_resizePacing = pacing;
+    emit resizePacingChanged();
+
+    if (pacing == SendImmediately) {
+        d->m_resizeSerialInFlight = 0;
+        if (d->m_hasDeferredResize)
+            sendResizing(d->m_deferredResizeSize);
+    }
 }
 
 /*!
@@ -1189,6 +1350,38 @@ QWaylandSurfaceRole *QWaylandXdgToplevelV6::role()
  * \sa QWaylandXdgShellV6::ping()
  */
 
+/*!
+ * \qmlsignal void QtWaylandCompositor::XdgShellV6::unresponsive(WaylandClient client)
+ * \since 5.12
+ *
+ * This signal is emitted when \a client hasn't answered a ping event within
+ * \l unresponsiveTimeout. No frame callbacks are sent to the client until it answers.
+ */
+
+/*!
+ * \fn void QWaylandXdgShellV6::unresponsive(QWaylandClient *client)
+ * \since 5.12
+ *
+ * This signal is emitted when \a client hasn't answered a ping event within
+ * \l unresponsiveTimeout. No frame callbacks are sent to the client until it answers.
+ *
+ * \sa QWaylandClient::responsive
+ */
+
+/*!
+ * \qmlsignal void QtWaylandCompositor::XdgShellV6::responsive(WaylandClient client)
+ * \since 5.12
+ *
+ * This signal is emitted when an unresponsive \a client answers a ping event again.
+ */
+
+/*!
+ * \fn void QWaylandXdgShellV6::responsive(QWaylandClient *client)
+ * \since 5.12
+ *
+ * This signal is emitted when an unresponsive \a client answers a ping event again.
+ */
+
 QList<int> QWaylandXdgToplevelV6::statesAsInts() const
 {
    QList<int> list;
@@ -1219,6 +1412,10 @@ void QWaylandXdgToplevelV6Private::handleAckConfigure(uint serial)
         // This won't work unless there always is a toplevel.configure for each xdgsurface.configure
         config = m_pendingConfigures.takeFirst();
 
+        // Acking a later configure implicitly acks the resize in flight as well
+        if (config.serial == m_resizeSerialInFlight)
+            m_resizeAcked = true;
+
         if (config.serial == serial)
             break;
     }
@@ -1252,6 +1449,19 @@ void QWaylandXdgToplevelV6Private::handleAckConfigure(uint serial)
         emit q->statesChanged();
 }
 
+void QWaylandXdgToplevelV6Private::handleCommit()
+{
+    Q_Q(QWaylandXdgToplevelV6);
+    if (!m_resizeSerialInFlight || !m_resizeAcked)
+        return;
+
+    // The client has caught up with the resize in flight, send it the latest size
+    m_resizeSerialInFlight = 0;
+    m_resizeAcked = false;
+    if (m_hasDeferredResize)
+        q->sendResizing(m_deferredResizeSize);
+}
+
 void QWaylandXdgToplevelV6Private::handleFocusLost()
 {
     Q_Q(QWaylandXdgToplevelV6);
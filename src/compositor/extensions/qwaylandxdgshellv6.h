@@ -66,6 +66,8 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandXdgShellV6 : public QWaylandShellTempl
 {
     Q_OBJECT
     Q_DECLARE_PRIVATE(QWaylandXdgShellV6)
+    Q_PROPERTY(int pingInterval READ pingInterval WRITE setPingInterval NOTIFY pingIntervalChanged)
+    Q_PROPERTY(int unresponsiveTimeout READ unresponsiveTimeout WRITE setUnresponsiveTimeout NOTIFY unresponsiveTimeoutChanged)
 public:
     QWaylandXdgShellV6();
     QWaylandXdgShellV6(QWaylandCompositor *compositor);
@@ -75,6 +77,11 @@ public:
     static const struct wl_interface *interface();
     static QByteArray interfaceName();
 
+    int pingInterval() const;
+    void setPingInterval(int msecs);
+    int unresponsiveTimeout() const;
+    void setUnresponsiveTimeout(int msecs);
+
 public Q_SLOTS:
     uint ping(QWaylandClient *client);
 
@@ -83,6 +90,10 @@ Q_SIGNALS:
     void toplevelCreated(QWaylandXdgToplevelV6 *toplevel, QWaylandXdgSurfaceV6 *xdgSurface);
     void popupCreated(QWaylandXdgPopupV6 *popup, QWaylandXdgSurfaceV6 *xdgSurface);
     void pong(uint serial);
+    void pingIntervalChanged();
+    void unresponsiveTimeoutChanged();
+    void unresponsive(QWaylandClient *client);
+    void responsive(QWaylandClient *client);
 
 private Q_SLOTS:
     void handleSeatChanged(QWaylandSeat *newSeat, QWaylandSeat *oldSeat);
@@ -150,6 +161,7 @@ class Q_WAYLAND_COMPOSITOR_EXPORT QWaylandXdgToplevelV6 : public QObject
     Q_PROPERTY(bool fullscreen READ fullscreen NOTIFY fullscreenChanged)
     Q_PROPERTY(bool resizing READ resizing NOTIFY resizingChanged)
     Q_PROPERTY(bool activated READ activated NOTIFY activatedChanged)
+    Q_PROPERTY(ResizePacing resizePacing READ resizePacing WRITE setResizePacing NOTIFY resizePacingChanged)
 public:
     enum State : uint {
         MaximizedState  = 1,
@@ -159,6 +171,12 @@ public:
     };
     Q_ENUM(State)
 
+    enum ResizePacing {
+        SendImmediately,
+        WaitForCommit
+    };
+    Q_ENUM(ResizePacing)
+
     QWaylandXdgToplevelV6(QWaylandXdgSurfaceV6 *xdgSurface, QWaylandResource &resource);
 
     QWaylandXdgToplevelV6 *parentToplevel() const;
@@ -173,6 +191,9 @@ public:
     bool resizing() const;
     bool activated() const;
 
+    ResizePacing resizePacing() const;
+    void setResizePacing(ResizePacing pacing);
+
     Q_INVOKABLE QSize sizeForResize(const QSizeF &size, const QPointF &delta, Qt::Edges edges) const;
     uint sendConfigure(const QSize &size, const QVector<State> &states);
     Q_INVOKABLE uint sendConfigure(const QSize &size, const QVector<int> &states);
@@ -197,6 +218,7 @@ Q_SIGNALS:
     void fullscreenChanged();
     void resizingChanged();
     void activatedChanged();
+    void resizePacingChanged();
 
     void showWindowMenu(QWaylandSeat *seat, const QPoint &localSurfacePosition);
     void setMaximized();
@@ -41,6 +41,7 @@
 #include <QtWaylandCompositor/private/qwayland-server-xdg-shell-unstable-v6.h>
 
 #include <QtWaylandCompositor/QWaylandXdgShellV6>
+#include <QtWaylandCompositor/private/qwaylandpingmonitor_p.h>
 
 #include <QtCore/QSet>
 
@@ -84,6 +85,7 @@ public:
     static Qt::Edges convertToEdges(uint xdgEdges);
 
     QSet<uint32_t> m_pings;
+    QWaylandPingMonitor m_pingMonitor;
     QMultiMap<struct wl_client *, QWaylandXdgSurfaceV6 *> m_xdgSurfaces;
 
     QWaylandXdgSurfaceV6 *xdgSurfaceFromSurface(QWaylandSurface *surface);
@@ -143,6 +145,7 @@ public:
     QWaylandXdgToplevelV6Private(QWaylandXdgSurfaceV6 *xdgSurface, const QWaylandResource& resource);
     ConfigureEvent lastSentConfigure() const { return m_pendingConfigures.empty() ? m_lastAckedConfigure : m_pendingConfigures.last(); }
     void handleAckConfigure(uint serial); //TODO: move?
+    void handleCommit();
     void handleFocusLost();
     void handleFocusReceived();
 
@@ -172,6 +175,15 @@ public:
     QWaylandXdgToplevelV6 *m_parentToplevel = nullptr;
     QList<ConfigureEvent> m_pendingConfigures;
     ConfigureEvent m_lastAckedConfigure;
+
+    // Interactive resizes keep at most one resizing configure in flight, until
+    // the client has acked and committed it. Newer sizes replace the deferred one.
+    QWaylandXdgToplevelV6::ResizePacing m_resizePacing = QWaylandXdgToplevelV6::SendImmediately;
+    uint m_resizeSerialInFlight = 0;
+    bool m_resizeAcked = false;
+    bool m_hasDeferredResize = false;
+    QSize m_deferredResizeSize;
+
     QString m_title;
     QString m_appId;
     QSize m_maxSize;
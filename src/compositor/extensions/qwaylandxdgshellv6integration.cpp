@@ -105,6 +105,12 @@ bool XdgToplevelV6Integration::mouseReleaseEvent(QMouseEvent *event)
 {
     Q_UNUSED(event);
 
+    if (grabberState == GrabberState::Resize && resizeState.pacingOverridden) {
+        // Sends the latest size if it was held back
+        m_toplevel->setResizePacing(resizeState.resizePacing);
+        resizeState.pacingOverridden = false;
+    }
+
     if (grabberState == GrabberState::Move) {
         grabberState = GrabberState::Default;
         return true;
@@ -128,6 +134,13 @@ void XdgToplevelV6Integration::handleStartResize(QWaylandSeat *seat, Qt::Edges e
     resizeState.initialPosition = m_item->moveItem()->position();
     resizeState.initialSurfaceSize = m_item->surface()->size();
     resizeState.initialized = false;
+
+    // Follow the pointer no faster than the client can keep up with
+    if (!resizeState.pacingOverridden) {
+        resizeState.resizePacing = m_toplevel->resizePacing();
+        resizeState.pacingOverridden = true;
+    }
+    m_toplevel->setResizePacing(QWaylandXdgToplevelV6::WaitForCommit);
 }
 
 void XdgToplevelV6Integration::handleSetMaximized()
@@ -100,6 +100,8 @@ private:
         QPointF initialMousePos;
         QPointF initialPosition;
         QSize initialSurfaceSize;
+        QWaylandXdgToplevelV6::ResizePacing resizePacing;
+        bool pacingOverridden = false;
         bool initialized;
     } resizeState;
 
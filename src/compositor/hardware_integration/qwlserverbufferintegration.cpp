@@ -39,6 +39,8 @@
 
 #include "qwlserverbufferintegration_p.h"
 
+#include <QtCore/QDebug>
+
 QT_BEGIN_NAMESPACE
 
 namespace QtWayland {
@@ -56,6 +58,21 @@ bool ServerBuffer::isYInverted() const
     return false;
 }
 
+/*
+    Replaces the contents of the buffer inside \a damage with the contents of
+    \a image, which must have the size and format the buffer was created with.
+    Clients that support it are told which areas changed, so they only need to
+    refresh those. Returns false if the integration can't update its buffers, in
+    which case a new buffer has to be created instead.
+*/
+bool ServerBuffer::update(const QImage &image, const QRegion &damage)
+{
+    Q_UNUSED(image);
+    Q_UNUSED(damage);
+    qWarning("ServerBuffer::update: this server buffer integration does not support updating buffers");
+    return false;
+}
+
 QSize ServerBuffer::size() const
 { return m_size; }
 
@@ -66,6 +66,7 @@ class QWaylandCompositor;
 class QOpenGLContext;
 class QOpenGLTexture;
 class QImage;
+class QRegion;
 
 namespace QtWayland {
 class Display;
@@ -87,6 +88,8 @@ public:
 
     virtual bool isYInverted() const;
 
+    virtual bool update(const QImage &image, const QRegion &damage);
+
     QSize size() const;
     Format format() const;
 protected:
@@ -43,19 +43,118 @@
 #include "hardware_integration/qwlclientbufferintegration_p.h"
 #include <qpa/qplatformopenglcontext.h>
 #include <QOpenGLTexture>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 #endif
 
 #include <QtCore/QDebug>
 
+#include <limits>
+
 #include <wayland-server-protocol.h>
 #include "qwaylandsharedmemoryformathelper_p.h"
 
 #include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
 
+#if QT_CONFIG(opengl)
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
 namespace QtWayland {
 
+namespace {
+struct ShmPlane
+{
+    int offset;
+    int stride;
+    QSize size;
+};
+}
+
+// NV12 and YUV420 buffers store their chroma planes after the luma plane,
+// subsampled by two in both directions. Returns the number of planes, or 0 if
+// the chroma planes do not fit the buffer's stride.
+//
+// libwayland only checks the stride * height bytes of the luma plane against
+// the pool, and does not expose the pool size to check the chroma planes,
+// which is why the compositor only advertises these formats on request.
+static int shmPlanes(wl_shm_buffer *shmBuffer, ShmPlane *planes)
+{
+    const int width = wl_shm_buffer_get_width(shmBuffer);
+    const int height = wl_shm_buffer_get_height(shmBuffer);
+    const int stride = wl_shm_buffer_get_stride(shmBuffer);
+    const QSize chromaSize((width + 1) / 2, (height + 1) / 2);
+
+    planes[0] = { 0, stride, QSize(width, height) };
+    int planeCount;
+    qint64 chromaRowBytes;
+    switch (wl_shm_buffer_get_format(shmBuffer)) {
+    case WL_SHM_FORMAT_NV12:
+        planeCount = 2;
+        chromaRowBytes = chromaSize.width() * 2;
+        break;
+    case WL_SHM_FORMAT_YUV420:
+        planeCount = 3;
+        chromaRowBytes = chromaSize.width();
+        break;
+    default:
+        return 1;
+    }
+
+    const int chromaStride = planeCount == 2 ? stride : stride / 2;
+    const qint64 end = qint64(stride) * height + qint64(chromaStride) * chromaSize.height() * (planeCount - 1);
+    if (chromaRowBytes > chromaStride || end > std::numeric_limits<int>::max())
+        return 0;
+
+    for (int i = 1; i < planeCount; ++i)
+        planes[i] = { stride * height + chromaStride * chromaSize.height() * (i - 1), chromaStride, chromaSize };
+    return planeCount;
+}
+
+// Converts a planar YUV buffer using the same BT.601 coefficients as the YUV
+// shaders. This is the slow path for users of image(), QWaylandQuickItem
+// samples the planes directly.
+static QImage convertYuvToImage(wl_shm_buffer *shmBuffer)
+{
+    ShmPlane planes[3];
+    const int planeCount = shmPlanes(shmBuffer, planes);
+    if (!planeCount) {
+        qWarning("Rejecting planar YUV buffer with a stride of %d for a width of %d",
+                 wl_shm_buffer_get_stride(shmBuffer), wl_shm_buffer_get_width(shmBuffer));
+        return QImage();
+    }
+    const uchar *data = static_cast<const uchar *>(wl_shm_buffer_get_data(shmBuffer));
+    const int chromaStep = planeCount == 2 ? 2 : 1;
+
+    QImage image(planes[0].size, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *lumaLine = data + planes[0].offset + y * planes[0].stride;
+        const uchar *uLine = data + planes[1].offset + y / 2 * planes[1].stride;
+        const uchar *vLine = planeCount == 2 ? uLine + 1 : data + planes[2].offset + y / 2 * planes[2].stride;
+        QRgb *pixel = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const int chroma = x / 2 * chromaStep;
+            const float luma = 1.16438356f * (lumaLine[x] - 16);
+            const float u = uLine[chroma] - 128;
+            const float v = vLine[chroma] - 128;
+            pixel[x] = qRgb(qBound(0, qRound(luma + 1.59602678f * v), 255),
+                            qBound(0, qRound(luma - 0.39176229f * u - 0.81296764f * v), 255),
+                            qBound(0, qRound(luma + 2.01723214f * u), 255));
+        }
+    }
+    return image;
+}
+
 ClientBuffer::ClientBuffer(struct ::wl_resource *buffer)
     : m_buffer(buffer)
 {
@@ -118,6 +217,21 @@ SharedMemoryBuffer::SharedMemoryBuffer(wl_resource *bufferResource)
 
 }
 
+QWaylandBufferRef::BufferFormatEgl SharedMemoryBuffer::bufferFormatEgl() const
+{
+    if (wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer)) {
+        switch (wl_shm_buffer_get_format(shmBuffer)) {
+        case WL_SHM_FORMAT_NV12:
+            return QWaylandBufferRef::BufferFormatEgl_Y_UV;
+        case WL_SHM_FORMAT_YUV420:
+            return QWaylandBufferRef::BufferFormatEgl_Y_U_V;
+        default:
+            break;
+        }
+    }
+    return ClientBuffer::bufferFormatEgl();
+}
+
 QSize SharedMemoryBuffer::size() const
 {
     if (wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer)) {
@@ -143,7 +257,18 @@ QImage SharedMemoryBuffer::image() const
         int height = wl_shm_buffer_get_height(shmBuffer);
         int bytesPerLine = wl_shm_buffer_get_stride(shmBuffer);
         uchar *data = static_cast<uchar *>(wl_shm_buffer_get_data(shmBuffer));
-        return QImage(data, width, height, bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+        const wl_shm_format shmFormat = wl_shm_format(wl_shm_buffer_get_format(shmBuffer));
+        if (QWaylandSharedMemoryFormatHelper::isPlanarYuv(shmFormat))
+            return convertYuvToImage(shmBuffer);
+        QImage::Format format = QWaylandSharedMemoryFormatHelper::fromWaylandShmFormat(shmFormat);
+        // wl_shm pixels with alpha are premultiplied by convention
+        if (format == QImage::Format_ARGB32)
+            format = QImage::Format_ARGB32_Premultiplied;
+        else if (format == QImage::Format_RGBA8888)
+            format = QImage::Format_RGBA8888_Premultiplied;
+        else if (format == QImage::Format_Invalid)
+            format = QImage::Format_ARGB32_Premultiplied;
+        return QImage(data, width, height, bytesPerLine, format);
     }
 
     return QImage();
@@ -152,37 +277,127 @@ QImage SharedMemoryBuffer::image() const
 #if QT_CONFIG(opengl)
 QOpenGLTexture *SharedMemoryBuffer::toOpenGlTexture(int plane)
 {
-    Q_UNUSED(plane);
-    if (isSharedMemory()) {
-        if (!m_shmTexture) {
-            m_shmTexture = new QOpenGLTexture(QOpenGLTexture::Target2D);
-            m_shmTexture->create();
-        }
-        if (m_textureDirty) {
-            m_textureDirty = false;
-            m_shmTexture->bind();
+    wl_shm_buffer *shmBuffer = wl_shm_buffer_get(m_buffer);
+    if (!shmBuffer)
+        return nullptr;
+
+    ShmPlane planes[3];
+    const int planeCount = shmPlanes(shmBuffer, planes);
+    // Contexts that cannot sample the planes get the buffer converted to RGB
+    const bool samplesPlanes = planeCount > 1 && canSamplePlanes(bufferFormatEgl());
+    if (plane < 0 || plane >= (samplesPlanes ? planeCount : qMin(planeCount, 1)))
+        return nullptr;
+
+    if (m_textureDirty) {
+        m_textureDirty = false;
+        if (samplesPlanes) {
+            uploadPlanes(shmBuffer);
+        } else {
+            if (!m_shmTextures[0]) {
+                m_shmTextures[0] = new QOpenGLTexture(QOpenGLTexture::Target2D);
+                m_shmTextures[0]->create();
+            }
+            QOpenGLTexture *shmTexture = m_shmTextures[0];
+            shmTexture->bind();
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             // TODO: partial texture upload
             QImage image = this->image();
-            m_shmTexture->setSize(image.width(), image.height());
+            shmTexture->setSize(image.width(), image.height());
             if (image.hasAlphaChannel()) {
-                m_shmTexture->setFormat(QOpenGLTexture::RGBAFormat);
+                shmTexture->setFormat(QOpenGLTexture::RGBAFormat);
                 if (image.format() != QImage::Format_RGBA8888)
                     image = image.convertToFormat(QImage::Format_RGBA8888);
                 glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
             } else {
-                m_shmTexture->setFormat(QOpenGLTexture::RGBFormat);
+                shmTexture->setFormat(QOpenGLTexture::RGBFormat);
                 if (image.format() != QImage::Format_RGBX8888)
                     image = image.convertToFormat(QImage::Format_RGBX8888);
                 glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width(), image.height(), 0, GL_RGB, GL_UNSIGNED_BYTE, image.constBits());
             }
-            //we can release the buffer after uploading, since we have a copy
-            if (isCommitted())
-                sendRelease();
         }
-        return m_shmTexture;
+        //we can release the buffer after uploading, since we have a copy
+        if (isCommitted())
+            sendRelease();
+    }
+    return m_shmTextures[plane];
+}
+
+static bool hasRgTextures(QOpenGLContext *context)
+{
+    return context->format().majorVersion() >= 3
+            || context->hasExtension(context->isOpenGLES() ? "GL_EXT_texture_rg" : "GL_ARB_texture_rg");
+}
+
+// Returns true if the planes of a shared memory buffer with the given YUV
+// format can be sampled by the buffer materials in the current context. The
+// chroma plane of NV12 buffers needs two-component textures.
+bool SharedMemoryBuffer::canSamplePlanes(QWaylandBufferRef::BufferFormatEgl format)
+{
+    switch (format) {
+    case QWaylandBufferRef::BufferFormatEgl_Y_U_V:
+        return true;
+    case QWaylandBufferRef::BufferFormatEgl_Y_UV:
+        return hasRgTextures(QOpenGLContext::currentContext());
+    default:
+        return false;
+    }
+}
+
+// Uploads each plane of an NV12 or YUV420 buffer to its own texture, to be
+// sampled by the Y_UV and Y_U_V buffer materials.
+void SharedMemoryBuffer::uploadPlanes(wl_shm_buffer *shmBuffer)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    QOpenGLFunctions *gl = context->functions();
+    const bool rgTextures = hasRgTextures(context);
+    const bool unpackRowLength = !context->isOpenGLES() || context->format().majorVersion() >= 3
+            || context->hasExtension("GL_EXT_unpack_subimage");
+
+    ShmPlane planes[3];
+    const int planeCount = shmPlanes(shmBuffer, planes);
+    const uchar *data = static_cast<const uchar *>(wl_shm_buffer_get_data(shmBuffer));
+
+    gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < planeCount; ++i) {
+        const ShmPlane &plane = planes[i];
+        // The chroma plane of NV12 interleaves U and V
+        const int components = planeCount == 2 && i == 1 ? 2 : 1;
+        GLenum format;
+        if (components == 2)
+            format = rgTextures ? GL_RG : GL_LUMINANCE_ALPHA;
+        else
+            format = rgTextures ? GL_RED : GL_LUMINANCE;
+
+        if (!m_shmTextures[i]) {
+            m_shmTextures[i] = new QOpenGLTexture(QOpenGLTexture::Target2D);
+            m_shmTextures[i]->create();
+        }
+        QOpenGLTexture *texture = m_shmTextures[i];
+        texture->bind();
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        texture->setSize(plane.size.width(), plane.size.height());
+
+        const int rowLength = plane.size.width() * components;
+        const uchar *pixels = data + plane.offset;
+        QByteArray packed;
+        if (plane.stride != rowLength) {
+            if (unpackRowLength) {
+                gl->glPixelStorei(GL_UNPACK_ROW_LENGTH, plane.stride / components);
+            } else {
+                packed.resize(rowLength * plane.size.height());
+                for (int y = 0; y < plane.size.height(); ++y)
+                    memcpy(packed.data() + y * rowLength, pixels + y * plane.stride, rowLength);
+                pixels = reinterpret_cast<const uchar *>(packed.constData());
+            }
+        }
+
+        gl->glTexImage2D(GL_TEXTURE_2D, 0, GLint(format), plane.size.width(), plane.size.height(), 0,
+                         format, GL_UNSIGNED_BYTE, pixels);
+
+        if (plane.stride != rowLength && unpackRowLength)
+            gl->glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     }
-    return nullptr;
+    gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 #endif
 
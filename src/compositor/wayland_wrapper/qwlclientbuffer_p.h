@@ -131,6 +131,7 @@ class Q_WAYLAND_COMPOSITOR_EXPORT SharedMemoryBuffer : public ClientBuffer
 public:
     SharedMemoryBuffer(struct ::wl_resource *bufferResource);
 
+    QWaylandBufferRef::BufferFormatEgl bufferFormatEgl() const override;
     QSize size() const override;
     QWaylandSurface::Origin origin() const  override;
     QImage image() const override;
@@ -138,8 +139,12 @@ public:
 #if QT_CONFIG(opengl)
     QOpenGLTexture *toOpenGlTexture(int plane = 0) override;
 
+    static bool canSamplePlanes(QWaylandBufferRef::BufferFormatEgl format);
+
 private:
-    QOpenGLTexture *m_shmTexture = nullptr;
+    void uploadPlanes(struct ::wl_shm_buffer *shmBuffer);
+
+    QOpenGLTexture *m_shmTextures[3] = {};
 #endif
 };
 
@@ -46,21 +46,54 @@
 #include "qwldatadevice_p.h"
 #include "qwldatasource_p.h"
 #include "qwldataoffer_p.h"
-#include "qwaylandmimehelper_p.h"
+#include "qwaylanddatawriter_p.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
 #include <QtCore/QSocketNotifier>
 #include <fcntl.h>
 #include <QtCore/private/qcore_unix_p.h>
-#include <QtCore/QFile>
 
 QT_BEGIN_NAMESPACE
 
+Q_DECLARE_LOGGING_CATEGORY(qLcCompositorSelection)
+Q_LOGGING_CATEGORY(qLcCompositorSelection, "qt.compositor.selection")
+
 namespace QtWayland {
 
+// The formats retained as soon as a selection is set. Everything else is
+// only fetched from the source when a client asks for it.
+static QStringList preferredRetainedFormats(const QStringList &offers)
+{
+    static const QStringList preferred = [] {
+        const QString formats = QString::fromLatin1(qgetenv("QT_WAYLAND_RETAINED_SELECTION_FORMATS"));
+        if (!formats.isEmpty())
+            return formats.split(QLatin1Char(','), QString::SkipEmptyParts);
+        return QStringList { QStringLiteral("text/plain;charset=utf-8"),
+                             QStringLiteral("text/plain"),
+                             QStringLiteral("UTF8_STRING"),
+                             QStringLiteral("text/uri-list") };
+    }();
+
+    QStringList formats;
+    for (const QString &format : preferred) {
+        if (offers.contains(format.trimmed()))
+            formats.append(format.trimmed());
+    }
+    // Sources list their most faithful format first
+    if (formats.isEmpty() && !offers.isEmpty())
+        formats.append(offers.first());
+    return formats;
+}
+
 DataDeviceManager::DataDeviceManager(QWaylandCompositor *compositor)
     : wl_data_device_manager(compositor->display(), 1)
     , m_compositor(compositor)
+    , m_dataWriter(new QWaylandDataWriter)
+{
+}
+
+DataDeviceManager::~DataDeviceManager()
 {
 }
 
@@ -74,44 +107,70 @@ void DataDeviceManager::setCurrentSelectionSource(DataSource *source)
 
     m_compositorOwnsSelection = false;
 
-    finishReadFromClient();
+    stopRetaining();
 
     m_current_selection_source = source;
     if (source)
         source->setManager(this);
 
-    // When retained selection is enabled, the compositor will query all the data from the client.
+    // When retained selection is enabled, the compositor will query the data from the client.
     // This makes it possible to
     //    1. supply the selection after the offering client is gone
     //    2. make it possible for the compositor to participate in copy-paste
-    // The downside is decreased performance, therefore this mode has to be enabled
+    // Only the preferred formats are fetched right away; the others are fetched
+    // when a client asks for them, and are lost if the source goes away first.
+    // Retaining still costs performance, therefore this mode has to be enabled
     // explicitly in the compositors.
     if (source && m_compositor->retainedSelectionEnabled()) {
-        m_retainedData.clear();
-        m_retainedReadIndex = 0;
+        const QStringList offers = source->mimeTypes();
+        m_retainedData.reset(offers);
+        m_retainedFetchQueue = preferredRetainedFormats(offers);
+        m_retainingPreferredFormats = true;
         retain();
     }
 }
 
 void DataDeviceManager::sourceDestroyed(DataSource *source)
 {
-    if (m_current_selection_source == source)
-        finishReadFromClient();
+    if (m_current_selection_source == source) {
+        stopRetaining();
+        m_retainedData.dropUnretainedFormats();
+        m_current_selection_source = nullptr;
+    }
+}
+
+// Aborts fetching from the current source; clients waiting for data get none
+void DataDeviceManager::stopRetaining()
+{
+    finishReadFromClient();
+    m_retainedFetchQueue.clear();
+    m_retainedReadMimeType.clear();
+    m_retainedReadBuf.clear();
+    m_retainingPreferredFormats = false;
+
+    for (int fd : qAsConst(m_retainedWaitingFds))
+        close(fd);
+    m_retainedWaitingFds.clear();
 }
 
 void DataDeviceManager::retain()
 {
-    QList<QString> offers = m_current_selection_source->mimeTypes();
     finishReadFromClient();
-    if (m_retainedReadIndex >= offers.count()) {
-        QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(&m_retainedData);
+    if (m_retainedFetchQueue.isEmpty() || !m_current_selection_source) {
+        if (m_retainingPreferredFormats) {
+            m_retainingPreferredFormats = false;
+            logRetainedSelectionStats();
+            QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(&m_retainedData);
+        }
         return;
     }
-    QString mimeType = offers.at(m_retainedReadIndex);
+    m_retainedReadMimeType = m_retainedFetchQueue.takeFirst();
+    const QString mimeType = m_retainedReadMimeType;
     m_retainedReadBuf.clear();
     int fd[2];
     if (pipe(fd) == -1) {
         qWarning("Clipboard: Failed to create pipe");
+        m_retainedReadMimeType.clear();
         return;
     }
     fcntl(fd[0], F_SETFL, fcntl(fd[0], F_GETFL, 0) | O_NONBLOCK);
@@ -139,7 +198,7 @@ void DataDeviceManager::finishReadFromClient(bool exhausted)
 
 void DataDeviceManager::readFromClient(int fd)
 {
-    static char buf[4096];
+    char buf[4096];
     int obsCount = m_obsoleteRetainedReadNotifiers.count();
     for (int i = 0; i < obsCount; ++i) {
         QSocketNotifier *sn = m_obsoleteRetainedReadNotifiers.at(i);
@@ -159,19 +218,65 @@ void DataDeviceManager::readFromClient(int fd)
             return;
         }
     }
-    int n = QT_READ(fd, buf, sizeof buf);
-    if (n <= 0) {
-        if (n != -1 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
-            finishReadFromClient(true);
-            QList<QString> offers = m_current_selection_source->mimeTypes();
-            QString mimeType = offers.at(m_retainedReadIndex);
-            m_retainedData.setData(mimeType, m_retainedReadBuf);
-            ++m_retainedReadIndex;
-            retain();
-        }
-    } else {
-        m_retainedReadBuf.append(buf, n);
+
+    // Drain everything that is available, growing the buffer geometrically
+    qint64 n;
+    forever {
+        const int size = m_retainedReadBuf.size();
+        if (m_retainedReadBuf.capacity() - size < 4096)
+            m_retainedReadBuf.reserve(qMax(2 * m_retainedReadBuf.capacity(), size + 64 * 1024));
+        const int chunk = m_retainedReadBuf.capacity() - size;
+        m_retainedReadBuf.resize(size + chunk);
+        n = qt_safe_read(fd, m_retainedReadBuf.data() + size, chunk);
+        m_retainedReadBuf.resize(size + int(qMax<qint64>(n, 0)));
+        if (n <= 0)
+            break;
     }
+
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return;
+
+    finishReadFromClient(true);
+    const QString mimeType = m_retainedReadMimeType;
+    m_retainedReadMimeType.clear();
+    m_retainedData.setPayload(mimeType, m_retainedReadBuf);
+    m_retainedReadBuf.clear();
+
+    const QList<int> waiting = m_retainedWaitingFds.values(mimeType);
+    m_retainedWaitingFds.remove(mimeType);
+    if (!waiting.isEmpty()) {
+        const QByteArray payload = m_retainedData.payload(mimeType);
+        for (int waitingFd : waiting)
+            m_dataWriter->write(waitingFd, payload);
+        if (!m_retainingPreferredFormats)
+            logRetainedSelectionStats();
+    }
+
+    retain();
+}
+
+// Fetches a format that was not retained up front, and hands it to \a fd once it arrived
+void DataDeviceManager::fetchRetainedData(const QString &mimeType, int fd)
+{
+    m_retainedWaitingFds.insert(mimeType, fd);
+    if (m_retainedReadMimeType == mimeType || m_retainedFetchQueue.contains(mimeType))
+        return;
+
+    m_retainedData.countLazyFetch();
+    m_retainedFetchQueue.append(mimeType);
+    if (!m_retainedReadNotifier)
+        retain();
+}
+
+void DataDeviceManager::logRetainedSelectionStats() const
+{
+    const RetainedSelection::Stats stats = m_retainedData.stats();
+    qCDebug(qLcCompositorSelection) << "Retained" << stats.retainedFormats << "of" << stats.offeredFormats
+                                    << "formats:" << stats.bytesInMemory << "bytes in memory,"
+                                    << stats.bytesSpilled << "bytes spilled,"
+                                    << stats.deduplicatedFormats << "duplicate formats sharing"
+                                    << stats.bytesDeduplicated << "bytes,"
+                                    << stats.lazyFetches << "fetched on demand";
 }
 
 DataSource *DataDeviceManager::currentSelectionSource()
@@ -190,9 +295,10 @@ void DataDeviceManager::overrideSelection(const QMimeData &mimeData)
     if (formats.isEmpty())
         return;
 
-    m_retainedData.clear();
+    stopRetaining();
+    m_retainedData.reset();
     foreach (const QString &format, formats)
-        m_retainedData.setData(format, mimeData.data(format));
+        m_retainedData.setPayload(format, mimeData.data(format));
 
     QWaylandCompositorPrivate::get(m_compositor)->feedRetainedSelectionData(&m_retainedData);
 
@@ -211,13 +317,13 @@ bool DataDeviceManager::offerFromCompositorToClient(wl_resource *clientDataDevic
         return false;
 
     wl_client *client = clientDataDeviceResource->client;
-    //qDebug("compositor offers %d types to %p", m_retainedData.formats().count(), client);
+    //qDebug("compositor offers %d types to %p", m_retainedData.offeredFormats().count(), client);
 
     struct wl_resource *selectionOffer =
              wl_resource_create(client, &wl_data_offer_interface, -1, 0);
     wl_resource_set_implementation(selectionOffer, &compositor_offer_interface, this, nullptr);
     wl_data_device_send_data_offer(clientDataDeviceResource, selectionOffer);
-    foreach (const QString &format, m_retainedData.formats()) {
+    foreach (const QString &format, m_retainedData.offeredFormats()) {
         QByteArray ba = format.toLatin1();
         wl_data_offer_send_offer(selectionOffer, ba.constData());
     }
@@ -228,7 +334,7 @@ bool DataDeviceManager::offerFromCompositorToClient(wl_resource *clientDataDevic
 
 void DataDeviceManager::offerRetainedSelection(wl_resource *clientDataDeviceResource)
 {
-    if (m_retainedData.formats().isEmpty())
+    if (m_retainedData.offeredFormats().isEmpty())
         return;
 
     m_compositorOwnsSelection = true;
@@ -255,13 +361,16 @@ void DataDeviceManager::comp_receive(wl_client *client, wl_resource *resource, c
     Q_UNUSED(client);
     DataDeviceManager *self = static_cast<DataDeviceManager *>(resource->data);
     //qDebug("client %p wants data for type %s from compositor", client, mime_type);
-    QByteArray content = QWaylandMimeHelper::getByteArray(&self->m_retainedData, QString::fromLatin1(mime_type));
-    if (!content.isEmpty()) {
-        QFile f;
-        if (f.open(fd, QIODevice::WriteOnly))
-            f.write(content);
-    }
-    close(fd);
+    const QString mimeType = QString::fromLatin1(mime_type);
+
+    // Never block the compositor on a slow reader; the payload is streamed
+    // out as the client consumes it.
+    if (self->m_retainedData.isRetained(mimeType))
+        self->m_dataWriter->write(fd, self->m_retainedData.payload(mimeType));
+    else if (self->m_current_selection_source && self->m_retainedData.isOffered(mimeType))
+        self->fetchRetainedData(mimeType, fd);
+    else
+        close(fd);
 }
 
 void DataDeviceManager::comp_destroy(wl_client *, wl_resource *)
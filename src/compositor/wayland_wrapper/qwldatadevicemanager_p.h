@@ -53,6 +53,8 @@
 
 #include <QtCore/QList>
 #include <QtCore/QMap>
+#include <QtCore/QMultiHash>
+#include <QtCore/QScopedPointer>
 #include <QtGui/QClipboard>
 #include <QtCore/QMimeData>
 
@@ -60,12 +62,14 @@
 
 #include <QtWaylandCompositor/private/qwayland-server-wayland.h>
 #include <QtWaylandCompositor/private/qtwaylandcompositorglobal_p.h>
+#include <QtWaylandCompositor/private/qwlretainedselection_p.h>
 
 QT_REQUIRE_CONFIG(wayland_datadevice);
 
 QT_BEGIN_NAMESPACE
 
 class QSocketNotifier;
+class QWaylandDataWriter;
 
 namespace QtWayland {
 
@@ -78,6 +82,7 @@ class DataDeviceManager : public QObject, public QtWaylandServer::wl_data_device
 
 public:
     DataDeviceManager(QWaylandCompositor *compositor);
+    ~DataDeviceManager() override;
 
     void setCurrentSelectionSource(DataSource *source);
     DataSource *currentSelectionSource();
@@ -90,6 +95,9 @@ public:
     bool offerFromCompositorToClient(wl_resource *clientDataDeviceResource);
     void offerRetainedSelection(wl_resource *clientDataDeviceResource);
 
+    RetainedSelection::Stats retainedSelectionStats() const { return m_retainedData.stats(); }
+    const QMimeData *retainedSelection() const { return &m_retainedData; }
+
 protected:
     void data_device_manager_create_data_source(Resource *resource, uint32_t id) override;
     void data_device_manager_get_data_device(Resource *resource, uint32_t id, struct ::wl_resource *seat) override;
@@ -100,17 +108,24 @@ private Q_SLOTS:
 private:
     void retain();
     void finishReadFromClient(bool exhausted = false);
+    void stopRetaining();
+    void fetchRetainedData(const QString &mimeType, int fd);
+    void logRetainedSelectionStats() const;
 
     QWaylandCompositor *m_compositor = nullptr;
     QList<DataDevice *> m_data_device_list;
 
     DataSource *m_current_selection_source = nullptr;
 
-    QMimeData m_retainedData;
+    RetainedSelection m_retainedData;
     QSocketNotifier *m_retainedReadNotifier = nullptr;
     QList<QSocketNotifier *> m_obsoleteRetainedReadNotifiers;
-    int m_retainedReadIndex;
+    QStringList m_retainedFetchQueue;
+    QString m_retainedReadMimeType;
     QByteArray m_retainedReadBuf;
+    QMultiHash<QString, int> m_retainedWaitingFds;
+    bool m_retainingPreferredFormats = false;
+    QScopedPointer<QWaylandDataWriter> m_dataWriter;
 
     bool m_compositorOwnsSelection = false;
 
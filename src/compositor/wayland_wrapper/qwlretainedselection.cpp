@@ -0,0 +1,276 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwlretainedselection_p.h"
+
+#include <QtCore/QSet>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h and linux/fcntl.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC         0x0001U
+#  endif
+#  ifndef MFD_ALLOW_SEALING
+#    define MFD_ALLOW_SEALING   0x0002U
+#  endif
+#  ifndef F_ADD_SEALS
+#    define F_ADD_SEALS         (1024 + 9)
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL         0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK       0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW         0x0004
+#  endif
+#  ifndef F_SEAL_WRITE
+#    define F_SEAL_WRITE        0x0008
+#  endif
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+/*
+    RetainedSelection holds the compositor's copy of the clipboard selection.
+
+    It knows every format the selection offers, but only holds the payloads
+    that have actually been fetched. Clients are offered all formats, while
+    the QMimeData interface only lists the retained ones, since the others
+    can't be read without waiting for the source. Formats with byte-identical payloads
+    share one copy. Once the payloads held in memory exceed memoryBudget(),
+    further payloads are moved to sealed memfds and are read back on demand.
+*/
+
+struct RetainedSelection::Payload
+{
+    ~Payload()
+    {
+        if (memfd != -1)
+            qt_safe_close(memfd);
+    }
+
+    QByteArray read() const
+    {
+        if (memfd == -1)
+            return data;
+
+        QByteArray result(int(size), Qt::Uninitialized);
+        qint64 offset = 0;
+        while (offset < size) {
+            const ssize_t n = ::pread(memfd, result.data() + offset, size_t(size - offset), off_t(offset));
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR)
+                    continue;
+                qWarning("Clipboard: Failed to read back retained data: %s", strerror(errno));
+                return QByteArray();
+            }
+            offset += n;
+        }
+        return result;
+    }
+
+    bool spill(const QByteArray &bytes)
+    {
+        int fd = -1;
+#ifdef SYS_memfd_create
+        fd = int(syscall(SYS_memfd_create, "qt-wayland-retained-selection", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+#endif
+        if (fd < 0)
+            return false;
+
+        const char *p = bytes.constData();
+        qint64 remaining = bytes.size();
+        while (remaining > 0) {
+            const qint64 n = qt_safe_write(fd, p, remaining);
+            if (n <= 0) {
+                qt_safe_close(fd);
+                return false;
+            }
+            p += n;
+            remaining -= n;
+        }
+
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+        memfd = fd;
+        return true;
+    }
+
+    QByteArray data;
+    int memfd = -1;
+    qint64 size = 0;
+    uint hash = 0;
+};
+
+RetainedSelection::RetainedSelection()
+{
+    bool ok = false;
+    const qint64 budget = qgetenv("QT_WAYLAND_RETAINED_SELECTION_BUDGET").toLongLong(&ok);
+    m_memoryBudget = ok && budget >= 0 ? budget : 32 * 1024 * 1024;
+}
+
+RetainedSelection::~RetainedSelection()
+{
+}
+
+/*
+    Forgets all payloads and starts over with a selection offering \a formats.
+*/
+void RetainedSelection::reset(const QStringList &formats)
+{
+    m_formats = formats;
+    m_payloads.clear();
+    m_stats = Stats();
+    m_stats.offeredFormats = formats.size();
+}
+
+/*
+    Removes the formats whose payload has not been fetched. Called when the
+    source goes away and they can no longer be fetched.
+*/
+void RetainedSelection::dropUnretainedFormats()
+{
+    QStringList retained;
+    for (const QString &format : qAsConst(m_formats)) {
+        if (m_payloads.contains(format))
+            retained.append(format);
+    }
+    m_formats = retained;
+    m_stats.offeredFormats = m_formats.size();
+}
+
+void RetainedSelection::setPayload(const QString &mimeType, const QByteArray &data)
+{
+    if (!m_formats.contains(mimeType)) {
+        m_formats.append(mimeType);
+        ++m_stats.offeredFormats;
+    }
+    m_payloads.remove(mimeType);
+    updateStats();
+
+    const uint hash = qHash(data);
+    QSharedPointer<Payload> payload = findIdentical(data, hash);
+    if (!payload) {
+        payload.reset(new Payload);
+        payload->size = data.size();
+        payload->hash = hash;
+        if (m_stats.bytesInMemory + payload->size <= m_memoryBudget || !payload->spill(data))
+            payload->data = data;
+    }
+    m_payloads.insert(mimeType, payload);
+    updateStats();
+}
+
+QByteArray RetainedSelection::payload(const QString &mimeType) const
+{
+    const QSharedPointer<Payload> payload = m_payloads.value(mimeType);
+    return payload ? payload->read() : QByteArray();
+}
+
+QStringList RetainedSelection::formats() const
+{
+    QStringList retained;
+    for (const QString &format : m_formats) {
+        if (m_payloads.contains(format))
+            retained.append(format);
+    }
+    return retained;
+}
+
+bool RetainedSelection::hasFormat(const QString &mimeType) const
+{
+    return isRetained(mimeType);
+}
+
+QVariant RetainedSelection::retrieveData(const QString &mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+    if (!isRetained(mimeType))
+        return QVariant();
+    return payload(mimeType);
+}
+
+void RetainedSelection::updateStats()
+{
+    m_stats.retainedFormats = m_payloads.size();
+    m_stats.deduplicatedFormats = 0;
+    m_stats.bytesInMemory = 0;
+    m_stats.bytesSpilled = 0;
+    m_stats.bytesDeduplicated = 0;
+
+    QSet<const Payload *> seen;
+    for (const QSharedPointer<Payload> &payload : qAsConst(m_payloads)) {
+        if (seen.contains(payload.data())) {
+            ++m_stats.deduplicatedFormats;
+            m_stats.bytesDeduplicated += payload->size;
+            continue;
+        }
+        seen.insert(payload.data());
+        if (payload->memfd == -1)
+            m_stats.bytesInMemory += payload->size;
+        else
+            m_stats.bytesSpilled += payload->size;
+    }
+}
+
+QSharedPointer<RetainedSelection::Payload> RetainedSelection::findIdentical(const QByteArray &data, uint hash) const
+{
+    for (const QSharedPointer<Payload> &payload : m_payloads) {
+        if (payload->size != data.size() || payload->hash != hash)
+            continue;
+        if (payload->read() == data)
+            return payload;
+    }
+    return QSharedPointer<Payload>();
+}
+
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWaylandCompositor module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef WLRETAINEDSELECTION_H
+#define WLRETAINEDSELECTION_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtWaylandCompositor/private/qtwaylandcompositorglobal_p.h>
+#include <QtCore/QHash>
+#include <QtCore/QMimeData>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+
+QT_REQUIRE_CONFIG(wayland_datadevice);
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWayland {
+
+class RetainedSelection : public QMimeData
+{
+public:
+    struct Stats {
+        int offeredFormats = 0;
+        int retainedFormats = 0;
+        int deduplicatedFormats = 0;
+        int lazyFetches = 0;
+        qint64 bytesInMemory = 0;
+        qint64 bytesSpilled = 0;
+        qint64 bytesDeduplicated = 0;
+    };
+
+    RetainedSelection();
+    ~RetainedSelection() override;
+
+    void reset(const QStringList &formats = QStringList());
+    void dropUnretainedFormats();
+
+    void setPayload(const QString &mimeType, const QByteArray &data);
+    QStringList offeredFormats() const { return m_formats; }
+    bool isOffered(const QString &mimeType) const { return m_formats.contains(mimeType); }
+    bool isRetained(const QString &mimeType) const { return m_payloads.contains(mimeType); }
+    QByteArray payload(const QString &mimeType) const;
+
+    qint64 memoryBudget() const { return m_memoryBudget; }
+    void setMemoryBudget(qint64 bytes) { m_memoryBudget = bytes; }
+
+    void countLazyFetch() { ++m_stats.lazyFetches; }
+    Stats stats() const { return m_stats; }
+
+    QStringList formats() const override;
+    bool hasFormat(const QString &mimeType) const override;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QVariant::Type type) const override;
+
+private:
+    struct Payload;
+
+    QSharedPointer<Payload> findIdentical(const QByteArray &data, uint hash) const;
+    void updateStats();
+
+    QStringList m_formats;
+    QHash<QString, QSharedPointer<Payload>> m_payloads;
+    qint64 m_memoryBudget;
+    Stats m_stats;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // WLRETAINEDSELECTION_H
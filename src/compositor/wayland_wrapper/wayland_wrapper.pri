@@ -19,13 +19,15 @@ qtConfig(wayland-datadevice) {
         wayland_wrapper/qwldatadevice_p.h \
         wayland_wrapper/qwldatadevicemanager_p.h \
         wayland_wrapper/qwldataoffer_p.h \
-        wayland_wrapper/qwldatasource_p.h
+        wayland_wrapper/qwldatasource_p.h \
+        wayland_wrapper/qwlretainedselection_p.h
 
     SOURCES += \
         wayland_wrapper/qwldatadevice.cpp \
         wayland_wrapper/qwldatadevicemanager.cpp \
         wayland_wrapper/qwldataoffer.cpp \
-        wayland_wrapper/qwldatasource.cpp
+        wayland_wrapper/qwldatasource.cpp \
+        wayland_wrapper/qwlretainedselection.cpp
 }
 
 INCLUDEPATH += wayland_wrapper
@@ -41,53 +41,93 @@
 #include <QtWaylandClient/private/qwaylanddisplay_p.h>
 #include <QDebug>
 #include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
 #include <QtGui/QOpenGLTexture>
 #include <QtGui/QImage>
 #include <QtCore/QSharedMemory>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <sys/mman.h>
 
 QT_BEGIN_NAMESPACE
 
-static QOpenGLTexture *createTextureFromShm(const QString &key, int w, int h, int bpl, int format)
+static QImage::Format imageFormat(int format)
+{
+    switch (format) {
+        case QtWayland::qt_shm_emulation_server_buffer::format_RGBA32:
+            return QImage::Format_RGBA8888;
+        case QtWayland::qt_shm_emulation_server_buffer::format_A8:
+            return QImage::Format_Alpha8;
+        default:
+            qWarning() << "ShmServerBuffer: unknown format" << format;
+            return QImage::Format_RGBA8888;
+    }
+}
+
+static QOpenGLTexture *createTextureFromImage(const QImage &image)
+{
+    if (!QOpenGLContext::currentContext())
+        qWarning("ShmServerBuffer: creating texture with no current context");
+
+    return new QOpenGLTexture(image, QOpenGLTexture::DontGenerateMipMaps);
+}
+
+static QImage imageFromShm(const QString &key, int w, int h, int bpl, int format)
 {
     QSharedMemory shm(key);
     bool ok;
     ok = shm.attach(QSharedMemory::ReadOnly);
     if (!ok) {
         qWarning() << "Could not attach to" << key;
-        return nullptr;
+        return QImage();
     }
     ok = shm.lock();
     if (!ok) {
         qWarning() << "Could not lock" << key << "for reading";
-        return nullptr;
+        return QImage();
     }
 
-    QImage::Format imageFormat;
-    switch (format) {
-        case QtWayland::qt_shm_emulation_server_buffer::format_RGBA32:
-            imageFormat = QImage::Format_RGBA8888;
-            break;
-        case QtWayland::qt_shm_emulation_server_buffer::format_A8:
-            imageFormat = QImage::Format_Alpha8;
-            break;
-        default:
-            qWarning() << "ShmServerBuffer: unknown format" << format;
-            imageFormat = QImage::Format_RGBA8888;
-            break;
+    QImage image = QImage(static_cast<const uchar*>(shm.constData()), w, h, bpl, imageFormat(format)).copy();
+    shm.unlock();
+    return image;
+}
+
+
+namespace QtWaylandClient {
+
+// A read-only mapping of a server buffer fd. It is shared by the buffer, its
+// texture upload and every QImage handed out by toImage(), so the contents are
+// mapped once per process and never copied on the client side.
+class ShmServerBufferMapping
+{
+public:
+    ShmServerBufferMapping(int fd, size_t size)
+        : m_size(size)
+    {
+        void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+            qErrnoWarning("ShmServerBuffer: mmap failed");
+        else
+            m_data = static_cast<const uchar *>(data);
+    }
+    ~ShmServerBufferMapping()
+    {
+        if (m_data)
+            munmap(const_cast<uchar *>(m_data), m_size);
     }
 
-    QImage image(static_cast<const uchar*>(shm.constData()), w, h, bpl, imageFormat);
+    const uchar *data() const { return m_data; }
 
-    if (!QOpenGLContext::currentContext())
-        qWarning("ShmServerBuffer: creating texture with no current context");
+private:
+    const uchar *m_data = nullptr;
+    size_t m_size;
+};
 
-    auto *tex = new QOpenGLTexture(image, QOpenGLTexture::DontGenerateMipMaps);
-    shm.unlock();
-    return tex;
+static void releaseMapping(void *mapping)
+{
+    delete static_cast<QSharedPointer<ShmServerBufferMapping> *>(mapping);
 }
 
-
-namespace QtWaylandClient {
 ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, const QString &key, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format)
     : m_integration(integration)
     , m_key(key)
@@ -97,18 +137,84 @@ ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, const
     m_size = QSize(width, height);
 }
 
+ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, int32_t fd, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format)
+    : m_integration(integration)
+    , m_bpl(bytes_per_line)
+    , m_format(format)
+{
+    m_size = QSize(width, height);
+    m_mappings[0].reset(new ShmServerBufferMapping(fd, size_t(bytes_per_line) * size_t(height)));
+    // The mapping keeps the contents alive
+    qt_safe_close(fd);
+}
+
 ShmServerBuffer::~ShmServerBuffer()
 {
 }
 
 QOpenGLTexture *ShmServerBuffer::toOpenGlTexture()
 {
-    if (!m_texture)
-        m_texture = createTextureFromShm(m_key, m_size.width(), m_size.height(), m_bpl, m_format);
+    if (!m_texture) {
+        const QImage image = m_mappings[0] ? toImage() : imageFromShm(m_key, m_size.width(), m_size.height(), m_bpl, m_format);
+        if (!image.isNull())
+            m_texture = createTextureFromImage(image);
+        m_textureDamage = QRegion();
+    } else if (!m_textureDamage.isEmpty()) {
+        // Only upload what the compositor changed
+        const QImage image = toImage();
+        if (!image.isNull()) {
+            QOpenGLFunctions *funcs = QOpenGLContext::currentContext()->functions();
+            m_texture->bind();
+            funcs->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            for (const QRect &rect : m_textureDamage) {
+                const QImage sub = image.copy(rect).convertToFormat(QImage::Format_RGBA8888);
+                funcs->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                                       GL_RGBA, GL_UNSIGNED_BYTE, sub.constBits());
+            }
+            m_texture->release();
+        }
+        m_textureDamage = QRegion();
+    }
 
     return m_texture;
 }
 
+QImage ShmServerBuffer::toImage()
+{
+    const QSharedPointer<ShmServerBufferMapping> &mapping = m_mappings[m_current];
+    if (!mapping)
+        return m_mappings[0] ? QImage() : imageFromShm(m_key, m_size.width(), m_size.height(), m_bpl, m_format);
+
+    if (!mapping->data())
+        return QImage();
+
+    // The image is a read-only view, any attempt to modify it detaches. For
+    // double buffered buffers, it stays valid until the next update arrives.
+    return QImage(mapping->data(), m_size.width(), m_size.height(), m_bpl, imageFormat(m_format),
+                  releaseMapping, new QSharedPointer<ShmServerBufferMapping>(mapping));
+}
+
+void ShmServerBuffer::setBackBuffer(int32_t fd)
+{
+    m_mappings[1].reset(new ShmServerBufferMapping(fd, size_t(m_bpl) * size_t(m_size.height())));
+    qt_safe_close(fd);
+}
+
+// Returns whether the buffer switched to the other slot
+bool ShmServerBuffer::handleUpdate(uint slot, const QRegion &damage)
+{
+    if (slot > 1 || !m_mappings[slot]) {
+        qWarning("ShmServerBuffer: update refers to an unknown buffer slot %u", slot);
+        return false;
+    }
+    const bool switched = slot != m_current;
+    m_current = slot;
+    m_damage += damage;
+    if (m_texture)
+        m_textureDamage += damage;
+    return switched;
+}
+
 void ShmServerBufferIntegration::initialize(QWaylandDisplay *display)
 {
     m_display = display;
@@ -122,10 +228,10 @@ QWaylandServerBuffer *ShmServerBufferIntegration::serverBuffer(struct qt_server_
 
 void ShmServerBufferIntegration::wlDisplayHandleGlobal(void *data, ::wl_registry *registry, uint32_t id, const QString &interface, uint32_t version)
 {
-    Q_UNUSED(version);
     if (interface == "qt_shm_emulation_server_buffer") {
         auto *integration = static_cast<ShmServerBufferIntegration *>(data);
-        integration->QtWayland::qt_shm_emulation_server_buffer::init(registry, id, 1);
+        integration->m_version = qMin(version, 4u);
+        integration->QtWayland::qt_shm_emulation_server_buffer::init(registry, id, integration->m_version);
     }
 }
 
@@ -136,6 +242,38 @@ void QtWaylandClient::ShmServerBufferIntegration::shm_emulation_server_buffer_se
     qt_server_buffer_set_user_data(id, server_buffer);
 }
 
+void QtWaylandClient::ShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_created_fd(qt_server_buffer *id, int32_t fd, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format)
+{
+    auto *server_buffer = new ShmServerBuffer(this, fd, width, height, bytes_per_line, format);
+    qt_server_buffer_set_user_data(id, server_buffer);
+}
+
+void QtWaylandClient::ShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_back_buffer(qt_server_buffer *buffer, int32_t fd)
+{
+    auto *server_buffer = static_cast<ShmServerBuffer *>(qt_server_buffer_get_user_data(buffer));
+    if (server_buffer)
+        server_buffer->setBackBuffer(fd);
+    else
+        qt_safe_close(fd);
+}
+
+void QtWaylandClient::ShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_updated(qt_server_buffer *buffer, uint32_t slot, wl_array *damage)
+{
+    auto *server_buffer = static_cast<ShmServerBuffer *>(qt_server_buffer_get_user_data(buffer));
+    if (!server_buffer)
+        return;
+
+    QRegion region;
+    const int32_t *values = static_cast<const int32_t *>(damage->data);
+    const size_t count = damage->size / sizeof(int32_t);
+    for (size_t i = 0; i + 3 < count; i += 4)
+        region += QRect(values[i], values[i + 1], values[i + 2], values[i + 3]);
+
+    // Nothing reads from the other file anymore, the compositor may write to it
+    if (server_buffer->handleUpdate(slot, region) && m_version >= 4)
+        server_buffer_release(buffer, 1 - slot);
+}
+
 }
 
 QT_END_NAMESPACE
@@ -46,6 +46,7 @@
 
 #include "shmserverbufferintegration.h"
 #include <QtWaylandClient/private/qwaylanddisplay_p.h>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QTextStream>
 
 QT_BEGIN_NAMESPACE
@@ -54,16 +55,26 @@ namespace QtWaylandClient {
 
 class ShmServerBufferIntegration;
 
+class ShmServerBufferMapping;
+
 class ShmServerBuffer : public QWaylandServerBuffer
 {
 public:
     ShmServerBuffer(ShmServerBufferIntegration *integration, const QString &key, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format);
+    ShmServerBuffer(ShmServerBufferIntegration *integration, int32_t fd, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format);
     ~ShmServerBuffer() override;
     QOpenGLTexture* toOpenGlTexture() override;
+    QImage toImage() override;
+
+    void setBackBuffer(int32_t fd);
+    bool handleUpdate(uint slot, const QRegion &damage);
 private:
     ShmServerBufferIntegration *m_integration = nullptr;
     QOpenGLTexture *m_texture = nullptr;
+    QRegion m_textureDamage;
     QString m_key;
+    QSharedPointer<ShmServerBufferMapping> m_mappings[2];
+    uint m_current = 0;
     int m_bpl;
     int m_format;
 };
@@ -79,11 +90,15 @@ public:
 
 protected:
     void shm_emulation_server_buffer_server_buffer_created(qt_server_buffer *id, const QString &key, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format) override;
+    void shm_emulation_server_buffer_server_buffer_created_fd(qt_server_buffer *id, int32_t fd, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format) override;
+    void shm_emulation_server_buffer_server_buffer_back_buffer(qt_server_buffer *buffer, int32_t fd) override;
+    void shm_emulation_server_buffer_server_buffer_updated(qt_server_buffer *buffer, uint32_t slot, wl_array *damage) override;
 
 private:
     static void wlDisplayHandleGlobal(void *data, struct ::wl_registry *registry, uint32_t id,
                                       const QString &interface, uint32_t version);
     QWaylandDisplay *m_display = nullptr;
+    uint m_version = 0;
 };
 
 }
@@ -105,9 +105,9 @@ void QWaylandEglWindow::setGeometry(const QRect &rect)
 
 void QWaylandEglWindow::updateSurface(bool create)
 {
-    QMargins margins = frameMargins();
+    QMargins margins = surfaceMargins();
     QRect rect = geometry();
-    QSize sizeWithMargins = (rect.size() + QSize(margins.left() + margins.right(), margins.top() + margins.bottom())) * scale();
+    QSize sizeWithMargins = (rect.size() + QSize(margins.left() + margins.right(), margins.top() + margins.bottom())) * devicePixelRatio();
 
     // wl_egl_windows must have both width and height > 0
     // mesa's egl returns NULL if we try to create a, invalid wl_egl_window, however not all EGL
@@ -147,7 +147,7 @@ void QWaylandEglWindow::updateSurface(bool create)
 QRect QWaylandEglWindow::contentsRect() const
 {
     QRect r = geometry();
-    QMargins m = frameMargins();
+    QMargins m = surfaceMargins();
     return QRect(m.left(), m.bottom(), r.width(), r.height());
 }
 
@@ -180,14 +180,26 @@ EGLSurface QWaylandEglWindow::eglSurface() const
     return m_eglSurface;
 }
 
+bool QWaylandEglWindow::wantsDecorationSubSurfaces() const
+{
+    // Rendering straight into the EGL surface avoids a content FBO and a full
+    // window blit on every frame
+    return true;
+}
+
+bool QWaylandEglWindow::needToUpdateContentFBO() const
+{
+    return decoration() && !decorationSubSurfaces() && (m_resize || !m_contentFBO);
+}
+
 GLuint QWaylandEglWindow::contentFBO() const
 {
-    if (!decoration())
+    if (!decoration() || decorationSubSurfaces())
         return 0;
 
     if (m_resize || !m_contentFBO) {
         QOpenGLFramebufferObject *old = m_contentFBO;
-        QSize fboSize = geometry().size() * scale();
+        QSize fboSize = geometry().size() * devicePixelRatio();
         m_contentFBO = new QOpenGLFramebufferObject(fboSize.width(), fboSize.height(), QOpenGLFramebufferObject::CombinedDepthStencil);
 
         delete old;
@@ -204,7 +216,7 @@ GLuint QWaylandEglWindow::contentTexture() const
 
 void QWaylandEglWindow::bindContentFBO()
 {
-    if (decoration()) {
+    if (decoration() && !decorationSubSurfaces()) {
         contentFBO();
         m_contentFBO->bind();
     }
@@ -68,15 +68,20 @@ public:
     EGLSurface eglSurface() const;
     GLuint contentFBO() const;
     GLuint contentTexture() const;
-    bool needToUpdateContentFBO() const { return decoration() && (m_resize || !m_contentFBO); }
+    bool needToUpdateContentFBO() const;
 
     QSurfaceFormat format() const override;
 
     void bindContentFBO();
+    void setNeedsDecorationSubSurfaces(bool needs) { m_needsDecorationSubSurfaces = needs; }
 
     void invalidateSurface() override;
     void setVisible(bool visible) override;
 
+protected:
+    bool wantsDecorationSubSurfaces() const override;
+    bool needsDecorationSubSurfaces() const override { return m_needsDecorationSubSurfaces; }
+
 private:
     QWaylandEglClientBufferIntegration *m_clientBufferIntegration = nullptr;
     struct wl_egl_window *m_waylandEglWindow = nullptr;
@@ -87,6 +92,7 @@ private:
     EGLConfig m_eglConfig;
     mutable bool m_resize = false;
     mutable QOpenGLFramebufferObject *m_contentFBO = nullptr;
+    bool m_needsDecorationSubSurfaces = false;
 
     QSurfaceFormat m_format;
 };
@@ -43,7 +43,9 @@
 #include <QtWaylandClient/private/qwaylandwindow_p.h>
 #include <QtWaylandClient/private/qwaylandsubsurface_p.h>
 #include <QtWaylandClient/private/qwaylandabstractdecoration_p.h>
+#include <QtWaylandClient/private/qwaylanddecorationsubsurfaces_p.h>
 #include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtWaylandClient/private/qwaylandstartupprofiler_p.h>
 #include "qwaylandeglwindow.h"
 
 #include <QDebug>
@@ -148,8 +150,8 @@ public:
         QOpenGLTextureCache *cache = QOpenGLTextureCache::cacheForContext(m_context->context());
 
         QRect windowRect = window->window()->frameGeometry();
-        int scale = window->scale() ;
-        glViewport(0, 0, windowRect.width() * scale, windowRect.height() * scale);
+        qreal scale = window->devicePixelRatio();
+        glViewport(0, 0, qRound(windowRect.width() * scale), qRound(windowRect.height() * scale));
 
         glDisable(GL_DEPTH_TEST);
         glDisable(GL_BLEND);
@@ -211,7 +213,7 @@ public:
         m_blitProgram->setAttributeArray(0, squareVertices, 2);
         glBindTexture(GL_TEXTURE_2D, window->contentTexture());
         QRect r = window->contentsRect();
-        glViewport(r.x() * scale, r.y() * scale, r.width() * scale, r.height() * scale);
+        glViewport(qRound(r.x() * scale), qRound(r.y() * scale), qRound(r.width() * scale), qRound(r.height() * scale));
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         //Cleanup
@@ -406,9 +408,11 @@ bool QWaylandGLContext::makeCurrent(QPlatformSurface *surface)
     // Core profiles mandate the use of VAOs when rendering. We would then need to use one
     // in DecorationsBlitter, but for that we would need a QOpenGLFunctions_3_2_Core instead
     // of the QOpenGLFunctions we use, but that would break when using a lower version context.
-    // Instead of going crazy, just disable decorations for core profiles until we use
-    // subsurfaces for them.
-    if (m_format.profile() != QSurfaceFormat::CoreProfile && !window->decoration())
+    // Instead of going crazy, just disable decorations for core profiles unless they are
+    // drawn in subsurfaces.
+    const bool coreProfile = m_format.profile() == QSurfaceFormat::CoreProfile;
+    window->setNeedsDecorationSubSurfaces(coreProfile);
+    if (!window->decoration() || (coreProfile && !window->decorationSubSurfaces()))
         window->createDecoration();
 
     if (eglSurface == EGL_NO_SURFACE) {
@@ -534,7 +538,11 @@ void QWaylandGLContext::swapBuffers(QPlatformSurface *surface)
 
     EGLSurface eglSurface = window->eglSurface();
 
-    if (window->decoration()) {
+    if (QWaylandDecorationSubSurfaces *decorationSurfaces = window->decorationSubSurfaces()) {
+        // The decoration surfaces are synchronized, so this is applied together with
+        // the commit done by eglSwapBuffers()
+        decorationSurfaces->update();
+    } else if (window->decoration()) {
         makeCurrent(surface);
 
         // Must save & restore all state. Applications are usually not prepared
@@ -546,6 +554,7 @@ void QWaylandGLContext::swapBuffers(QPlatformSurface *surface)
         m_blitter->blit(window);
     }
 
+    window->requestPresentationFeedback();
 
     QWaylandSubSurface *sub = window->subSurfaceWindow();
     if (sub) {
@@ -559,7 +568,7 @@ void QWaylandGLContext::swapBuffers(QPlatformSurface *surface)
         eglSwapInterval(m_eglDisplay, m_format.swapInterval());
         eglSwapBuffers(m_eglDisplay, eglSurface);
     }
-
+    QWaylandStartupProfiler::mark(QWaylandStartupProfiler::FirstCommitPhase);
 
     window->setCanResize(true);
 }
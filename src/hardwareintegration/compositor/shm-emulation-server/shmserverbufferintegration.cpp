@@ -42,9 +42,45 @@
 #include <QtGui/QOpenGLContext>
 #include <QtGui/QOpenGLTexture>
 #include <QtCore/QSharedMemory>
+#include <QtCore/private/qcore_unix_p.h>
 
 #include <QtCore/QDebug>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h and linux/fcntl.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC         0x0001U
+#  endif
+#  ifndef MFD_ALLOW_SEALING
+#    define MFD_ALLOW_SEALING   0x0002U
+#  endif
+#  ifndef F_ADD_SEALS
+#    define F_ADD_SEALS         (1024 + 9)
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL         0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK       0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW         0x0004
+#  endif
+#  ifndef F_SEAL_WRITE
+#    define F_SEAL_WRITE        0x0008
+#  endif
+#  ifndef F_SEAL_FUTURE_WRITE
+#    define F_SEAL_FUTURE_WRITE 0x0010
+#  endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
 ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, const QImage &qimage, QtWayland::ServerBuffer::Format format)
@@ -68,21 +104,123 @@ ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, const
             break;
     }
 
-    QString key = "qt_shm_emulation_" + QString::number(qimage.cacheKey());
+    // Clients binding version 2 get the contents through a memfd, which can't
+    // leak when the compositor dies and is mapped directly by the clients. The
+    // QSharedMemory segment is only created if a client bound to version 1
+    // asks for the buffer. A second memfd is added the first time the buffer
+    // is updated, see update(). Clients that can't release a file after an
+    // update, i.e. those bound to version 2 or 3, get a snapshot of their own,
+    // see resourceForClient().
+    m_fds[0] = createMemfd(qimage, &m_data[0]);
+    if (m_fds[0] == -1)
+        m_image = qimage;
+}
+
+ShmServerBuffer::~ShmServerBuffer()
+{
+    const size_t size = size_t(m_bpl) * size_t(m_height);
+    for (int i = 0; i < 2; ++i) {
+        if (m_data[i])
+            munmap(m_data[i], size);
+        if (m_fds[i] != -1)
+            qt_safe_close(m_fds[i]);
+    }
+    if (m_snapshotFd != -1)
+        qt_safe_close(m_snapshotFd);
+    delete m_shm;
+}
+
+int ShmServerBuffer::createMemfd(const QImage &qimage, uchar **data)
+{
+    int fd = -1;
+#ifdef SYS_memfd_create
+    fd = int(syscall(SYS_memfd_create, "qt-shm-emulation-server-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+#endif
+    if (fd == -1)
+        return -1;
+
+    const size_t size = size_t(qimage.sizeInBytes());
+    if (ftruncate(fd, off_t(size)) != 0) {
+        qWarning("ShmServerBuffer: could not allocate server buffer: %s", strerror(errno));
+        qt_safe_close(fd);
+        return -1;
+    }
+
+    // The compositor keeps a writable mapping for updates, clients only ever
+    // get to map it read-only
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        qWarning("ShmServerBuffer: could not map server buffer: %s", strerror(errno));
+        qt_safe_close(fd);
+        return -1;
+    }
+    memcpy(mapping, qimage.constBits(), size);
+
+    // The buffer is shared by all clients, so none of them may write to it. F_SEAL_WRITE
+    // would also revoke the mapping above, so seal future writes where the kernel supports
+    // it (Linux 5.1), and only ever hand out a read-only descriptor.
+#ifdef F_ADD_SEALS
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) < 0)
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif
+
+    const QByteArray path = "/proc/self/fd/" + QByteArray::number(fd);
+    const int readOnlyFd = qt_safe_open(path.constData(), O_RDONLY);
+    qt_safe_close(fd);
+    if (readOnlyFd == -1) {
+        qWarning("ShmServerBuffer: could not open a read-only descriptor: %s", strerror(errno));
+        munmap(mapping, size);
+        return -1;
+    }
+
+    if (data)
+        *data = static_cast<uchar *>(mapping);
+    else
+        munmap(mapping, size);
+    return readOnlyFd;
+}
+
+static void copyRects(uchar *dst, const QImage &src, const QRegion &region)
+{
+    const int bytesPerPixel = src.depth() / 8;
+    const int bpl = src.bytesPerLine();
+    for (const QRect &rect : region) {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            memcpy(dst + y * bpl + rect.x() * bytesPerPixel,
+                   src.constScanLine(y) + rect.x() * bytesPerPixel,
+                   size_t(rect.width() * bytesPerPixel));
+        }
+    }
+}
+
+// Returns the current contents, without copying them when they are in a memfd
+QImage ShmServerBuffer::currentImage() const
+{
+    if (!m_data[m_current])
+        return m_image;
+    return QImage(m_data[m_current], m_width, m_height, m_bpl,
+                  m_format == A8 ? QImage::Format_Alpha8 : QImage::Format_RGBA8888);
+}
+
+bool ShmServerBuffer::createSharedMemory()
+{
+    if (m_shm)
+        return m_shm->isAttached();
+
+    const QImage image = currentImage();
+
+    QString key = "qt_shm_emulation_" + QString::number(image.cacheKey());
     m_shm = new QSharedMemory(key);
-    qsizetype shm_size = qimage.sizeInBytes();
+    qsizetype shm_size = image.sizeInBytes();
     bool ok = m_shm->create(shm_size) && m_shm->lock();
     if (ok) {
-        memcpy(m_shm->data(), qimage.constBits(), shm_size);
+        memcpy(m_shm->data(), image.constBits(), shm_size);
         m_shm->unlock();
     } else {
         qWarning() << "Could not create shared memory" << key << shm_size;
     }
-}
-
-ShmServerBuffer::~ShmServerBuffer()
-{
-    delete m_shm;
+    m_image = QImage();
+    return ok;
 }
 
 struct ::wl_resource *ShmServerBuffer::resourceForClient(struct ::wl_client *client)
@@ -95,6 +233,30 @@ struct ::wl_resource *ShmServerBuffer::resourceForClient(struct ::wl_client *cli
             return nullptr;
         }
         struct ::wl_resource *shm_integration_resource = integrationResource->handle;
+        const int version = integrationResource->version();
+        if (m_fds[0] != -1 && version >= 4) {
+            Resource *resource = add(client, 1);
+            m_integration->send_server_buffer_created_fd(shm_integration_resource, resource->handle, m_fds[0], m_width, m_height, m_bpl, m_shm_format);
+            if (m_current != 0)
+                sendUpdate(resource, QRect(0, 0, m_width, m_height));
+            return resource->handle;
+        }
+        if (m_fds[0] != -1 && version >= 2) {
+            // Version 2 clients only know about one file and are not told about
+            // updates, version 3 clients don't tell when they stopped reading
+            // from a file. Either of the two files may be rewritten under them,
+            // so they get a snapshot of the current contents instead, which is
+            // shared until the next update.
+            if (m_snapshotFd == -1)
+                m_snapshotFd = createMemfd(currentImage(), nullptr);
+            if (m_snapshotFd != -1) {
+                Resource *resource = add(client, 1);
+                m_integration->send_server_buffer_created_fd(shm_integration_resource, resource->handle, m_snapshotFd, m_width, m_height, m_bpl, m_shm_format);
+                return resource->handle;
+            }
+        }
+        if (!createSharedMemory())
+            return nullptr;
         Resource *resource = add(client, 1);
         m_integration->send_server_buffer_created(shm_integration_resource, resource->handle, m_shm->key(), m_width, m_height, m_bpl, m_shm_format);
         return resource->handle;
@@ -102,6 +264,119 @@ struct ::wl_resource *ShmServerBuffer::resourceForClient(struct ::wl_client *cli
     return bufferResource->handle;
 }
 
+bool ShmServerBuffer::update(const QImage &image, const QRegion &damage)
+{
+    if (image.size() != QSize(m_width, m_height) || image.bytesPerLine() != m_bpl) {
+        qWarning("ShmServerBuffer::update: the image does not match the size and layout of the buffer");
+        return false;
+    }
+
+    const QRegion region = damage & QRect(0, 0, m_width, m_height);
+    if (region.isEmpty())
+        return true;
+
+    // The file to write to is the one clients switched away from on the last
+    // update. As long as one of them hasn't released it, the update waits and
+    // is merged with any that follow.
+    if (!m_backBufferReaders.isEmpty()) {
+        m_pendingImage = image;
+        m_pendingDamage += region;
+        return true;
+    }
+
+    // Clients that already got the snapshot keep it, the next ones get a new one
+    if (m_snapshotFd != -1) {
+        qt_safe_close(m_snapshotFd);
+        m_snapshotFd = -1;
+    }
+
+    if (m_shm && m_shm->isAttached() && m_shm->lock()) {
+        copyRects(static_cast<uchar *>(m_shm->data()), image, region);
+        m_shm->unlock();
+    }
+
+    if (m_fds[0] == -1) {
+        if (!m_shm)
+            m_image = image;
+        return true;
+    }
+
+    // Write into the file clients are not reading from, bringing it up to date
+    // with the previous update as well, then flip. Clients switch files when
+    // they get the update event, so they never see a half written update.
+    const int back = 1 - m_current;
+    if (m_fds[back] == -1) {
+        m_fds[back] = createMemfd(image, &m_data[back]);
+        if (m_fds[back] == -1) {
+            // No second file, update in place
+            copyRects(m_data[m_current], image, region);
+            for (Resource *resource : resourceMap())
+                sendUpdate(resource, region);
+            return true;
+        }
+    } else {
+        copyRects(m_data[back], image, m_backDamage | region);
+    }
+    m_backDamage = region;
+    m_current = back;
+
+    for (Resource *resource : resourceMap())
+        sendUpdate(resource, region);
+    return true;
+}
+
+void ShmServerBuffer::sendUpdate(Resource *resource, const QRegion &region)
+{
+    auto integrationResource = m_integration->resourceMap().value(resource->client());
+    if (!integrationResource || integrationResource->version() < 4)
+        return;
+
+    // Until it releases it, the client may still be reading from the other file
+    if (m_fds[1] != -1)
+        m_backBufferReaders.insert(resource);
+
+    if (m_fds[1] != -1 && !m_backBufferSent.contains(resource)) {
+        m_integration->send_server_buffer_back_buffer(integrationResource->handle, resource->handle, m_fds[1]);
+        m_backBufferSent.insert(resource);
+    }
+
+    QByteArray rects;
+    rects.reserve(region.rectCount() * 4 * int(sizeof(int32_t)));
+    for (const QRect &rect : region) {
+        const int32_t values[] = { rect.x(), rect.y(), rect.width(), rect.height() };
+        rects.append(reinterpret_cast<const char *>(values), int(sizeof(values)));
+    }
+    m_integration->send_server_buffer_updated(integrationResource->handle, resource->handle, uint32_t(m_current), rects);
+}
+
+// Called when the client of \a resource stopped reading from file \a slot
+void ShmServerBuffer::release(Resource *resource, uint slot)
+{
+    if (int(slot) == m_current)
+        return;
+
+    m_backBufferReaders.remove(resource);
+    flushPendingUpdate();
+}
+
+void ShmServerBuffer::flushPendingUpdate()
+{
+    if (!m_backBufferReaders.isEmpty() || m_pendingImage.isNull())
+        return;
+
+    const QImage image = m_pendingImage;
+    const QRegion region = m_pendingDamage;
+    m_pendingImage = QImage();
+    m_pendingDamage = QRegion();
+    update(image, region);
+}
+
+void ShmServerBuffer::server_buffer_destroy_resource(Resource *resource)
+{
+    m_backBufferSent.remove(resource);
+    m_backBufferReaders.remove(resource);
+    flushPendingUpdate();
+}
 
 QOpenGLTexture *ShmServerBuffer::toOpenGlTexture()
 {
@@ -123,7 +398,15 @@ void ShmServerBufferIntegration::initializeHardware(QWaylandCompositor *composit
 {
     Q_ASSERT(QGuiApplication::platformNativeInterface());
 
-    QtWaylandServer::qt_shm_emulation_server_buffer::init(compositor->display(), 1);
+    QtWaylandServer::qt_shm_emulation_server_buffer::init(compositor->display(), 4);
+}
+
+void ShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_release(Resource *resource, struct ::wl_resource *buffer, uint32_t slot)
+{
+    Q_UNUSED(resource);
+    auto *bufferResource = QtWaylandServer::qt_server_buffer::Resource::fromResource(buffer);
+    if (bufferResource)
+        static_cast<ShmServerBuffer *>(bufferResource->server_buffer_object)->release(bufferResource, slot);
 }
 
 bool ShmServerBufferIntegration::supportsFormat(QtWayland::ServerBuffer::Format format) const
@@ -44,7 +44,9 @@
 
 #include "qwayland-server-shm-emulation-server-buffer.h"
 
+#include <QtCore/QSet>
 #include <QtGui/QImage>
+#include <QtGui/QRegion>
 #include <QtGui/QWindow>
 #include <QtGui/qpa/qplatformnativeinterface.h>
 #include <QtGui/QGuiApplication>
@@ -65,10 +67,32 @@ public:
 
     struct ::wl_resource *resourceForClient(struct ::wl_client *) override;
     QOpenGLTexture *toOpenGlTexture() override;
+    bool update(const QImage &image, const QRegion &damage) override;
+
+    void release(Resource *resource, uint slot);
+
+protected:
+    void server_buffer_destroy_resource(Resource *resource) override;
 
 private:
+    static int createMemfd(const QImage &qimage, uchar **data);
+    QImage currentImage() const;
+    bool createSharedMemory();
+    void sendUpdate(Resource *resource, const QRegion &region);
+    void flushPendingUpdate();
+
     ShmServerBufferIntegration *m_integration = nullptr;
 
+    QImage m_image;
+    int m_fds[2] = { -1, -1 };
+    uchar *m_data[2] = { nullptr, nullptr };
+    int m_current = 0;
+    int m_snapshotFd = -1;
+    QRegion m_backDamage;
+    QSet<Resource *> m_backBufferSent;
+    QSet<Resource *> m_backBufferReaders;
+    QImage m_pendingImage;
+    QRegion m_pendingDamage;
     QSharedMemory *m_shm = nullptr;
     int m_width;
     int m_height;
@@ -90,8 +114,8 @@ public:
     bool supportsFormat(QtWayland::ServerBuffer::Format format) const override;
     QtWayland::ServerBuffer *createServerBufferFromImage(const QImage &qimage, QtWayland::ServerBuffer::Format format) override;
 
-
-private:
+protected:
+    void shm_emulation_server_buffer_server_buffer_release(Resource *resource, struct ::wl_resource *buffer, uint32_t slot) override;
 };
 
 QT_END_NAMESPACE
@@ -42,11 +42,16 @@
 #include <QtGui/QPainter>
 #include <QtGui/QPalette>
 #include <QtGui/QLinearGradient>
+#include <QtGui/QPainterPath>
+#include <QtGui/QPixmap>
+#include <QtGui/QTextLayout>
 
 #include <qpa/qwindowsysteminterface.h>
 
 #include <QtWaylandClient/private/qwaylanddecorationplugin_p.h>
 #include <QtWaylandClient/private/qwaylandabstractdecoration_p.h>
+#include <QtWaylandClient/private/qwaylanddisplay_p.h>
+#include <QtWaylandClient/private/qwaylandglyphcache_p.h>
 #include <QtWaylandClient/private/qwaylandwindow_p.h>
 #include <QtWaylandClient/private/qwaylandshellsurface_p.h>
 
@@ -137,6 +142,7 @@ public:
 protected:
     QMargins margins() const override;
     void paint(QPaintDevice *device) override;
+    void paintDecoration(QPainter *painter, const QRegion &region) override;
     bool handleMouse(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global,Qt::MouseButtons b,Qt::KeyboardModifiers mods) override;
     bool handleTouch(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global, Qt::TouchPointState state, Qt::KeyboardModifiers mods) override;
 private:
@@ -149,10 +155,19 @@ private:
     QRectF closeButtonRect() const;
     QRectF maximizeButtonRect() const;
     QRectF minimizeButtonRect() const;
+    QRect iconRect() const;
 
     QColor m_foregroundColor;
     QColor m_backgroundColor;
-    QStaticText m_windowTitle;
+    QLinearGradient m_gradient;
+    QFont m_titleFont;
+    QString m_windowTitle;
+    QList<QGlyphRun> m_titleGlyphRuns;
+    QSizeF m_titleSize;
+    QPainterPath m_frameShape;
+    QSize m_frameShapeSize;
+    QPixmap m_icon;
+    qint64 m_iconCacheKey = 0;
     Button m_clicking = None;
 };
 
@@ -164,9 +179,12 @@ QWaylandBradientDecoration::QWaylandBradientDecoration()
     m_foregroundColor = palette.color(QPalette::Active, QPalette::HighlightedText);
     m_backgroundColor = palette.color(QPalette::Active, QPalette::Highlight);
 
-    QTextOption option(Qt::AlignHCenter | Qt::AlignVCenter);
-    option.setWrapMode(QTextOption::NoWrap);
-    m_windowTitle.setTextOption(option);
+    m_titleFont.setBold(true);
+
+    // The title bar gradient only depends on the top margin, so it's built once
+    m_gradient = QLinearGradient(0, 0, 0, margins().top() - 1);
+    m_gradient.setColorAt(0, m_backgroundColor.lighter(100));
+    m_gradient.setColorAt(1, m_backgroundColor.darker(180));
 }
 
 QRectF QWaylandBradientDecoration::closeButtonRect() const
@@ -187,6 +205,11 @@ QRectF QWaylandBradientDecoration::minimizeButtonRect() const
                   (margins().top() - BUTTON_WIDTH) / 2, BUTTON_WIDTH, BUTTON_WIDTH);
 }
 
+QRect QWaylandBradientDecoration::iconRect() const
+{
+    return QRect(margins().left() + BUTTON_SPACING, 4, 22, 22);
+}
+
 QMargins QWaylandBradientDecoration::margins() const
 {
     return QMargins(3, 30, 3, 3);
@@ -194,88 +217,114 @@ QMargins QWaylandBradientDecoration::margins() const
 
 void QWaylandBradientDecoration::paint(QPaintDevice *device)
 {
+    QPainter p(device);
+    paintDecoration(&p, QRect(QPoint(), window()->frameGeometry().size()));
+}
+
+void QWaylandBradientDecoration::paintDecoration(QPainter *painter, const QRegion &region)
+{
+    QPainter &p = *painter;
     QRect surfaceRect(QPoint(), window()->frameGeometry().size());
     QRect clips[] =
     {
         QRect(0, 0, surfaceRect.width(), margins().top()),
         QRect(0, surfaceRect.height() - margins().bottom(), surfaceRect.width(), margins().bottom()),
         QRect(0, margins().top(), margins().left(), surfaceRect.height() - margins().top() - margins().bottom()),
-        QRect(surfaceRect.width() - margins().right(), margins().top(), margins().left(), surfaceRect.height() - margins().top() - margins().bottom())
+        QRect(surfaceRect.width() - margins().right(), margins().top(), margins().right(), surfaceRect.height() - margins().top() - margins().bottom())
     };
 
     QRect top = clips[0];
 
-    QPainter p(device);
+    p.save();
     p.setRenderHint(QPainter::Antialiasing);
 
     // Title bar
-    QLinearGradient grad(top.topLeft(), top.bottomLeft());
-    QColor base(m_backgroundColor);
-    grad.setColorAt(0, base.lighter(100));
-    grad.setColorAt(1, base.darker(180));
-    QPainterPath roundedRect;
-    roundedRect.addRoundedRect(surfaceRect, 6, 6);
+    if (m_frameShapeSize != surfaceRect.size()) {
+        m_frameShape = QPainterPath();
+        m_frameShape.addRoundedRect(surfaceRect, 6, 6);
+        m_frameShapeSize = surfaceRect.size();
+    }
     for (int i = 0; i < 4; ++i) {
+        if (!region.intersects(clips[i]))
+            continue;
         p.save();
-        p.setClipRect(clips[i]);
-        p.fillPath(roundedRect, grad);
+        p.setClipRect(clips[i], Qt::IntersectClip);
+        p.fillPath(m_frameShape, m_gradient);
         p.restore();
     }
 
     // Window icon
     QIcon icon = waylandWindow()->windowIcon();
-    if (!icon.isNull()) {
+    if (!icon.isNull() && region.intersects(iconRect())) {
         QPixmap pixmap = icon.pixmap(QSize(128, 128));
-        QPixmap scaled = pixmap.scaled(22, 22, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-
-        QRectF iconRect(0, 0, 22, 22);
-        p.drawPixmap(iconRect.adjusted(margins().left() + BUTTON_SPACING, 4,
-                                       margins().left() + BUTTON_SPACING, 4),
-                     scaled, iconRect);
+        if (pixmap.cacheKey() != m_iconCacheKey) {
+            m_icon = pixmap.scaled(22, 22, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            m_iconCacheKey = pixmap.cacheKey();
+        }
+        p.drawPixmap(iconRect(), m_icon, m_icon.rect());
     }
 
     // Window title
     QString windowTitleText = window()->title();
-    if (!windowTitleText.isEmpty()) {
-        if (m_windowTitle.text() != windowTitleText) {
-            m_windowTitle.setText(windowTitleText);
-            m_windowTitle.prepare();
+    QRect titleBar = top;
+    titleBar.setLeft(margins().left() + BUTTON_SPACING +
+        (icon.isNull() ? 0 : 22 + BUTTON_SPACING));
+    titleBar.setRight(minimizeButtonRect().left() - BUTTON_SPACING);
+    if (!windowTitleText.isEmpty() && region.intersects(titleBar)) {
+        // Lay the title out only when it changes, and draw its glyphs from
+        // the compositor's glyph cache when there is one
+        if (m_windowTitle != windowTitleText) {
+            QTextLayout layout(windowTitleText, m_titleFont);
+            layout.beginLayout();
+            QTextLine line = layout.createLine();
+            layout.endLayout();
+            m_windowTitle = windowTitleText;
+            m_titleGlyphRuns = layout.glyphRuns();
+            m_titleSize = QSizeF(line.naturalTextWidth(), line.height());
         }
 
-        QRect titleBar = top;
-        titleBar.setLeft(margins().left() + BUTTON_SPACING +
-            (icon.isNull() ? 0 : 22 + BUTTON_SPACING));
-        titleBar.setRight(minimizeButtonRect().left() - BUTTON_SPACING);
-
         p.save();
-        p.setClipRect(titleBar);
+        p.setClipRect(titleBar, Qt::IntersectClip);
         p.setPen(m_foregroundColor);
-        QSizeF size = m_windowTitle.size();
-        int dx = (top.width() - size.width()) /2;
-        int dy = (top.height()- size.height()) /2;
-        QFont font = p.font();
-        font.setBold(true);
-        p.setFont(font);
+        int dx = (top.width() - m_titleSize.width()) /2;
+        int dy = (top.height()- m_titleSize.height()) /2;
         QPoint windowTitlePoint(top.topLeft().x() + dx,
                  top.topLeft().y() + dy);
-        p.drawStaticText(windowTitlePoint, m_windowTitle);
+        QWaylandGlyphCache *glyphCache = waylandWindow()->display()->glyphCache();
+        for (const QGlyphRun &run : qAsConst(m_titleGlyphRuns)) {
+            if (glyphCache)
+                glyphCache->drawGlyphRun(&p, windowTitlePoint, run);
+            else
+                p.drawGlyphRun(windowTitlePoint, run);
+        }
         p.restore();
     }
 
+    // Only the buttons inside the region are repainted
+    const bool paintClose = region.intersects(closeButtonRect().toAlignedRect());
+    const bool paintMaximize = region.intersects(maximizeButtonRect().toAlignedRect());
+    const bool paintMinimize = region.intersects(minimizeButtonRect().toAlignedRect());
+
 #if QT_CONFIG(imageformat_xpm)
     p.save();
 
     // Close button
-    QPixmap closePixmap(qt_close_xpm);
-    p.drawPixmap(closeButtonRect(), closePixmap, closePixmap.rect());
+    if (paintClose) {
+        QPixmap closePixmap(qt_close_xpm);
+        p.drawPixmap(closeButtonRect(), closePixmap, closePixmap.rect());
+    }
 
     // Maximize button
-    QPixmap maximizePixmap((window()->windowStates() & Qt::WindowMaximized) ? qt_normalizeup_xpm : qt_maximize_xpm);
-    p.drawPixmap(maximizeButtonRect(), maximizePixmap, maximizePixmap.rect());
+    if (paintMaximize) {
+        QPixmap maximizePixmap((window()->windowStates() & Qt::WindowMaximized) ? qt_normalizeup_xpm : qt_maximize_xpm);
+        p.drawPixmap(maximizeButtonRect(), maximizePixmap, maximizePixmap.rect());
+    }
 
     // Minimize button
-    QPixmap minimizePixmap(qt_minimize_xpm);
-    p.drawPixmap(minimizeButtonRect(), minimizePixmap, minimizePixmap.rect());
+    if (paintMinimize) {
+        QPixmap minimizePixmap(qt_minimize_xpm);
+        p.drawPixmap(minimizeButtonRect(), minimizePixmap, minimizePixmap.rect());
+    }
 
     p.restore();
 #else
@@ -289,43 +338,51 @@ void QWaylandBradientDecoration::paint(QPaintDevice *device)
     p.setPen(pen);
 
     // Close button
-    p.save();
-    rect = closeButtonRect();
-    p.drawRect(rect);
-    qreal crossSize = rect.height() / 2;
-    QPointF crossCenter(rect.center());
-    QRectF crossRect(crossCenter.x() - crossSize / 2, crossCenter.y() - crossSize / 2, crossSize, crossSize);
-    pen.setWidth(2);
-    p.setPen(pen);
-    p.drawLine(crossRect.topLeft(), crossRect.bottomRight());
-    p.drawLine(crossRect.bottomLeft(), crossRect.topRight());
-    p.restore();
+    if (paintClose) {
+        p.save();
+        rect = closeButtonRect();
+        p.drawRect(rect);
+        qreal crossSize = rect.height() / 2;
+        QPointF crossCenter(rect.center());
+        QRectF crossRect(crossCenter.x() - crossSize / 2, crossCenter.y() - crossSize / 2, crossSize, crossSize);
+        pen.setWidth(2);
+        p.setPen(pen);
+        p.drawLine(crossRect.topLeft(), crossRect.bottomRight());
+        p.drawLine(crossRect.bottomLeft(), crossRect.topRight());
+        p.restore();
+    }
 
     // Maximize button
-    p.save();
-    p.drawRect(maximizeButtonRect());
-    rect = maximizeButtonRect().adjusted(5, 5, -5, -5);
-    if (waylandWindow()->isMaximized()) {
-        QRectF rect1 = rect.adjusted(rect.width() / 3, 0, 0, -rect.height() / 3);
-        QRectF rect2 = rect.adjusted(0, rect.height() / 4, -rect.width() / 4, 0);
-        p.drawRect(rect1);
-        p.drawRect(rect2);
-    } else {
-        p.setPen(m_foregroundColor);
-        p.drawRect(rect);
-        p.drawLine(rect.left(), rect.top() + 1, rect.right(), rect.top() + 1);
+    if (paintMaximize) {
+        p.save();
+        p.drawRect(maximizeButtonRect());
+        rect = maximizeButtonRect().adjusted(5, 5, -5, -5);
+        if (waylandWindow()->isMaximized()) {
+            QRectF rect1 = rect.adjusted(rect.width() / 3, 0, 0, -rect.height() / 3);
+            QRectF rect2 = rect.adjusted(0, rect.height() / 4, -rect.width() / 4, 0);
+            p.drawRect(rect1);
+            p.drawRect(rect2);
+        } else {
+            p.setPen(m_foregroundColor);
+            p.drawRect(rect);
+            p.drawLine(rect.left(), rect.top() + 1, rect.right(), rect.top() + 1);
+        }
+        p.restore();
     }
-    p.restore();
 
     // Minimize button
-    p.save();
-    p.drawRect(minimizeButtonRect());
-    rect = minimizeButtonRect().adjusted(5, 5, -5, -5);
-    pen.setWidth(2);
-    p.setPen(pen);
-    p.drawLine(rect.bottomLeft(), rect.bottomRight());
-    p.restore();
+    if (paintMinimize) {
+        p.save();
+        p.drawRect(minimizeButtonRect());
+        rect = minimizeButtonRect().adjusted(5, 5, -5, -5);
+        pen.setWidth(2);
+        p.setPen(pen);
+        p.drawLine(rect.bottomLeft(), rect.bottomRight());
+        p.restore();
+    }
 #endif
+
+    p.restore();
 }
 
 bool QWaylandBradientDecoration::clickButton(Qt::MouseButtons b, Button btn)
@@ -1,7 +1,7 @@
 # We have a bunch of C code with casts, so we can't have this option
 QMAKE_CXXFLAGS_WARN_ON -= -Wcast-qual
 
-QT += waylandclient-private
+QT += waylandclient-private core-private
 
 include(../../../../hardwareintegration/client/shm-emulation-server/shm-emulation-server.pri)
 
@@ -0,0 +1,241 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylanddatawriter_p.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    QWaylandDataWriter streams selection and drag-and-drop payloads into the
+    file descriptors handed out by wl_data_source.send and wl_data_offer.receive.
+
+    Every fd is switched to non-blocking mode and written as far as the reader
+    allows; the rest is written in chunks whenever a socket notifier reports
+    the fd as writable. A reader that stops reading therefore never blocks the
+    calling thread, and is dropped once it has made no progress for
+    stallTimeout() milliseconds.
+*/
+
+struct QWaylandDataWriter::Transfer
+{
+    int fd;
+    bool isSocket;
+    QByteArray data;
+    int offset;
+    QSocketNotifier *notifier;
+    QElapsedTimer lastProgress;
+};
+
+// Writes without ever raising SIGPIPE, so that a reader closing its end
+// early cannot terminate the process.
+static qint64 writeWithoutSigpipe(int fd, bool isSocket, const char *data, qint64 size)
+{
+    if (isSocket)
+        return ::send(fd, data, size_t(size), MSG_NOSIGNAL);
+
+    // Pipes have no MSG_NOSIGNAL; block SIGPIPE in this thread instead and
+    // consume the signal if the write raised it.
+    sigset_t pipeSet, oldSet, pendingSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+    sigpending(&pendingSet);
+    const bool alreadyPending = sigismember(&pendingSet, SIGPIPE);
+
+    const qint64 n = qt_safe_write(fd, data, size);
+    if (n < 0 && errno == EPIPE && !alreadyPending) {
+        const int savedErrno = errno;
+        const struct timespec zero = { 0, 0 };
+        while (sigtimedwait(&pipeSet, nullptr, &zero) == -1 && errno == EINTR)
+            ;
+        errno = savedErrno;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+    return n;
+}
+
+QWaylandDataWriter::QWaylandDataWriter(QObject *parent)
+    : QObject(parent)
+{
+    m_stallTimer.setInterval(1000);
+    connect(&m_stallTimer, &QTimer::timeout, this, [this]() { cancelStalledTransfers(); });
+}
+
+QWaylandDataWriter::~QWaylandDataWriter()
+{
+    cancelAll();
+}
+
+/*
+    Writes \a data to \a fd and closes it when done. The writer takes
+    ownership of \a fd.
+*/
+void QWaylandDataWriter::write(int fd, const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        qt_safe_close(fd);
+        return;
+    }
+
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    QT_STATBUF st;
+    const bool isSocket = QT_FSTAT(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+
+#ifdef F_SETPIPE_SZ
+    // Let a large payload go through in as few wakeups as the system permits.
+    // This is a hint; it fails for sockets or above fs.pipe-max-size.
+    if (!isSocket && data.size() > 64 * 1024)
+        ::fcntl(fd, F_SETPIPE_SZ, qMin(data.size(), 1024 * 1024));
+#endif
+
+    Transfer *transfer = new Transfer { fd, isSocket, data, 0, nullptr, QElapsedTimer() };
+    transfer->lastProgress.start();
+
+    // Most payloads fit into the pipe right away
+    if (!writeAvailable(transfer))
+        return;
+
+    transfer->notifier = new QSocketNotifier(fd, QSocketNotifier::Write, this);
+    connect(transfer->notifier, &QSocketNotifier::activated, this, [this, transfer]() {
+        writeAvailable(transfer);
+    });
+    m_transfers.append(transfer);
+
+    if (m_stallTimeout > 0 && !m_stallTimer.isActive())
+        m_stallTimer.start();
+}
+
+/*
+    Writes as much of \a transfer as the reader accepts without blocking.
+    Returns \c true if the transfer is still pending, otherwise it has been
+    finished and deleted.
+*/
+bool QWaylandDataWriter::writeAvailable(Transfer *transfer)
+{
+    while (transfer->offset < transfer->data.size()) {
+        const qint64 n = writeWithoutSigpipe(transfer->fd, transfer->isSocket,
+                                             transfer->data.constData() + transfer->offset,
+                                             transfer->data.size() - transfer->offset);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true;
+            // The reader went away, which is its prerogative
+            break;
+        }
+        transfer->offset += int(n);
+        transfer->lastProgress.start();
+    }
+
+    finish(transfer);
+    return false;
+}
+
+void QWaylandDataWriter::finish(Transfer *transfer)
+{
+    m_transfers.removeOne(transfer);
+    if (m_transfers.isEmpty())
+        m_stallTimer.stop();
+
+    if (transfer->notifier) {
+        transfer->notifier->setEnabled(false);
+        transfer->notifier->deleteLater();
+    }
+    qt_safe_close(transfer->fd);
+    delete transfer;
+}
+
+/*
+    Aborts all pending transfers and closes their file descriptors. Readers
+    see a truncated payload.
+*/
+void QWaylandDataWriter::cancelAll()
+{
+    while (!m_transfers.isEmpty())
+        finish(m_transfers.last());
+}
+
+int QWaylandDataWriter::pendingTransfers() const
+{
+    return m_transfers.size();
+}
+
+int QWaylandDataWriter::stallTimeout() const
+{
+    return m_stallTimeout;
+}
+
+/*
+    Sets the time a reader may go without accepting any data before its
+    transfer is cancelled to \a msecs. A value of 0 disables the timeout.
+*/
+void QWaylandDataWriter::setStallTimeout(int msecs)
+{
+    m_stallTimeout = qMax(0, msecs);
+    if (m_stallTimeout == 0)
+        m_stallTimer.stop();
+    else if (!m_transfers.isEmpty())
+        m_stallTimer.start();
+}
+
+void QWaylandDataWriter::cancelStalledTransfers()
+{
+    const QVector<Transfer *> transfers = m_transfers;
+    for (Transfer *transfer : transfers) {
+        if (transfer->lastProgress.hasExpired(m_stallTimeout)) {
+            qWarning("QWaylandDataWriter: cancelling transfer to a reader that stopped reading");
+            finish(transfer);
+        }
+    }
+}
+
+QT_END_NAMESPACE
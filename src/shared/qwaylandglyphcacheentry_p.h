@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the plugins of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWAYLANDGLYPHCACHEENTRY_P_H
+#define QWAYLANDGLYPHCACHEENTRY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QByteArray>
+#include <QtCore/QCryptographicHash>
+#include <QtGui/QRawFont>
+
+QT_BEGIN_NAMESPACE
+
+// One entry of the glyph table files of zqt_glyph_cache_v1, shared by the
+// compositor and the client since it is part of the protocol.
+struct QWaylandGlyphCacheEntry
+{
+    quint32 glyphIndex;
+    quint32 atlas;
+    qint16 x;
+    qint16 y;
+    quint16 width;
+    quint16 height;
+    qint16 left;
+    qint16 top;
+};
+
+Q_STATIC_ASSERT(sizeof(QWaylandGlyphCacheEntry) == 20);
+
+// Identifies the font file a QRawFont was loaded from, so that glyph indexes
+// are only shared between processes using the same version of the same file.
+// The checksum adjustment in "head" covers the whole file; "maxp" and "cmap"
+// are added so fonts with a bogus checksum are still told apart. Weight,
+// style and hinting change how glyphs are rendered, so they are part of it
+// too. Returns an empty id for fonts without SFNT tables, which can't be
+// shared.
+inline QByteArray qWaylandGlyphCacheFontId(const QRawFont &font)
+{
+    const QByteArray head = font.fontTable("head");
+    if (head.isEmpty())
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(head);
+    hash.addData(font.fontTable("maxp"));
+    hash.addData(font.fontTable("cmap"));
+    const qint32 properties[] = { font.weight(), font.style(), font.hintingPreference() };
+    hash.addData(reinterpret_cast<const char *>(properties), sizeof(properties));
+    return hash.result();
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDGLYPHCACHEENTRY_P_H
@@ -259,23 +259,79 @@ QWaylandInputMethodContentType QWaylandInputMethodContentType::convert(Qt::Input
     return QWaylandInputMethodContentType{hint, purpose};
 }
 
+namespace {
+
+// Returns the number of UTF-8 bytes QString::toUtf8() produces for the code point
+// starting at \a c, and sets \a units to the number of UTF-16 code units it takes.
+inline int utf8Length(const QChar *c, const QChar *end, int *units)
+{
+    const ushort u = c->unicode();
+    *units = 1;
+    if (u < 0x80)
+        return 1;
+    if (u < 0x800)
+        return 2;
+    if (QChar::isHighSurrogate(u) && c + 1 < end && c[1].isLowSurrogate()) {
+        *units = 2;
+        return 4;
+    }
+    if (QChar::isSurrogate(u))
+        return 1; // Unpaired surrogates are encoded as '?'
+    return 3;
+}
+
+}
+
+// The conversions below walk the text in place rather than converting it to UTF-8,
+// so their cost depends on the distance covered, not on the length of the text.
 int QWaylandInputMethodEventBuilder::indexFromWayland(const QString &text, int length, int base)
 {
     if (length == 0)
         return base;
 
+    base = qBound(0, base, text.length());
+    const QChar *begin = text.unicode();
+    const QChar *end = begin + text.length();
+    int units = 0;
+
     if (length < 0) {
-        const QByteArray &utf8 = text.leftRef(base).toUtf8();
-        return QString::fromUtf8(utf8.left(qMax(utf8.length() + length, 0))).length();
+        int remaining = -length;
+        int pos = base;
+        while (remaining > 0 && pos > 0) {
+            // Step back over a whole surrogate pair if there is one
+            int start = pos - 1;
+            if (start > 0 && begin[start].isLowSurrogate() && begin[start - 1].isHighSurrogate())
+                --start;
+            const int bytes = utf8Length(begin + start, begin + pos, &units);
+            if (bytes > remaining)
+                break; // A partially deleted character is kept
+            remaining -= bytes;
+            pos = start;
+        }
+        return pos;
     } else {
-        const QByteArray &utf8 = text.midRef(base).toUtf8();
-        return QString::fromUtf8(utf8.left(length)).length() + base;
+        int remaining = length;
+        const QChar *c = begin + base;
+        while (remaining > 0 && c < end) {
+            remaining -= utf8Length(c, end, &units);
+            c += units;
+        }
+        return c - begin;
     }
 }
 
 int QWaylandInputMethodEventBuilder::indexToWayland(const QString &text, int length, int base)
 {
-    return text.midRef(base, length).toUtf8().size();
+    const QStringRef range = text.midRef(base, length);
+    const QChar *c = range.unicode();
+    const QChar *end = c + range.size();
+    int bytes = 0;
+    int units = 0;
+    while (c < end) {
+        bytes += utf8Length(c, end, &units);
+        c += units;
+    }
+    return bytes;
 }
 
 QT_END_NAMESPACE
@@ -43,43 +43,214 @@
 #include <QUrl>
 #include <QBuffer>
 #include <QImageWriter>
+#include <QHash>
+#include <QMutex>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 QT_BEGIN_NAMESPACE
 
+namespace {
+
+QByteArray encodeImage(const QImage &image, const QByteArray &format)
+{
+    QBuffer buf;
+    buf.open(QIODevice::ReadWrite);
+    QImageWriter wr(&buf, format);
+    wr.write(image);
+    return buf.buffer();
+}
+
+// An encoded payload, possibly still being produced on a worker thread
+struct EncodedPayload
+{
+    explicit EncodedPayload(const QByteArray &encoded = QByteArray())
+        : data(encoded)
+        , done(true)
+    {
+    }
+
+    EncodedPayload(const QImage &source, const QByteArray &format)
+        : image(source)
+        , imageFormat(format)
+        , done(false)
+    {
+    }
+
+    // Encodes the image unless another thread already does
+    void encode()
+    {
+        if (!claimed.testAndSetRelaxed(0, 1))
+            return;
+        const QByteArray encoded = encodeImage(image, imageFormat);
+        image = QImage();
+
+        QMutexLocker locker(&mutex);
+        data = encoded;
+        done = true;
+        finished.wakeAll();
+    }
+
+    QByteArray wait()
+    {
+        encode();
+        QMutexLocker locker(&mutex);
+        while (!done)
+            finished.wait(&mutex);
+        return data;
+    }
+
+    QImage image;
+    QByteArray imageFormat;
+    QAtomicInt claimed;
+
+    QMutex mutex;
+    QWaitCondition finished;
+    QByteArray data;
+    bool done;
+};
+
+class ImageEncodeTask : public QRunnable
+{
+public:
+    explicit ImageEncodeTask(const QSharedPointer<EncodedPayload> &payload)
+        : m_payload(payload)
+    {
+    }
+
+    void run() override
+    {
+        m_payload->encode();
+    }
+
+private:
+    QSharedPointer<EncodedPayload> m_payload;
+};
+
+// The source each payload was encoded from, to notice when the data changes
+struct CacheEntry
+{
+    QString text;
+    QList<QUrl> urls;
+    qint64 imageKey = 0;
+    QSharedPointer<EncodedPayload> payload;
+};
+
+typedef QHash<QString, CacheEntry> MimeDataCache;
+
+// Shared by every thread using the helper; lock the mutex around any access
+struct MimeDataCaches
+{
+    QMutex mutex;
+    QHash<const QMimeData *, MimeDataCache> caches;
+};
+Q_GLOBAL_STATIC(MimeDataCaches, encodedPayloads)
+
+// The caller must hold encodedPayloads()->mutex
+CacheEntry &cacheEntry(QMimeData *mimeData, const QString &mimeType)
+{
+    auto it = encodedPayloads()->caches.find(mimeData);
+    if (it == encodedPayloads()->caches.end()) {
+        // The mime data is its own context, so the connection goes away with it
+        QObject::connect(mimeData, &QObject::destroyed, mimeData, [mimeData]() {
+            if (!encodedPayloads.exists())
+                return;
+            QMutexLocker locker(&encodedPayloads()->mutex);
+            encodedPayloads()->caches.remove(mimeData);
+        });
+        it = encodedPayloads()->caches.insert(mimeData, MimeDataCache());
+    }
+    return (*it)[mimeType];
+}
+
+bool isImageFormat(QMimeData *mimeData, const QString &mimeType)
+{
+    return mimeData->hasImage()
+            && (mimeType == QLatin1String("application/x-qt-image")
+                || mimeType.startsWith(QLatin1String("image/")));
+}
+
+QSharedPointer<EncodedPayload> imagePayload(QMimeData *mimeData, const QString &mimeType, bool background)
+{
+    const QImage image = qvariant_cast<QImage>(mimeData->imageData());
+    QMutexLocker locker(&encodedPayloads()->mutex);
+    CacheEntry &entry = cacheEntry(mimeData, mimeType);
+    if (entry.payload && entry.imageKey == image.cacheKey())
+        return entry.payload;
+
+    entry.imageKey = image.cacheKey();
+    if (image.isNull()) {
+        entry.payload.reset(new EncodedPayload);
+        return entry.payload;
+    }
+
+    QByteArray fmt = "BMP";
+    if (mimeType.startsWith(QLatin1String("image/"))) {
+        QByteArray imgFmt = mimeType.mid(6).toUpper().toLatin1();
+        if (QImageWriter::supportedImageFormats().contains(imgFmt))
+            fmt = imgFmt;
+    }
+    entry.payload.reset(new EncodedPayload(image, fmt));
+    if (background)
+        QThreadPool::globalInstance()->start(new ImageEncodeTask(entry.payload));
+    return entry.payload;
+}
+
+}
+
+/*
+    Returns the data of \a mimeData encoded for \a mimeType.
+
+    Encoded payloads are cached per QMimeData and mime type until the data
+    changes or the QMimeData is destroyed, and are handed out as implicitly
+    shared byte arrays. Must be called from the thread \a mimeData lives in,
+    but different mime data may be used from different threads.
+*/
 QByteArray QWaylandMimeHelper::getByteArray(QMimeData *mimeData, const QString &mimeType)
 {
-    QByteArray content;
     if (mimeType == QLatin1String("text/plain")) {
-        content = mimeData->text().toUtf8();
-    } else if (mimeData->hasImage()
-               && (mimeType == QLatin1String("application/x-qt-image")
-                   || mimeType.startsWith(QLatin1String("image/")))) {
-        QImage image = qvariant_cast<QImage>(mimeData->imageData());
-        if (!image.isNull()) {
-            QBuffer buf;
-            buf.open(QIODevice::ReadWrite);
-            QByteArray fmt = "BMP";
-            if (mimeType.startsWith(QLatin1String("image/"))) {
-                QByteArray imgFmt = mimeType.mid(6).toUpper().toLatin1();
-                if (QImageWriter::supportedImageFormats().contains(imgFmt))
-                    fmt = imgFmt;
-            }
-            QImageWriter wr(&buf, fmt);
-            wr.write(image);
-            content = buf.buffer();
+        const QString text = mimeData->text();
+        QMutexLocker locker(&encodedPayloads()->mutex);
+        CacheEntry &entry = cacheEntry(mimeData, mimeType);
+        if (!entry.payload || entry.text != text) {
+            entry.text = text;
+            entry.payload.reset(new EncodedPayload(text.toUtf8()));
         }
+        return entry.payload->data;
+    } else if (isImageFormat(mimeData, mimeType)) {
+        return imagePayload(mimeData, mimeType, false)->wait();
     } else if (mimeType == QLatin1String("application/x-color")) {
-        content = qvariant_cast<QColor>(mimeData->colorData()).name().toLatin1();
+        return qvariant_cast<QColor>(mimeData->colorData()).name().toLatin1();
     } else if (mimeType == QLatin1String("text/uri-list")) {
-        QList<QUrl> urls = mimeData->urls();
-        for (int i = 0; i < urls.count(); ++i) {
-            content.append(urls.at(i).toEncoded());
-            content.append('\n');
+        const QList<QUrl> urls = mimeData->urls();
+        QMutexLocker locker(&encodedPayloads()->mutex);
+        CacheEntry &entry = cacheEntry(mimeData, mimeType);
+        if (!entry.payload || entry.urls != urls) {
+            QByteArray content;
+            for (int i = 0; i < urls.count(); ++i) {
+                content.append(urls.at(i).toEncoded());
+                content.append('\n');
+            }
+            entry.urls = urls;
+            entry.payload.reset(new EncodedPayload(content));
         }
-    } else {
-        content = mimeData->data(mimeType);
+        return entry.payload->data;
+    }
+    return mimeData->data(mimeType);
+}
+
+/*
+    Starts encoding the image formats among \a mimeTypes on a worker thread,
+    so that a later getByteArray() finds them ready.
+*/
+void QWaylandMimeHelper::prepareByteArrays(QMimeData *mimeData, const QStringList &mimeTypes)
+{
+    for (const QString &mimeType : mimeTypes) {
+        if (isImageFormat(mimeData, mimeType))
+            imagePayload(mimeData, mimeType, true);
     }
-    return content;
 }
 
 QT_END_NAMESPACE
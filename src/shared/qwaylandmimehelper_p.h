@@ -41,6 +41,7 @@
 #define QWAYLANDMIMEHELPER_H
 
 #include <QString>
+#include <QStringList>
 #include <QByteArray>
 #include <QMimeData>
 
@@ -50,6 +51,7 @@ class QWaylandMimeHelper
 {
 public:
     static QByteArray getByteArray(QMimeData *mimeData, const QString &mimeType);
+    static void prepareByteArrays(QMimeData *mimeData, const QStringList &mimeTypes);
 };
 
 QT_END_NAMESPACE
@@ -53,6 +53,8 @@ public:
     static inline wl_shm_format fromQImageFormat(QImage::Format format);
     static inline QImage::Format fromWaylandShmFormat(wl_shm_format format);
     static inline QVector<wl_shm_format> supportedWaylandFormats();
+    static inline QVector<wl_shm_format> planarYuvWaylandFormats();
+    static inline bool isPlanarYuv(wl_shm_format format);
 
 private:
 //IMPLEMENTATION (which has to be inline in the header because of the include trick)
@@ -131,6 +133,19 @@ QVector<wl_shm_format> QWaylandSharedMemoryFormatHelper::supportedWaylandFormats
     return retFormats;
 }
 
+//planar YUV formats have no QImage equivalent, the compositor samples their planes directly.
+//They are not part of supportedWaylandFormats() since their chroma planes lie past the
+//stride * height bytes libwayland checks against the pool, and the pool size is not exposed
+QVector<wl_shm_format> QWaylandSharedMemoryFormatHelper::planarYuvWaylandFormats()
+{
+    return QVector<wl_shm_format>() << WL_SHM_FORMAT_NV12 << WL_SHM_FORMAT_YUV420;
+}
+
+bool QWaylandSharedMemoryFormatHelper::isPlanarYuv(wl_shm_format format)
+{
+    return format == WL_SHM_FORMAT_NV12 || format == WL_SHM_FORMAT_YUV420;
+}
+
 QT_END_NAMESPACE
 
 #endif //QWAYLANDSHAREDMEMORYFORMATHELPER_H
@@ -2,6 +2,10 @@ TEMPLATE=subdirs
 
 SUBDIRS += \
     client \
+    mimehelper \
     iviapplication \
+    startup \
+    textinput \
+    viewporter \
     xdgshellv6 \
     wl_connect
@@ -1,6 +1,7 @@
 include (../shared/shared.pri)
 
 TARGET = tst_client
+INCLUDEPATH += ../../../../src/shared
 SOURCES += tst_client.cpp
 
 check.commands = $(TESTRUNNER) $${PWD}/run-with-all-shells.sh $(TESTARGS)
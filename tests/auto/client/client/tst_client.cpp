@@ -37,10 +37,33 @@
 #include <QDrag>
 #include <QWindow>
 #include <QOpenGLWindow>
+#include <QClipboard>
+#include <QGlyphRun>
+#include <QRawFont>
+
+#include <functional>
+
+#include <time.h>
 
 #include <QtTest/QtTest>
 #include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtWaylandClient/private/qwaylanddataoffer_p.h>
+#include <QtWaylandClient/private/qwaylanddisplay_p.h>
+#include <QtWaylandClient/private/qwaylandwindow_p.h>
+#include <QtWaylandClient/private/qwaylandabstractdecoration_p.h>
+#include <QtWaylandClient/private/qwaylanddecorationsubsurfaces_p.h>
+#include <QtWaylandClient/private/qwaylandglyphcache_p.h>
+#if QT_CONFIG(cursor)
+#include <QtWaylandClient/private/qwaylandcursor_p.h>
+#include <QtWaylandClient/private/qwaylandscreen_p.h>
+#endif
+#if QT_CONFIG(xkbcommon_evdev)
+#include <QtWaylandClient/private/qwaylandkeymapcache_p.h>
+#endif
 #include <QtGui/private/qguiapplication_p.h>
+#include <qpa/qplatformnativeinterface.h>
+
+#include "qwaylandglyphcacheentry_p.h"
 
 static const QSize screenSize(1600, 1200);
 
@@ -114,12 +137,19 @@ class TestGlWindow : public QOpenGLWindow
 public:
     TestGlWindow();
     int paintGLCalled = 0;
+    int mousePressEventCount = 0;
+    QPoint mousePressPos;
 
 public slots:
     void hideShow();
 
 protected:
     void paintGL() override;
+    void mousePressEvent(QMouseEvent *event) override
+    {
+        ++mousePressEventCount;
+        mousePressPos = event->pos();
+    }
 };
 
 TestGlWindow::TestGlWindow()
@@ -174,13 +204,41 @@ private slots:
     void createDestroyWindow();
     void activeWindowFollowsKeyboardFocus();
     void events();
+#if QT_CONFIG(xkbcommon_evdev)
+    void keymapIsCompiledOnce();
+    void keymapToFirstFrame_data();
+    void keymapToFirstFrame();
+#endif
     void backingStore();
+    void backingStoreFormat_data();
+    void backingStoreFormat();
+    void backingStoreBandwidth_data();
+    void backingStoreBandwidth();
+    void damageIsExact_data();
+    void damageIsExact();
+    void decorationTiles();
+    void decorationIsNotRepaintedEveryFrame();
+    void presentationFeedback();
     void touchDrag();
     void mouseDrag();
+    void clipboardTransfer_data();
+    void clipboardTransfer();
+    void clipboardSendDoesNotBlock();
     void dontCrashOnMultipleCommits();
     void hiddenTransientParent();
     void hiddenPopupParent();
     void glWindow();
+#if QT_CONFIG(cursor)
+    void cursorThemeIsLoadedLazily();
+    void bitmapCursorBuffersAreCached();
+    void unchangedCursorIsNotReattached();
+    void animatedCursorFollowsFrameCallbacks();
+#endif
+    // These have to stay last, they add globals for good. The glyph cache
+    // doesn't change what the ones after it test.
+    void glyphCache();
+    void coreProfileDecorationFallsBack();
+    void decorationSubSurfacesMapInput();
 
 private:
     MockCompositor *compositor = nullptr;
@@ -381,6 +439,112 @@ void tst_WaylandClient::events()
     QTRY_COMPARE(window.mouseReleaseEventCount, 1);
 }
 
+#if QT_CONFIG(xkbcommon_evdev)
+static const char testKeymap[] =
+    "xkb_keymap {\n"
+    "    xkb_keycodes { include \"evdev\" };\n"
+    "    xkb_types { include \"complete\" };\n"
+    "    xkb_compatibility { include \"complete\" };\n"
+    "    xkb_symbols { include \"pc+us\" };\n"
+    "};\n";
+
+void tst_WaylandClient::keymapIsCompiledOnce()
+{
+    QtWaylandClient::QWaylandKeymapCache::clear();
+
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+    compositor->setKeyboardFocus(surface);
+    QTRY_COMPARE(QGuiApplication::focusWindow(), &window);
+
+    compositor->sendKeymap(testKeymap);
+    compositor->sendKeyPress(surface, 30);
+    QTRY_COMPARE(window.keyPressEventCount, 1);
+    if (QtWaylandClient::QWaylandKeymapCache::cachedKeymapCount() == 0)
+        QSKIP("The XKB data needed to compile the test keymap is not installed");
+    const int compiled = QtWaylandClient::QWaylandKeymapCache::compiledKeymapCount();
+    QVERIFY(compiled >= 1);
+
+    // A compositor sending the same keymap again must not cause a recompile
+    compositor->sendKeymap(testKeymap);
+    compositor->sendKeyPress(surface, 30);
+    QTRY_COMPARE(window.keyPressEventCount, 2);
+    QCOMPARE(QtWaylandClient::QWaylandKeymapCache::compiledKeymapCount(), compiled);
+    QCOMPARE(QtWaylandClient::QWaylandKeymapCache::cachedKeymapCount(), 1);
+    QCOMPARE(window.keyCode, 30u);
+}
+
+void tst_WaylandClient::keymapToFirstFrame_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("uncached") << false;
+    QTest::newRow("cached") << true;
+}
+
+// Time from receiving a keymap until a new window has committed its first
+// frame. The keymap is handled before anything queued after it, so compiling
+// it delays the first frame of a starting client.
+void tst_WaylandClient::keymapToFirstFrame()
+{
+    class FrameWindow : public TestWindow
+    {
+    public:
+        void exposeEvent(QExposeEvent *) override
+        {
+            if (!isExposed())
+                return;
+            const QRect rect(QPoint(), size());
+            backingStore.resize(rect.size());
+            backingStore.beginPaint(rect);
+            QPainter painter(backingStore.paintDevice());
+            painter.fillRect(rect, Qt::red);
+            painter.end();
+            backingStore.endPaint();
+            backingStore.flush(rect);
+        }
+
+        QBackingStore backingStore { this };
+    };
+
+    QFETCH(bool, cached);
+
+    // QTRY_VERIFY polls too coarsely to time this
+    auto waitFor = [](const std::function<bool()> &condition) {
+        QElapsedTimer timeout;
+        timeout.start();
+        while (!condition()) {
+            if (timeout.hasExpired(5000))
+                return false;
+            QCoreApplication::processEvents();
+            QThread::usleep(100);
+        }
+        return true;
+    };
+
+    QBENCHMARK {
+        if (!cached)
+            QtWaylandClient::QWaylandKeymapCache::clear();
+        compositor->sendKeymap(testKeymap);
+
+        FrameWindow window;
+        window.show();
+        QSharedPointer<MockSurface> surface;
+        QVERIFY(waitFor([&]() { return bool(surface = compositor->surface()); }));
+        compositor->sendShellSurfaceConfigure(surface);
+        QVERIFY(waitFor([&]() { return !surface->image.isNull(); }));
+
+        // Don't let the next round mistake this surface for its own
+        window.destroy();
+        QVERIFY(waitFor([&]() { return !compositor->surface(); }));
+    }
+}
+#endif
+
 void tst_WaylandClient::backingStore()
 {
     TestWindow window;
@@ -418,6 +582,331 @@ void tst_WaylandClient::backingStore()
     QTRY_VERIFY(!compositor->surface());
 }
 
+void tst_WaylandClient::backingStoreFormat_data()
+{
+    QTest::addColumn<int>("colorBits");
+    QTest::addColumn<bool>("alpha");
+    QTest::addColumn<bool>("frameless");
+    QTest::addColumn<int>("expectedFormat");
+    QTest::addColumn<int>("expectedBytesPerLine");
+
+    // odd width so the 16-bit scanlines need padding
+    QTest::newRow("argb32") << 8 << true << true << int(QImage::Format_ARGB32_Premultiplied) << 33 * 4;
+    QTest::newRow("rgb32") << 8 << false << true << int(QImage::Format_RGB32) << 33 * 4;
+    QTest::newRow("rgb16") << 5 << false << true << int(QImage::Format_RGB16) << 68;
+    QTest::newRow("rgb16-with-alpha") << 5 << true << true << int(QImage::Format_ARGB32_Premultiplied) << 33 * 4;
+    QTest::newRow("rgb16-decorated") << 5 << false << false << int(QImage::Format_ARGB32_Premultiplied) << -1;
+    // the mock compositor doesn't advertise 10-bit formats
+    QTest::newRow("rgb30-unsupported") << 10 << false << true << int(QImage::Format_RGB32) << 33 * 4;
+}
+
+void tst_WaylandClient::backingStoreFormat()
+{
+    QFETCH(int, colorBits);
+    QFETCH(bool, alpha);
+    QFETCH(bool, frameless);
+    QFETCH(int, expectedFormat);
+    QFETCH(int, expectedBytesPerLine);
+
+    TestWindow window;
+    QSurfaceFormat format;
+    format.setRedBufferSize(colorBits);
+    format.setGreenBufferSize(colorBits == 5 ? 6 : colorBits);
+    format.setBlueBufferSize(colorBits);
+    format.setAlphaBufferSize(alpha ? 8 : 0);
+    window.setFormat(format);
+    if (frameless)
+        window.setFlags(window.flags() | Qt::FramelessWindowHint);
+    window.resize(33, 32);
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    // Without a decoration plugin the window gets the undecorated format
+    if (!frameless && window.frameMargins().isNull())
+        QSKIP("No decoration plugin to decorate the window with");
+
+    QRect rect(QPoint(), window.size());
+
+    QBackingStore backingStore(&window);
+    backingStore.resize(rect.size());
+    backingStore.beginPaint(rect);
+    QCOMPARE(int(static_cast<QImage *>(backingStore.paintDevice())->format()), expectedFormat);
+    QPainter p(backingStore.paintDevice());
+    p.fillRect(rect, Qt::magenta);
+    p.end();
+    backingStore.endPaint();
+
+    backingStore.flush(rect);
+
+    QTRY_COMPARE(surface->image.size(), window.frameGeometry().size());
+    QCOMPARE(int(surface->image.format()), expectedFormat);
+    if (expectedBytesPerLine != -1)
+        QCOMPARE(surface->image.bytesPerLine(), expectedBytesPerLine);
+    QCOMPARE(surface->image.pixel(window.frameMargins().left(), window.frameMargins().top()), QColor(Qt::magenta).rgba());
+}
+
+void tst_WaylandClient::backingStoreBandwidth_data()
+{
+    QTest::addColumn<int>("colorBits");
+
+    QTest::newRow("rgb32") << 8;
+    QTest::newRow("rgb16") << 5;
+}
+
+void tst_WaylandClient::backingStoreBandwidth()
+{
+    QFETCH(int, colorBits);
+
+    TestWindow window;
+    QSurfaceFormat format;
+    format.setRedBufferSize(colorBits);
+    format.setGreenBufferSize(colorBits == 5 ? 6 : colorBits);
+    format.setBlueBufferSize(colorBits);
+    format.setAlphaBufferSize(0);
+    window.setFormat(format);
+    window.setFlags(window.flags() | Qt::FramelessWindowHint);
+    window.resize(1024, 768);
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    QRect rect(QPoint(), window.size());
+    QBackingStore backingStore(&window);
+    backingStore.resize(rect.size());
+
+    // Repaints the whole back buffer, so the cost scales with the bytes per pixel.
+    // Nothing is committed inside the loop, since the mock compositor never releases buffers.
+    int frame = 0;
+    QBENCHMARK {
+        backingStore.beginPaint(rect);
+        QPainter p(backingStore.paintDevice());
+        p.fillRect(rect, (++frame % 2) ? Qt::magenta : Qt::cyan);
+        p.end();
+        backingStore.endPaint();
+    }
+
+    backingStore.flush(rect);
+    QTRY_COMPARE(surface->image.size(), window.frameGeometry().size());
+}
+
+void tst_WaylandClient::damageIsExact_data()
+{
+    QTest::addColumn<QRegion>("damage");
+    QTest::addColumn<QVector<QRect>>("expected");
+    QTest::addColumn<int>("scale");
+
+    // Two small rects far apart should not be merged into one big rect
+    const QVector<QRect> apart = { QRect(10, 10, 8, 8), QRect(200, 200, 8, 8) };
+    QTest::newRow("apart") << QRegion().united(apart.at(0)).united(apart.at(1)) << apart << 1;
+
+    // Neighbours are merged when that adds at most a quarter of undamaged area
+    QTest::newRow("merged-below-quarter") << QRegion(QRect(10, 10, 40, 10)).united(QRect(10, 21, 40, 10))
+                                          << QVector<QRect>{ QRect(10, 10, 40, 21) } << 1;
+    QTest::newRow("merged-at-quarter") << QRegion(QRect(10, 10, 40, 10)).united(QRect(10, 25, 40, 10))
+                                       << QVector<QRect>{ QRect(10, 10, 40, 25) } << 1;
+    QTest::newRow("kept-above-quarter") << QRegion(QRect(10, 10, 40, 10)).united(QRect(10, 26, 40, 10))
+                                        << QVector<QRect>{ QRect(10, 10, 40, 10), QRect(10, 26, 40, 10) } << 1;
+
+    // At most 16 rects are sent. Merging any neighbours of the diagonal costs
+    // the same at first, after that the first pair not involving an already
+    // merged rect is the cheapest. So pairs are merged from the top left.
+    QRegion diagonal;
+    QVector<QRect> capped;
+    for (int i = 0; i < 20; ++i) {
+        diagonal += QRect(i * 12, i * 12, 2, 2);
+        if (i < 8 && i % 2 == 0)
+            capped.append(QRect(i * 12, i * 12, 14, 14));
+        else if (i >= 8)
+            capped.append(QRect(i * 12, i * 12, 2, 2));
+    }
+    QTest::newRow("capped") << diagonal << capped << 1;
+
+    // Damage is sent in buffer coordinates
+    QTest::newRow("scale-2") << QRegion().united(apart.at(0)).united(apart.at(1)) << apart << 2;
+}
+
+void tst_WaylandClient::damageIsExact()
+{
+    QFETCH(QRegion, damage);
+    QFETCH(QVector<QRect>, expected);
+    QFETCH(int, scale);
+
+    // The window picks up the scale of its screen when it's initialized
+    compositor->setOutputScale(scale);
+    QTRY_COMPARE(QGuiApplication::primaryScreen()->devicePixelRatio(), qreal(scale));
+
+    TestWindow window;
+    window.resize(256, 256);
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    QRect rect(QPoint(), window.size());
+
+    QBackingStore backingStore(&window);
+    backingStore.resize(rect.size());
+
+    backingStore.beginPaint(rect);
+    QPainter p(backingStore.paintDevice());
+    p.fillRect(rect, Qt::magenta);
+    p.end();
+    backingStore.endPaint();
+
+    backingStore.flush(rect);
+    QTRY_COMPARE(surface->image.size(), window.frameGeometry().size() * scale);
+
+    backingStore.beginPaint(damage);
+    p.begin(backingStore.paintDevice());
+    p.fillRect(rect, Qt::cyan);
+    p.end();
+    backingStore.endPaint();
+
+    backingStore.flush(damage);
+
+    // The decoration didn't change, so only the damaged contents are sent
+    const QMargins margins = window.frameMargins();
+    QRegion expectedBufferDamage;
+    for (const QRect &expectedRect : qAsConst(expected)) {
+        const QRect translated = expectedRect.translated(margins.left(), margins.top());
+        expectedBufferDamage += QRect(translated.topLeft() * scale, translated.size() * scale);
+    }
+    QTRY_COMPARE(surface->bufferDamage, expectedBufferDamage);
+    QVERIFY(surface->surfaceDamage.isEmpty());
+
+    window.hide();
+    QTRY_VERIFY(!compositor->surface());
+
+    compositor->setOutputScale(1);
+    QTRY_COMPARE(QGuiApplication::primaryScreen()->devicePixelRatio(), qreal(1));
+}
+
+// Records which parts of the frame the tiles ask to be repainted
+class TileTestDecoration : public QtWaylandClient::QWaylandAbstractDecoration
+{
+public:
+    QMargins margins() const override { return QMargins(4, 20, 4, 4); }
+    bool handleMouse(QtWaylandClient::QWaylandInputDevice *, const QPointF &, const QPointF &, Qt::MouseButtons, Qt::KeyboardModifiers) override { return false; }
+    bool handleTouch(QtWaylandClient::QWaylandInputDevice *, const QPointF &, const QPointF &, Qt::TouchPointState, Qt::KeyboardModifiers) override { return false; }
+
+    QVector<QRegion> paintedRegions;
+
+protected:
+    void paint(QPaintDevice *) override {}
+    void paintDecoration(QPainter *painter, const QRegion &region) override
+    {
+        paintedRegions << region;
+        for (const QRect &rect : region)
+            painter->fillRect(rect, Qt::red);
+    }
+};
+
+void tst_WaylandClient::decorationTiles()
+{
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    auto *waylandWindow = static_cast<QtWaylandClient::QWaylandWindow *>(window.handle());
+    TileTestDecoration decoration;
+    decoration.setWaylandWindow(waylandWindow);
+
+    const QRect frame(QPoint(), window.frameGeometry().size());
+    const QRegion margins = QRegion(frame) - frame.marginsRemoved(decoration.margins());
+
+    // A full repaint covers the margins but not the area under the contents
+    QVERIFY(decoration.isDirty());
+    QCOMPARE(decoration.dirtyRegion(), margins);
+
+    const Qt::Edge edges[] = { Qt::TopEdge, Qt::LeftEdge, Qt::RightEdge, Qt::BottomEdge };
+    QRegion tiles;
+    for (Qt::Edge edge : edges) {
+        const QRect rect = decoration.edgeRect(edge);
+        const QImage &image = decoration.edgeImage(edge);
+        QCOMPARE(image.size(), rect.size() * waylandWindow->scale());
+        QCOMPARE(image.pixel(0, 0), QColor(Qt::red).rgba());
+        QVERIFY(!tiles.intersects(rect));
+        tiles += rect;
+    }
+    QCOMPARE(tiles, margins);
+
+    QCOMPARE(decoration.paintedRegions.size(), 4);
+    QRegion painted;
+    for (const QRegion &region : qAsConst(decoration.paintedRegions))
+        painted += region;
+    QCOMPARE(painted, margins);
+    QVERIFY(!decoration.isDirty());
+
+    // Clean tiles are not repainted
+    decoration.paintedRegions.clear();
+    for (Qt::Edge edge : edges)
+        decoration.edgeImage(edge);
+    QVERIFY(decoration.paintedRegions.isEmpty());
+
+    // A partial update only repaints that part of the one tile it touches
+    const QRect button(frame.width() - 12, 4, 8, 8);
+    decoration.update(button);
+    QCOMPARE(decoration.dirtyRegion(), QRegion(button));
+    decoration.edgeImage(Qt::TopEdge);
+    QCOMPARE(decoration.paintedRegions.size(), 1);
+    QCOMPARE(decoration.paintedRegions.first(), QRegion(button));
+    QVERIFY(!decoration.isDirty());
+}
+
+void tst_WaylandClient::decorationIsNotRepaintedEveryFrame()
+{
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    const QMargins margins = window.frameMargins();
+    if (margins.isNull())
+        QSKIP("This test needs window decorations");
+
+    QRect rect(QPoint(), window.size());
+    QBackingStore backingStore(&window);
+    backingStore.resize(rect.size());
+
+    auto paint = [&](const QRegion &region, const QColor &color) {
+        backingStore.beginPaint(region);
+        QPainter p(backingStore.paintDevice());
+        p.fillRect(rect, color);
+        p.end();
+        backingStore.endPaint();
+        backingStore.flush(region);
+    };
+
+    paint(rect, Qt::magenta);
+    QTRY_COMPARE(surface->image.size(), window.frameGeometry().size());
+    const int commits = surface->commitCount;
+
+    // Repainting the contents leaves the decoration alone
+    const QRect small(4, 4, 8, 8);
+    paint(small, Qt::cyan);
+    QTRY_COMPARE(surface->commitCount, commits + 1);
+    QCOMPARE(surface->bufferDamage, QRegion(small.translated(margins.left(), margins.top())));
+
+    // Changing the title repaints the decoration, but still not the contents
+    window.setTitle(QStringLiteral("decorationIsNotRepaintedEveryFrame"));
+    paint(small, Qt::magenta);
+    QTRY_COMPARE(surface->commitCount, commits + 2);
+    const QRect frame(QPoint(), window.frameGeometry().size());
+    QVERIFY(surface->bufferDamage.contains(QRect(0, 0, frame.width(), margins.top())));
+    QVERIFY(!surface->bufferDamage.contains(QPoint(24, 24) + QPoint(margins.left(), margins.top())));
+}
+
 class DndWindow : public QWindow
 {
     Q_OBJECT
@@ -454,6 +943,72 @@ private:
     QPixmap m_dragIcon;
 };
 
+void tst_WaylandClient::presentationFeedback()
+{
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    QBackingStore backingStore(&window);
+    auto paint = [&](const QColor &color) {
+        const QRect rect(QPoint(), window.size());
+        backingStore.resize(rect.size());
+        backingStore.beginPaint(rect);
+        QPainter p(backingStore.paintDevice());
+        p.fillRect(rect, color);
+        p.end();
+        backingStore.endPaint();
+        backingStore.flush(rect);
+    };
+
+    QPlatformNativeInterface *nativeInterface = QGuiApplication::platformNativeInterface();
+    QPlatformWindow *platformWindow = window.handle();
+    auto presentation = [&]() {
+        return nativeInterface->windowProperty(platformWindow, QStringLiteral("presentation")).toMap();
+    };
+
+    // Nothing is requested unless the window asks for it
+    paint(Qt::magenta);
+    QTRY_VERIFY(!surface->image.isNull());
+    QCOMPARE(compositor->presentationFeedbackCount(), 0);
+
+    nativeInterface->setWindowProperty(platformWindow, QStringLiteral("presentationFeedback"), true);
+    paint(Qt::cyan);
+    QTRY_COMPARE(compositor->presentationFeedbackCount(), 1);
+
+    const quint64 timestamp = Q_UINT64_C(5000000123);
+    const quint64 sequence = (Q_UINT64_C(1) << 32) + 7;
+    compositor->sendPresentationPresented(timestamp, 16666666, sequence, 1);
+    QTRY_COMPARE(presentation().value(QStringLiteral("presentedFrames")).toULongLong(), Q_UINT64_C(1));
+    QCOMPARE(presentation().value(QStringLiteral("clockId")).toUInt(), uint(CLOCK_MONOTONIC));
+    QCOMPARE(presentation().value(QStringLiteral("timestamp")).toLongLong(), qint64(timestamp));
+    QCOMPARE(presentation().value(QStringLiteral("refresh")).toUInt(), 16666666u);
+    QCOMPARE(presentation().value(QStringLiteral("sequence")).toULongLong(), sequence);
+    QCOMPARE(presentation().value(QStringLiteral("flags")).toUInt(), 1u);
+    QCOMPARE(presentation().value(QStringLiteral("discardedFrames")).toULongLong(), Q_UINT64_C(0));
+    QCOMPARE(compositor->presentationFeedbackCount(), 0);
+
+    paint(Qt::yellow);
+    QTRY_COMPARE(compositor->presentationFeedbackCount(), 1);
+    compositor->sendPresentationDiscarded();
+    QTRY_COMPARE(presentation().value(QStringLiteral("discardedFrames")).toULongLong(), Q_UINT64_C(1));
+    QCOMPARE(presentation().value(QStringLiteral("presentedFrames")).toULongLong(), Q_UINT64_C(1));
+
+    // Feedback still pending when the surface is destroyed goes away with it
+    paint(Qt::green);
+    QTRY_COMPARE(compositor->presentationFeedbackCount(), 1);
+    window.hide();
+    QTRY_VERIFY(!compositor->surface());
+    compositor->sendPresentationPresented(timestamp, 16666666, sequence + 1, 1);
+    QCOMPARE(compositor->presentationFeedbackCount(), 0);
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    waylandIntegration->display()->forceRoundTrip();
+    QCOMPARE(presentation().value(QStringLiteral("presentedFrames")).toULongLong(), Q_UINT64_C(1));
+}
+
 void tst_WaylandClient::touchDrag()
 {
     DndWindow window;
@@ -502,6 +1057,100 @@ void tst_WaylandClient::mouseDrag()
     QTRY_VERIFY(window.dragStarted);
 }
 
+void tst_WaylandClient::clipboardTransfer_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("async");
+
+    // 1MB doesn't fit into a pipe buffer, so it arrives in several reads
+    const QVector<QPair<const char *, int>> sizes = {
+        { "1KB", 1024 },
+        { "1MB", 1024 * 1024 }
+    };
+    for (const auto &size : sizes) {
+        QTest::newRow(QByteArray("sync-") + size.first) << size.second << false;
+        QTest::newRow(QByteArray("async-") + size.first) << size.second << true;
+    }
+}
+
+void tst_WaylandClient::clipboardTransfer()
+{
+    QFETCH(int, size);
+    QFETCH(bool, async);
+    const QString mimeType = QStringLiteral("application/x-qt-test");
+    const QByteArray payload(size, 'q');
+
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    compositor->setKeyboardFocus(surface);
+    QTRY_COMPARE(QGuiApplication::focusWindow(), &window);
+
+    QClipboard *clipboard = QGuiApplication::clipboard();
+
+    QSignalSpy changedSpy(clipboard, &QClipboard::dataChanged);
+    compositor->sendDataDeviceSelection(surface, mimeType, payload);
+    QVERIFY(changedSpy.wait());
+
+    auto *mimeData = static_cast<const QtWaylandClient::QWaylandMimeData *>(clipboard->mimeData());
+    QVERIFY(mimeData->hasFormat(mimeType));
+
+    QByteArray received;
+    if (async) {
+        QEventLoop loop;
+        mimeData->retrieveDataAsync(mimeType, &loop, [&](const QByteArray &data) {
+            received = data;
+            loop.quit();
+        });
+        QTimer::singleShot(30000, &loop, &QEventLoop::quit);
+        loop.exec();
+    } else {
+        // QClipboard reads synchronously, but keeps dispatching Wayland events
+        // while it waits, so the compositor gets to serve the request
+        received = mimeData->data(mimeType);
+    }
+
+    QCOMPARE(received.size(), size);
+    QVERIFY(received == payload);
+}
+
+void tst_WaylandClient::clipboardSendDoesNotBlock()
+{
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    compositor->setKeyboardFocus(surface);
+    QTRY_COMPARE(QGuiApplication::focusWindow(), &window);
+
+    const QString mimeType = QStringLiteral("application/x-qt-test");
+    QMimeData *mimeData = new QMimeData;
+    mimeData->setData(mimeType, QByteArray(8 * 1024 * 1024, 'q'));
+    QGuiApplication::clipboard()->setMimeData(mimeData);
+
+    // The compositor never reads what it asked for, so the client must not
+    // wait for the write to complete
+    compositor->requestSelectionDataWithoutReading(mimeType);
+    QTRY_VERIFY(compositor->selectionDataPending());
+
+    // The event loop keeps running while most of the payload is still unsent
+    int timerTicks = 0;
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, [&timerTicks]() { ++timerTicks; });
+    timer.start(10);
+    QTRY_VERIFY(timerTicks >= 5);
+    QVERIFY(compositor->selectionDataPending());
+
+    QGuiApplication::clipboard()->clear();
+}
+
 void tst_WaylandClient::dontCrashOnMultipleCommits()
 {
     auto window = new TestWindow();
@@ -597,11 +1246,406 @@ void tst_WaylandClient::glWindow()
     QTRY_VERIFY(!compositor->surface());
 }
 
+#if QT_CONFIG(cursor)
+static void appendCard32(QByteArray *data, quint32 value)
+{
+    const quint32 littleEndian = qToLittleEndian(value);
+    data->append(reinterpret_cast<const char *>(&littleEndian), 4);
+}
+
+// An Xcursor file with one image per size, with the hot spot at (size / 8, size / 4)
+static QByteArray xcursorFile(const QVector<quint32> &sizes)
+{
+    const quint32 imageType = 0xfffd0002;
+    QByteArray data;
+    appendCard32(&data, 0x72756358);
+    appendCard32(&data, 16);
+    appendCard32(&data, 0x10000);
+    appendCard32(&data, quint32(sizes.size()));
+
+    quint32 position = 16 + quint32(sizes.size()) * 12;
+    for (quint32 size : sizes) {
+        appendCard32(&data, imageType);
+        appendCard32(&data, size);
+        appendCard32(&data, position);
+        position += 36 + size * size * 4;
+    }
+    for (quint32 size : sizes) {
+        for (quint32 value : {36u, imageType, size, 1u, size, size, size / 8, size / 4, 0u})
+            appendCard32(&data, value);
+        for (quint32 i = 0; i < size * size; ++i)
+            appendCard32(&data, 0xff0000ff);
+    }
+    return data;
+}
+
+void tst_WaylandClient::cursorThemeIsLoadedLazily()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QDir root(dir.path());
+    QVERIFY(root.mkpath(QStringLiteral("child")));
+    QVERIFY(root.mkpath(QStringLiteral("parent/cursors")));
+
+    QFile index(root.filePath(QStringLiteral("child/index.theme")));
+    QVERIFY(index.open(QIODevice::WriteOnly));
+    index.write("[Icon Theme]\nInherits=parent\n");
+    index.close();
+
+    QFile cursor(root.filePath(QStringLiteral("parent/cursors/left_ptr")));
+    QVERIFY(cursor.open(QIODevice::WriteOnly));
+    cursor.write(xcursorFile({16, 32}));
+    cursor.close();
+
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    const QByteArray cursorPath = qgetenv("XCURSOR_PATH");
+    qputenv("XCURSOR_PATH", QFile::encodeName(dir.path()));
+    QScopedPointer<QtWaylandClient::QWaylandCursorTheme> theme(
+            QtWaylandClient::QWaylandCursorTheme::create(waylandIntegration->display()->shm(), 30, QStringLiteral("child")));
+    qputenv("XCURSOR_PATH", cursorPath);
+    QVERIFY(theme);
+
+    // The inherited theme has the shape, and the size closest to 30 is used
+    const QtWaylandClient::QWaylandCursorTheme::Image image = theme->cursorImage(Qt::ArrowCursor);
+    QVERIFY(image.buffer);
+    QCOMPARE(image.size, QSize(32, 32));
+    QCOMPARE(image.hotSpot, QPoint(4, 8));
+
+    // Shapes are only read from disk the first time they are requested
+    QVERIFY(cursor.remove());
+    QCOMPARE(theme->cursorImage(Qt::ArrowCursor).buffer, image.buffer);
+}
+
+void tst_WaylandClient::bitmapCursorBuffersAreCached()
+{
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    QTRY_VERIFY(!waylandIntegration->display()->screens().isEmpty());
+    QtWaylandClient::QWaylandCursor *cursor = waylandIntegration->display()->screens().first()->waylandCursor();
+
+    QPixmap pixmap(16, 16);
+    pixmap.fill(Qt::red);
+    const QCursor redCursor(pixmap);
+    const QSharedPointer<QtWaylandClient::QWaylandBuffer> buffer = cursor->cursorBitmapImage(&redCursor);
+    QVERIFY(buffer);
+
+    // Setting the same cursor again, or another cursor with the same pixmap, reuses the buffer
+    QCOMPARE(cursor->cursorBitmapImage(&redCursor), buffer);
+    const QCursor redCursorWithHotSpot(pixmap, 8, 8);
+    QCOMPARE(cursor->cursorBitmapImage(&redCursorWithHotSpot), buffer);
+
+    pixmap.fill(Qt::blue);
+    const QCursor blueCursor(pixmap);
+    QVERIFY(cursor->cursorBitmapImage(&blueCursor) != buffer);
+}
+
+void tst_WaylandClient::unchangedCursorIsNotReattached()
+{
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    QPixmap pixmap(16, 16);
+    pixmap.fill(Qt::red);
+    window.setCursor(QCursor(pixmap));
+    compositor->sendMousePress(surface, QPoint(10, 10));
+    compositor->sendMouseRelease(surface);
+
+    QSharedPointer<MockSurface> cursorSurface;
+    QTRY_VERIFY(cursorSurface = compositor->cursorSurface());
+    QTRY_COMPARE(cursorSurface->image.pixel(0, 0), QColor(Qt::red).rgba());
+    const int commits = cursorSurface->commitCount;
+    const int setCursors = compositor->setCursorCount();
+
+    // Entering the window again sends set_cursor, but the cursor surface keeps its buffer
+    compositor->sendMouseLeave(surface);
+    compositor->sendMousePress(surface, QPoint(12, 12));
+    compositor->sendMouseRelease(surface);
+    QTRY_VERIFY(compositor->setCursorCount() > setCursors);
+    QCOMPARE(cursorSurface->commitCount, commits);
+
+    // Setting an identical cursor doesn't touch the cursor surface, a changed one is committed once
+    window.setCursor(QCursor(pixmap));
+    pixmap.fill(Qt::blue);
+    window.setCursor(QCursor(pixmap));
+    QTRY_COMPARE(cursorSurface->image.pixel(0, 0), QColor(Qt::blue).rgba());
+    QCOMPARE(cursorSurface->commitCount, commits + 1);
+
+    compositor->sendMouseLeave(surface);
+}
+
+static const int animatedCursorDelay = 20;
+static const QVector<quint32> animatedCursorColors = { 0xffff0000, 0xff00ff00, 0xff0000ff };
+
+static QByteArray animatedXcursorFile(quint32 size, const QVector<quint32> &colors, quint32 delay)
+{
+    const quint32 imageType = 0xfffd0002;
+    QByteArray data;
+    appendCard32(&data, 0x72756358);
+    appendCard32(&data, 16);
+    appendCard32(&data, 0x10000);
+    appendCard32(&data, quint32(colors.size()));
+
+    quint32 position = 16 + quint32(colors.size()) * 12;
+    for (int i = 0; i < colors.size(); ++i) {
+        appendCard32(&data, imageType);
+        appendCard32(&data, size);
+        appendCard32(&data, position);
+        position += 36 + size * size * 4;
+    }
+    for (quint32 color : colors) {
+        for (quint32 value : {36u, imageType, size, 1u, size, size, 0u, 0u, delay})
+            appendCard32(&data, value);
+        for (quint32 i = 0; i < size * size; ++i)
+            appendCard32(&data, color);
+    }
+    return data;
+}
+
+void tst_WaylandClient::animatedCursorFollowsFrameCallbacks()
+{
+    TestWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+
+    // The wait cursor of the test theme set up in main() is animated
+    compositor->setFrameCallbacksHeld(true);
+    window.setCursor(Qt::WaitCursor);
+    compositor->sendMousePress(surface, QPoint(10, 10));
+    compositor->sendMouseRelease(surface);
+
+    QSharedPointer<MockSurface> cursorSurface;
+    QTRY_VERIFY(cursorSurface = compositor->cursorSurface());
+
+    // The second frame asks for a frame callback, so the animation stops there
+    QTRY_COMPARE(cursorSurface->image.pixel(0, 0), QRgb(animatedCursorColors.at(1)));
+    const int commits = cursorSurface->commitCount;
+    QTest::qWait(10 * animatedCursorDelay);
+    QCOMPARE(cursorSurface->commitCount, commits);
+    QCOMPARE(cursorSurface->image.pixel(0, 0), QRgb(animatedCursorColors.at(1)));
+
+    // and continues once the frame has been shown
+    compositor->setFrameCallbacksHeld(false);
+    QTRY_COMPARE(cursorSurface->image.pixel(0, 0), QRgb(animatedCursorColors.at(2)));
+
+    window.unsetCursor();
+    compositor->sendMouseLeave(surface);
+}
+#endif
+
+void tst_WaylandClient::glyphCache()
+{
+    QFont font;
+    font.setPixelSize(20);
+    const QRawFont rawFont = QRawFont::fromFont(font);
+    const QByteArray id = qWaylandGlyphCacheFontId(rawFont);
+    if (id.isEmpty())
+        QSKIP("This test needs a font with SFNT tables");
+    const QVector<quint32> glyphIndexes = rawFont.glyphIndexesForString(QStringLiteral("A"));
+    QCOMPARE(glyphIndexes.size(), 1);
+
+    // The glyph is a solid block, which the real one can't be mistaken for
+    QImage atlas(8, 8, QImage::Format_Alpha8);
+    atlas.fill(0);
+    for (int y = 1; y < 7; ++y)
+        memset(atlas.scanLine(y) + 2, 0xff, 4);
+    QWaylandGlyphCacheEntry entry = { glyphIndexes.first(), 0, 2, 1, 4, 6, 1, 6 };
+    const QByteArray entries(reinterpret_cast<const char *>(&entry), sizeof(entry));
+
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    qputenv("QT_WAYLAND_USE_GLYPH_CACHE", "1");
+    compositor->setGlyphCacheAtlas(atlas);
+    // Same names and size, but rendered from another version of the font file
+    compositor->addGlyphCacheFont(rawFont.familyName(), rawFont.styleName(), QByteArray(20, 'x'), 20, entries);
+    compositor->addGlyphCacheFont(rawFont.familyName(), rawFont.styleName(), id, 20, entries);
+
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    QtWaylandClient::QWaylandDisplay *display = waylandIntegration->display();
+    // The global is bound as soon as it is announced
+    QTRY_VERIFY(display->hasRegistryGlobal(QStringLiteral("zqt_glyph_cache_v1")));
+    QtWaylandClient::QWaylandGlyphCache *cache = display->glyphCache();
+    qunsetenv("QT_WAYLAND_USE_GLYPH_CACHE");
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+    if (!cache)
+        QSKIP("The shm-emulation-server plugin is not available");
+
+    // Only the font file the glyphs were rendered from matches
+    QTRY_VERIFY(cache->findFont(rawFont));
+    QCOMPARE(cache->findFont(rawFont)->id, id);
+    QFont bold = font;
+    bold.setBold(true);
+    QVERIFY(!cache->findFont(QRawFont::fromFont(bold)));
+    QFont larger = font;
+    larger.setPixelSize(21);
+    QVERIFY(!cache->findFont(QRawFont::fromFont(larger)));
+
+    QGlyphRun run;
+    run.setRawFont(rawFont);
+    run.setGlyphIndexes(glyphIndexes);
+    run.setPositions(QVector<QPointF>() << QPointF(10, 20));
+
+    QImage image(32, 32, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        QPainter painter(&image);
+        painter.setPen(Qt::red);
+        cache->drawGlyphRun(&painter, QPointF(1, 2), run);
+    }
+    // The origin is at (11, 22), the block is 1 right of and 6 above it
+    const QRect block(12, 16, 4, 6);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            QCOMPARE(image.pixel(x, y), block.contains(x, y) ? qRgb(255, 0, 0) : 0u);
+    }
+
+    // Transformed glyphs are rasterized by the painter
+    QImage expected = image;
+    expected.fill(Qt::transparent);
+    {
+        QPainter painter(&expected);
+        painter.setPen(Qt::red);
+        painter.scale(1.5, 1.5);
+        painter.drawGlyphRun(QPointF(1, 2), run);
+    }
+    image.fill(Qt::transparent);
+    {
+        QPainter painter(&image);
+        painter.setPen(Qt::red);
+        painter.scale(1.5, 1.5);
+        cache->drawGlyphRun(&painter, QPointF(1, 2), run);
+    }
+    QCOMPARE(image, expected);
+}
+
+void tst_WaylandClient::coreProfileDecorationFallsBack()
+{
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    QtWaylandClient::QWaylandDisplay *display = waylandIntegration->display();
+    if (!display->supportsWindowDecoration())
+        QSKIP("This test needs window decorations");
+    QVERIFY(!display->hasRegistryGlobal(QStringLiteral("wl_subcompositor")));
+
+    QSurfaceFormat format;
+    format.setVersion(3, 2);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || context.format().profile() != QSurfaceFormat::CoreProfile)
+        QSKIP("This test needs a core profile context");
+
+    TestGlWindow window;
+    window.setFormat(format);
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+    QTRY_VERIFY(window.paintGLCalled > 0);
+
+    // Core profiles can't use the blitter, so without subsurfaces there is no decoration at all
+    auto *waylandWindow = static_cast<QtWaylandClient::QWaylandWindow *>(window.handle());
+    QVERIFY(!waylandWindow->decoration());
+    QVERIFY(!waylandWindow->decorationSubSurfaces());
+    QVERIFY(window.frameMargins().isNull());
+
+    const int painted = window.paintGLCalled;
+    window.requestUpdate();
+    QTRY_VERIFY(window.paintGLCalled > painted);
+    QVERIFY(!waylandWindow->decoration());
+}
+
+void tst_WaylandClient::decorationSubSurfacesMapInput()
+{
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    QtWaylandClient::QWaylandDisplay *display = waylandIntegration->display();
+    if (!display->supportsWindowDecoration())
+        QSKIP("This test needs window decorations");
+
+    compositor->enableSubCompositor();
+    QTRY_VERIFY(display->hasRegistryGlobal(QStringLiteral("wl_subcompositor")));
+
+    TestGlWindow window;
+    window.resize(64, 64);
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+    QTRY_VERIFY(window.paintGLCalled > 0);
+
+    auto *waylandWindow = static_cast<QtWaylandClient::QWaylandWindow *>(window.handle());
+    QtWaylandClient::QWaylandDecorationSubSurfaces *decorationSurfaces = waylandWindow->decorationSubSurfaces();
+    QVERIFY(decorationSurfaces);
+
+    const QMargins margins = window.frameMargins();
+    const QSize frameSize = window.frameGeometry().size();
+    QVERIFY(!margins.isNull());
+
+    // One subsurface per margin, placed around the contents
+    QVector<QSharedPointer<MockSurface>> edges;
+    QTRY_COMPARE((edges = compositor->subSurfaces(surface)).size(), 4);
+    QSharedPointer<MockSurface> topEdge;
+    QVector<QPoint> positions;
+    for (const QSharedPointer<MockSurface> &edge : qAsConst(edges)) {
+        positions << edge->subSurfacePosition;
+        if (edge->subSurfacePosition == QPoint(-margins.left(), -margins.top()))
+            topEdge = edge;
+    }
+    QVERIFY(topEdge);
+    QVERIFY(positions.contains(QPoint(-margins.left(), 0)));
+    QVERIFY(positions.contains(QPoint(frameSize.width() - margins.right() - margins.left(), 0)));
+    QVERIFY(positions.contains(QPoint(-margins.left(), frameSize.height() - margins.bottom() - margins.top())));
+
+    // Positions on any of the window's surfaces map to frame coordinates
+    const QPointF pos(1, 2);
+    QCOMPARE(waylandWindow->mapFromWlSurface(waylandWindow->object(), pos), pos + QPointF(margins.left(), margins.top()));
+    QCOMPARE(waylandWindow->mapFromWlSurface(decorationSurfaces->surface(Qt::TopEdge), pos), pos);
+    QCOMPARE(waylandWindow->mapFromWlSurface(decorationSurfaces->surface(Qt::LeftEdge), pos), pos + QPointF(0, margins.top()));
+    QCOMPARE(waylandWindow->mapFromWlSurface(decorationSurfaces->surface(Qt::RightEdge), pos),
+             pos + QPointF(frameSize.width() - margins.right(), margins.top()));
+    QCOMPARE(waylandWindow->mapFromWlSurface(decorationSurfaces->surface(Qt::BottomEdge), pos),
+             pos + QPointF(0, frameSize.height() - margins.bottom()));
+
+    // Input on the contents reaches the window where it happened
+    compositor->sendMousePress(surface, QPoint(10, 10));
+    compositor->sendMouseRelease(surface);
+    QTRY_COMPARE(window.mousePressEventCount, 1);
+    QCOMPARE(window.mousePressPos, QPoint(10, 10));
+
+    // while input on the decoration is left to the decoration. The next press on
+    // the contents shows the one on the title bar has been processed.
+    compositor->sendMousePress(topEdge, QPoint(frameSize.width() / 2, margins.top() / 2));
+    compositor->sendMouseRelease(topEdge);
+    compositor->sendMousePress(surface, QPoint(20, 20));
+    compositor->sendMouseRelease(surface);
+    QTRY_COMPARE(window.mousePressPos, QPoint(20, 20));
+    QCOMPARE(window.mousePressEventCount, 2);
+}
+
 int main(int argc, char **argv)
 {
     setenv("XDG_RUNTIME_DIR", ".", 1);
     setenv("QT_QPA_PLATFORM", "wayland", 1); // force QGuiApplication to use wayland plugin
 
+#if QT_CONFIG(cursor)
+    // A cursor theme with an animated wait cursor, all other shapes use the built-in cursors
+    QTemporaryDir cursorDir;
+    if (!cursorDir.isValid() || !QDir(cursorDir.path()).mkpath(QStringLiteral("qt-test/cursors")))
+        qFatal("Failed to create the test cursor theme");
+    QFile waitCursor(cursorDir.filePath(QStringLiteral("qt-test/cursors/watch")));
+    if (!waitCursor.open(QIODevice::WriteOnly))
+        qFatal("Failed to create the test cursor theme");
+    waitCursor.write(animatedXcursorFile(16, animatedCursorColors, animatedCursorDelay));
+    waitCursor.close();
+    setenv("XCURSOR_PATH", QFile::encodeName(cursorDir.path()).constData(), 1);
+    setenv("XCURSOR_THEME", "qt-test", 1);
+#endif
+
     MockCompositor compositor;
     compositor.setOutputMode(screenSize);
 
@@ -0,0 +1,12 @@
+CONFIG += testcase
+QT += testlib
+
+INCLUDEPATH += ../../../../src/shared
+
+SOURCES += \
+    tst_mimehelper.cpp \
+    ../../../../src/shared/qwaylandmimehelper.cpp
+
+HEADERS += ../../../../src/shared/qwaylandmimehelper_p.h
+
+TARGET = tst_mimehelper
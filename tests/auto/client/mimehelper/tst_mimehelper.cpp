@@ -0,0 +1,174 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwaylandmimehelper_p.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QMimeData>
+#include <QtCore/QThread>
+#include <QtGui/QImage>
+
+class tst_WaylandMimeHelper : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cachesText();
+    void cachesUrls();
+    void cachesImages();
+    void preparesImagesInBackground();
+    void dropsCacheWithMimeData();
+    void concurrentMimeData();
+};
+
+static bool sameData(const QByteArray &a, const QByteArray &b)
+{
+    return a.constData() == b.constData();
+}
+
+void tst_WaylandMimeHelper::cachesText()
+{
+    const QString mimeType = QStringLiteral("text/plain");
+    QMimeData mimeData;
+    mimeData.setText(QStringLiteral("hello"));
+
+    const QByteArray first = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    const QByteArray second = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QCOMPARE(first, QByteArray("hello"));
+    QVERIFY(sameData(first, second));
+
+    mimeData.setText(QStringLiteral("world"));
+    const QByteArray changed = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QCOMPARE(changed, QByteArray("world"));
+    QVERIFY(!sameData(first, changed));
+}
+
+void tst_WaylandMimeHelper::cachesUrls()
+{
+    const QString mimeType = QStringLiteral("text/uri-list");
+    QMimeData mimeData;
+    mimeData.setUrls({ QUrl(QStringLiteral("file:///a")), QUrl(QStringLiteral("file:///b")) });
+
+    const QByteArray first = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    const QByteArray second = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QCOMPARE(first, QByteArray("file:///a\nfile:///b\n"));
+    QVERIFY(sameData(first, second));
+
+    mimeData.setUrls({ QUrl(QStringLiteral("file:///c")) });
+    const QByteArray changed = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QCOMPARE(changed, QByteArray("file:///c\n"));
+}
+
+void tst_WaylandMimeHelper::cachesImages()
+{
+    const QString mimeType = QStringLiteral("image/png");
+    QImage red(16, 16, QImage::Format_ARGB32);
+    red.fill(Qt::red);
+    QMimeData mimeData;
+    mimeData.setImageData(red);
+
+    const QByteArray first = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    const QByteArray second = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QVERIFY(!first.isEmpty());
+    QVERIFY(sameData(first, second));
+    QCOMPARE(QImage::fromData(first, "PNG").convertToFormat(QImage::Format_ARGB32), red);
+
+    QImage blue(16, 16, QImage::Format_ARGB32);
+    blue.fill(Qt::blue);
+    mimeData.setImageData(blue);
+    const QByteArray changed = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QVERIFY(!sameData(first, changed));
+    QCOMPARE(QImage::fromData(changed, "PNG").convertToFormat(QImage::Format_ARGB32), blue);
+}
+
+void tst_WaylandMimeHelper::preparesImagesInBackground()
+{
+    const QString mimeType = QStringLiteral("image/png");
+    QImage image(64, 64, QImage::Format_ARGB32);
+    image.fill(Qt::green);
+    QMimeData mimeData;
+    mimeData.setImageData(image);
+
+    QWaylandMimeHelper::prepareByteArrays(&mimeData, { mimeType, QStringLiteral("text/plain") });
+    QThreadPool::globalInstance()->waitForDone();
+
+    const QByteArray prepared = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QVERIFY(sameData(prepared, QWaylandMimeHelper::getByteArray(&mimeData, mimeType)));
+    QCOMPARE(QImage::fromData(prepared, "PNG").convertToFormat(QImage::Format_ARGB32), image);
+}
+
+void tst_WaylandMimeHelper::dropsCacheWithMimeData()
+{
+    const QString mimeType = QStringLiteral("text/plain");
+    QByteArray payload;
+    {
+        QMimeData mimeData;
+        mimeData.setText(QStringLiteral("gone"));
+        payload = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    }
+    // Handed out payloads outlive the cache entry
+    QCOMPARE(payload, QByteArray("gone"));
+
+    // A new mime data, quite possibly at the same address, starts afresh
+    QMimeData mimeData;
+    mimeData.setText(QStringLiteral("gone"));
+    const QByteArray fresh = QWaylandMimeHelper::getByteArray(&mimeData, mimeType);
+    QCOMPARE(fresh, payload);
+    QVERIFY(!sameData(fresh, payload));
+}
+
+void tst_WaylandMimeHelper::concurrentMimeData()
+{
+    class Worker : public QThread
+    {
+    public:
+        void run() override
+        {
+            const QString mimeType = QStringLiteral("text/plain");
+            for (int i = 0; i < 1000; ++i) {
+                QMimeData mimeData;
+                const QString text = QString::number(i);
+                mimeData.setText(text);
+                if (QWaylandMimeHelper::getByteArray(&mimeData, mimeType) != text.toUtf8())
+                    ++failures;
+            }
+        }
+        int failures = 0;
+    };
+
+    Worker workers[4];
+    for (Worker &worker : workers)
+        worker.start();
+    for (Worker &worker : workers) {
+        QVERIFY(worker.wait(30000));
+        QCOMPARE(worker.failures, 0);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_WaylandMimeHelper)
+#include <tst_mimehelper.moc>
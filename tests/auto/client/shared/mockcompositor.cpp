@@ -33,10 +33,16 @@
 #include "mockwlshell.h"
 #include "mockxdgshellv6.h"
 #include "mockiviapplication.h"
+#include "mockviewporter.h"
+#include "mocksubcompositor.h"
+#include "mockglyphcache.h"
+#include "mockpresentationtime.h"
+#include "mocktextinput.h"
 
 #include <wayland-xdg-shell-unstable-v6-server-protocol.h>
 
 #include <stdio.h>
+#include <unistd.h>
 MockCompositor::MockCompositor()
 {
     pthread_create(&m_thread, 0, run, this);
@@ -68,6 +74,12 @@ void MockCompositor::applicationInitialized()
     m_ready = true;
 }
 
+// Simulates a loaded compositor by delaying every dispatch of client requests
+void MockCompositor::setDispatchLatency(int msecs)
+{
+    m_dispatchLatency.store(msecs);
+}
+
 int MockCompositor::waylandFileDescriptor() const
 {
     return m_compositor->fileDescriptor();
@@ -85,6 +97,13 @@ void MockCompositor::setOutputMode(const QSize &size)
     processCommand(command);
 }
 
+void MockCompositor::setOutputScale(int scale)
+{
+    Command command = makeCommand(Impl::Compositor::setOutputScale, m_compositor);
+    command.parameters << scale;
+    processCommand(command);
+}
+
 void MockCompositor::setKeyboardFocus(const QSharedPointer<MockSurface> &surface)
 {
     Command command = makeCommand(Impl::Compositor::setKeyboardFocus, m_compositor);
@@ -106,6 +125,69 @@ void MockCompositor::sendMouseRelease(const QSharedPointer<MockSurface> &surface
     processCommand(command);
 }
 
+void MockCompositor::sendMouseLeave(const QSharedPointer<MockSurface> &surface)
+{
+    Command command = makeCommand(Impl::Compositor::sendMouseLeave, m_compositor);
+    command.parameters << QVariant::fromValue(surface);
+    processCommand(command);
+}
+
+// Keeps frame callbacks of all surfaces pending until they are released again
+void MockCompositor::setFrameCallbacksHeld(bool held)
+{
+    Command command = makeCommand(Impl::Compositor::setFrameCallbacksHeld, m_compositor);
+    command.parameters << held;
+    processCommand(command);
+}
+
+// There's no way to take the global back, the client would keep using the wl_subcompositor
+// it bound. Tests that need it have to run after the ones that test running without it.
+void MockCompositor::enableSubCompositor()
+{
+    Command command = makeCommand(Impl::Compositor::enableSubCompositor, m_compositor);
+    processCommand(command);
+}
+
+// Like the subcompositor, the text input manager can't be taken back. It has to be
+// added before the client connects for the client to create its input context.
+void MockCompositor::enableTextInput()
+{
+    Command command = makeCommand(Impl::Compositor::enableTextInput, m_compositor);
+    processCommand(command);
+}
+
+// Adds the glyph cache and the shm-emulation server buffer integration it
+// shares its atlas through the first time. The client has to load the
+// shm-emulation-server plugin to use them.
+void MockCompositor::setGlyphCacheAtlas(const QImage &atlas)
+{
+    Command command = makeCommand(Impl::Compositor::setGlyphCacheAtlas, m_compositor);
+    command.parameters << atlas;
+    processCommand(command);
+}
+
+void MockCompositor::addGlyphCacheFont(const QString &family, const QString &styleName, const QByteArray &id,
+                                       double pixelSize, const QByteArray &entries)
+{
+    Command command = makeCommand(Impl::Compositor::addGlyphCacheFont, m_compositor);
+    command.parameters << family << styleName << id << pixelSize << entries;
+    processCommand(command);
+}
+
+// Answers the feedback requests of all surfaces that are still pending
+void MockCompositor::sendPresentationPresented(quint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags)
+{
+    Command command = makeCommand(Impl::Compositor::sendPresentationPresented, m_compositor);
+    command.parameters << timestampNsecs << refreshNsecs << sequence << flags;
+    processCommand(command);
+}
+
+void MockCompositor::sendPresentationDiscarded()
+{
+    Command command = makeCommand(Impl::Compositor::sendPresentationDiscarded, m_compositor);
+    processCommand(command);
+}
+
 void MockCompositor::sendKeyPress(const QSharedPointer<MockSurface> &surface, uint code)
 {
     Command command = makeCommand(Impl::Compositor::sendKeyPress, m_compositor);
@@ -120,6 +202,13 @@ void MockCompositor::sendKeyRelease(const QSharedPointer<MockSurface> &surface,
     processCommand(command);
 }
 
+void MockCompositor::sendKeymap(const QByteArray &keymap)
+{
+    Command command = makeCommand(Impl::Compositor::sendKeymap, m_compositor);
+    command.parameters << keymap;
+    processCommand(command);
+}
+
 void MockCompositor::sendTouchDown(const QSharedPointer<MockSurface> &surface, const QPoint &position, int id)
 {
     Command command = makeCommand(Impl::Compositor::sendTouchDown, m_compositor);
@@ -183,6 +272,29 @@ void MockCompositor::sendDataDeviceLeave(const QSharedPointer<MockSurface> &surf
     processCommand(command);
 }
 
+void MockCompositor::sendDataDeviceSelection(const QSharedPointer<MockSurface> &surface, const QString &mimeType, const QByteArray &payload)
+{
+    Command command = makeCommand(Impl::Compositor::sendDataDeviceSelection, m_compositor);
+    command.parameters << QVariant::fromValue(surface) << mimeType << payload;
+    processCommand(command);
+}
+
+// Unlike sendAddOutput(), this doesn't wait for a client to bind the output,
+// so it can be used before the application is started
+void MockCompositor::addOutput(const QRect &geometry)
+{
+    lock();
+    const int count = m_compositor->outputs().size();
+    unlock();
+
+    Command command = makeCommand(Impl::Compositor::addOutput, m_compositor);
+    command.parameters << geometry;
+    processCommand(command);
+
+    while (!output(count))
+        usleep(1000);
+}
+
 void MockCompositor::sendAddOutput()
 {
     Command command = makeCommand(Impl::Compositor::sendAddOutput, m_compositor);
@@ -253,6 +365,22 @@ void MockCompositor::waitForStartDrag()
     processCommand(command);
 }
 
+void MockCompositor::requestSelectionDataWithoutReading(const QString &mimeType)
+{
+    Command command = makeCommand(Impl::Compositor::requestSelectionDataWithoutReading, m_compositor);
+    command.parameters << mimeType;
+    processCommand(command);
+}
+
+// Whether a client is still writing data requested with requestSelectionDataWithoutReading()
+bool MockCompositor::selectionDataPending()
+{
+    lock();
+    bool pending = m_compositor->dataDeviceManager()->dataDevice()->hasPendingUnreadData();
+    unlock();
+    return pending;
+}
+
 QSharedPointer<MockSurface> MockCompositor::surface()
 {
     QSharedPointer<MockSurface> result;
@@ -269,6 +397,53 @@ QSharedPointer<MockSurface> MockCompositor::surface()
     return result;
 }
 
+// The surface last set with wl_pointer.set_cursor
+QSharedPointer<MockSurface> MockCompositor::cursorSurface()
+{
+    QSharedPointer<MockSurface> result;
+    lock();
+    if (Impl::Surface *surface = m_compositor->cursorSurface())
+        result = surface->mockSurface();
+    unlock();
+    return result;
+}
+
+QVector<QSharedPointer<MockSurface>> MockCompositor::subSurfaces(const QSharedPointer<MockSurface> &parent)
+{
+    QVector<QSharedPointer<MockSurface>> result;
+    lock();
+    for (Impl::Surface *surface : m_compositor->surfaces()) {
+        if (surface->mockSurface()->subSurfaceParent == parent)
+            result.append(surface->mockSurface());
+    }
+    unlock();
+    return result;
+}
+
+int MockCompositor::setCursorCount()
+{
+    lock();
+    int count = m_compositor->setCursorCount();
+    unlock();
+    return count;
+}
+
+int MockCompositor::presentationFeedbackCount()
+{
+    lock();
+    int count = m_compositor->presentationFeedbackCount();
+    unlock();
+    return count;
+}
+
+MockTextInputState MockCompositor::textInputState()
+{
+    lock();
+    MockTextInputState state = m_compositor->textInputState();
+    unlock();
+    return state;
+}
+
 QSharedPointer<MockOutput> MockCompositor::output(int index)
 {
     QSharedPointer<MockOutput> result;
@@ -341,6 +516,8 @@ void *MockCompositor::run(void *data)
 
     while (!controller->m_ready) {
         controller->dispatchCommands();
+        if (const int latency = controller->m_dispatchLatency.load())
+            usleep(latency * 1000);
         compositor.dispatchEvents(20);
     }
 
@@ -351,6 +528,8 @@ void *MockCompositor::run(void *data)
                 controller->m_waitCondition.wait(&controller->m_mutex);
         }
         controller->dispatchCommands();
+        if (const int latency = controller->m_dispatchLatency.load())
+            usleep(latency * 1000);
         compositor.dispatchEvents(20);
     }
 
@@ -367,11 +546,12 @@ Compositor::Compositor()
         exit(EXIT_FAILURE);
     }
 
-    wl_global_create(m_display, &wl_compositor_interface, 1, this, bindCompositor);
+    wl_global_create(m_display, &wl_compositor_interface, 4, this, bindCompositor);
 
     m_data_device_manager.reset(new DataDeviceManager(this, m_display));
 
     wl_display_init_shm(m_display);
+    wl_display_add_shm_format(m_display, WL_SHM_FORMAT_RGB565);
 
     m_seat.reset(new Seat(this, m_display));
     m_pointer = m_seat->pointer();
@@ -382,6 +562,8 @@ Compositor::Compositor()
     m_iviApplication.reset(new IviApplication(m_display));
     m_wlShell.reset(new WlShell(m_display));
     m_xdgShellV6.reset(new XdgShellV6(m_display));
+    m_viewporter.reset(new Viewporter(m_display));
+    m_presentation.reset(new Presentation(m_display));
 
     m_loop = wl_display_get_event_loop(m_display);
     m_fd = wl_event_loop_get_fd(m_loop);
@@ -454,6 +636,26 @@ IviApplication *Compositor::iviApplication() const
     return m_iviApplication.data();
 }
 
+DataDeviceManager *Compositor::dataDeviceManager() const
+{
+    return m_data_device_manager.data();
+}
+
+Surface *Compositor::cursorSurface() const
+{
+    return m_pointer->cursorSurface();
+}
+
+int Compositor::setCursorCount() const
+{
+    return m_pointer->setCursorCount();
+}
+
+int Compositor::presentationFeedbackCount() const
+{
+    return m_presentation->feedbackCount();
+}
+
 XdgShellV6 *Compositor::xdgShellV6() const
 {
     return m_xdgShellV6.data();
@@ -36,14 +36,28 @@
 #include <qglobal.h>
 #include <wayland-server.h>
 
+#include <QAtomicInt>
 #include <QImage>
 #include <QMutex>
 #include <QRect>
+#include <QRegion>
 #include <QSharedPointer>
+#include <QString>
 #include <QVariant>
 #include <QVector>
 #include <QWaitCondition>
 
+// What the client last told the text input manager, if there is one
+struct MockTextInputState
+{
+    bool available = false;
+    QString surroundingText;
+    int cursor = -1;
+    int anchor = -1;
+    int surroundingTextCount = 0;
+    int updateStateCount = 0;
+};
+
 namespace Impl {
 
 typedef void (**Implementation)(void);
@@ -58,6 +72,12 @@ class Output;
 class IviApplication;
 class WlShell;
 class XdgShellV6;
+class Viewporter;
+class SubCompositor;
+class ShmServerBufferEmulation;
+class Presentation;
+class GlyphCache;
+class TextInputManager;
 
 class Compositor
 {
@@ -76,15 +96,31 @@ public:
 
     IviApplication *iviApplication() const;
     XdgShellV6 *xdgShellV6() const;
+    DataDeviceManager *dataDeviceManager() const;
 
     void addSurface(Surface *surface);
     void removeSurface(Surface *surface);
 
+    bool frameCallbacksHeld() const { return m_frameCallbacksHeld; }
+    Surface *cursorSurface() const;
+    int setCursorCount() const;
+    int presentationFeedbackCount() const;
+    MockTextInputState textInputState() const;
+
     static void setKeyboardFocus(void *data, const QList<QVariant> &parameters);
     static void sendMousePress(void *data, const QList<QVariant> &parameters);
     static void sendMouseRelease(void *data, const QList<QVariant> &parameters);
+    static void sendMouseLeave(void *data, const QList<QVariant> &parameters);
+    static void setFrameCallbacksHeld(void *data, const QList<QVariant> &parameters);
+    static void enableSubCompositor(void *data, const QList<QVariant> &parameters);
+    static void enableTextInput(void *data, const QList<QVariant> &parameters);
+    static void setGlyphCacheAtlas(void *data, const QList<QVariant> &parameters);
+    static void addGlyphCacheFont(void *data, const QList<QVariant> &parameters);
+    static void sendPresentationPresented(void *data, const QList<QVariant> &parameters);
+    static void sendPresentationDiscarded(void *data, const QList<QVariant> &parameters);
     static void sendKeyPress(void *data, const QList<QVariant> &parameters);
     static void sendKeyRelease(void *data, const QList<QVariant> &parameters);
+    static void sendKeymap(void *data, const QList<QVariant> &parameters);
     static void sendTouchDown(void *data, const QList<QVariant> &parameters);
     static void sendTouchUp(void *data, const QList<QVariant> &parameters);
     static void sendTouchMotion(void *data, const QList<QVariant> &parameters);
@@ -94,8 +130,12 @@ public:
     static void sendDataDeviceMotion(void *data, const QList<QVariant> &parameters);
     static void sendDataDeviceDrop(void *data, const QList<QVariant> &parameters);
     static void sendDataDeviceLeave(void *data, const QList<QVariant> &parameters);
+    static void sendDataDeviceSelection(void *data, const QList<QVariant> &parameters);
     static void waitForStartDrag(void *data, const QList<QVariant> &parameters);
+    static void requestSelectionDataWithoutReading(void *data, const QList<QVariant> &parameters);
     static void setOutputMode(void *compositor, const QList<QVariant> &parameters);
+    static void setOutputScale(void *data, const QList<QVariant> &parameters);
+    static void addOutput(void *data, const QList<QVariant> &parameters);
     static void sendAddOutput(void *data, const QList<QVariant> &parameters);
     static void sendRemoveOutput(void *data, const QList<QVariant> &parameters);
     static void sendOutputGeometry(void *data, const QList<QVariant> &parameters);
@@ -116,6 +156,7 @@ private:
     static XdgToplevelV6 *resolveToplevel(const QVariant &v);
 
     void initShm();
+    GlyphCache *glyphCache();
 
     QRect m_outputGeometry;
 
@@ -136,6 +177,13 @@ private:
     QScopedPointer<IviApplication> m_iviApplication;
     QScopedPointer<WlShell> m_wlShell;
     QScopedPointer<XdgShellV6> m_xdgShellV6;
+    QScopedPointer<Viewporter> m_viewporter;
+    QScopedPointer<SubCompositor> m_subCompositor;
+    QScopedPointer<Presentation> m_presentation;
+    QScopedPointer<ShmServerBufferEmulation> m_shmServerBufferEmulation;
+    QScopedPointer<GlyphCache> m_glyphCache;
+    QScopedPointer<TextInputManager> m_textInputManager;
+    bool m_frameCallbacksHeld = false;
 };
 
 void registerResource(wl_list *list, wl_resource *resource);
@@ -148,6 +196,13 @@ public:
     Impl::Surface *handle() const { return m_surface; }
 
     QImage image;
+    int commitCount = 0;
+    QRegion surfaceDamage;
+    QRegion bufferDamage;
+    QRectF viewportSource;
+    QSize viewportDestination;
+    QWeakPointer<MockSurface> subSurfaceParent;
+    QPoint subSurfacePosition;
 
 private:
     MockSurface(Impl::Surface *surface);
@@ -217,16 +272,28 @@ public:
     ~MockCompositor();
 
     void applicationInitialized();
+    void setDispatchLatency(int msecs);
 
     int waylandFileDescriptor() const;
     void processWaylandEvents();
 
     void setOutputMode(const QSize &size);
+    void setOutputScale(int scale);
     void setKeyboardFocus(const QSharedPointer<MockSurface> &surface);
     void sendMousePress(const QSharedPointer<MockSurface> &surface, const QPoint &pos);
     void sendMouseRelease(const QSharedPointer<MockSurface> &surface);
+    void sendMouseLeave(const QSharedPointer<MockSurface> &surface);
+    void setFrameCallbacksHeld(bool held);
+    void enableSubCompositor();
+    void enableTextInput();
+    void setGlyphCacheAtlas(const QImage &atlas);
+    void addGlyphCacheFont(const QString &family, const QString &styleName, const QByteArray &id,
+                           double pixelSize, const QByteArray &entries);
+    void sendPresentationPresented(quint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags);
+    void sendPresentationDiscarded();
     void sendKeyPress(const QSharedPointer<MockSurface> &surface, uint code);
     void sendKeyRelease(const QSharedPointer<MockSurface> &surface, uint code);
+    void sendKeymap(const QByteArray &keymap);
     void sendTouchDown(const QSharedPointer<MockSurface> &surface, const QPoint &position, int id);
     void sendTouchMotion(const QSharedPointer<MockSurface> &surface, const QPoint &position, int id);
     void sendTouchUp(const QSharedPointer<MockSurface> &surface, int id);
@@ -236,6 +303,8 @@ public:
     void sendDataDeviceMotion(const QPoint &position);
     void sendDataDeviceDrop(const QSharedPointer<MockSurface> &surface);
     void sendDataDeviceLeave(const QSharedPointer<MockSurface> &surface);
+    void sendDataDeviceSelection(const QSharedPointer<MockSurface> &surface, const QString &mimeType, const QByteArray &payload);
+    void addOutput(const QRect &geometry);
     void sendAddOutput();
     void sendRemoveOutput(const QSharedPointer<MockOutput> &output);
     void sendOutputGeometry(const QSharedPointer<MockOutput> &output, const QRect &geometry);
@@ -246,8 +315,15 @@ public:
     void sendXdgToplevelV6Configure(const QSharedPointer<MockXdgToplevelV6> toplevel, const QSize &size = QSize(0, 0),
                                     const QVector<uint> &states = { ZXDG_TOPLEVEL_V6_STATE_ACTIVATED });
     void waitForStartDrag();
+    void requestSelectionDataWithoutReading(const QString &mimeType);
+    bool selectionDataPending();
 
     QSharedPointer<MockSurface> surface();
+    QSharedPointer<MockSurface> cursorSurface();
+    QVector<QSharedPointer<MockSurface>> subSurfaces(const QSharedPointer<MockSurface> &parent);
+    int setCursorCount();
+    int presentationFeedbackCount();
+    MockTextInputState textInputState();
     QSharedPointer<MockOutput> output(int index = 0);
     QSharedPointer<MockIviSurface> iviSurface(int index = 0);
     QSharedPointer<MockXdgToplevelV6> xdgToplevelV6(int index = 0);
@@ -274,6 +350,7 @@ private:
 
     bool m_alive = true;
     bool m_ready = false;
+    QAtomicInt m_dispatchLatency;
     pthread_t m_thread;
     QMutex m_mutex;
     QWaitCondition m_waitCondition;
@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mockglyphcache.h"
+#include "mockcompositor.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#  define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace Impl {
+
+void Compositor::setGlyphCacheAtlas(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    compositor->glyphCache()->setAtlas(parameters.first().value<QImage>());
+}
+
+void Compositor::addGlyphCacheFont(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    compositor->glyphCache()->addFont(parameters.at(0).toString(), parameters.at(1).toString(),
+                                      parameters.at(2).toByteArray(), parameters.at(3).toDouble(),
+                                      parameters.at(4).toByteArray());
+}
+
+GlyphCache *Compositor::glyphCache()
+{
+    if (!m_glyphCache) {
+        m_shmServerBufferEmulation.reset(new ShmServerBufferEmulation(m_display));
+        m_glyphCache.reset(new GlyphCache(m_display, m_shmServerBufferEmulation.data()));
+    }
+    return m_glyphCache.data();
+}
+
+static int createFile(const void *data, size_t size)
+{
+    int fd = int(syscall(SYS_memfd_create, "mock-glyph-cache", MFD_CLOEXEC));
+    if (fd < 0)
+        return -1;
+    if (write(fd, data, size) != ssize_t(size)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void ServerBuffer::server_buffer_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    delete this;
+}
+
+void ServerBuffer::server_buffer_release(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+GlyphCache::~GlyphCache()
+{
+    if (m_atlasFd != -1)
+        close(m_atlasFd);
+    for (const Font &font : qAsConst(m_fonts))
+        close(font.fd);
+}
+
+// Only clients binding the glyph cache afterwards get the atlas
+void GlyphCache::setAtlas(const QImage &atlas)
+{
+    m_atlas = atlas.convertToFormat(QImage::Format_Alpha8);
+    if (m_atlasFd != -1)
+        close(m_atlasFd);
+    m_atlasFd = createFile(m_atlas.constBits(), size_t(m_atlas.sizeInBytes()));
+}
+
+void GlyphCache::addFont(const QString &family, const QString &styleName, const QByteArray &id,
+                         double pixelSize, const QByteArray &entries)
+{
+    // 20 bytes per entry, see the protocol
+    const Font font = { family, styleName, id, wl_fixed_from_double(pixelSize),
+                        createFile(entries.constData(), size_t(entries.size())), uint(entries.size() / 20) };
+    m_fonts.append(font);
+    for (Resource *resource : resourceMap()) {
+        sendFont(resource, font);
+        send_done(resource->handle);
+    }
+}
+
+void GlyphCache::sendAtlas(Resource *resource)
+{
+    auto *shmEmulation = m_shmEmulation->resourceMap().value(resource->client());
+    if (!shmEmulation || m_atlasFd == -1)
+        return;
+
+    auto *buffer = new ServerBuffer(resource->client());
+    m_shmEmulation->send_server_buffer_created_fd(shmEmulation->handle, buffer->resource()->handle, m_atlasFd,
+                                                  m_atlas.width(), m_atlas.height(), m_atlas.bytesPerLine(),
+                                                  QtWaylandServer::qt_shm_emulation_server_buffer::format_A8);
+    send_atlas(resource->handle, 0, buffer->resource()->handle);
+}
+
+void GlyphCache::sendFont(Resource *resource, const Font &font)
+{
+    send_font(resource->handle, font.family, font.styleName, font.id, font.pixelSize, font.fd, font.glyphCount);
+}
+
+void GlyphCache::zqt_glyph_cache_v1_bind_resource(Resource *resource)
+{
+    sendAtlas(resource);
+    for (const Font &font : qAsConst(m_fonts))
+        sendFont(resource, font);
+    send_done(resource->handle);
+}
+
+void GlyphCache::zqt_glyph_cache_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+} // namespace Impl
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef MOCKGLYPHCACHE_H
+#define MOCKGLYPHCACHE_H
+
+#include <qwayland-server-qt-glyph-cache-unstable-v1.h>
+#include <qwayland-server-server-buffer-extension.h>
+#include <qwayland-server-shm-emulation-server-buffer.h>
+
+#include <QImage>
+#include <QVector>
+
+namespace Impl {
+
+class ServerBuffer : public QtWaylandServer::qt_server_buffer
+{
+public:
+    explicit ServerBuffer(wl_client *client) : qt_server_buffer(client, 0, 1) {}
+
+protected:
+    void server_buffer_destroy_resource(Resource *resource) override;
+    void server_buffer_release(Resource *resource) override;
+};
+
+class ShmServerBufferEmulation : public QtWaylandServer::qt_shm_emulation_server_buffer
+{
+public:
+    explicit ShmServerBufferEmulation(::wl_display *display) : qt_shm_emulation_server_buffer(display, 2) {}
+};
+
+// Shares one A8 atlas and the fonts whose glyphs are in it. The atlas and the
+// glyph tables are sent through the shm-emulation server buffer integration,
+// which the client has to bind before binding the glyph cache.
+class GlyphCache : public QtWaylandServer::zqt_glyph_cache_v1
+{
+public:
+    GlyphCache(::wl_display *display, ShmServerBufferEmulation *shmEmulation)
+        : zqt_glyph_cache_v1(display, 1)
+        , m_shmEmulation(shmEmulation)
+    {}
+    ~GlyphCache() override;
+
+    void setAtlas(const QImage &atlas);
+    void addFont(const QString &family, const QString &styleName, const QByteArray &id,
+                 double pixelSize, const QByteArray &entries);
+
+protected:
+    void zqt_glyph_cache_v1_bind_resource(Resource *resource) override;
+    void zqt_glyph_cache_v1_destroy(Resource *resource) override;
+
+private:
+    struct Font {
+        QString family;
+        QString styleName;
+        QByteArray id;
+        wl_fixed_t pixelSize;
+        int fd;
+        uint glyphCount;
+    };
+
+    void sendAtlas(Resource *resource);
+    void sendFont(Resource *resource, const Font &font);
+
+    ShmServerBufferEmulation *m_shmEmulation = nullptr;
+    QImage m_atlas;
+    int m_atlasFd = -1;
+    QVector<Font> m_fonts;
+};
+
+} // namespace Impl
+
+#endif // MOCKGLYPHCACHE_H
@@ -30,6 +30,16 @@
 #include "mockinput.h"
 #include "mocksurface.h"
 
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 namespace Impl {
 
 void Compositor::setKeyboardFocus(void *data, const QList<QVariant> &parameters)
@@ -61,6 +71,26 @@ void Compositor::sendMouseRelease(void *data, const QList<QVariant> &parameters)
     compositor->m_pointer->sendButton(0x110, 0);
 }
 
+void Compositor::sendMouseLeave(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    Surface *surface = resolveSurface(parameters.first());
+    if (!surface || compositor->m_pointer->focus() != surface)
+        return;
+
+    compositor->m_pointer->setFocus(nullptr, QPoint());
+}
+
+void Compositor::setFrameCallbacksHeld(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    compositor->m_frameCallbacksHeld = parameters.first().toBool();
+    if (!compositor->m_frameCallbacksHeld) {
+        for (Surface *surface : qAsConst(compositor->m_surfaces))
+            surface->sendFrameCallbacks();
+    }
+}
+
 void Compositor::sendKeyPress(void *data, const QList<QVariant> &parameters)
 {
     Compositor *compositor = static_cast<Compositor *>(data);
@@ -81,6 +111,12 @@ void Compositor::sendKeyRelease(void *data, const QList<QVariant> &parameters)
     compositor->m_keyboard->sendKey(parameters.last().toUInt() - 8, 0);
 }
 
+void Compositor::sendKeymap(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    compositor->m_keyboard->sendKeymap(parameters.first().toByteArray());
+}
+
 void Compositor::sendTouchDown(void *data, const QList<QVariant> &parameters)
 {
     Compositor *compositor = static_cast<Compositor *>(data);
@@ -186,6 +222,19 @@ void Compositor::sendDataDeviceLeave(void *data, const QList<QVariant> &paramete
     compositor->m_data_device_manager->dataDevice()->sendLeave(surface);
 }
 
+void Compositor::sendDataDeviceSelection(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    Surface *surface = resolveSurface(parameters.at(0));
+
+    Q_ASSERT(compositor);
+    Q_ASSERT(surface);
+
+    compositor->m_data_device_manager->dataDevice()->sendSelection(surface->resource()->client(),
+                                                                   parameters.at(1).toString(),
+                                                                   parameters.at(2).toByteArray());
+}
+
 void Compositor::waitForStartDrag(void *data, const QList<QVariant> &parameters)
 {
     Q_UNUSED(parameters);
@@ -198,6 +247,25 @@ void Compositor::waitForStartDrag(void *data, const QList<QVariant> &parameters)
     compositor->m_startDragSeen = false;
 }
 
+void Compositor::requestSelectionDataWithoutReading(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    Q_ASSERT(compositor);
+    DataDevice *dataDevice = compositor->m_data_device_manager->dataDevice();
+    wl_resource *source = nullptr;
+    QElapsedTimer timer;
+    timer.start();
+    while (!(source = dataDevice->takeSelectionSource())) {
+        if (timer.hasExpired(5000)) {
+            qWarning("No selection was set within 5 seconds");
+            return;
+        }
+        wl_display_flush_clients(compositor->m_display);
+        wl_event_loop_dispatch(compositor->m_loop, 100);
+    }
+    dataDevice->requestDataWithoutReading(source, parameters.first().toString());
+}
+
 Seat::Seat(Compositor *compositor, struct ::wl_display *display)
     : wl_seat(display, 2)
     , m_compositor(compositor)
@@ -275,6 +343,20 @@ void Keyboard::sendKey(uint32_t key, uint32_t state)
     }
 }
 
+void Keyboard::sendKeymap(const QByteArray &keymap)
+{
+    // Like real compositors, include the terminating null
+    QByteArray name = QFile::encodeName(QDir::tempPath() + QStringLiteral("/mockkeymap-XXXXXX"));
+    int fd = mkstemp(name.data());
+    if (fd < 0)
+        return;
+    unlink(name.constData());
+    if (write(fd, keymap.constData(), keymap.size() + 1) == keymap.size() + 1) {
+        for (Resource *resource : resourceMap())
+            send_keymap(resource->handle, WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1, fd, keymap.size() + 1);
+    }
+    close(fd);
+}
 
 void Keyboard::keyboard_destroy_resource(wl_keyboard::Resource *resource)
 {
@@ -317,6 +399,8 @@ void Pointer::handleSurfaceDestroyed(Surface *surface)
         m_focus = nullptr;
         m_focusResource = nullptr;
     }
+    if (m_cursorSurface == surface)
+        m_cursorSurface = nullptr;
 }
 
 void Pointer::sendMotion(const QPoint &pos)
@@ -341,6 +425,17 @@ void Pointer::pointer_destroy_resource(wl_pointer::Resource *resource)
         m_focusResource = 0;
 }
 
+void Pointer::pointer_set_cursor(wl_pointer::Resource *resource, uint32_t serial, struct ::wl_resource *surface,
+                                 int32_t hotspot_x, int32_t hotspot_y)
+{
+    Q_UNUSED(resource);
+    Q_UNUSED(serial);
+    Q_UNUSED(hotspot_x);
+    Q_UNUSED(hotspot_y);
+    m_cursorSurface = surface ? Surface::fromResource(surface) : nullptr;
+    ++m_setCursorCount;
+}
+
 Touch::Touch(Compositor *compositor)
     : wl_touch()
     , m_compositor(compositor)
@@ -380,10 +475,44 @@ void Touch::sendFrame(Surface *surface)
     wl_touch_send_frame(resource->handle);
 }
 
-DataOffer::DataOffer()
-    : wl_data_offer()
+DataOffer::DataOffer(wl_client *client, const QString &mimeType, const QByteArray &payload)
+    : wl_data_offer(client, 0, 1)
+    , m_mimeType(mimeType)
+    , m_payload(payload)
 {
+}
 
+void DataOffer::data_offer_receive(Resource *resource, const QString &mime_type, int32_t fd)
+{
+    Q_UNUSED(resource);
+    if (mime_type == m_mimeType) {
+        // Write the whole payload from the compositor thread while the client reads
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        const char *data = m_payload.constData();
+        qint64 remaining = m_payload.size();
+        while (remaining > 0) {
+            const ssize_t written = ::write(fd, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            data += written;
+            remaining -= written;
+        }
+    }
+    close(fd);
+}
+
+void DataOffer::data_offer_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void DataOffer::data_offer_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    delete this;
 }
 
 DataDevice::DataDevice(Compositor *compositor)
@@ -426,11 +555,58 @@ void DataDevice::sendLeave(Surface *surface)
     send_leave(resource->handle);
 }
 
+void DataDevice::sendSelection(wl_client *client, const QString &mimeType, const QByteArray &payload)
+{
+    DataOffer *offer = new DataOffer(client, mimeType, payload);
+    Resource *resource = resourceMap().value(client);
+    send_data_offer(resource->handle, offer->resource()->handle);
+    offer->send_offer(mimeType);
+    send_selection(resource->handle, offer->resource()->handle);
+}
+
+wl_resource *DataDevice::takeSelectionSource()
+{
+    wl_resource *source = m_selectionSource;
+    m_selectionSource = nullptr;
+    return source;
+}
+
+// Asks the source for its data, but keeps the pipe open without ever reading from it
+void DataDevice::requestDataWithoutReading(wl_resource *source, const QString &mimeType)
+{
+    int fd[2];
+    if (pipe(fd) == -1)
+        return;
+    wl_data_source_send(source, mimeType.toUtf8().constData(), fd[1]);
+    close(fd[1]);
+    m_unreadFds.append(fd[0]);
+}
+
+// The client has written into a pipe but not closed its end yet
+bool DataDevice::hasPendingUnreadData() const
+{
+    for (int fd : m_unreadFds) {
+        pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN) && !(pfd.revents & POLLHUP))
+            return true;
+    }
+    return false;
+}
+
 DataDevice::~DataDevice()
 {
+    for (int fd : qAsConst(m_unreadFds))
+        close(fd);
 
 }
 
+void DataDevice::data_device_set_selection(Resource *resource, wl_resource *source, uint32_t serial)
+{
+    Q_UNUSED(resource);
+    Q_UNUSED(serial);
+    m_selectionSource = source;
+}
+
 void DataDevice::data_device_start_drag(QtWaylandServer::wl_data_device::Resource *resource, wl_resource *source, wl_resource *origin, wl_resource *icon, uint32_t serial)
 {
     Q_UNUSED(resource);
@@ -78,6 +78,7 @@ public:
     void handleSurfaceDestroyed(Surface *surface);
 
     void sendKey(uint32_t key, uint32_t state);
+    void sendKeymap(const QByteArray &keymap);
 
 protected:
     void keyboard_destroy_resource(wl_keyboard::Resource *resource) override;
@@ -102,14 +103,21 @@ public:
     void sendMotion(const QPoint &pos);
     void sendButton(uint32_t button, uint32_t state);
 
+    Surface *cursorSurface() const { return m_cursorSurface; }
+    int setCursorCount() const { return m_setCursorCount; }
+
 protected:
     void pointer_destroy_resource(wl_pointer::Resource *resource) override;
+    void pointer_set_cursor(wl_pointer::Resource *resource, uint32_t serial, struct ::wl_resource *surface,
+                            int32_t hotspot_x, int32_t hotspot_y) override;
 
 private:
     Compositor *m_compositor = nullptr;
 
     Resource *m_focusResource = nullptr;
     Surface *m_focus = nullptr;
+    Surface *m_cursorSurface = nullptr;
+    int m_setCursorCount = 0;
 };
 
 class Touch : public QtWaylandServer::wl_touch
@@ -127,7 +135,16 @@ private:
 class DataOffer : public QtWaylandServer::wl_data_offer
 {
 public:
-    DataOffer();
+    DataOffer(wl_client *client, const QString &mimeType, const QByteArray &payload);
+
+protected:
+    void data_offer_receive(Resource *resource, const QString &mime_type, int32_t fd) override;
+    void data_offer_destroy(Resource *resource) override;
+    void data_offer_destroy_resource(Resource *resource) override;
+
+private:
+    QString m_mimeType;
+    QByteArray m_payload;
 };
 
 class DataDevice : public QtWaylandServer::wl_data_device
@@ -139,15 +156,22 @@ public:
     void sendMotion(const QPoint &position);
     void sendDrop(Surface *surface);
     void sendLeave(Surface *surface);
+    void sendSelection(wl_client *client, const QString &mimeType, const QByteArray &payload);
+    wl_resource *takeSelectionSource();
+    void requestDataWithoutReading(wl_resource *source, const QString &mimeType);
+    bool hasPendingUnreadData() const;
     ~DataDevice();
 
 protected:
     void data_device_start_drag(Resource *resource, struct ::wl_resource *source, struct ::wl_resource *origin, struct ::wl_resource *icon, uint32_t serial) override;
+    void data_device_set_selection(Resource *resource, struct ::wl_resource *source, uint32_t serial) override;
 
 private:
     Compositor *m_compositor = nullptr;
     QtWaylandServer::wl_data_offer *m_dataOffer = nullptr;
     Surface* m_focus = nullptr;
+    wl_resource *m_selectionSource = nullptr;
+    QVector<int> m_unreadFds;
 };
 
 class DataDeviceManager : public QtWaylandServer::wl_data_device_manager
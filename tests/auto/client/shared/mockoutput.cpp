@@ -33,6 +33,13 @@
 
 namespace Impl {
 
+void Compositor::addOutput(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    const QRect geometry = parameters.first().toRect();
+    compositor->m_outputs.append(new Output(compositor->m_display, geometry.size(), geometry.topLeft()));
+}
+
 void Compositor::sendAddOutput(void *data, const QList<QVariant> &parameters) {
     Q_UNUSED(parameters);
     Compositor *compositor = static_cast<Compositor *>(data);
@@ -73,6 +80,14 @@ void Compositor::setOutputMode(void *data, const QList<QVariant> &parameters)
     output->setCurrentMode(size);
 }
 
+void Compositor::setOutputScale(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    Output *output = compositor->m_outputs.first();
+    Q_ASSERT(output);
+    output->setScale(parameters.first().toInt());
+}
+
 Output::Output(wl_display *display, const QSize &resolution, const QPoint &position)
     : wl_output(display, 2)
     , m_size(resolution)
@@ -91,6 +106,15 @@ void Output::setCurrentMode(const QSize &size)
     }
 }
 
+void Output::setScale(int scale)
+{
+    m_scale = scale;
+    for (Resource *resource : resourceMap()) {
+        send_scale(resource->handle, m_scale);
+        send_done(resource->handle);
+    }
+}
+
 void Output::sendGeometryAndMode(const QRect &geometry)
 {
     m_size = geometry.size();
@@ -106,6 +130,8 @@ void Output::output_bind_resource(QtWaylandServer::wl_output::Resource *resource
 {
     sendGeometry(resource);
     sendCurrentMode(resource);
+    if (m_scale != 1)
+        send_scale(resource->handle, m_scale);
     send_done(resource->handle);
 }
 
@@ -44,6 +44,7 @@ public:
 
     QSharedPointer<MockOutput> mockOutput() const { return m_mockOutput; }
     void setCurrentMode(const QSize &size);
+    void setScale(int scale);
     void sendGeometryAndMode(const QRect &geometry);
 
 protected:
@@ -54,6 +55,7 @@ private:
     void sendCurrentMode(Resource *resource);
     QSize m_size;
     QPoint m_position;
+    int m_scale = 1;
     const QSize m_physicalSize;
     QSharedPointer<MockOutput> m_mockOutput;
 };
@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mockpresentationtime.h"
+#include "mockcompositor.h"
+
+#include <time.h>
+
+namespace Impl {
+
+void Compositor::sendPresentationPresented(void *data, const QList<QVariant> &parameters)
+{
+    Compositor *compositor = static_cast<Compositor *>(data);
+    compositor->m_presentation->sendPresented(parameters.at(0).toULongLong(), parameters.at(1).toUInt(),
+                                              parameters.at(2).toULongLong(), parameters.at(3).toUInt());
+}
+
+void Compositor::sendPresentationDiscarded(void *data, const QList<QVariant> &parameters)
+{
+    Q_UNUSED(parameters);
+    Compositor *compositor = static_cast<Compositor *>(data);
+    compositor->m_presentation->sendDiscarded();
+}
+
+PresentationFeedback::PresentationFeedback(Presentation *presentation, wl_client *client, uint32_t id)
+    : QtWaylandServer::wp_presentation_feedback(client, id, 1)
+    , m_presentation(presentation)
+{
+}
+
+void PresentationFeedback::wp_presentation_feedback_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    m_presentation->removeFeedback(this);
+    delete this;
+}
+
+// Answers all pending feedback requests, the compositor destroys them afterwards
+void Presentation::sendPresented(quint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags)
+{
+    const quint64 seconds = timestampNsecs / 1000000000;
+    const uint nanoseconds = uint(timestampNsecs % 1000000000);
+    const QVector<PresentationFeedback *> feedbacks = m_feedbacks;
+    for (PresentationFeedback *feedback : feedbacks) {
+        feedback->send_presented(uint(seconds >> 32), uint(seconds & 0xffffffff), nanoseconds, refreshNsecs,
+                                 uint(sequence >> 32), uint(sequence & 0xffffffff), flags);
+        wl_resource_destroy(feedback->resource()->handle);
+    }
+}
+
+void Presentation::sendDiscarded()
+{
+    const QVector<PresentationFeedback *> feedbacks = m_feedbacks;
+    for (PresentationFeedback *feedback : feedbacks) {
+        feedback->send_discarded();
+        wl_resource_destroy(feedback->resource()->handle);
+    }
+}
+
+void Presentation::wp_presentation_bind_resource(Resource *resource)
+{
+    send_clock_id(resource->handle, CLOCK_MONOTONIC);
+}
+
+void Presentation::wp_presentation_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void Presentation::wp_presentation_feedback(Resource *resource, ::wl_resource *surface, uint32_t callback)
+{
+    Q_UNUSED(surface);
+    m_feedbacks.append(new PresentationFeedback(this, resource->client(), callback));
+}
+
+} // namespace Impl
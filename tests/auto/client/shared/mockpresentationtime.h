@@ -0,0 +1,73 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef MOCKPRESENTATIONTIME_H
+#define MOCKPRESENTATIONTIME_H
+
+#include <qwayland-server-presentation-time.h>
+
+#include <QVector>
+
+namespace Impl {
+
+class Presentation;
+
+class PresentationFeedback : public QtWaylandServer::wp_presentation_feedback
+{
+public:
+    PresentationFeedback(Presentation *presentation, wl_client *client, uint32_t id);
+
+protected:
+    void wp_presentation_feedback_destroy_resource(Resource *resource) override;
+
+private:
+    Presentation *m_presentation = nullptr;
+};
+
+class Presentation : public QtWaylandServer::wp_presentation
+{
+public:
+    explicit Presentation(::wl_display *display) : wp_presentation(display, 1) {}
+
+    int feedbackCount() const { return m_feedbacks.size(); }
+    void sendPresented(quint64 timestampNsecs, uint refreshNsecs, quint64 sequence, uint flags);
+    void sendDiscarded();
+    void removeFeedback(PresentationFeedback *feedback) { m_feedbacks.removeOne(feedback); }
+
+protected:
+    void wp_presentation_bind_resource(Resource *resource) override;
+    void wp_presentation_destroy(Resource *resource) override;
+    void wp_presentation_feedback(Resource *resource, ::wl_resource *surface, uint32_t callback) override;
+
+private:
+    QVector<PresentationFeedback *> m_feedbacks;
+};
+
+} // namespace Impl
+
+#endif // MOCKPRESENTATIONTIME_H
@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "mocksubcompositor.h"
+#include "mocksurface.h"
+#include "mockcompositor.h"
+
+namespace Impl {
+
+void Compositor::enableSubCompositor(void *data, const QList<QVariant> &parameters)
+{
+    Q_UNUSED(parameters);
+    Compositor *compositor = static_cast<Compositor *>(data);
+    if (!compositor->m_subCompositor)
+        compositor->m_subCompositor.reset(new SubCompositor(compositor->m_display));
+}
+
+SubSurface::SubSurface(Surface *surface, Surface *parent, wl_client *client, uint32_t id)
+    : QtWaylandServer::wl_subsurface(client, id, 1)
+    , m_mockSurface(surface->mockSurface())
+{
+    m_mockSurface->subSurfaceParent = parent->mockSurface();
+}
+
+void SubSurface::subsurface_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    m_mockSurface->subSurfaceParent.clear();
+    m_mockSurface->subSurfacePosition = QPoint();
+    delete this;
+}
+
+void SubSurface::subsurface_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+// Applied right away instead of on the parent's next commit, the tests only look at
+// the position once the parent has been committed anyway
+void SubSurface::subsurface_set_position(Resource *resource, int32_t x, int32_t y)
+{
+    Q_UNUSED(resource);
+    m_mockSurface->subSurfacePosition = QPoint(x, y);
+}
+
+void SubCompositor::subcompositor_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void SubCompositor::subcompositor_get_subsurface(Resource *resource, uint32_t id, ::wl_resource *surface, ::wl_resource *parent)
+{
+    new SubSurface(Surface::fromResource(surface), Surface::fromResource(parent), resource->client(), id);
+}
+
+} // namespace Impl
@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef MOCKSUBCOMPOSITOR_H
+#define MOCKSUBCOMPOSITOR_H
+
+#include <qwayland-server-wayland.h>
+
+#include <QSharedPointer>
+
+class MockSurface;
+
+namespace Impl {
+
+class Surface;
+
+class SubSurface : public QtWaylandServer::wl_subsurface
+{
+public:
+    SubSurface(Surface *surface, Surface *parent, wl_client *client, uint32_t id);
+
+protected:
+    void subsurface_destroy_resource(Resource *resource) override;
+    void subsurface_destroy(Resource *resource) override;
+    void subsurface_set_position(Resource *resource, int32_t x, int32_t y) override;
+
+private:
+    QSharedPointer<MockSurface> m_mockSurface;
+};
+
+class SubCompositor : public QtWaylandServer::wl_subcompositor
+{
+public:
+    explicit SubCompositor(::wl_display *display) : wl_subcompositor(display, 1) {}
+
+protected:
+    void subcompositor_destroy(Resource *resource) override;
+    void subcompositor_get_subsurface(Resource *resource, uint32_t id, ::wl_resource *surface, ::wl_resource *parent) override;
+};
+
+} // namespace Impl
+
+#endif // MOCKSUBCOMPOSITOR_H
@@ -141,10 +141,7 @@ void Surface::surface_damage(Resource *resource,
                              int32_t x, int32_t y, int32_t width, int32_t height)
 {
     Q_UNUSED(resource);
-    Q_UNUSED(x);
-    Q_UNUSED(y);
-    Q_UNUSED(width);
-    Q_UNUSED(height);
+    m_pendingSurfaceDamage += QRect(x, y, width, height);
 }
 
 void Surface::surface_frame(Resource *resource,
@@ -169,15 +166,36 @@ void Surface::surface_commit(Resource *resource)
 
         if (shm_buffer) {
             int stride = wl_shm_buffer_get_stride(shm_buffer);
-            uint format = wl_shm_buffer_get_format(shm_buffer);
-            Q_UNUSED(format);
+            QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+            switch (wl_shm_buffer_get_format(shm_buffer)) {
+            case WL_SHM_FORMAT_XRGB8888:
+                format = QImage::Format_RGB32;
+                break;
+            case WL_SHM_FORMAT_RGB565:
+                format = QImage::Format_RGB16;
+                break;
+            default:
+                break;
+            }
             void *data = wl_shm_buffer_get_data(shm_buffer);
             const uchar *char_data = static_cast<const uchar *>(data);
-            QImage img(char_data, wl_shm_buffer_get_width(shm_buffer), wl_shm_buffer_get_height(shm_buffer), stride, QImage::Format_ARGB32_Premultiplied);
+            QImage img(char_data, wl_shm_buffer_get_width(shm_buffer), wl_shm_buffer_get_height(shm_buffer), stride, format);
             m_mockSurface->image = img;
         }
     }
 
+    m_mockSurface->surfaceDamage = m_pendingSurfaceDamage;
+    m_mockSurface->bufferDamage = m_pendingBufferDamage;
+    m_pendingSurfaceDamage = QRegion();
+    m_pendingBufferDamage = QRegion();
+    ++m_mockSurface->commitCount;
+
+    if (!m_compositor->frameCallbacksHeld())
+        sendFrameCallbacks();
+}
+
+void Surface::sendFrameCallbacks()
+{
     foreach (wl_resource *frameCallback, m_frameCallbackList) {
         wl_callback_send_done(frameCallback, m_compositor->time());
         wl_resource_destroy(frameCallback);
@@ -185,6 +203,13 @@ void Surface::surface_commit(Resource *resource)
     m_frameCallbackList.clear();
 }
 
+void Surface::surface_damage_buffer(Resource *resource,
+                                    int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    Q_UNUSED(resource);
+    m_pendingBufferDamage += QRect(x, y, width, height);
+}
+
 }
 MockSurface::MockSurface(Impl::Surface *surface)
     : m_surface(surface)
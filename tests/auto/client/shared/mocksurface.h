@@ -50,6 +50,7 @@ public:
     static Surface *fromResource(struct ::wl_resource *resource);
     void map();
     bool isMapped() const;
+    void sendFrameCallbacks();
     XdgToplevelV6 *xdgToplevelV6() const { return m_xdgToplevelV6; }
     WlShellSurface *wlShellSurface() const { return m_wlShellSurface; }
 
@@ -67,8 +68,12 @@ protected:
     void surface_frame(Resource *resource,
                        uint32_t callback) override;
     void surface_commit(Resource *resource) override;
+    void surface_damage_buffer(Resource *resource,
+                               int32_t x, int32_t y, int32_t width, int32_t height) override;
 private:
     wl_resource *m_buffer = nullptr;
+    QRegion m_pendingSurfaceDamage;
+    QRegion m_pendingBufferDamage;
     XdgToplevelV6 *m_xdgToplevelV6 = nullptr;
     WlShellSurface *m_wlShellSurface = nullptr;
 
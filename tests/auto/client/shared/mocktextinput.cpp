@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mocktextinput.h"
+
+namespace Impl {
+
+void Compositor::enableTextInput(void *data, const QList<QVariant> &parameters)
+{
+    Q_UNUSED(parameters);
+    Compositor *compositor = static_cast<Compositor *>(data);
+    if (!compositor->m_textInputManager)
+        compositor->m_textInputManager.reset(new TextInputManager(compositor->m_display));
+}
+
+MockTextInputState Compositor::textInputState() const
+{
+    if (!m_textInputManager)
+        return MockTextInputState();
+
+    MockTextInputState state = m_textInputManager->state();
+    state.available = true;
+    return state;
+}
+
+TextInput::TextInput(TextInputManager *manager, wl_client *client, uint32_t id)
+    : QtWaylandServer::zwp_text_input_v2(client, id, 1)
+    , m_manager(manager)
+{
+}
+
+void TextInput::zwp_text_input_v2_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    m_manager->removeTextInput(this);
+    delete this;
+}
+
+void TextInput::zwp_text_input_v2_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+// Any surface the client enables text input on has text input focus
+void TextInput::zwp_text_input_v2_enable(Resource *resource, ::wl_resource *surface)
+{
+    send_enter(resource->handle, wl_display_next_serial(m_manager->m_display), surface);
+}
+
+void TextInput::zwp_text_input_v2_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor)
+{
+    Q_UNUSED(resource);
+    MockTextInputState &state = m_manager->m_state;
+    state.surroundingText = text;
+    state.cursor = cursor;
+    state.anchor = anchor;
+    ++state.surroundingTextCount;
+}
+
+void TextInput::zwp_text_input_v2_update_state(Resource *resource, uint32_t serial, uint32_t reason)
+{
+    Q_UNUSED(resource);
+    Q_UNUSED(serial);
+    Q_UNUSED(reason);
+    ++m_manager->m_state.updateStateCount;
+}
+
+void TextInputManager::zwp_text_input_manager_v2_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void TextInputManager::zwp_text_input_manager_v2_get_text_input(Resource *resource, uint32_t id, ::wl_resource *seat)
+{
+    Q_UNUSED(seat);
+    m_textInputs.append(new TextInput(this, resource->client(), id));
+}
+
+} // namespace Impl
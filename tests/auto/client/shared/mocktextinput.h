@@ -0,0 +1,81 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef MOCKTEXTINPUT_H
+#define MOCKTEXTINPUT_H
+
+#include <qwayland-server-text-input-unstable-v2.h>
+
+#include "mockcompositor.h"
+
+#include <QVector>
+
+namespace Impl {
+
+class TextInputManager;
+
+class TextInput : public QtWaylandServer::zwp_text_input_v2
+{
+public:
+    TextInput(TextInputManager *manager, wl_client *client, uint32_t id);
+
+protected:
+    void zwp_text_input_v2_destroy_resource(Resource *resource) override;
+    void zwp_text_input_v2_destroy(Resource *resource) override;
+    void zwp_text_input_v2_enable(Resource *resource, ::wl_resource *surface) override;
+    void zwp_text_input_v2_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor) override;
+    void zwp_text_input_v2_update_state(Resource *resource, uint32_t serial, uint32_t reason) override;
+
+private:
+    TextInputManager *m_manager = nullptr;
+};
+
+// Records what the client tells the compositor about the focused text
+class TextInputManager : public QtWaylandServer::zwp_text_input_manager_v2
+{
+public:
+    explicit TextInputManager(::wl_display *display) : zwp_text_input_manager_v2(display, 1), m_display(display) {}
+
+    const MockTextInputState &state() const { return m_state; }
+    void removeTextInput(TextInput *textInput) { m_textInputs.removeOne(textInput); }
+
+protected:
+    void zwp_text_input_manager_v2_destroy(Resource *resource) override;
+    void zwp_text_input_manager_v2_get_text_input(Resource *resource, uint32_t id, ::wl_resource *seat) override;
+
+private:
+    friend class TextInput;
+
+    ::wl_display *m_display = nullptr;
+    QVector<TextInput *> m_textInputs;
+    MockTextInputState m_state;
+};
+
+} // namespace Impl
+
+#endif // MOCKTEXTINPUT_H
@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mockviewporter.h"
+#include "mocksurface.h"
+#include "mockcompositor.h"
+
+namespace Impl {
+
+Viewport::Viewport(const QSharedPointer<MockSurface> &mockSurface, wl_client *client, uint32_t id)
+    : QtWaylandServer::wp_viewport(client, id, 1)
+    , m_mockSurface(mockSurface)
+{
+}
+
+void Viewport::wp_viewport_destroy(Resource *resource)
+{
+    m_mockSurface->viewportSource = QRectF();
+    m_mockSurface->viewportDestination = QSize();
+    wl_resource_destroy(resource->handle);
+}
+
+void Viewport::wp_viewport_set_source(Resource *resource, wl_fixed_t x, wl_fixed_t y, wl_fixed_t width, wl_fixed_t height)
+{
+    Q_UNUSED(resource);
+    m_mockSurface->viewportSource = QRectF(wl_fixed_to_double(x), wl_fixed_to_double(y),
+                                           wl_fixed_to_double(width), wl_fixed_to_double(height));
+}
+
+void Viewport::wp_viewport_set_destination(Resource *resource, int32_t width, int32_t height)
+{
+    Q_UNUSED(resource);
+    m_mockSurface->viewportDestination = QSize(width, height);
+}
+
+void Viewporter::wp_viewporter_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void Viewporter::wp_viewporter_get_viewport(Resource *resource, uint32_t id, ::wl_resource *surface)
+{
+    new Viewport(Surface::fromResource(surface)->mockSurface(), resource->client(), id);
+}
+
+} // namespace Impl
@@ -8,7 +8,13 @@ CONFIG += wayland-scanner
 WAYLANDSERVERSOURCES += \
     ../../../../src/3rdparty/protocol/ivi-application.xml \
     ../../../../src/3rdparty/protocol/wayland.xml \
-    ../../../../src/3rdparty/protocol/xdg-shell-unstable-v6.xml
+    ../../../../src/3rdparty/protocol/xdg-shell-unstable-v6.xml \
+    ../../../../src/3rdparty/protocol/viewporter.xml \
+    ../../../../src/3rdparty/protocol/presentation-time.xml \
+    ../../../../src/3rdparty/protocol/text-input-unstable-v2.xml \
+    ../../../../src/extensions/server-buffer-extension.xml \
+    ../../../../src/extensions/shm-emulation-server-buffer.xml \
+    ../../../../src/extensions/qt-glyph-cache-unstable-v1.xml
 
 INCLUDEPATH += ../shared
 
@@ -19,7 +25,12 @@ SOURCES += \
     ../shared/mockwlshell.cpp \
     ../shared/mockxdgshellv6.cpp \
     ../shared/mocksurface.cpp \
-    ../shared/mockoutput.cpp
+    ../shared/mockoutput.cpp \
+    ../shared/mockviewporter.cpp \
+    ../shared/mocksubcompositor.cpp \
+    ../shared/mockglyphcache.cpp \
+    ../shared/mockpresentationtime.cpp \
+    ../shared/mocktextinput.cpp
 
 HEADERS += \
     ../shared/mockcompositor.h \
@@ -28,4 +39,9 @@ HEADERS += \
     ../shared/mockwlshell.h \
     ../shared/mockxdgshellv6.h \
     ../shared/mocksurface.h \
-    ../shared/mockoutput.h
+    ../shared/mockoutput.h \
+    ../shared/mockviewporter.h \
+    ../shared/mocksubcompositor.h \
+    ../shared/mockglyphcache.h \
+    ../shared/mockpresentationtime.h \
+    ../shared/mocktextinput.h
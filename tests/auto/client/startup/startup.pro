@@ -0,0 +1,4 @@
+include (../shared/shared.pri)
+
+TARGET = tst_client_startup
+SOURCES += tst_startup.cpp
@@ -0,0 +1,211 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mockcompositor.h"
+
+#include <QBackingStore>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QPainter>
+#include <QScreen>
+#include <QWindow>
+
+#include <QtTest/QtTest>
+#include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtWaylandClient/private/qwaylandstartupprofiler_p.h>
+#include <QtGui/private/qguiapplication_p.h>
+
+using QtWaylandClient::QWaylandStartupProfiler;
+
+static const QSize outputSize(1920, 1080);
+static const int outputCount = 4;
+static const int dispatchLatency = 5;
+
+class tst_WaylandClientStartup : public QObject
+{
+    Q_OBJECT
+public:
+    tst_WaylandClientStartup(qint64 startupTime)
+        : m_startupTime(startupTime)
+    {
+    }
+
+private slots:
+    void screensReady();
+    void startupPhases();
+    void startupTime();
+
+private:
+    qint64 m_startupTime;
+};
+
+void tst_WaylandClientStartup::screensReady()
+{
+    // All outputs are bound in one batch, make sure none of them is
+    // announced before its geometry is known
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    QCOMPARE(screens.size(), outputCount);
+    for (int i = 0; i < outputCount; ++i) {
+        const QRect expected(QPoint(i * outputSize.width(), 0), outputSize);
+        bool found = false;
+        for (QScreen *screen : screens)
+            found = found || screen->geometry() == expected;
+        QVERIFY2(found, qPrintable(QStringLiteral("No screen at %1,%2").arg(expected.x()).arg(expected.y())));
+    }
+}
+
+class RasterWindow : public QWindow
+{
+public:
+    RasterWindow() : m_backingStore(this) {}
+
+protected:
+    void exposeEvent(QExposeEvent *) override
+    {
+        if (!isExposed())
+            return;
+        const QRect rect(QPoint(), size());
+        m_backingStore.resize(size());
+        m_backingStore.beginPaint(rect);
+        QPainter painter(m_backingStore.paintDevice());
+        painter.fillRect(rect, Qt::cyan);
+        painter.end();
+        m_backingStore.endPaint();
+        m_backingStore.flush(rect);
+    }
+
+private:
+    QBackingStore m_backingStore;
+};
+
+static QStringList startupMessages;
+
+static void startupMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    Q_UNUSED(type);
+    if (qstrcmp(context.category, "qt.qpa.wayland.startup") == 0)
+        startupMessages.append(message);
+}
+
+void tst_WaylandClientStartup::startupPhases()
+{
+    // Nothing needs the buffer integrations for a raster window, so they are
+    // initialized here to have every phase in the report
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    waylandIntegration->clientBufferIntegration();
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    waylandIntegration->serverBufferIntegration();
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+
+    // Nothing has been committed yet, so there's no report either
+    QVERIFY(!QWaylandStartupProfiler::report().contains(QLatin1String("timeToFirstCommit")));
+
+    startupMessages.clear();
+    QtMessageHandler previousHandler = qInstallMessageHandler(startupMessageHandler);
+    RasterWindow window;
+    window.resize(64, 64);
+    window.show();
+    QTRY_VERIFY(!startupMessages.isEmpty());
+    qInstallMessageHandler(previousHandler);
+
+    const QJsonObject report = QWaylandStartupProfiler::report();
+    QVERIFY(report.contains(QLatin1String("timeToFirstCommit")));
+    const double timeToFirstCommit = report.value(QLatin1String("timeToFirstCommit")).toDouble();
+    QVERIFY(timeToFirstCommit > 0);
+
+    // All phases are there, in the order they are defined in
+    const QStringList expectedNames = {
+        QStringLiteral("integration"),
+        QStringLiteral("display"),
+        QStringLiteral("shellIntegration"),
+        QStringLiteral("clientBufferIntegration"),
+        QStringLiteral("serverBufferIntegration"),
+        QStringLiteral("initWindow"),
+        QStringLiteral("firstCommit")
+    };
+    const QJsonArray phases = report.value(QLatin1String("phases")).toArray();
+    QStringList names;
+    for (const QJsonValue &value : phases) {
+        const QJsonObject phase = value.toObject();
+        names.append(phase.value(QLatin1String("name")).toString());
+        QVERIFY(phase.value(QLatin1String("start")).toDouble() >= 0);
+        QVERIFY(phase.value(QLatin1String("duration")).toDouble() >= 0);
+    }
+    QCOMPARE(names, expectedNames);
+
+    // The display is connected while the integration is created, and the
+    // window is initialized before its first commit
+    const QJsonObject integration = phases.at(0).toObject();
+    const QJsonObject display = phases.at(1).toObject();
+    const QJsonObject initWindow = phases.at(5).toObject();
+    QVERIFY(display.value(QLatin1String("start")).toDouble() >= integration.value(QLatin1String("start")).toDouble());
+    QVERIFY(initWindow.value(QLatin1String("start")).toDouble() <= timeToFirstCommit);
+    QCOMPARE(phases.at(6).toObject().value(QLatin1String("start")).toDouble()
+             + phases.at(6).toObject().value(QLatin1String("duration")).toDouble(), timeToFirstCommit);
+
+    // The last line logged is the report as one line of JSON
+    QCOMPARE(QJsonDocument::fromJson(startupMessages.last().toUtf8()).object(), report);
+}
+
+void tst_WaylandClientStartup::startupTime()
+{
+    // Every round trip during startup costs at least dispatchLatency
+    QTest::setBenchmarkResult(m_startupTime, QTest::WalltimeMilliseconds);
+}
+
+int main(int argc, char **argv)
+{
+    setenv("XDG_RUNTIME_DIR", ".", 1);
+    setenv("QT_QPA_PLATFORM", "wayland", 1); // force QGuiApplication to use wayland plugin
+    // The startup profiler only records anything if its category is enabled
+    // before the platform integration is created
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.qpa.wayland.startup.debug=true"));
+
+    MockCompositor compositor;
+    compositor.setOutputMode(outputSize);
+    for (int i = 1; i < outputCount; ++i)
+        compositor.addOutput(QRect(QPoint(i * outputSize.width(), 0), outputSize));
+    compositor.setDispatchLatency(dispatchLatency);
+
+    QElapsedTimer timer;
+    timer.start();
+    QGuiApplication app(argc, argv);
+    const qint64 startupTime = timer.elapsed();
+
+    compositor.setDispatchLatency(0);
+    compositor.applicationInitialized();
+
+    tst_WaylandClientStartup tc(startupTime);
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include <tst_startup.moc>
@@ -0,0 +1,200 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mockcompositor.h"
+
+#include <QGuiApplication>
+#include <QInputMethod>
+#include <QInputMethodQueryEvent>
+#include <QThread>
+#include <QWindow>
+
+#include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtGui/private/qguiapplication_p.h>
+
+#include <QtTest/QtTest>
+
+static const int surroundingTextWindow = 512;
+
+// A window that is its own focus object and holds a large document
+class EditorWindow : public QWindow
+{
+public:
+    explicit EditorWindow(int cursorPosition)
+    {
+        setSurfaceType(QSurface::RasterSurface);
+        setGeometry(0, 0, 32, 32);
+        for (int i = 0; i < 10000; ++i)
+            text += QLatin1Char('a' + i % 26);
+        cursor = cursorPosition;
+        create();
+    }
+
+    void insert(const QString &str)
+    {
+        text.insert(cursor, str);
+        cursor += str.size();
+    }
+
+    bool event(QEvent *event) override
+    {
+        if (event->type() != QEvent::InputMethodQuery)
+            return QWindow::event(event);
+
+        QInputMethodQueryEvent *query = static_cast<QInputMethodQueryEvent *>(event);
+        if (query->queries() & Qt::ImEnabled)
+            query->setValue(Qt::ImEnabled, true);
+        if (query->queries() & Qt::ImSurroundingText)
+            query->setValue(Qt::ImSurroundingText, text);
+        if (query->queries() & Qt::ImCursorPosition)
+            query->setValue(Qt::ImCursorPosition, cursor);
+        if (query->queries() & Qt::ImAnchorPosition)
+            query->setValue(Qt::ImAnchorPosition, cursor);
+        query->accept();
+        return true;
+    }
+
+    QString text;
+    int cursor = 0;
+};
+
+class tst_WaylandClientTextInput : public QObject
+{
+    Q_OBJECT
+public:
+    tst_WaylandClientTextInput(MockCompositor *c)
+        : compositor(c)
+    {
+    }
+
+private slots:
+    void cleanup();
+    void sendsSurroundingTextWindow();
+    void coalescesUpdates();
+
+private:
+    void focus(EditorWindow *window);
+
+    MockCompositor *compositor = nullptr;
+};
+
+void tst_WaylandClientTextInput::cleanup()
+{
+    QTRY_VERIFY(!compositor->surface());
+}
+
+void tst_WaylandClientTextInput::focus(EditorWindow *window)
+{
+    window->show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+    QTRY_VERIFY(window->isExposed());
+
+    compositor->setKeyboardFocus(surface);
+    QTRY_COMPARE(QGuiApplication::focusWindow(), window);
+}
+
+void tst_WaylandClientTextInput::sendsSurroundingTextWindow()
+{
+    EditorWindow window(5000);
+    focus(&window);
+    if (QTest::currentTestFailed())
+        return;
+
+    // Only the text around the cursor goes over the wire, not the whole document
+    const int offset = window.cursor - surroundingTextWindow / 2;
+    QTRY_COMPARE(compositor->textInputState().surroundingText, window.text.mid(offset, surroundingTextWindow));
+    QCOMPARE(compositor->textInputState().cursor, surroundingTextWindow / 2);
+    QCOMPARE(compositor->textInputState().anchor, surroundingTextWindow / 2);
+}
+
+void tst_WaylandClientTextInput::coalescesUpdates()
+{
+    EditorWindow window(3000);
+    focus(&window);
+    if (QTest::currentTestFailed())
+        return;
+
+    const int offset = window.cursor - surroundingTextWindow / 2;
+    QTRY_COMPARE(compositor->textInputState().surroundingText, window.text.mid(offset, surroundingTextWindow));
+    const MockTextInputState initial = compositor->textInputState();
+
+    // Typing a word without returning to the event loop results in a single update
+    for (const QChar c : QStringLiteral("hello")) {
+        window.insert(c);
+        QGuiApplication::inputMethod()->update(Qt::ImSurroundingText | Qt::ImCursorPosition);
+        QGuiApplication::inputMethod()->update(Qt::ImAnchorPosition);
+    }
+
+    const int newOffset = window.cursor - surroundingTextWindow / 2;
+    QTRY_COMPARE(compositor->textInputState().updateStateCount, initial.updateStateCount + 1);
+    QTest::qWait(100);
+    MockTextInputState state = compositor->textInputState();
+    QCOMPARE(state.updateStateCount, initial.updateStateCount + 1);
+    QCOMPARE(state.surroundingTextCount, initial.surroundingTextCount + 1);
+    QCOMPARE(state.surroundingText, window.text.mid(newOffset, surroundingTextWindow));
+    QCOMPARE(state.cursor, surroundingTextWindow / 2);
+
+    // An edit outside of the window doesn't resend the surrounding text
+    window.text[0] = QLatin1Char('#');
+    QGuiApplication::inputMethod()->update(Qt::ImSurroundingText);
+    QTRY_COMPARE(compositor->textInputState().updateStateCount, initial.updateStateCount + 2);
+    QCOMPARE(compositor->textInputState().surroundingTextCount, initial.surroundingTextCount + 1);
+}
+
+int main(int argc, char **argv)
+{
+    setenv("XDG_RUNTIME_DIR", ".", 1);
+    setenv("QT_QPA_PLATFORM", "wayland", 1); // force QGuiApplication to use wayland plugin
+    unsetenv("QT_IM_MODULE"); // use the text input protocol
+    setenv("QT_WAYLAND_SURROUNDING_TEXT_WINDOW", QByteArray::number(surroundingTextWindow).constData(), 1);
+
+    MockCompositor compositor;
+
+    // The client only creates its input context if the global is there when it connects
+    compositor.enableTextInput();
+    while (!compositor.textInputState().available)
+        QThread::msleep(1);
+
+    QGuiApplication app(argc, argv);
+
+    // Initializing some client buffer integrations (i.e. eglInitialize) may block while waiting
+    // for a wayland sync. So we call clientBufferIntegration prior to applicationInitialized
+    // (while the compositor processes events without waiting) in order to avoid hanging later.
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    waylandIntegration->clientBufferIntegration();
+
+    compositor.applicationInitialized();
+
+    tst_WaylandClientTextInput tc(&compositor);
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include <tst_textinput.moc>
@@ -0,0 +1,221 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "mockcompositor.h"
+
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QWindow>
+#include <qpa/qplatformnativeinterface.h>
+
+#include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtGui/private/qguiapplication_p.h>
+
+#include <QtTest/QtTest>
+
+static const QSize screenSize(1600, 1200);
+static const QSize windowSize(1280, 720);
+
+class GLWindow : public QWindow
+{
+public:
+    GLWindow()
+    {
+        setSurfaceType(QSurface::OpenGLSurface);
+        QSurfaceFormat format;
+        format.setSwapInterval(0);
+        setFormat(format);
+        setGeometry(QRect(QPoint(), windowSize));
+        create();
+    }
+
+    void setRenderScale(qreal renderScale)
+    {
+        QGuiApplication::platformNativeInterface()->setWindowProperty(handle(), QStringLiteral("renderScale"), renderScale);
+    }
+};
+
+class tst_WaylandClientViewporter : public QObject
+{
+    Q_OBJECT
+public:
+    tst_WaylandClientViewporter(MockCompositor *c)
+        : compositor(c)
+    {
+    }
+
+private slots:
+    void init();
+    void cleanup();
+    void renderScaleSetsViewport();
+    void renderCost_data();
+    void renderCost();
+
+private:
+    bool initGL(GLWindow *window);
+    void renderFrame(GLWindow *window);
+
+    MockCompositor *compositor = nullptr;
+    QScopedPointer<QOpenGLContext> m_context;
+    QScopedPointer<QOpenGLShaderProgram> m_program;
+};
+
+void tst_WaylandClientViewporter::init()
+{
+    m_context.reset(new QOpenGLContext);
+    QSurfaceFormat format;
+    format.setSwapInterval(0);
+    m_context->setFormat(format);
+    if (!m_context->create())
+        QSKIP("OpenGL is not available");
+}
+
+void tst_WaylandClientViewporter::cleanup()
+{
+    m_program.reset();
+    m_context.reset();
+    QTRY_VERIFY(!compositor->surface());
+}
+
+bool tst_WaylandClientViewporter::initGL(GLWindow *window)
+{
+    if (!m_context->makeCurrent(window))
+        return false;
+
+    // A fragment shader expensive enough to make the benchmark fill-rate bound
+    m_program.reset(new QOpenGLShaderProgram);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex,
+        "attribute highp vec2 position;\n"
+        "varying highp vec2 coord;\n"
+        "void main() {\n"
+        "    coord = position;\n"
+        "    gl_Position = vec4(position, 0.0, 1.0);\n"
+        "}\n");
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment,
+        "varying highp vec2 coord;\n"
+        "void main() {\n"
+        "    highp float v = 0.0;\n"
+        "    for (int i = 0; i < 32; ++i)\n"
+        "        v += sin(coord.x * float(i)) * cos(coord.y * float(i));\n"
+        "    gl_FragColor = vec4(fract(v), coord, 1.0);\n"
+        "}\n");
+    m_program->bindAttributeLocation("position", 0);
+    return m_program->link();
+}
+
+void tst_WaylandClientViewporter::renderFrame(GLWindow *window)
+{
+    static const GLfloat vertices[] = { -1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f };
+
+    m_context->makeCurrent(window);
+    QOpenGLFunctions *gl = m_context->functions();
+    const QSize size = window->size() * window->devicePixelRatio();
+    gl->glViewport(0, 0, size.width(), size.height());
+    m_program->bind();
+    m_program->enableAttributeArray(0);
+    m_program->setAttributeArray(0, vertices, 2);
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_program->disableAttributeArray(0);
+    m_context->swapBuffers(window);
+    gl->glFinish();
+}
+
+void tst_WaylandClientViewporter::renderScaleSetsViewport()
+{
+    GLWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+    QVERIFY(initGL(&window));
+
+    window.setRenderScale(0.5);
+    QCOMPARE(window.devicePixelRatio(), 0.5);
+    renderFrame(&window);
+
+    // The buffer is rendered at half the size and scaled up by the compositor
+    QTRY_COMPARE(surface->viewportDestination, window.frameGeometry().size());
+
+    window.setRenderScale(1);
+    QCOMPARE(window.devicePixelRatio(), 1.0);
+    QTRY_COMPARE(surface->viewportDestination, QSize());
+}
+
+void tst_WaylandClientViewporter::renderCost_data()
+{
+    QTest::addColumn<qreal>("renderScale");
+    QTest::newRow("100%") << qreal(1);
+    QTest::newRow("50%") << qreal(0.5);
+}
+
+void tst_WaylandClientViewporter::renderCost()
+{
+    QFETCH(qreal, renderScale);
+
+    GLWindow window;
+    window.show();
+
+    QSharedPointer<MockSurface> surface;
+    QTRY_VERIFY(surface = compositor->surface());
+    compositor->sendShellSurfaceConfigure(surface);
+    QVERIFY(initGL(&window));
+
+    window.setRenderScale(renderScale);
+    renderFrame(&window);
+
+    QBENCHMARK {
+        renderFrame(&window);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    setenv("XDG_RUNTIME_DIR", ".", 1);
+    setenv("QT_QPA_PLATFORM", "wayland", 1); // force QGuiApplication to use wayland plugin
+
+    MockCompositor compositor;
+    compositor.setOutputMode(screenSize);
+
+    QGuiApplication app(argc, argv);
+
+    // Initializing some client buffer integrations (i.e. eglInitialize) may block while waiting
+    // for a wayland sync. So we call clientBufferIntegration prior to applicationInitialized
+    // (while the compositor processes events without waiting) in order to avoid hanging later.
+    auto *waylandIntegration = static_cast<QtWaylandClient::QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    waylandIntegration->clientBufferIntegration();
+
+    compositor.applicationInitialized();
+
+    tst_WaylandClientViewporter tc(&compositor);
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include <tst_viewporter.moc>
@@ -0,0 +1,4 @@
+include (../shared/shared.pri)
+
+TARGET = tst_client_viewporter
+SOURCES += tst_viewporter.cpp
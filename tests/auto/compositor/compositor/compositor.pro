@@ -7,12 +7,21 @@ QT += core-private gui-private waylandcompositor waylandcompositor-private
 
 QMAKE_USE += wayland-client wayland-server
 
+INCLUDEPATH += ../../../../src/shared
+
 qtConfig(xkbcommon-evdev): \
     QMAKE_USE += xkbcommon_evdev
 
 WAYLANDCLIENTSOURCES += \
             ../../../../src/3rdparty/protocol/xdg-shell-unstable-v5.xml \
+            ../../../../src/3rdparty/protocol/xdg-shell-unstable-v6.xml \
             ../../../../src/3rdparty/protocol/ivi-application.xml \
+            ../../../../src/3rdparty/protocol/text-input-unstable-v2.xml \
+            ../../../../src/3rdparty/protocol/viewporter.xml \
+            ../../../../src/3rdparty/protocol/presentation-time.xml \
+            ../../../../src/extensions/server-buffer-extension.xml \
+            ../../../../src/extensions/shm-emulation-server-buffer.xml \
+            ../../../../src/extensions/qt-glyph-cache-unstable-v1.xml \
 
 SOURCES += \
     tst_compositor.cpp \
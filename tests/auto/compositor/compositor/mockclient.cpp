@@ -123,6 +123,24 @@ void MockClient::outputScale(void *, wl_output *, int)
 
 }
 
+const wl_shm_listener MockClient::shmListener = {
+    MockClient::shmFormat
+};
+
+void MockClient::shmFormat(void *data, wl_shm *, uint32_t format)
+{
+    resolve(data)->shmFormats.append(format);
+}
+
+const wp_presentation_listener MockClient::presentationListener = {
+    MockClient::presentationClockId
+};
+
+void MockClient::presentationClockId(void *data, wp_presentation *, uint32_t clockId)
+{
+    resolve(data)->presentationClockId = clockId;
+}
+
 void MockClient::readEvents()
 {
     if (error)
@@ -166,19 +184,36 @@ void MockClient::handleGlobalRemove(void *data, wl_registry *wl_registry, uint32
 void MockClient::handleGlobal(uint32_t id, const QByteArray &interface)
 {
     if (interface == "wl_compositor") {
-        compositor = static_cast<wl_compositor *>(wl_registry_bind(registry, id, &wl_compositor_interface, 1));
+        compositor = static_cast<wl_compositor *>(wl_registry_bind(registry, id, &wl_compositor_interface, 3));
     } else if (interface == "wl_output") {
         auto output = static_cast<wl_output *>(wl_registry_bind(registry, id, &wl_output_interface, 2));
         m_outputs.insert(id, output);
         wl_output_add_listener(output, &outputListener, this);
     } else if (interface == "wl_shm") {
         shm = static_cast<wl_shm *>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        wl_shm_add_listener(shm, &shmListener, this);
     } else if (interface == "wl_shell") {
         wlshell = static_cast<wl_shell *>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
     } else if (interface == "xdg_shell") {
         xdgShell = static_cast<xdg_shell *>(wl_registry_bind(registry, id, &xdg_shell_interface, 1));
+    } else if (interface == "zxdg_shell_v6") {
+        xdgShellV6 = static_cast<zxdg_shell_v6 *>(wl_registry_bind(registry, id, &zxdg_shell_v6_interface, 1));
     } else if (interface == "ivi_application") {
         iviApplication = static_cast<ivi_application *>(wl_registry_bind(registry, id, &ivi_application_interface, 1));
+    } else if (interface == "zwp_text_input_manager_v2") {
+        textInputManager = static_cast<zwp_text_input_manager_v2 *>(wl_registry_bind(registry, id, &zwp_text_input_manager_v2_interface, 1));
+    } else if (interface == "wp_viewporter") {
+        viewporter = static_cast<wp_viewporter *>(wl_registry_bind(registry, id, &wp_viewporter_interface, 1));
+    } else if (interface == "wp_presentation") {
+        presentation = static_cast<wp_presentation *>(wl_registry_bind(registry, id, &wp_presentation_interface, 1));
+        wp_presentation_add_listener(presentation, &presentationListener, this);
+    } else if (interface == "wl_data_device_manager") {
+        dataDeviceManager = static_cast<wl_data_device_manager *>(wl_registry_bind(registry, id, &wl_data_device_manager_interface, 1));
+    } else if (interface == "qt_shm_emulation_server_buffer") {
+        // Bound by the tests, at the version they need
+        shmEmulationServerBufferId = id;
+    } else if (interface == "zqt_glyph_cache_v1") {
+        glyphCacheId = id;
     } else if (interface == "wl_seat") {
         wl_seat *s = static_cast<wl_seat *>(wl_registry_bind(registry, id, &wl_seat_interface, 1));
         m_seats << new MockSeat(s);
@@ -208,16 +243,25 @@ xdg_surface *MockClient::createXdgSurface(wl_surface *surface)
     return xdg_shell_get_xdg_surface(xdgShell, surface);
 }
 
+zxdg_surface_v6 *MockClient::createXdgSurfaceV6(wl_surface *surface)
+{
+    flushDisplay();
+    return zxdg_shell_v6_get_xdg_surface(xdgShellV6, surface);
+}
+
 ivi_surface *MockClient::createIviSurface(wl_surface *surface, uint iviId)
 {
     flushDisplay();
     return ivi_application_surface_create(iviApplication, iviId, surface);
 }
 
-ShmBuffer::ShmBuffer(const QSize &size, wl_shm *shm)
+ShmBuffer::ShmBuffer(const QSize &size, wl_shm *shm, wl_shm_format format)
 {
-    int stride = size.width() * 4;
-    int alloc = stride * size.height();
+    // Planar YUV buffers have a byte per luma sample, followed by the chroma planes
+    const bool yuv = format == WL_SHM_FORMAT_NV12 || format == WL_SHM_FORMAT_YUV420;
+    int stride = yuv ? size.width() : size.width() * 4;
+    int rows = yuv ? size.height() + (size.height() + 1) / 2 : size.height();
+    int alloc = stride * rows;
 
     char filename[] = "/tmp/wayland-shm-XXXXXX";
 
@@ -242,10 +286,11 @@ ShmBuffer::ShmBuffer(const QSize &size, wl_shm *shm)
         return;
     }
 
-    image = QImage(static_cast<uchar *>(data), size.width(), size.height(), stride, QImage::Format_ARGB32_Premultiplied);
+    image = QImage(static_cast<uchar *>(data), size.width(), rows, stride,
+                   yuv ? QImage::Format_Grayscale8 : QImage::Format_ARGB32_Premultiplied);
     shm_pool = wl_shm_create_pool(shm,fd,alloc);
     handle = wl_shm_pool_create_buffer(shm_pool,0, size.width(), size.height(),
-                                   stride, WL_SHM_FORMAT_ARGB8888);
+                                   stride, format);
     close(fd);
 }
 
@@ -28,7 +28,11 @@
 
 #include <wayland-client.h>
 #include <qwayland-xdg-shell-unstable-v5.h>
+#include <qwayland-xdg-shell-unstable-v6.h>
 #include <wayland-ivi-application-client-protocol.h>
+#include <wayland-text-input-unstable-v2-client-protocol.h>
+#include <wayland-viewporter-client-protocol.h>
+#include <wayland-presentation-time-client-protocol.h>
 
 #include <QObject>
 #include <QImage>
@@ -41,7 +45,7 @@ class MockSeat;
 class ShmBuffer
 {
 public:
-    ShmBuffer(const QSize &size, wl_shm *shm);
+    ShmBuffer(const QSize &size, wl_shm *shm, wl_shm_format format = WL_SHM_FORMAT_ARGB8888);
     ~ShmBuffer();
 
     struct wl_buffer *handle = nullptr;
@@ -60,16 +64,26 @@ public:
     wl_surface *createSurface();
     wl_shell_surface *createShellSurface(wl_surface *surface);
     xdg_surface *createXdgSurface(wl_surface *surface);
+    zxdg_surface_v6 *createXdgSurfaceV6(wl_surface *surface);
     ivi_surface *createIviSurface(wl_surface *surface, uint iviId);
 
     wl_display *display = nullptr;
     wl_compositor *compositor = nullptr;
     QMap<uint, wl_output *> m_outputs;
     wl_shm *shm = nullptr;
+    QList<uint> shmFormats;
     wl_registry *registry = nullptr;
     wl_shell *wlshell = nullptr;
     xdg_shell *xdgShell = nullptr;
+    zxdg_shell_v6 *xdgShellV6 = nullptr;
     ivi_application *iviApplication = nullptr;
+    zwp_text_input_manager_v2 *textInputManager = nullptr;
+    wl_data_device_manager *dataDeviceManager = nullptr;
+    wp_viewporter *viewporter = nullptr;
+    wp_presentation *presentation = nullptr;
+    uint presentationClockId = ~0u;
+    uint shmEmulationServerBufferId = 0;
+    uint glyphCacheId = 0;
 
     QList<MockSeat *> m_seats;
 
@@ -117,9 +131,14 @@ private:
     static void outputDone(void *data, wl_output *output);
     static void outputScale(void *data, wl_output *output, int factor);
 
+    static void shmFormat(void *data, wl_shm *shm, uint32_t format);
+    static void presentationClockId(void *data, wp_presentation *presentation, uint32_t clockId);
+
     void handleGlobal(uint32_t id, const QByteArray &interface);
     void handleGlobalRemove(uint32_t id);
 
     static const wl_output_listener outputListener;
+    static const wl_shm_listener shmListener;
+    static const wp_presentation_listener presentationListener;
 };
 
@@ -28,13 +28,19 @@
 
 #include "mockkeyboard.h"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 void keyboardKeymap(void *keyboard, struct wl_keyboard *wl_keyboard, uint32_t format, int32_t fd, uint32_t size)
 {
-    Q_UNUSED(keyboard);
     Q_UNUSED(wl_keyboard);
     Q_UNUSED(format);
-    Q_UNUSED(fd);
     Q_UNUSED(size);
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+        static_cast<MockKeyboard *>(keyboard)->m_keymapInode = st.st_ino;
+    close(fd);
+    static_cast<MockKeyboard *>(keyboard)->m_keymapCount++;
 }
 
 void keyboardEnter(void *keyboard, struct wl_keyboard *wl_keyboard, uint32_t serial, struct wl_surface *surface, struct wl_array *keys)
@@ -45,6 +45,8 @@ public:
     uint m_lastKeyCode = 0;
     uint m_lastKeyState = 0;
     uint m_group = 0;
+    quint64 m_keymapInode = 0;
+    int m_keymapCount = 0;
 };
 
 #endif // MOCKKEYBOARD_H
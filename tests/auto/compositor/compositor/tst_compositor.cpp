@@ -39,18 +39,72 @@
 
 #include <QtGui/QScreen>
 #include <QtWaylandCompositor/QWaylandXdgShellV5>
+#include <QtWaylandCompositor/QWaylandClient>
 #include <QtWaylandCompositor/private/qwaylandxdgshellv6_p.h>
 #include <QtWaylandCompositor/private/qwaylandkeyboard_p.h>
+#if QT_CONFIG(xkbcommon_evdev)
+#include <QtWaylandCompositor/private/qwaylandkeymapcache_p.h>
+#endif
 #include <QtWaylandCompositor/QWaylandIviApplication>
 #include <QtWaylandCompositor/QWaylandIviSurface>
 #include <QtWaylandCompositor/QWaylandSurface>
 #include <QtWaylandCompositor/QWaylandResource>
 #include <QtWaylandCompositor/QWaylandKeymap>
+#include <QtWaylandCompositor/QWaylandSurfaceCapture>
+#include <QtWaylandCompositor/QWaylandTextInputManager>
+#include <QtWaylandCompositor/QWaylandViewporter>
+#include <QtWaylandCompositor/QWaylandPresentationTime>
+#include <QtWaylandCompositor/QWaylandView>
+#include <QtWaylandCompositor/QWaylandOutputRecorder>
+#include <QtWaylandCompositor/qwaylandoutputrecorderlayout.h>
+#include <QtWaylandCompositor/private/qwaylandtextinput_p.h>
+#include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
+#include <QtWaylandCompositor/private/qwldatadevicemanager_p.h>
+#include <QtWaylandCompositor/private/qwaylandoutput_p.h>
 #include <qwayland-xdg-shell-unstable-v5.h>
 #include <qwayland-ivi-application.h>
+#include <wayland-shm-emulation-server-buffer-client-protocol.h>
+#include <wayland-qt-glyph-cache-unstable-v1-client-protocol.h>
+#include <QtWaylandCompositor/QWaylandGlyphCache>
+#include "qwaylandglyphcacheentry_p.h"
+#if QT_CONFIG(opengl)
+#include <QtWaylandCompositor/private/qwlserverbufferintegration_p.h>
+#include <QtWaylandCompositor/private/qwlclientbuffer_p.h>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLTexture>
+#endif
 
 #include <QtTest/QtTest>
 
+#include <algorithm>
+#include <functional>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef Q_OS_LINUX
+#  ifndef F_GET_SEALS
+#    define F_GET_SEALS         (1024 + 10)
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL         0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK       0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW         0x0004
+#  endif
+#  ifndef F_SEAL_FUTURE_WRITE
+#    define F_SEAL_FUTURE_WRITE 0x0010
+#  endif
+#endif
+
 class tst_WaylandCompositor : public QObject
 {
     Q_OBJECT
@@ -62,6 +116,8 @@ private slots:
     void simpleKeyboard();
     void keyboardKeymaps();
     void keyboardLayoutSwitching();
+    void keymapsAreSharedAndCached();
+    void prewarmsKeymaps();
 #endif
     void keyboardGrab();
     void seatCreation();
@@ -74,13 +130,37 @@ private slots:
     void sizeFollowsWindow();
     void mapSurface();
     void frameCallback();
+    void surfaceCapture();
+    void surfaceCaptureBufferScale();
+    void surfaceCaptureThroughput();
+    void outputRecorder();
+#if QT_CONFIG(opengl)
+    void shmServerBufferMemfd();
+    void shmServerBufferIsReadOnly();
+    void shmServerBufferUpdates();
+    void shmServerBufferWaitsForRelease();
+    void glyphCacheFontIdentity();
+#endif
     void removeOutput();
+    void sharedMemoryYuvBuffers_data();
+    void sharedMemoryYuvBuffers();
+    void sharedMemoryYuvFormatsAreOptIn();
+#if QT_CONFIG(opengl)
+    void sharedMemoryYuvTexture_data();
+    void sharedMemoryYuvTexture();
+#endif
 
     void advertisesXdgShellSupport();
     void createsXdgSurfaces();
     void reportsXdgSurfaceWindowGeometry();
     void setsXdgAppId();
     void sendsXdgConfigure();
+    void coalescesXdgResizeConfigures_data();
+    void coalescesXdgResizeConfigures();
+    void detectsUnresponsiveXdgClients();
+    void textInputTyping_data();
+    void textInputTyping();
+    void retainsSelectionLazily();
 
     void advertisesIviApplicationSupport();
     void createsIviSurfaces();
@@ -90,6 +170,12 @@ private slots:
 
     void convertsXdgEdgesToQtEdges();
     void xdgShellV6Positioner();
+
+    void viewporterScalesAndCrops();
+    void viewporterEmitsErrorOnOutOfBufferSource();
+
+    void presentationFeedbackIsPresented();
+    void presentationFeedbackIsDiscarded();
 };
 
 void tst_WaylandCompositor::init() {
@@ -280,6 +366,79 @@ void tst_WaylandCompositor::keyboardLayoutSwitching()
     QTRY_COMPARE(mockKeyboard->m_lastKeyCode, 44u);
 }
 
+void tst_WaylandCompositor::keymapsAreSharedAndCached()
+{
+    TestCompositor compositor;
+    compositor.create();
+    QWaylandSeat* seat = compositor.defaultSeat();
+    seat->keymap()->setLayout("us");
+
+    MockClient client;
+    MockClient otherClient;
+    QTRY_COMPARE(client.m_seats.size(), 1);
+    QTRY_COMPARE(otherClient.m_seats.size(), 1);
+    MockKeyboard *mockKeyboard = client.m_seats.at(0)->keyboard();
+    MockKeyboard *otherKeyboard = otherClient.m_seats.at(0)->keyboard();
+    QTRY_VERIFY(mockKeyboard->m_keymapCount > 0);
+    QTRY_VERIFY(otherKeyboard->m_keymapCount > 0);
+
+    // All clients get the same sealed file
+    const quint64 usKeymap = mockKeyboard->m_keymapInode;
+    QVERIFY(usKeymap != 0);
+    QCOMPARE(otherKeyboard->m_keymapInode, usKeymap);
+
+    int count = mockKeyboard->m_keymapCount;
+    seat->keymap()->setLayout("de");
+    compositor.flushClients();
+    QTRY_COMPARE(mockKeyboard->m_keymapCount, count + 1);
+    QVERIFY(mockKeyboard->m_keymapInode != usKeymap);
+
+    // Switching back reuses the keymap compiled before
+    count = mockKeyboard->m_keymapCount;
+    seat->keymap()->setLayout("us");
+    compositor.flushClients();
+    QTRY_COMPARE(mockKeyboard->m_keymapCount, count + 1);
+    QCOMPARE(mockKeyboard->m_keymapInode, usKeymap);
+}
+
+void tst_WaylandCompositor::prewarmsKeymaps()
+{
+    qputenv("QT_WAYLAND_KEYMAP_PREWARM", "it; fr:azerty");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_KEYMAP_PREWARM");
+
+    QWaylandSeat* seat = compositor.defaultSeat();
+    QWaylandKeymapNames names;
+    names.rules = seat->keymap()->rules().toLocal8Bit();
+    names.model = seat->keymap()->model().toLocal8Bit();
+    names.options = seat->keymap()->options().toLocal8Bit();
+    QWaylandKeymapNames italian = names;
+    italian.layout = "it";
+    QWaylandKeymapNames french = names;
+    french.layout = "fr";
+    french.variant = "azerty";
+
+    // The layouts are compiled in the background, without anyone using them yet
+    QVERIFY(QThreadPool::globalInstance()->waitForDone(10000));
+    const QSharedPointer<QWaylandCompiledKeymap> prewarmed = QWaylandKeymapCache::cachedKeymap(italian);
+    QVERIFY(prewarmed);
+    QVERIFY(QWaylandKeymapCache::cachedKeymap(french));
+
+    MockClient client;
+    QTRY_COMPARE(client.m_seats.size(), 1);
+    MockKeyboard *mockKeyboard = client.m_seats.at(0)->keyboard();
+    QTRY_VERIFY(mockKeyboard->m_keymapCount > 0);
+
+    // Switching to a prewarmed layout sends the keymap compiled up front
+    const int count = mockKeyboard->m_keymapCount;
+    seat->keymap()->setLayout("it");
+    compositor.flushClients();
+    QTRY_COMPARE(mockKeyboard->m_keymapCount, count + 1);
+    struct stat st;
+    QCOMPARE(fstat(prewarmed->fd, &st), 0);
+    QCOMPARE(mockKeyboard->m_keymapInode, quint64(st.st_ino));
+}
 #endif // QT_CONFIG(xkbcommon_evdev)
 
 void tst_WaylandCompositor::keyboardGrab()
@@ -503,6 +662,695 @@ void tst_WaylandCompositor::frameCallback()
     wl_surface_destroy(surface);
 }
 
+void tst_WaylandCompositor::surfaceCapture()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QWaylandSurfaceCapture capture(waylandSurface);
+    QSignalSpy frameSpy(&capture, SIGNAL(frameCaptured(const QImage &, const QRegion &)));
+    QSignalSpy failedSpy(&capture, SIGNAL(failed(QWaylandSurfaceGrabber::Error)));
+
+    capture.setActive(true);
+    QCOMPARE(failedSpy.count(), 1);
+    QCOMPARE(frameSpy.count(), 0);
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::red);
+
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(frameSpy.count(), 1);
+    QCOMPARE(frameSpy.last().at(1).value<QRegion>(), QRegion(QRect(QPoint(), size)));
+    QCOMPARE(capture.frame().size(), size);
+    QCOMPARE(capture.frame().pixel(32, 32), QColor(Qt::red).rgba());
+
+    // Only the damaged part is updated, and the captured frame does not alias client memory
+    buffer.image.fill(Qt::blue);
+    QCOMPARE(capture.frame().pixel(32, 32), QColor(Qt::red).rgba());
+
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, 16, 16);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(frameSpy.count(), 2);
+    QCOMPARE(frameSpy.last().at(1).value<QRegion>(), QRegion(0, 0, 16, 16));
+    QCOMPARE(capture.frame().pixel(8, 8), QColor(Qt::blue).rgba());
+    QCOMPARE(capture.frame().pixel(32, 32), QColor(Qt::red).rgba());
+
+    capture.setActive(false);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+    compositor.flushClients();
+    QTest::qWait(50);
+    QCOMPARE(frameSpy.count(), 2);
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::surfaceCaptureBufferScale()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QWaylandSurfaceCapture capture(waylandSurface);
+    QSignalSpy frameSpy(&capture, SIGNAL(frameCaptured(const QImage &, const QRegion &)));
+    capture.setActive(true);
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(Qt::red);
+
+    wl_surface_set_buffer_scale(surface, 2);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width() / 2, size.height() / 2);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(frameSpy.count(), 1);
+    QCOMPARE(capture.frame().size(), size);
+
+    // Surface damage covers twice as many buffer pixels in each direction
+    buffer.image.fill(Qt::blue);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 8, 8, 8, 8);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(frameSpy.count(), 2);
+    QCOMPARE(frameSpy.last().at(1).value<QRegion>(), QRegion(16, 16, 16, 16));
+    QCOMPARE(capture.frame().pixel(16, 16), QColor(Qt::blue).rgba());
+    QCOMPARE(capture.frame().pixel(31, 31), QColor(Qt::blue).rgba());
+    QCOMPARE(capture.frame().pixel(15, 15), QColor(Qt::red).rgba());
+    QCOMPARE(capture.frame().pixel(32, 32), QColor(Qt::red).rgba());
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::surfaceCaptureThroughput()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    QWaylandSurfaceCapture capture(compositor.surfaces.at(0));
+    QSignalSpy frameSpy(&capture, SIGNAL(frameCaptured(const QImage &, const QRegion &)));
+    capture.setActive(true);
+
+    QSize size(1920, 1080);
+    ShmBuffer buffer(size, client.shm);
+    int frames = 0;
+
+    QBENCHMARK {
+        buffer.image.fill(frames % 2 ? Qt::red : Qt::blue);
+        wl_surface_attach(surface, buffer.handle, 0, 0);
+        wl_surface_damage(surface, 0, 0, size.width(), size.height());
+        wl_surface_commit(surface);
+        QTRY_COMPARE(frameSpy.count(), ++frames);
+    }
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::outputRecorder()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    QWaylandOutputRecorder recorder(compositor.defaultOutput());
+    QSignalSpy recordedSpy(&recorder, SIGNAL(frameRecorded(quint64, quint64)));
+    QSignalSpy bufferSpy(&recorder, SIGNAL(bufferChanged()));
+    recorder.setFrameCount(2);
+    recorder.setActive(true);
+    QCOMPARE(recorder.fileDescriptor(), -1);
+
+    QImage image(64, 48, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::red);
+    recorder.recordImage(image);
+    QTRY_COMPARE(recordedSpy.count(), 1);
+    QTRY_COMPARE(bufferSpy.count(), 1);
+    QCOMPARE(recorder.frameSize(), image.size());
+
+    const int fd = recorder.fileDescriptor();
+    QVERIFY(fd >= 0);
+    const size_t size = size_t(lseek(fd, 0, SEEK_END));
+
+    // Consumers only get to read the ring
+    QCOMPARE(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), MAP_FAILED);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    QVERIFY(data != MAP_FAILED);
+
+    // Read the ring the way a consumer in another process would
+    const auto *ring = static_cast<const uchar *>(data);
+    const auto *header = reinterpret_cast<const QWaylandOutputRecorderRingHeader *>(ring);
+    QCOMPARE(header->magic, uint32_t(QT_WAYLAND_OUTPUT_RECORDER_MAGIC));
+    QCOMPARE(header->version, uint32_t(QT_WAYLAND_OUTPUT_RECORDER_VERSION));
+    QCOMPARE(header->frameCount, 2u);
+    QCOMPARE(header->width, 64u);
+    QCOMPARE(header->height, 48u);
+    QVERIFY(header->stride >= 64 * 4);
+    QVERIFY(header->frameOffset >= sizeof(QWaylandOutputRecorderRingHeader));
+    QVERIFY(size_t(header->frameOffset) + size_t(header->slotSize) * header->frameCount <= size);
+
+    auto load = [](const uint64_t *value) {
+        return reinterpret_cast<const QAtomicInteger<quint64> *>(value)->loadAcquire();
+    };
+    auto readFrame = [&](quint64 sequence, QImage *frame, quint64 *timestamp) {
+        const uchar *slot = ring + header->frameOffset + size_t((sequence - 1) % header->frameCount) * header->slotSize;
+        const auto *frameHeader = reinterpret_cast<const QWaylandOutputRecorderFrameHeader *>(slot);
+        if (load(&frameHeader->lock) != 2 * sequence)
+            return false;
+        *timestamp = frameHeader->timestamp;
+        *frame = QImage(slot + QWaylandOutputRecorderDataOffset, int(header->width), int(header->height),
+                        int(header->stride), QImage::Format(header->format)).copy();
+        return frameHeader->sequence == sequence && load(&frameHeader->lock) == 2 * sequence;
+    };
+
+    QImage frame;
+    quint64 timestamp = 0;
+    QCOMPARE(load(&header->latestSequence), quint64(1));
+    QVERIFY(readFrame(1, &frame, &timestamp));
+    QCOMPARE(timestamp, recordedSpy.last().at(1).value<quint64>());
+    QCOMPARE(frame.size(), image.size());
+    QCOMPARE(frame.pixel(0, 0), QColor(Qt::red).rgba());
+    QCOMPARE(frame.pixel(63, 47), QColor(Qt::red).rgba());
+
+    // Nothing changed, so nothing is recorded
+    recorder.recordImage(image);
+    QCOMPARE(load(&header->latestSequence), quint64(1));
+
+    // Rows are stored top-down
+    image.fill(Qt::blue);
+    image.setPixel(0, 0, QColor(Qt::green).rgba());
+    recorder.markDirty();
+    recorder.recordImage(image);
+    QCOMPARE(load(&header->latestSequence), quint64(2));
+    QVERIFY(readFrame(2, &frame, &timestamp));
+    QCOMPARE(frame.pixel(0, 0), QColor(Qt::green).rgba());
+    QCOMPARE(frame.pixel(0, 47), QColor(Qt::blue).rgba());
+
+    // The third frame wraps around and overwrites the first slot
+    const quint64 secondTimestamp = timestamp;
+    image.fill(Qt::yellow);
+    recorder.markDirty();
+    recorder.recordImage(image);
+    QCOMPARE(load(&header->latestSequence), quint64(3));
+    QVERIFY(!readFrame(1, &frame, &timestamp));
+    QVERIFY(readFrame(3, &frame, &timestamp));
+    QVERIFY(timestamp >= secondTimestamp);
+    QCOMPARE(frame.pixel(10, 10), QColor(Qt::yellow).rgba());
+    QTRY_COMPARE(recordedSpy.count(), 3);
+
+    // A new frame size means a new ring
+    munmap(data, size);
+    recorder.markDirty();
+    recorder.recordImage(QImage(32, 32, QImage::Format_ARGB32_Premultiplied));
+    QTRY_COMPARE(bufferSpy.count(), 2);
+    QCOMPARE(recorder.frameSize(), QSize(32, 32));
+
+    recorder.setActive(false);
+    QCOMPARE(recorder.fileDescriptor(), -1);
+}
+
+#if QT_CONFIG(opengl)
+// Receives the shm-emulation server buffers sent to a client
+class ShmServerBufferClient
+{
+public:
+    ShmServerBufferClient(MockClient *client, uint version)
+        : shmEmulation(static_cast<qt_shm_emulation_server_buffer *>(
+                           wl_registry_bind(client->registry, client->shmEmulationServerBufferId,
+                                            &qt_shm_emulation_server_buffer_interface, version)))
+        , client(client)
+        , version(version)
+    {
+        qt_shm_emulation_server_buffer_add_listener(shmEmulation, &listener, this);
+    }
+
+    ~ShmServerBufferClient()
+    {
+        for (int fd : fds) {
+            if (fd != -1)
+                close(fd);
+        }
+        if (buffer)
+            qt_server_buffer_destroy(buffer);
+        qt_shm_emulation_server_buffer_destroy(shmEmulation);
+    }
+
+    // Returns the contents of the given file, or a null image if it can't be mapped
+    QImage contents(int slot) const
+    {
+        const size_t size = size_t(bytesPerLine) * size_t(height);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fds[slot], 0);
+        if (data == MAP_FAILED)
+            return QImage();
+        QImage image = QImage(static_cast<const uchar *>(data), width, height, bytesPerLine, QImage::Format_RGBA8888).copy();
+        munmap(data, size);
+        return image;
+    }
+
+    // Tells the compositor that the file the last update switched away from is no longer read
+    void release()
+    {
+        qt_shm_emulation_server_buffer_server_buffer_release(shmEmulation, buffer, 1 - slot);
+        wl_display_flush(client->display);
+    }
+
+    qt_shm_emulation_server_buffer *shmEmulation = nullptr;
+    MockClient *client = nullptr;
+    uint version = 0;
+    bool autoRelease = true;
+    qt_server_buffer *buffer = nullptr;
+    int fds[2] = { -1, -1 };
+    int width = 0;
+    int height = 0;
+    int bytesPerLine = 0;
+    uint slot = 0;
+    int updates = 0;
+
+private:
+    static void created(void *data, qt_shm_emulation_server_buffer *, qt_server_buffer *id, const char *,
+                        int32_t width, int32_t height, int32_t bytesPerLine, int32_t)
+    {
+        auto *self = static_cast<ShmServerBufferClient *>(data);
+        self->buffer = id;
+        self->width = width;
+        self->height = height;
+        self->bytesPerLine = bytesPerLine;
+    }
+
+    static void createdFd(void *data, qt_shm_emulation_server_buffer *shmEmulation, qt_server_buffer *id, int32_t fd,
+                          int32_t width, int32_t height, int32_t bytesPerLine, int32_t format)
+    {
+        created(data, shmEmulation, id, nullptr, width, height, bytesPerLine, format);
+        static_cast<ShmServerBufferClient *>(data)->fds[0] = fd;
+    }
+
+    static void backBuffer(void *data, qt_shm_emulation_server_buffer *, qt_server_buffer *, int32_t fd)
+    {
+        static_cast<ShmServerBufferClient *>(data)->fds[1] = fd;
+    }
+
+    static void updated(void *data, qt_shm_emulation_server_buffer *, qt_server_buffer *, uint32_t slot, wl_array *)
+    {
+        auto *self = static_cast<ShmServerBufferClient *>(data);
+        const bool switched = slot != self->slot;
+        self->slot = slot;
+        ++self->updates;
+        if (switched && self->autoRelease && self->version >= 4)
+            self->release();
+    }
+
+    static const qt_shm_emulation_server_buffer_listener listener;
+};
+
+const qt_shm_emulation_server_buffer_listener ShmServerBufferClient::listener = {
+    ShmServerBufferClient::created,
+    ShmServerBufferClient::createdFd,
+    ShmServerBufferClient::backBuffer,
+    ShmServerBufferClient::updated
+};
+
+// Returns the compositor side of the given client, found through a surface it creates
+static wl_client *serverSideClient(TestCompositor *compositor, MockClient *client)
+{
+    const int count = compositor->surfaces.size();
+    client->createSurface();
+    if (!QTest::qWaitFor([&]() { return compositor->surfaces.size() > count; }))
+        return nullptr;
+    return compositor->surfaces.last()->client()->client();
+}
+
+void tst_WaylandCompositor::shmServerBufferMemfd()
+{
+    if (!QGuiApplication::platformNativeInterface())
+        QSKIP("The shm-emulation-server integration needs a platform native interface");
+
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration();
+    if (!integration)
+        QSKIP("The shm-emulation-server plugin is not available");
+
+    QImage image(33, 17, QImage::Format_RGBA8888);
+    image.fill(Qt::magenta);
+    QScopedPointer<QtWayland::ServerBuffer> serverBuffer(integration->createServerBufferFromImage(image, QtWayland::ServerBuffer::RGBA32));
+
+    MockClient client;
+    QTRY_VERIFY(client.shmEmulationServerBufferId);
+    ShmServerBufferClient receiver(&client, 4);
+    wl_client *waylandClient = serverSideClient(&compositor, &client);
+    QVERIFY(waylandClient);
+
+    QVERIFY(serverBuffer->resourceForClient(waylandClient));
+    QTRY_VERIFY(receiver.buffer);
+    if (receiver.fds[0] == -1)
+        QSKIP("memfd is not supported, the buffer was sent through QSharedMemory");
+
+    QCOMPARE(receiver.width, image.width());
+    QCOMPARE(receiver.height, image.height());
+    QCOMPARE(receiver.bytesPerLine, image.bytesPerLine());
+
+    struct stat st;
+    QCOMPARE(fstat(receiver.fds[0], &st), 0);
+    QCOMPARE(qint64(st.st_size), qint64(image.sizeInBytes()));
+
+    // The size can't change under the clients, and the seals can't be taken back
+    const int seals = fcntl(receiver.fds[0], F_GET_SEALS);
+    QVERIFY(seals != -1);
+    QCOMPARE(seals & (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL), F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+    QCOMPARE(ftruncate(receiver.fds[0], 0), -1);
+
+    QCOMPARE(receiver.contents(0), image);
+}
+
+void tst_WaylandCompositor::shmServerBufferIsReadOnly()
+{
+    if (!QGuiApplication::platformNativeInterface())
+        QSKIP("The shm-emulation-server integration needs a platform native interface");
+
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration();
+    if (!integration)
+        QSKIP("The shm-emulation-server plugin is not available");
+
+    QImage image(16, 16, QImage::Format_RGBA8888);
+    image.fill(Qt::magenta);
+    QScopedPointer<QtWayland::ServerBuffer> serverBuffer(integration->createServerBufferFromImage(image, QtWayland::ServerBuffer::RGBA32));
+
+    MockClient client;
+    QTRY_VERIFY(client.shmEmulationServerBufferId);
+    ShmServerBufferClient receiver(&client, 4);
+    wl_client *waylandClient = serverSideClient(&compositor, &client);
+    QVERIFY(waylandClient);
+    QVERIFY(serverBuffer->resourceForClient(waylandClient));
+    QTRY_VERIFY(receiver.buffer);
+    if (receiver.fds[0] == -1)
+        QSKIP("memfd is not supported, the buffer was sent through QSharedMemory");
+
+    // The buffer is shared by all clients, none of them may change it
+    const int fd = receiver.fds[0];
+    QCOMPARE(fcntl(fd, F_GETFL) & O_ACCMODE, O_RDONLY);
+    QCOMPARE(mmap(nullptr, size_t(image.sizeInBytes()), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), MAP_FAILED);
+    const char byte = 0;
+    QCOMPARE(write(fd, &byte, 1), ssize_t(-1));
+
+    // Reopening the file doesn't help either, where the kernel can seal future writes
+    if (fcntl(fd, F_GET_SEALS) & F_SEAL_FUTURE_WRITE) {
+        const QByteArray path = "/proc/self/fd/" + QByteArray::number(fd);
+        const int writableFd = open(path.constData(), O_RDWR | O_CLOEXEC);
+        if (writableFd != -1) {
+            QCOMPARE(pwrite(writableFd, &byte, 1, 0), ssize_t(-1));
+            QCOMPARE(mmap(nullptr, size_t(image.sizeInBytes()), PROT_READ | PROT_WRITE, MAP_SHARED, writableFd, 0), MAP_FAILED);
+            close(writableFd);
+        }
+    }
+
+    // while the compositor can still update it
+    image.fill(Qt::cyan);
+    QVERIFY(serverBuffer->update(image, image.rect()));
+    QTRY_COMPARE(receiver.updates, 1);
+    QCOMPARE(receiver.contents(int(receiver.slot)), image);
+}
+
+void tst_WaylandCompositor::shmServerBufferUpdates()
+{
+    if (!QGuiApplication::platformNativeInterface())
+        QSKIP("The shm-emulation-server integration needs a platform native interface");
+
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration();
+    if (!integration)
+        QSKIP("The shm-emulation-server plugin is not available");
+
+    const QColor colors[] = { Qt::magenta, Qt::cyan, Qt::yellow, Qt::green };
+    QImage image(16, 16, QImage::Format_RGBA8888);
+    image.fill(colors[0]);
+    const QImage first = image;
+    QScopedPointer<QtWayland::ServerBuffer> serverBuffer(integration->createServerBufferFromImage(image, QtWayland::ServerBuffer::RGBA32));
+
+    MockClient client;
+    QTRY_VERIFY(client.shmEmulationServerBufferId);
+    ShmServerBufferClient receiver(&client, 4);
+    wl_client *waylandClient = serverSideClient(&compositor, &client);
+    QVERIFY(waylandClient);
+    QVERIFY(serverBuffer->resourceForClient(waylandClient));
+    QTRY_VERIFY(receiver.buffer);
+    if (receiver.fds[0] == -1)
+        QSKIP("memfd is not supported, the buffer was sent through QSharedMemory");
+
+    // Version 2 clients are not told about updates, so what they got must never change
+    MockClient oldClient;
+    QTRY_VERIFY(oldClient.shmEmulationServerBufferId);
+    ShmServerBufferClient oldReceiver(&oldClient, 2);
+    wl_client *oldWaylandClient = serverSideClient(&compositor, &oldClient);
+    QVERIFY(oldWaylandClient);
+    QVERIFY(serverBuffer->resourceForClient(oldWaylandClient));
+    QTRY_VERIFY(oldReceiver.buffer);
+    QVERIFY(oldReceiver.fds[0] != -1);
+
+    // Each update goes to the file the client is not reading from
+    for (int i = 1; i < 4; ++i) {
+        image.fill(colors[i]);
+        QVERIFY(serverBuffer->update(image, image.rect()));
+        QTRY_COMPARE(receiver.updates, i);
+        QVERIFY(receiver.fds[1] != -1);
+        QCOMPARE(receiver.slot, uint(i % 2));
+        QCOMPARE(receiver.contents(int(receiver.slot)), image);
+        QCOMPARE(oldReceiver.contents(0), first);
+    }
+
+    // A version 2 client getting the buffer later sees the contents at that point
+    MockClient newClient;
+    QTRY_VERIFY(newClient.shmEmulationServerBufferId);
+    ShmServerBufferClient newReceiver(&newClient, 2);
+    wl_client *newWaylandClient = serverSideClient(&compositor, &newClient);
+    QVERIFY(newWaylandClient);
+    QVERIFY(serverBuffer->resourceForClient(newWaylandClient));
+    QTRY_VERIFY(newReceiver.buffer);
+    QCOMPARE(newReceiver.contents(0), image);
+    QCOMPARE(oldReceiver.contents(0), first);
+}
+
+void tst_WaylandCompositor::shmServerBufferWaitsForRelease()
+{
+    if (!QGuiApplication::platformNativeInterface())
+        QSKIP("The shm-emulation-server integration needs a platform native interface");
+
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration();
+    if (!integration)
+        QSKIP("The shm-emulation-server plugin is not available");
+
+    QImage image(16, 16, QImage::Format_RGBA8888);
+    image.fill(Qt::magenta);
+    const QImage first = image;
+    QScopedPointer<QtWayland::ServerBuffer> serverBuffer(integration->createServerBufferFromImage(image, QtWayland::ServerBuffer::RGBA32));
+
+    MockClient client;
+    QTRY_VERIFY(client.shmEmulationServerBufferId);
+    ShmServerBufferClient receiver(&client, 4);
+    receiver.autoRelease = false;
+    wl_client *waylandClient = serverSideClient(&compositor, &client);
+    QVERIFY(waylandClient);
+    QVERIFY(serverBuffer->resourceForClient(waylandClient));
+    QTRY_VERIFY(receiver.buffer);
+    if (receiver.fds[0] == -1)
+        QSKIP("memfd is not supported, the buffer was sent through QSharedMemory");
+
+    // Version 3 clients can't release a file, so they get a snapshot like version 2 clients
+    MockClient oldClient;
+    QTRY_VERIFY(oldClient.shmEmulationServerBufferId);
+    ShmServerBufferClient oldReceiver(&oldClient, 3);
+    wl_client *oldWaylandClient = serverSideClient(&compositor, &oldClient);
+    QVERIFY(oldWaylandClient);
+    QVERIFY(serverBuffer->resourceForClient(oldWaylandClient));
+    QTRY_VERIFY(oldReceiver.buffer);
+    QVERIFY(oldReceiver.fds[0] != -1);
+
+    image.fill(Qt::cyan);
+    const QImage second = image;
+    QVERIFY(serverBuffer->update(image, image.rect()));
+    QTRY_COMPARE(receiver.updates, 1);
+    QCOMPARE(receiver.slot, 1u);
+
+    // The client still reads from the first file, so later updates must not go there yet
+    image.fill(Qt::yellow);
+    QVERIFY(serverBuffer->update(image, image.rect()));
+    image.fill(Qt::green);
+    QVERIFY(serverBuffer->update(image, image.rect()));
+    compositor.flushClients();
+    QTest::qWait(50);
+    QCOMPARE(receiver.updates, 1);
+    QCOMPARE(receiver.contents(0), first);
+    QCOMPARE(receiver.contents(1), second);
+
+    // Once it's released, the updates go out merged into one
+    receiver.release();
+    QTRY_COMPARE(receiver.updates, 2);
+    QCOMPARE(receiver.slot, 0u);
+    QCOMPARE(receiver.contents(0), image);
+    QCOMPARE(receiver.contents(1), second);
+
+    QCOMPARE(oldReceiver.updates, 0);
+    QCOMPARE(oldReceiver.contents(0), first);
+}
+
+// Receives the fonts announced by a glyph cache
+class GlyphCacheClient
+{
+public:
+    struct Font {
+        QString family;
+        QByteArray id;
+        wl_fixed_t pixelSize;
+        QVector<QWaylandGlyphCacheEntry> entries;
+    };
+
+    explicit GlyphCacheClient(MockClient *client)
+        : glyphCache(static_cast<zqt_glyph_cache_v1 *>(
+                         wl_registry_bind(client->registry, client->glyphCacheId, &zqt_glyph_cache_v1_interface, 1)))
+    {
+        zqt_glyph_cache_v1_add_listener(glyphCache, &listener, this);
+    }
+
+    ~GlyphCacheClient()
+    {
+        zqt_glyph_cache_v1_destroy(glyphCache);
+    }
+
+    zqt_glyph_cache_v1 *glyphCache = nullptr;
+    QVector<Font> fonts;
+    int batches = 0;
+
+private:
+    static void atlas(void *, zqt_glyph_cache_v1 *, uint32_t, qt_server_buffer *)
+    {
+    }
+
+    static void font(void *data, zqt_glyph_cache_v1 *, const char *family, const char *, wl_array *fontId,
+                     wl_fixed_t pixelSize, int32_t fd, uint32_t glyphCount)
+    {
+        Font font;
+        font.family = QString::fromUtf8(family);
+        font.id = QByteArray(static_cast<const char *>(fontId->data), int(fontId->size));
+        font.pixelSize = pixelSize;
+        font.entries.resize(int(glyphCount));
+        const size_t size = glyphCount * sizeof(QWaylandGlyphCacheEntry);
+        void *entries = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (entries != MAP_FAILED) {
+            memcpy(font.entries.data(), entries, size);
+            munmap(entries, size);
+        }
+        close(fd);
+        static_cast<GlyphCacheClient *>(data)->fonts.append(font);
+    }
+
+    static void done(void *data, zqt_glyph_cache_v1 *)
+    {
+        ++static_cast<GlyphCacheClient *>(data)->batches;
+    }
+
+    static const zqt_glyph_cache_v1_listener listener;
+};
+
+const zqt_glyph_cache_v1_listener GlyphCacheClient::listener = {
+    GlyphCacheClient::atlas,
+    GlyphCacheClient::font,
+    GlyphCacheClient::done
+};
+
+void tst_WaylandCompositor::glyphCacheFontIdentity()
+{
+    if (!QGuiApplication::platformNativeInterface())
+        QSKIP("The shm-emulation-server integration needs a platform native interface");
+
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    TestCompositor compositor;
+    QWaylandGlyphCache glyphCache(&compositor);
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration();
+    if (!integration || !integration->supportsFormat(QtWayland::ServerBuffer::A8))
+        QSKIP("The shm-emulation-server plugin is not available");
+
+    QFont font;
+    font.setPixelSize(16);
+    const QRawFont rawFont = QRawFont::fromFont(font);
+    const QByteArray id = qWaylandGlyphCacheFontId(rawFont);
+    if (id.isEmpty())
+        QSKIP("This test needs a font with SFNT tables");
+    // The id only depends on the font file
+    QCOMPARE(qWaylandGlyphCacheFontId(QRawFont::fromFont(font)), id);
+
+    const QString characters = QStringLiteral("Wayland");
+    QVector<quint32> glyphIndexes = rawFont.glyphIndexesForString(characters);
+    std::sort(glyphIndexes.begin(), glyphIndexes.end());
+    glyphIndexes.erase(std::unique(glyphIndexes.begin(), glyphIndexes.end()), glyphIndexes.end());
+
+    QVERIFY(glyphCache.addFont(font, characters));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Font already added"));
+    QVERIFY(!glyphCache.addFont(font, characters));
+
+    MockClient client;
+    QTRY_VERIFY(client.glyphCacheId);
+    GlyphCacheClient receiver(&client);
+    QTRY_COMPARE(receiver.batches, 1);
+    QCOMPARE(receiver.fonts.size(), 1);
+    QCOMPARE(receiver.fonts.at(0).family, rawFont.familyName());
+    QCOMPARE(receiver.fonts.at(0).id, id);
+    QCOMPARE(receiver.fonts.at(0).pixelSize, wl_fixed_from_double(16));
+    QCOMPARE(receiver.fonts.at(0).entries.size(), glyphIndexes.size());
+    for (int i = 0; i < glyphIndexes.size(); ++i)
+        QCOMPARE(receiver.fonts.at(0).entries.at(i).glyphIndex, glyphIndexes.at(i));
+
+    // Bold glyphs are different glyphs, even if they come from the same file
+    QFont bold = font;
+    bold.setBold(true);
+    const QByteArray boldId = qWaylandGlyphCacheFontId(QRawFont::fromFont(bold));
+    QVERIFY(boldId != id);
+    QVERIFY(glyphCache.addFont(bold, characters));
+    QTRY_COMPARE(receiver.batches, 2);
+    QCOMPARE(receiver.fonts.size(), 2);
+    QCOMPARE(receiver.fonts.at(1).id, boldId);
+}
+#endif
+
 void tst_WaylandCompositor::removeOutput()
 {
     TestCompositor compositor;
@@ -657,22 +1505,204 @@ public:
     QWaylandXdgShellV5 xdgShell;
 };
 
-void tst_WaylandCompositor::advertisesXdgShellSupport()
+namespace {
+class BufferRefView : public QWaylandView
 {
-    XdgTestCompositor compositor;
-    compositor.create();
+public:
+    void bufferCommitted(const QWaylandBufferRef &ref, const QRegion &damage) override
+    {
+        Q_UNUSED(damage);
+        bufferRef = ref;
+    }
 
-    MockClient client;
-    QTRY_VERIFY(client.xdgShell);
+    QWaylandBufferRef bufferRef;
+};
+
+// White on the left, black on the right, no chroma
+void fillYuvTestBuffer(ShmBuffer *buffer, const QSize &size)
+{
+    buffer->image.fill(128);
+    for (int y = 0; y < size.height(); ++y) {
+        memset(buffer->image.scanLine(y), 235, size.width() / 2);
+        memset(buffer->image.scanLine(y) + size.width() / 2, 16, size.width() - size.width() / 2);
+    }
+}
 }
 
-void tst_WaylandCompositor::createsXdgSurfaces()
+void tst_WaylandCompositor::sharedMemoryYuvBuffers_data()
 {
-    XdgTestCompositor compositor;
-    compositor.create();
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("bufferFormat");
 
-    MockClient client;
-    QTRY_VERIFY(client.xdgShell);
+    QTest::newRow("nv12") << int(WL_SHM_FORMAT_NV12) << int(QWaylandBufferRef::BufferFormatEgl_Y_UV);
+    QTest::newRow("yuv420") << int(WL_SHM_FORMAT_YUV420) << int(QWaylandBufferRef::BufferFormatEgl_Y_U_V);
+}
+
+void tst_WaylandCompositor::sharedMemoryYuvBuffers()
+{
+    QFETCH(int, format);
+    QFETCH(int, bufferFormat);
+
+    qputenv("QT_WAYLAND_SHM_PLANAR_YUV", "1");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SHM_PLANAR_YUV");
+
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    BufferRefView view;
+    view.setSurface(compositor.surfaces.at(0));
+
+    QSize size(8, 8);
+    ShmBuffer buffer(size, client.shm, wl_shm_format(format));
+    fillYuvTestBuffer(&buffer, size);
+
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    QTRY_VERIFY(!view.bufferRef.isNull());
+    QVERIFY(view.bufferRef.isSharedMemory());
+    QCOMPARE(int(view.bufferRef.bufferFormatEgl()), bufferFormat);
+    QCOMPARE(view.bufferRef.size(), size);
+
+    QImage image = view.bufferRef.image();
+    QCOMPARE(image.size(), size);
+    QCOMPARE(image.pixel(0, 0), qRgb(255, 255, 255));
+    QCOMPARE(image.pixel(7, 7), qRgb(0, 0, 0));
+    QCOMPARE(client.error, 0);
+}
+
+void tst_WaylandCompositor::sharedMemoryYuvFormatsAreOptIn()
+{
+    {
+        TestCompositor compositor;
+        compositor.create();
+
+        MockClient client;
+        QTRY_VERIFY(client.shmFormats.contains(WL_SHM_FORMAT_ARGB8888));
+        QVERIFY(!client.shmFormats.contains(WL_SHM_FORMAT_NV12));
+        QVERIFY(!client.shmFormats.contains(WL_SHM_FORMAT_YUV420));
+    }
+
+    qputenv("QT_WAYLAND_SHM_PLANAR_YUV", "1");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SHM_PLANAR_YUV");
+
+    MockClient client;
+    QTRY_VERIFY(client.shmFormats.contains(WL_SHM_FORMAT_ARGB8888));
+    QVERIFY(client.shmFormats.contains(WL_SHM_FORMAT_NV12));
+    QVERIFY(client.shmFormats.contains(WL_SHM_FORMAT_YUV420));
+
+    // The interleaved chroma row of an odd width does not fit a stride of the width
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    BufferRefView view;
+    view.setSurface(compositor.surfaces.at(0));
+
+    QSize size(7, 8);
+    ShmBuffer buffer(size, client.shm, WL_SHM_FORMAT_NV12);
+    fillYuvTestBuffer(&buffer, size);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    QTRY_VERIFY(!view.bufferRef.isNull());
+    QTest::ignoreMessage(QtWarningMsg, "Rejecting planar YUV buffer with a stride of 7 for a width of 7");
+    QVERIFY(view.bufferRef.image().isNull());
+}
+
+#if QT_CONFIG(opengl)
+void tst_WaylandCompositor::sharedMemoryYuvTexture_data()
+{
+    QTest::addColumn<int>("format");
+
+    QTest::newRow("nv12") << int(WL_SHM_FORMAT_NV12);
+    QTest::newRow("yuv420") << int(WL_SHM_FORMAT_YUV420);
+}
+
+// Contexts that cannot sample the planes of a buffer, like NV12 without
+// two-component textures, get a single RGB texture instead of the luma plane.
+void tst_WaylandCompositor::sharedMemoryYuvTexture()
+{
+    QFETCH(int, format);
+
+    QOffscreenSurface offscreenSurface;
+    offscreenSurface.create();
+    QOpenGLContext context;
+    if (!context.create() || !context.makeCurrent(&offscreenSurface))
+        QSKIP("Could not make an OpenGL context current");
+
+    qputenv("QT_WAYLAND_SHM_PLANAR_YUV", "1");
+    TestCompositor compositor;
+    compositor.create();
+    qunsetenv("QT_WAYLAND_SHM_PLANAR_YUV");
+
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    BufferRefView view;
+    view.setSurface(compositor.surfaces.at(0));
+
+    QSize size(8, 8);
+    ShmBuffer buffer(size, client.shm, wl_shm_format(format));
+    fillYuvTestBuffer(&buffer, size);
+
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+
+    QTRY_VERIFY(!view.bufferRef.isNull());
+    QVERIFY(context.makeCurrent(&offscreenSurface));
+
+    QOpenGLTexture *texture = view.bufferRef.toOpenGLTexture(0);
+    QVERIFY(texture);
+    QCOMPARE(QSize(texture->width(), texture->height()), size);
+    if (QtWayland::SharedMemoryBuffer::canSamplePlanes(view.bufferRef.bufferFormatEgl())) {
+        QVERIFY(view.bufferRef.toOpenGLTexture(1));
+        return;
+    }
+
+    QVERIFY(!view.bufferRef.toOpenGLTexture(1));
+    QCOMPARE(texture->format(), QOpenGLTexture::RGBFormat);
+
+    QOpenGLFunctions *gl = context.functions();
+    GLuint fbo = 0;
+    gl->glGenFramebuffers(1, &fbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->textureId(), 0);
+    QCOMPARE(gl->glCheckFramebufferStatus(GL_FRAMEBUFFER), GLenum(GL_FRAMEBUFFER_COMPLETE));
+
+    QImage pixels(size, QImage::Format_RGBA8888);
+    gl->glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels.bits());
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, context.defaultFramebufferObject());
+    gl->glDeleteFramebuffers(1, &fbo);
+
+    QCOMPARE(pixels.pixel(0, 0), qRgb(255, 255, 255));
+    QCOMPARE(pixels.pixel(7, 7), qRgb(0, 0, 0));
+}
+#endif
+
+void tst_WaylandCompositor::advertisesXdgShellSupport()
+{
+    XdgTestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.xdgShell);
+}
+
+void tst_WaylandCompositor::createsXdgSurfaces()
+{
+    XdgTestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.xdgShell);
 
     QSignalSpy xdgSurfaceCreatedSpy(&compositor.xdgShell, &QWaylandXdgShellV5::xdgSurfaceCreated);
     QWaylandXdgSurfaceV5 *xdgSurface = nullptr;
@@ -847,6 +1877,431 @@ void tst_WaylandCompositor::sendsXdgConfigure()
     QTRY_VERIFY(!xdgSurface->resizing());
 }
 
+void tst_WaylandCompositor::coalescesXdgResizeConfigures_data()
+{
+    QTest::addColumn<int>("xdgShellVersion");
+
+    QTest::newRow("xdg-shell-v5") << 5;
+    QTest::newRow("xdg-shell-v6") << 6;
+}
+
+void tst_WaylandCompositor::coalescesXdgResizeConfigures()
+{
+    QFETCH(int, xdgShellVersion);
+
+    class MockXdgSurfaceV5 : public QtWayland::xdg_surface
+    {
+    public:
+        MockXdgSurfaceV5(::xdg_surface *xdgSurface) : QtWayland::xdg_surface(xdgSurface) {}
+        void xdg_surface_configure(int32_t width, int32_t height, wl_array *rawStates, uint32_t serial) override
+        {
+            Q_UNUSED(rawStates);
+            configureSize = QSize(width, height);
+            configureSerial = serial;
+            ++configureCount;
+        }
+
+        QSize configureSize;
+        uint configureSerial = 0;
+        int configureCount = 0;
+    };
+
+    class MockXdgSurfaceV6 : public QtWayland::zxdg_surface_v6
+    {
+    public:
+        MockXdgSurfaceV6(::zxdg_surface_v6 *xdgSurface) : QtWayland::zxdg_surface_v6(xdgSurface) {}
+        void zxdg_surface_v6_configure(uint32_t serial) override
+        {
+            configureSerial = serial;
+            ++configureCount;
+        }
+
+        uint configureSerial = 0;
+        int configureCount = 0;
+    };
+
+    class MockXdgToplevelV6 : public QtWayland::zxdg_toplevel_v6
+    {
+    public:
+        MockXdgToplevelV6(::zxdg_toplevel_v6 *toplevel) : QtWayland::zxdg_toplevel_v6(toplevel) {}
+        void zxdg_toplevel_v6_configure(int32_t width, int32_t height, wl_array *states) override
+        {
+            Q_UNUSED(states);
+            configureSize = QSize(width, height);
+        }
+
+        QSize configureSize;
+    };
+
+    TestCompositor compositor;
+    QWaylandXdgShellV5 xdgShellV5(&compositor);
+    QWaylandXdgShellV6 xdgShellV6(&compositor);
+    compositor.create();
+
+    QWaylandXdgSurfaceV5 *xdgSurfaceV5 = nullptr;
+    QObject::connect(&xdgShellV5, &QWaylandXdgShellV5::xdgSurfaceCreated, [&](QWaylandXdgSurfaceV5 *s) {
+        xdgSurfaceV5 = s;
+    });
+    QWaylandXdgToplevelV6 *toplevelV6 = nullptr;
+    QObject::connect(&xdgShellV6, &QWaylandXdgShellV6::toplevelCreated, [&](QWaylandXdgToplevelV6 *t) {
+        toplevelV6 = t;
+    });
+
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+
+    // Both versions have the same pacing API, only the protocol objects differ
+    QScopedPointer<MockXdgSurfaceV5> mockXdgSurfaceV5;
+    QScopedPointer<MockXdgSurfaceV6> mockXdgSurfaceV6;
+    QScopedPointer<MockXdgToplevelV6> mockToplevelV6;
+    std::function<uint(const QSize &)> sendResizing;
+    std::function<void()> setWaitForCommit;
+    std::function<bool()> sendsImmediately;
+    std::function<int()> configureCount;
+    std::function<void()> ackConfigure;
+    std::function<QSize()> configureSize;
+    QWaylandSurface *waylandSurface = nullptr;
+
+    if (xdgShellVersion == 5) {
+        mockXdgSurfaceV5.reset(new MockXdgSurfaceV5(client.createXdgSurface(surface)));
+        QTRY_VERIFY(xdgSurfaceV5);
+        waylandSurface = xdgSurfaceV5->surface();
+        sendResizing = [&](const QSize &size) { return xdgSurfaceV5->sendResizing(size); };
+        setWaitForCommit = [&]() { xdgSurfaceV5->setResizePacing(QWaylandXdgSurfaceV5::WaitForCommit); };
+        sendsImmediately = [&]() { return xdgSurfaceV5->resizePacing() == QWaylandXdgSurfaceV5::SendImmediately; };
+        configureCount = [&]() { return mockXdgSurfaceV5->configureCount; };
+        ackConfigure = [&]() { mockXdgSurfaceV5->ack_configure(mockXdgSurfaceV5->configureSerial); };
+        configureSize = [&]() { return mockXdgSurfaceV5->configureSize; };
+    } else {
+        mockXdgSurfaceV6.reset(new MockXdgSurfaceV6(client.createXdgSurfaceV6(surface)));
+        mockToplevelV6.reset(new MockXdgToplevelV6(mockXdgSurfaceV6->get_toplevel()));
+        wl_display_flush(client.display);
+        QTRY_VERIFY(toplevelV6);
+        // The toplevel is configured right away
+        QTRY_COMPARE(mockXdgSurfaceV6->configureCount, 1);
+        waylandSurface = toplevelV6->xdgSurface()->surface();
+        sendResizing = [&](const QSize &size) { return toplevelV6->sendResizing(size); };
+        setWaitForCommit = [&]() { toplevelV6->setResizePacing(QWaylandXdgToplevelV6::WaitForCommit); };
+        sendsImmediately = [&]() { return toplevelV6->resizePacing() == QWaylandXdgToplevelV6::SendImmediately; };
+        configureCount = [&]() { return mockXdgSurfaceV6->configureCount; };
+        ackConfigure = [&]() { mockXdgSurfaceV6->ack_configure(mockXdgSurfaceV6->configureSerial); };
+        configureSize = [&]() { return mockToplevelV6->configureSize; };
+    }
+
+    // By default every resize is sent, and returns its serial
+    QVERIFY(sendsImmediately());
+    const int initialCount = configureCount();
+    QVERIFY(sendResizing(QSize(50, 50)) != 0);
+    QVERIFY(sendResizing(QSize(60, 60)) != 0);
+    compositor.flushClients();
+    QTRY_COMPARE(configureCount(), initialCount + 2);
+
+    setWaitForCommit();
+    QSignalSpy redrawSpy(waylandSurface, SIGNAL(redraw()));
+
+    QSize size(100, 100);
+    ShmBuffer buffer(size, client.shm);
+
+    // A client that only gets around to handling events every 20th pointer motion
+    int ackedCount = configureCount();
+    for (int i = 0; i < 200; ++i) {
+        sendResizing(QSize(100 + i, 100 + i));
+        compositor.flushClients();
+
+        if (i % 20 != 19)
+            continue;
+
+        // Only the resize in flight has been sent, the rest has been coalesced
+        QTRY_COMPARE(configureCount(), ackedCount + 1);
+        ackedCount = configureCount();
+
+        ackConfigure();
+        wl_surface_attach(surface, buffer.handle, 0, 0);
+        wl_surface_damage(surface, 0, 0, size.width(), size.height());
+        wl_surface_commit(surface);
+        wl_display_flush(client.display);
+        QTRY_COMPARE(redrawSpy.count(), i / 20 + 1);
+    }
+
+    // The last commit releases the latest size
+    compositor.flushClients();
+    QTRY_COMPARE(configureSize(), QSize(299, 299));
+    QCOMPARE(configureCount(), initialCount + 2 + 11);
+}
+
+void tst_WaylandCompositor::detectsUnresponsiveXdgClients()
+{
+    class MockXdgShell : public QtWayland::xdg_shell
+    {
+    public:
+        MockXdgShell(::xdg_shell *xdgShell) : QtWayland::xdg_shell(xdgShell) {}
+        void xdg_shell_ping(uint32_t serial) override { pingSerial = serial; }
+        uint pingSerial = 0;
+    };
+
+    XdgTestCompositor compositor;
+    compositor.create();
+    compositor.xdgShell.setUnresponsiveTimeout(50);
+    compositor.xdgShell.setPingInterval(100);
+
+    QSignalSpy unresponsiveSpy(&compositor.xdgShell, SIGNAL(unresponsive(QWaylandClient*)));
+    QSignalSpy responsiveSpy(&compositor.xdgShell, SIGNAL(responsive(QWaylandClient*)));
+
+    MockClient client;
+    MockXdgShell mockXdgShell(client.xdgShell);
+    wl_surface *surface = client.createSurface();
+    client.createXdgSurface(surface);
+
+    // Only clients with mapped surfaces are pinged
+    QSize size(32, 32);
+    ShmBuffer buffer(size, client.shm);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+    wl_display_flush(client.display);
+
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandClient *waylandClient = compositor.surfaces.at(0)->client();
+    QVERIFY(waylandClient->isResponsive());
+    QCOMPARE(waylandClient->pingLatency(), -1);
+
+    // The client doesn't answer the ping
+    QTRY_VERIFY(mockXdgShell.pingSerial != 0);
+    QTRY_COMPARE(unresponsiveSpy.count(), 1);
+    QCOMPARE(unresponsiveSpy.first().first().value<QWaylandClient *>(), waylandClient);
+    QVERIFY(!waylandClient->isResponsive());
+
+    // Frame callbacks are held back while it is unresponsive
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    QWaylandView view;
+    view.setSurface(waylandSurface);
+    view.setOutput(compositor.defaultOutput());
+    QSignalSpy redrawSpy(waylandSurface, SIGNAL(redraw()));
+    int frameCounter = 0;
+    registerFrameCallback(surface, &frameCounter);
+    wl_surface_commit(surface);
+    wl_display_flush(client.display);
+    QTRY_COMPARE(redrawSpy.count(), 1);
+    compositor.defaultOutput()->frameStarted();
+    compositor.defaultOutput()->sendFrameCallbacks();
+    QTest::qWait(50);
+    QCOMPARE(frameCounter, 0);
+
+    // A late pong makes it responsive again and is recorded in the histogram
+    mockXdgShell.pong(mockXdgShell.pingSerial);
+    wl_display_flush(client.display);
+    QTRY_COMPARE(responsiveSpy.count(), 1);
+    QVERIFY(waylandClient->isResponsive());
+
+    // and the held back frame callback is sent right away. Nothing repaints the
+    // output here, the client would otherwise wait for it forever.
+    QTRY_COMPARE(frameCounter, 1);
+    QVERIFY(waylandClient->pingLatency() >= 50);
+
+    const QVector<int> histogram = waylandClient->pingLatencyHistogram();
+    QCOMPARE(histogram.size(), QWaylandClient::pingLatencyHistogramBounds().size() + 1);
+    int answeredPings = 0;
+    for (int count : histogram)
+        answeredPings += count;
+    QCOMPARE(answeredPings, 1);
+}
+
+class TextInputTestCompositor: public TestCompositor {
+    Q_OBJECT
+public:
+    TextInputTestCompositor() : textInputManager(this) {}
+    QWaylandTextInputManager textInputManager;
+};
+
+void tst_WaylandCompositor::textInputTyping_data()
+{
+    QTest::addColumn<int>("documentLength");
+
+    QTest::newRow("short") << 64;
+    // About as much surrounding text as fits in a single Wayland message
+    QTest::newRow("long") << 1600;
+}
+
+void tst_WaylandCompositor::textInputTyping()
+{
+    QFETCH(int, documentLength);
+
+    TextInputTestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.textInputManager);
+    QTRY_VERIFY(!client.m_seats.isEmpty());
+
+    wl_surface *surface = client.createSurface();
+    zwp_text_input_v2 *clientTextInput = zwp_text_input_manager_v2_get_text_input(client.textInputManager, client.m_seats.first()->m_seat);
+    wl_display_flush(client.display);
+
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandCompositorExtension *extension = nullptr;
+    QTRY_VERIFY((extension = compositor.defaultSeat()->extension(QByteArrayLiteral("zwp_text_input_v2"))));
+    auto textInput = static_cast<QWaylandTextInputPrivate *>(QObjectPrivate::get(extension));
+    textInput->setFocus(compositor.surfaces.at(0));
+
+    // A document mixing one and two byte UTF-8 characters, with the cursor in the middle
+    QString text;
+    while (text.length() < documentLength)
+        text += QStringLiteral("Notes r\u00e9sum\u00e9 ");
+    text.truncate(documentLength);
+    const int cursor = documentLength / 2;
+    const int cursorBytes = text.left(cursor).toUtf8().size();
+    zwp_text_input_v2_set_surrounding_text(clientTextInput, text.toUtf8().constData(), cursorBytes, cursorBytes);
+    zwp_text_input_v2_update_state(clientTextInput, 0, ZWP_TEXT_INPUT_V2_UPDATE_STATE_FULL);
+    wl_display_flush(client.display);
+    QTRY_COMPARE(textInput->inputMethodQuery(Qt::ImSurroundingText, QVariant()).toString(), text);
+    QCOMPARE(textInput->inputMethodQuery(Qt::ImCursorPosition, QVariant()).toInt(), cursor);
+
+    QInputMethodEvent keystroke;
+    keystroke.setCommitString(QStringLiteral("x"));
+    textInput->sendInputMethodEvent(&keystroke);
+    QCOMPARE(textInput->inputMethodQuery(Qt::ImSurroundingText, QVariant()).toString(),
+             text.left(cursor) + QLatin1Char('x') + text.mid(cursor));
+    QCOMPARE(textInput->inputMethodQuery(Qt::ImCursorPosition, QVariant()).toInt(), cursor + 1);
+
+    // Replacing the character before the cursor, as an auto correction would
+    QInputMethodEvent correction;
+    correction.setCommitString(QStringLiteral("\u00e9"), -1, 1);
+    textInput->sendInputMethodEvent(&correction);
+    QCOMPARE(textInput->inputMethodQuery(Qt::ImSurroundingText, QVariant()).toString(),
+             text.left(cursor) + QChar(0xe9) + text.mid(cursor));
+    QCOMPARE(textInput->inputMethodQuery(Qt::ImCursorPosition, QVariant()).toInt(), cursor + 1);
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i)
+            textInput->sendInputMethodEvent(&keystroke);
+        // Let the client drain the events so its socket doesn't fill up
+        compositor.flushClients();
+        QCoreApplication::processEvents();
+    }
+
+    zwp_text_input_v2_destroy(clientTextInput);
+    wl_surface_destroy(surface);
+}
+
+struct SelectionClient
+{
+    QHash<QByteArray, QByteArray> payloads;
+    QList<QByteArray> requested;
+    wl_data_offer *offer = nullptr;
+
+    static void sourceTarget(void *, wl_data_source *, const char *) {}
+    static void sourceSend(void *data, wl_data_source *, const char *mimeType, int32_t fd)
+    {
+        auto *self = static_cast<SelectionClient *>(data);
+        self->requested << QByteArray(mimeType);
+        const QByteArray payload = self->payloads.value(mimeType);
+        QVERIFY(write(fd, payload.constData(), size_t(payload.size())) == payload.size());
+        close(fd);
+    }
+    static void sourceCancelled(void *, wl_data_source *) {}
+
+    static void deviceDataOffer(void *data, wl_data_device *, wl_data_offer *offer)
+    {
+        static_cast<SelectionClient *>(data)->offer = offer;
+    }
+    static void deviceEnter(void *, wl_data_device *, uint32_t, wl_surface *, wl_fixed_t, wl_fixed_t, wl_data_offer *) {}
+    static void deviceLeave(void *, wl_data_device *) {}
+    static void deviceMotion(void *, wl_data_device *, uint32_t, wl_fixed_t, wl_fixed_t) {}
+    static void deviceDrop(void *, wl_data_device *) {}
+    static void deviceSelection(void *, wl_data_device *, wl_data_offer *) {}
+};
+
+static const wl_data_source_listener selectionSourceListener = {
+    SelectionClient::sourceTarget,
+    SelectionClient::sourceSend,
+    SelectionClient::sourceCancelled
+};
+
+static const wl_data_device_listener selectionDeviceListener = {
+    SelectionClient::deviceDataOffer,
+    SelectionClient::deviceEnter,
+    SelectionClient::deviceLeave,
+    SelectionClient::deviceMotion,
+    SelectionClient::deviceDrop,
+    SelectionClient::deviceSelection
+};
+
+void tst_WaylandCompositor::retainsSelectionLazily()
+{
+    TestCompositor compositor;
+    compositor.setRetainedSelectionEnabled(true);
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.dataDeviceManager);
+    QTRY_VERIFY(!client.m_seats.isEmpty());
+
+    const QByteArray text("Retained selection");
+    const QByteArray image(256 * 1024, 'i');
+
+    SelectionClient selection;
+    selection.payloads.insert("text/plain;charset=utf-8", text);
+    selection.payloads.insert("text/plain", text);
+    selection.payloads.insert("image/png", image);
+
+    wl_data_device *device = wl_data_device_manager_get_data_device(client.dataDeviceManager, client.m_seats.first()->m_seat);
+    wl_data_device_add_listener(device, &selectionDeviceListener, &selection);
+    wl_data_source *source = wl_data_device_manager_create_data_source(client.dataDeviceManager);
+    wl_data_source_add_listener(source, &selectionSourceListener, &selection);
+    wl_data_source_offer(source, "image/png");
+    wl_data_source_offer(source, "text/plain;charset=utf-8");
+    wl_data_source_offer(source, "text/plain");
+    wl_data_device_set_selection(device, source, 0);
+    wl_display_flush(client.display);
+
+    // Only the text formats are fetched up front, and they share one payload
+    QtWayland::DataDeviceManager *manager = QWaylandCompositorPrivate::get(&compositor)->dataDeviceManager();
+    QTRY_COMPARE(manager->retainedSelectionStats().retainedFormats, 2);
+    QCOMPARE(manager->retainedSelectionStats().offeredFormats, 3);
+    QCOMPARE(manager->retainedSelectionStats().deduplicatedFormats, 1);
+    QCOMPARE(manager->retainedSelectionStats().bytesInMemory, qint64(text.size()));
+    QVERIFY(!selection.requested.contains("image/png"));
+
+    // The compositor itself only gets to see what can be read right away
+    const QMimeData *mimeData = manager->retainedSelection();
+    QCOMPARE(mimeData->formats(), QStringList() << "text/plain;charset=utf-8" << "text/plain");
+    QVERIFY(!mimeData->hasFormat("image/png"));
+    QCOMPARE(mimeData->data("text/plain"), text);
+
+    // The image is fetched from the source once a client asks for it
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    compositor.surfaces.at(0)->updateSelection();
+    QTRY_VERIFY(selection.offer);
+
+    int fd[2];
+    QCOMPARE(pipe2(fd, O_CLOEXEC | O_NONBLOCK), 0);
+    wl_data_offer_receive(selection.offer, "image/png", fd[1]);
+    close(fd[1]);
+    wl_display_flush(client.display);
+
+    QByteArray received;
+    QTRY_VERIFY_WITH_TIMEOUT(([&]() {
+        char buffer[65536];
+        ssize_t n;
+        while ((n = read(fd[0], buffer, sizeof(buffer))) > 0)
+            received.append(buffer, int(n));
+        return n == 0;
+    }()), 10000);
+    close(fd[0]);
+
+    QCOMPARE(received, image);
+    QCOMPARE(selection.requested.count("image/png"), 1);
+    QCOMPARE(manager->retainedSelectionStats().retainedFormats, 3);
+    QCOMPARE(manager->retainedSelectionStats().lazyFetches, 1);
+    QVERIFY(mimeData->hasFormat("image/png"));
+
+    wl_data_offer_destroy(selection.offer);
+    wl_data_source_destroy(source);
+    wl_data_device_destroy(device);
+    wl_surface_destroy(surface);
+}
+
 class IviTestCompositor: public TestCompositor {
     Q_OBJECT
 public:
@@ -1035,5 +2490,212 @@ void tst_WaylandCompositor::xdgShellV6Positioner()
     QCOMPARE(p.unconstrainedPosition(), QPoint(1 + 800 - 100 / 2 + 4, 2 + 600 / 2 - 50 + 8));
 }
 
+class ViewporterTestCompositor: public TestCompositor {
+    Q_OBJECT
+public:
+    ViewporterTestCompositor() : viewporter(this) {}
+    QWaylandViewporter viewporter;
+};
+
+void tst_WaylandCompositor::viewporterScalesAndCrops()
+{
+    ViewporterTestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.viewporter);
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    wp_viewport *viewport = wp_viewporter_get_viewport(client.viewporter, surface);
+
+    QSize size(128, 64);
+    ShmBuffer buffer(size, client.shm);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+
+    // Scale the buffer up to twice its size
+    wp_viewport_set_destination(viewport, 256, 128);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(waylandSurface->destinationSize(), QSize(256, 128));
+    QCOMPARE(waylandSurface->size(), QSize(256, 128));
+    QCOMPARE(waylandSurface->sourceGeometry(), QRectF(0, 0, 128, 64));
+
+    // Crop without scaling
+    wp_viewport_set_destination(viewport, -1, -1);
+    wp_viewport_set_source(viewport, wl_fixed_from_int(16), wl_fixed_from_int(8),
+                           wl_fixed_from_int(32), wl_fixed_from_int(16));
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(waylandSurface->destinationSize(), QSize(32, 16));
+    QCOMPARE(waylandSurface->sourceGeometry(), QRectF(16, 8, 32, 16));
+
+    // Destroying the viewport restores the buffer size on the next commit
+    wp_viewport_destroy(viewport);
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(waylandSurface->destinationSize(), size);
+    QCOMPARE(waylandSurface->size(), size);
+    QCOMPARE(waylandSurface->sourceGeometry(), QRectF(QPointF(), size));
+    QCOMPARE(client.error, 0);
+}
+
+void tst_WaylandCompositor::viewporterEmitsErrorOnOutOfBufferSource()
+{
+    ViewporterTestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.viewporter);
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    wp_viewport *viewport = wp_viewporter_get_viewport(client.viewporter, surface);
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wp_viewport_set_source(viewport, wl_fixed_from_int(32), wl_fixed_from_int(32),
+                           wl_fixed_from_int(64), wl_fixed_from_int(64));
+    wl_surface_commit(surface);
+
+    QTRY_COMPARE(client.error, EPROTO);
+    QCOMPARE(client.protocolError.interface, &wp_viewport_interface);
+    QCOMPARE(static_cast<wp_viewport_error>(client.protocolError.code), WP_VIEWPORT_ERROR_OUT_OF_BUFFER);
+}
+
+class PresentationTimeTestCompositor: public TestCompositor {
+    Q_OBJECT
+public:
+    PresentationTimeTestCompositor() : presentationTime(this) {}
+    QWaylandPresentationTime presentationTime;
+};
+
+struct PresentationFeedback
+{
+    PresentationFeedback(wp_presentation *presentation, wl_surface *surface)
+    {
+        struct wp_presentation_feedback *feedback = wp_presentation_feedback(presentation, surface);
+        wp_presentation_feedback_add_listener(feedback, &listener, this);
+    }
+
+    static void syncOutput(void *data, struct wp_presentation_feedback *, wl_output *output)
+    {
+        static_cast<PresentationFeedback *>(data)->output = output;
+    }
+
+    static void presented(void *data, struct wp_presentation_feedback *feedback,
+                          uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags)
+    {
+        Q_UNUSED(flags);
+        auto self = static_cast<PresentationFeedback *>(data);
+        self->presented = true;
+        self->timestamp = ((quint64(tv_sec_hi) << 32 | tv_sec_lo) * 1000000000) + tv_nsec;
+        self->refresh = refresh;
+        self->sequence = quint64(seq_hi) << 32 | seq_lo;
+        wp_presentation_feedback_destroy(feedback);
+    }
+
+    static void discarded(void *data, struct wp_presentation_feedback *feedback)
+    {
+        static_cast<PresentationFeedback *>(data)->discarded = true;
+        wp_presentation_feedback_destroy(feedback);
+    }
+
+    static const wp_presentation_feedback_listener listener;
+
+    wl_output *output = nullptr;
+    bool presented = false;
+    bool discarded = false;
+    quint64 timestamp = 0;
+    uint refresh = 0;
+    quint64 sequence = 0;
+};
+
+const wp_presentation_feedback_listener PresentationFeedback::listener = {
+    PresentationFeedback::syncOutput,
+    PresentationFeedback::presented,
+    PresentationFeedback::discarded
+};
+
+void tst_WaylandCompositor::presentationFeedbackIsPresented()
+{
+    PresentationTimeTestCompositor compositor;
+    compositor.create();
+    QWaylandOutput *output = compositor.defaultOutput();
+    QWaylandOutputMode mode(QSize(1024, 768), 60000);
+    output->addMode(mode, true);
+    output->setCurrentMode(mode);
+
+    // The output is not backed by a QQuickWindow, so report presentation manually
+    QWaylandOutputPrivate *outputPrivate = QWaylandOutputPrivate::get(output);
+    outputPrivate->reportsPresentation = true;
+
+    MockClient client;
+    QTRY_VERIFY(client.presentation);
+    QTRY_COMPARE(client.presentationClockId, uint(CLOCK_MONOTONIC));
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QWaylandView view;
+    view.setSurface(waylandSurface);
+    view.setOutput(output);
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    PresentationFeedback feedback(client.presentation, surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_commit(surface);
+    QTRY_VERIFY(waylandSurface->hasContent());
+
+    output->frameStarted();
+    outputPrivate->sendPresentationFeedbacks(outputPrivate->latchedFrame, Q_INT64_C(12000000042), 0);
+
+    QTRY_VERIFY(feedback.presented);
+    QVERIFY(!feedback.discarded);
+    QCOMPARE(feedback.output, client.m_outputs.first());
+    QCOMPARE(feedback.timestamp, Q_UINT64_C(12000000042));
+    QCOMPARE(feedback.refresh, 16666666u);
+    QCOMPARE(feedback.sequence, Q_UINT64_C(1));
+    QCOMPARE(client.error, 0);
+}
+
+void tst_WaylandCompositor::presentationFeedbackIsDiscarded()
+{
+    PresentationTimeTestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_VERIFY(client.presentation);
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    QSize size(64, 64);
+    ShmBuffer buffer(size, client.shm);
+    PresentationFeedback superseded(client.presentation, surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_commit(surface);
+
+    // A content update that is replaced before being shown is discarded
+    PresentationFeedback destroyed(client.presentation, surface);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_commit(surface);
+    QTRY_VERIFY(superseded.discarded);
+    QVERIFY(!destroyed.discarded);
+
+    // So are the updates of destroyed surfaces
+    wl_surface_destroy(surface);
+    QTRY_VERIFY(destroyed.discarded);
+    QVERIFY(!superseded.presented && !destroyed.presented);
+    QCOMPARE(client.error, 0);
+}
+
 #include <tst_compositor.moc>
 QTEST_MAIN(tst_WaylandCompositor);